@@ -0,0 +1,590 @@
+/*
+ * bench/bench.c
+ *
+ * Microbenchmarks dos coletores e exportadores (make bench).
+ *
+ * Para cada caso e cada escala (1..10k alvos), roda repetições de
+ * aquecimento descartadas e depois REPS repetições medidas; cada repetição
+ * chama o coletor uma vez por alvo (ou exporta N amostras) e registra:
+ *   - ns/amostra (CLOCK_MONOTONIC; mediana, mínimo e máximo entre repetições);
+ *   - syscalls/amostra (tracepoint raw_syscalls:sys_enter via perf_event_open,
+ *     contado só nesta thread; sem permissão, syscr+syscw de
+ *     /proc/thread-self/io, que não vê open/close);
+ *   - alocações/amostra (malloc/calloc/realloc interpostos neste binário).
+ *
+ * O resultado vai para um JSON (um resultado por linha) e, com --compare,
+ * é confrontado com uma execução anterior: regressão acima do limiar na
+ * mediana e no mínimo de ns/amostra, ou qualquer syscall/alocação a mais
+ * por amostra, faz o programa sair com 1.
+ *
+ * Com --proc-root/--cgroup-root os coletores leem uma árvore sintética
+ * (resource_monitor --make-fixture), o que permite medir 50k processos
+ * sem root e sem depender da carga da máquina.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <linux/perf_event.h>
+#include "../include/monitor.h"
+#include "../include/cgroup.h"
+#include "../include/export.h"
+#include "../include/sketch.h"
+#include "../include/top.h"
+
+#define BENCH_MAX_SCALES 16
+#define BENCH_MAX_RESULTS 256
+#define BENCH_MAX_REPS 101
+
+/* ===================== ALOCAÇÕES ====================== */
+
+/* substitui o malloc da glibc neste binário; os __libc_* são o alocador original */
+extern void *__libc_malloc(size_t n);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *p, size_t n);
+extern void __libc_free(void *p);
+
+static __thread unsigned long long t_allocs;
+
+void *malloc(size_t n) {
+    t_allocs++;
+    return __libc_malloc(n);
+}
+
+void *calloc(size_t n, size_t size) {
+    t_allocs++;
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *p, size_t n) {
+    if (!p) t_allocs++;
+    return __libc_realloc(p, n);
+}
+
+void free(void *p) {
+    __libc_free(p);
+}
+
+/* ===================== SYSCALLS ====================== */
+
+static int g_sys_fd = -1;
+static const char *g_sys_source = "proc_io";
+
+static void syscalls_open(void) {
+    static const char *ids[] = {
+        "/sys/kernel/tracing/events/raw_syscalls/sys_enter/id",
+        "/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id",
+    };
+    for (size_t i = 0; i < sizeof(ids) / sizeof(ids[0]); i++) {
+        FILE *f = fopen(ids[i], "r");
+        if (!f) continue;
+        unsigned long long id = 0;
+        int ok = fscanf(f, "%llu", &id) == 1;
+        fclose(f);
+        if (!ok) continue;
+
+        struct perf_event_attr a;
+        memset(&a, 0, sizeof(a));
+        a.size = sizeof(a);
+        a.type = PERF_TYPE_TRACEPOINT;
+        a.config = id;
+        int fd = (int)syscall(SYS_perf_event_open, &a, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+        if (fd >= 0) {
+            g_sys_fd = fd;
+            g_sys_source = "tracepoint";
+            return;
+        }
+    }
+    g_sys_fd = open("/proc/thread-self/io", O_RDONLY | O_CLOEXEC);
+    if (g_sys_fd < 0) g_sys_source = "none";
+}
+
+/* a própria leitura entra na contagem uma vez entre duas chamadas: o chamador desconta 1 */
+static unsigned long long syscalls_now(void) {
+    if (g_sys_fd < 0) return 0;
+    if (strcmp(g_sys_source, "tracepoint") == 0) {
+        unsigned long long v = 0;
+        if (read(g_sys_fd, &v, sizeof(v)) != sizeof(v)) return 0;
+        return v;
+    }
+    char buf[512];
+    ssize_t n = pread(g_sys_fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) return 0;
+    buf[n] = '\0';
+    unsigned long long r = 0, w = 0;
+    char *p;
+    if ((p = strstr(buf, "syscr:"))) r = strtoull(p + 6, NULL, 10);
+    if ((p = strstr(buf, "syscw:"))) w = strtoull(p + 6, NULL, 10);
+    return r + w;
+}
+
+/* ===================== CASOS ====================== */
+
+typedef struct {
+    pid_t *pids;            // alvos (PIDs existentes repetidos até a escala)
+    size_t npids;
+    proc_metrics_t *samples;
+    size_t n;               // escala atual
+    const char *cgroup;     // --cgroup (cgroup_metrics)
+    char path[256];         // arquivo temporário dos exportadores
+    top_collector_t top;
+    fd_state_t *fds;        // uma listagem anterior por alvo (fd_usage)
+} bench_ctx_t;
+
+typedef struct {
+    const char *name;
+    const char *kind;       // "collector" ou "exporter"
+    int fixed_scale;        // 1: escala = processos do sistema (varredura do top)
+    int (*setup)(bench_ctx_t *c);
+    void (*run)(bench_ctx_t *c);
+    void (*teardown)(bench_ctx_t *c);
+} bench_case_t;
+
+static void run_cpu(bench_ctx_t *c) {
+    double v;
+    for (size_t i = 0; i < c->n; i++) monitor_cpu_usage(c->pids[i], &v);
+}
+
+static void run_mem(bench_ctx_t *c) {
+    unsigned long rss, vsz, minflt, majflt, swap;
+    for (size_t i = 0; i < c->n; i++) monitor_memory_usage(c->pids[i], &rss, &vsz, &minflt, &majflt, &swap);
+}
+
+static void run_smaps(bench_ctx_t *c) {
+    smaps_rollup_t r;
+    for (size_t i = 0; i < c->n; i++) monitor_smaps_rollup(c->pids[i], &r);
+}
+
+static void run_io(bench_ctx_t *c) {
+    unsigned long long r, w, rb, wb, sc;
+    for (size_t i = 0; i < c->n; i++) monitor_io_usage(c->pids[i], &r, &w, &rb, &wb, &sc);
+}
+
+/* um estado para todos os alvos: mede a leitura das threads, não os deltas */
+static void run_sched(bench_ctx_t *c) {
+    static schedstat_state_t st;
+    double run, wait;
+    unsigned long long slices;
+    for (size_t i = 0; i < c->n; i++) monitor_schedstat(c->pids[i], &st, &run, &wait, &slices);
+}
+
+/* sem cache: cada alvo lê net/dev e net/snmp */
+static void run_net(bench_ctx_t *c) {
+    net_counters_t nc;
+    for (size_t i = 0; i < c->n; i++) monitor_net_usage(c->pids[i], &nc);
+}
+
+/* um tick do cache: cada netns distinto é lido uma vez, os demais alvos reusam */
+static void run_net_netns(bench_ctx_t *c) {
+    static netns_cache_t cache;
+    netns_cache_begin(&cache);
+    for (size_t i = 0; i < c->n; i++)
+        netns_cache_read(&cache, c->pids[i], monitor_netns(c->pids[i]), NULL, NULL);
+}
+
+/* primeiro tick: readlink de todos os descritores */
+static void run_fd_full(bench_ctx_t *c) {
+    fd_counts_t fc;
+    for (size_t i = 0; i < c->n; i++) {
+        fd_state_t st = {0};
+        monitor_fd_usage(c->pids[i], &st, &fc);
+        monitor_fd_free(&st);
+    }
+}
+
+/* regime: listagem por getdents64, readlink só dos novos e da releitura completa */
+static int setup_fd(bench_ctx_t *c) {
+    c->fds = calloc(c->n, sizeof(*c->fds));
+    if (!c->fds) return -1;
+    fd_counts_t fc;
+    for (size_t i = 0; i < c->n; i++) monitor_fd_usage(c->pids[i], &c->fds[i], &fc);
+    return 0;
+}
+
+static void run_fd(bench_ctx_t *c) {
+    fd_counts_t fc;
+    for (size_t i = 0; i < c->n; i++) monitor_fd_usage(c->pids[i], &c->fds[i], &fc);
+}
+
+/* --fd-sockets: net/tcp e net/tcp6 cruzados com os sockets de cada alvo */
+static void run_tcp_states(bench_ctx_t *c) {
+    tcp_states_t ts;
+    for (size_t i = 0; i < c->n; i++)
+        monitor_tcp_states(c->pids[i], c->fds[i].sockets, c->fds[i].nsockets, &ts);
+}
+
+static void teardown_fd(bench_ctx_t *c) {
+    for (size_t i = 0; i < c->n; i++) monitor_fd_free(&c->fds[i]);
+    free(c->fds);
+    c->fds = NULL;
+}
+
+static void run_mem_available(bench_ctx_t *c) {
+    unsigned long avail, total;
+    for (size_t i = 0; i < c->n; i++) monitor_mem_available(&avail, &total);
+}
+
+static void run_pressure(bench_ctx_t *c) {
+    cgroup_psi_metrics_t psi;
+    for (size_t i = 0; i < c->n; i++) cgroup_read_system_pressure(&psi);
+}
+
+static int setup_cgroup(bench_ctx_t *c) {
+    return c->cgroup ? 0 : -1;
+}
+
+static void run_cgroup(bench_ctx_t *c) {
+    cgroup_metrics_t cg;
+    for (size_t i = 0; i < c->n; i++) cgroup_read_metrics(c->cgroup, &cg);
+}
+
+static void unlink_outputs(bench_ctx_t *c) {
+    char idx[300];
+    unlink(c->path);
+    snprintf(idx, sizeof(idx), "%s.idx", c->path);
+    unlink(idx);
+}
+
+static void run_csv(bench_ctx_t *c) {
+    export_metrics_csv(c->path, c->samples, c->n);
+}
+
+static void run_json(bench_ctx_t *c) {
+    export_metrics_json(c->path, c->samples, c->n);
+}
+
+static void run_rmb(bench_ctx_t *c) {
+    export_metrics_rmb(c->path, c->samples, c->n);
+}
+
+static void run_summary(bench_ctx_t *c) {
+    metric_summary_t *s = malloc(sizeof(*s));
+    metric_summary_init(s, c->samples[0].pid);
+    for (size_t i = 0; i < c->n; i++) metric_summary_add(s, &c->samples[i]);
+    export_summary(c->path, s, 1);
+    free(s);
+}
+
+static int setup_top(bench_ctx_t *c, int backend) {
+    if (top_collector_init(&c->top, 1000) != 0) return -1;
+    c->top.workers = 1;
+    c->top.io_backend = backend;
+    c->top.proc_root = monitor_proc_root();
+    return top_collector_scan(&c->top);     // estado anterior e descritores já abertos
+}
+
+static int setup_top_pread(bench_ctx_t *c) { return setup_top(c, BATCHREAD_PREAD); }
+static int setup_top_uring(bench_ctx_t *c) { return setup_top(c, BATCHREAD_URING); }
+
+static void run_top(bench_ctx_t *c) {
+    top_collector_scan(&c->top);
+}
+
+static void teardown_top(bench_ctx_t *c) {
+    top_collector_free(&c->top);
+}
+
+static const bench_case_t k_cases[] = {
+    { "cpu_usage",       "collector", 0, NULL, run_cpu, NULL },
+    { "memory_usage",    "collector", 0, NULL, run_mem, NULL },
+    { "io_usage",        "collector", 0, NULL, run_io, NULL },
+    { "schedstat",       "collector", 0, NULL, run_sched, NULL },
+    { "smaps_rollup",    "collector", 0, NULL, run_smaps, NULL },
+    { "net_usage",       "collector", 0, NULL, run_net, NULL },
+    { "net_usage_netns", "collector", 0, NULL, run_net_netns, NULL },
+    { "fd_usage_full",   "collector", 0, NULL, run_fd_full, NULL },
+    { "fd_usage",        "collector", 0, setup_fd, run_fd, teardown_fd },
+    { "tcp_states",      "collector", 0, setup_fd, run_tcp_states, teardown_fd },
+    { "mem_available",   "collector", 0, NULL, run_mem_available, NULL },
+    { "system_pressure", "collector", 0, NULL, run_pressure, NULL },
+    { "cgroup_metrics",  "collector", 0, setup_cgroup, run_cgroup, NULL },
+    { "top_scan_pread",  "collector", 1, setup_top_pread, run_top, teardown_top },
+    { "top_scan_uring",  "collector", 1, setup_top_uring, run_top, teardown_top },
+    { "export_csv",      "exporter",  0, NULL, run_csv, unlink_outputs },
+    { "export_json",     "exporter",  0, NULL, run_json, unlink_outputs },
+    { "export_rmb",      "exporter",  0, NULL, run_rmb, unlink_outputs },
+    { "export_summary",  "exporter",  0, NULL, run_summary, unlink_outputs },
+};
+
+/* ===================== MEDIÇÃO ====================== */
+
+typedef struct {
+    char name[32];
+    char kind[16];
+    size_t targets;
+    double ns_median, ns_min, ns_max;
+    double syscalls;
+    double allocs;
+} bench_result_t;
+
+static double now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void measure(const bench_case_t *bc, bench_ctx_t *c, size_t per_rep, int warmup, int reps,
+                    bench_result_t *r) {
+    double ns[BENCH_MAX_REPS];
+    unsigned long long sys = 0, allocs = 0;
+    for (int w = 0; w < warmup; w++) bc->run(c);
+    for (int k = 0; k < reps; k++) {
+        unsigned long long s0 = syscalls_now(), a0 = t_allocs;
+        double t0 = now_ns();
+        bc->run(c);
+        double t1 = now_ns();
+        unsigned long long a1 = t_allocs, s1 = syscalls_now();
+        ns[k] = (t1 - t0) / (double)per_rep;
+        allocs += a1 - a0;
+        sys += s1 - s0 > 0 ? s1 - s0 - 1 : 0;
+    }
+    qsort(ns, (size_t)reps, sizeof(double), cmp_double);
+    snprintf(r->name, sizeof(r->name), "%s", bc->name);
+    snprintf(r->kind, sizeof(r->kind), "%s", bc->kind);
+    r->targets = per_rep;
+    r->ns_median = reps % 2 ? ns[reps / 2] : (ns[reps / 2 - 1] + ns[reps / 2]) / 2.0;
+    r->ns_min = ns[0];
+    r->ns_max = ns[reps - 1];
+    r->syscalls = (double)sys / ((double)reps * (double)per_rep);
+    r->allocs = (double)allocs / ((double)reps * (double)per_rep);
+}
+
+/* PIDs da raiz de /proc, repetidos em ciclo até max alvos */
+static size_t collect_pids(pid_t *out, size_t max, size_t *distinct) {
+    DIR *d = opendir(monitor_proc_root());
+    size_t n = 0;
+    struct dirent *e;
+    while (d && (e = readdir(d)) && n < max) {
+        char *end;
+        long pid = strtol(e->d_name, &end, 10);
+        if (*end == '\0' && pid > 0) out[n++] = (pid_t)pid;
+    }
+    if (d) closedir(d);
+    *distinct = n;
+    if (n == 0) out[n++] = getpid();
+    for (size_t i = n; i < max; i++) out[i] = out[i % n];
+    return max;
+}
+
+/* ===================== SAÍDA E COMPARAÇÃO ====================== */
+
+static int write_json(const char *path, const bench_result_t *res, size_t n, int warmup, int reps,
+                      size_t distinct) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror("Erro ao criar arquivo do benchmark");
+        return -1;
+    }
+    struct utsname u;
+    uname(&u);
+    fprintf(f, "{\n  \"version\": 1,\n  \"timestamp\": %ld,\n  \"kernel\": \"%s\",\n  \"cpus\": %ld,\n",
+            (long)time(NULL), u.release, sysconf(_SC_NPROCESSORS_ONLN));
+    fprintf(f, "  \"syscall_source\": \"%s\",\n  \"warmup\": %d,\n  \"reps\": %d,\n  \"distinct_pids\": %zu,\n",
+            g_sys_source, warmup, reps, distinct);
+    fprintf(f, "  \"results\": [\n");
+    for (size_t i = 0; i < n; i++) {
+        const bench_result_t *r = &res[i];
+        fprintf(f, "    {\"name\": \"%s\", \"kind\": \"%s\", \"targets\": %zu, \"ns_per_sample\": %.1f, "
+                "\"ns_min\": %.1f, \"ns_max\": %.1f, \"syscalls_per_sample\": %.3f, "
+                "\"allocs_per_sample\": %.3f}%s\n", r->name, r->kind, r->targets, r->ns_median,
+                r->ns_min, r->ns_max, r->syscalls, r->allocs, i + 1 < n ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return 0;
+}
+
+/* lê as linhas de resultado de um JSON gravado por write_json */
+static size_t read_json(const char *path, bench_result_t *out, size_t max) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror("Erro ao abrir a referência do benchmark");
+        return 0;
+    }
+    char line[512];
+    size_t n = 0;
+    while (n < max && fgets(line, sizeof(line), f)) {
+        bench_result_t *r = &out[n];
+        memset(r, 0, sizeof(*r));
+        if (sscanf(line, " {\"name\": \"%31[^\"]\", \"kind\": \"%15[^\"]\", \"targets\": %zu, "
+                   "\"ns_per_sample\": %lf, \"ns_min\": %lf, \"ns_max\": %lf, "
+                   "\"syscalls_per_sample\": %lf, \"allocs_per_sample\": %lf",
+                   r->name, r->kind, &r->targets, &r->ns_median, &r->ns_min, &r->ns_max,
+                   &r->syscalls, &r->allocs) == 8)
+            n++;
+    }
+    fclose(f);
+    return n;
+}
+
+static int compare(const bench_result_t *cur, size_t n, const char *base_path, double threshold_pct) {
+    static bench_result_t base[BENCH_MAX_RESULTS];
+    size_t nb = read_json(base_path, base, BENCH_MAX_RESULTS);
+    if (nb == 0) {
+        fprintf(stderr, "Referência sem resultados: %s\n", base_path);
+        return -1;
+    }
+    int regressions = 0;
+    double lim = 1.0 + threshold_pct / 100.0;
+    printf("\nComparação com %s (limiar %.0f%%):\n", base_path, threshold_pct);
+    for (size_t i = 0; i < n; i++) {
+        const bench_result_t *b = NULL;
+        for (size_t j = 0; j < nb && !b; j++)
+            if (strcmp(base[j].name, cur[i].name) == 0 && base[j].targets == cur[i].targets) b = &base[j];
+        if (!b) continue;
+
+        /* mediana e mínimo precisam piorar juntos: um único pico de ruído não reprova */
+        int slow = cur[i].ns_median > b->ns_median * lim && cur[i].ns_min > b->ns_min * lim;
+        int more_sys = cur[i].syscalls > b->syscalls + 0.5;
+        int more_alloc = cur[i].allocs > b->allocs + 0.5;
+        double delta = b->ns_median > 0.0 ? 100.0 * (cur[i].ns_median / b->ns_median - 1.0) : 0.0;
+        if (slow || more_sys || more_alloc) regressions++;
+        printf("  %s %-16s %6zu  %+7.1f%%  syscalls %.2f -> %.2f  alocações %.2f -> %.2f\n",
+               slow || more_sys || more_alloc ? "❌" : "  ", cur[i].name, cur[i].targets, delta,
+               b->syscalls, cur[i].syscalls, b->allocs, cur[i].allocs);
+    }
+    if (regressions) printf("%d regressões.\n", regressions);
+    return regressions ? 1 : 0;
+}
+
+/* ===================== PRINCIPAL ====================== */
+
+static size_t parse_scales(const char *spec, size_t *out) {
+    size_t n = 0;
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", spec);
+    for (char *tok = strtok(buf, ","); tok && n < BENCH_MAX_SCALES; tok = strtok(NULL, ",")) {
+        long v = atol(tok);
+        if (v > 0) out[n++] = (size_t)v;
+    }
+    return n;
+}
+
+static void usage(void) {
+    fprintf(stderr, "Uso: bench [--targets 1,10,100,1000,10000] [--reps N] [--warmup N] [--only nome]\n"
+                    "             [--cgroup grupo] [--pin-cpu n] [--out arquivo.json]\n"
+                    "             [--proc-root dir] [--cgroup-root dir]\n"
+                    "             [--compare referência.json] [--threshold pct]\n");
+}
+
+int main(int argc, char *argv[]) {
+    size_t scales[BENCH_MAX_SCALES];
+    size_t nscales = parse_scales("1,10,100,1000,10000", scales);
+    int reps = 7, warmup = 2, pin_cpu = -1;
+    double threshold = 10.0;
+    const char *out = "bench.json", *base = NULL, *only = NULL;
+    bench_ctx_t c;
+    memset(&c, 0, sizeof(c));
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--targets") == 0 && i + 1 < argc) nscales = parse_scales(argv[++i], scales);
+        else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) reps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) warmup = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--only") == 0 && i + 1 < argc) only = argv[++i];
+        else if (strcmp(argv[i], "--cgroup") == 0 && i + 1 < argc) c.cgroup = argv[++i];
+        else if (strcmp(argv[i], "--pin-cpu") == 0 && i + 1 < argc) pin_cpu = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) out = argv[++i];
+        else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) base = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) threshold = atof(argv[++i]);
+        else if (strcmp(argv[i], "--proc-root") == 0 && i + 1 < argc) monitor_set_proc_root(argv[++i]);
+        else if (strcmp(argv[i], "--cgroup-root") == 0 && i + 1 < argc) cgroup_set_root(argv[++i]);
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (nscales == 0 || reps < 1 || reps > BENCH_MAX_REPS || warmup < 0) {
+        usage();
+        return 2;
+    }
+
+    if (pin_cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(pin_cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0)
+            fprintf(stderr, "Aviso: não foi possível fixar o benchmark no núcleo %d\n", pin_cpu);
+    }
+    monitor_set_verbose(0);
+    syscalls_open();
+
+    size_t max_scale = 0;
+    for (size_t i = 0; i < nscales; i++)
+        if (scales[i] > max_scale) max_scale = scales[i];
+    size_t distinct;
+    c.pids = malloc(max_scale * sizeof(pid_t));
+    c.samples = calloc(max_scale, sizeof(proc_metrics_t));
+    if (!c.pids || !c.samples) {
+        fprintf(stderr, "Memória insuficiente para %zu alvos\n", max_scale);
+        return 1;
+    }
+    c.npids = collect_pids(c.pids, max_scale, &distinct);
+
+    /* amostras sintéticas variadas para os exportadores (sem supressão de repetidas) */
+    for (size_t i = 0; i < max_scale; i++) {
+        proc_metrics_t *m = &c.samples[i];
+        m->timestamp = 1700000000.0 + (double)i;
+        m->pid = getpid();
+        m->cpu_percent = (double)(i % 1000) / 10.0;
+        m->threads = 1 + i % 8;
+        m->rss_kb = 10000 + i * 7;
+        m->vmsize_kb = 50000 + i * 13;
+        m->minflt = i * 3;
+        m->rchar = i * 4096;
+        m->wchar = i * 1024;
+        m->syscalls = i * 5;
+        m->rchar_per_s = (double)(i % 97) * 4096.0;
+        m->wchar_per_s = (double)(i % 89) * 1024.0;
+    }
+
+    static bench_result_t res[BENCH_MAX_RESULTS];
+    size_t nres = 0;
+    printf("Benchmark: %d aquecimentos, %d repetições, syscalls via %s, %zu PIDs distintos\n",
+           warmup, reps, g_sys_source, distinct);
+    printf("  %-16s %6s %12s %12s %12s %10s %10s\n", "caso", "alvos", "ns/amostra", "ns mín",
+           "ns máx", "syscalls", "alocações");
+
+    for (size_t k = 0; k < sizeof(k_cases) / sizeof(k_cases[0]); k++) {
+        const bench_case_t *bc = &k_cases[k];
+        if (only && !strstr(bc->name, only)) continue;
+        for (size_t s = 0; s < nscales && nres < BENCH_MAX_RESULTS; s++) {
+            c.n = scales[s];
+            if (bc->setup && bc->setup(&c) != 0) break;
+            size_t per = c.n;
+            if (bc->fixed_scale) per = c.top.nprocs ? c.top.nprocs : 1;
+            snprintf(c.path, sizeof(c.path), "/tmp/rm_bench_%d.%s", (int)getpid(),
+                     strcmp(bc->name, "export_json") == 0 ? "json" : strcmp(bc->name, "export_rmb") == 0 ? "rmb" : "csv");
+
+            bench_result_t *r = &res[nres++];
+            measure(bc, &c, per, warmup, reps, r);
+            if (bc->teardown) bc->teardown(&c);
+            printf("  %-16s %6zu %12.1f %12.1f %12.1f %10.2f %10.2f\n", r->name, r->targets,
+                   r->ns_median, r->ns_min, r->ns_max, r->syscalls, r->allocs);
+            if (bc->fixed_scale) break;     // a varredura cobre todos os processos de uma vez
+        }
+    }
+
+    int rc = write_json(out, res, nres, warmup, reps, distinct) == 0 ? 0 : 1;
+    if (rc == 0) printf("Resultados em %s\n", out);
+    if (rc == 0 && base) {
+        int cmp = compare(res, nres, base, threshold);
+        rc = cmp < 0 ? 1 : cmp;
+    }
+    if (g_sys_fd >= 0) close(g_sys_fd);
+    free(c.samples);
+    free(c.pids);
+    return rc;
+}
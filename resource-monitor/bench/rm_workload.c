@@ -0,0 +1,554 @@
+/*
+ * bench/rm_workload.c
+ *
+ * Gerador de carga calibrado para os experimentos (make rm_workload).
+ *
+ * Substitui os programas que o compare_tools.sh compilava em tmp/
+ * (bench_cpu, mem_alloc, io_workload) por perfis configuráveis:
+ *   cpu   ciclo de trabalho (--duty, em tempo de CPU por período) em N
+ *         threads, com a unidade de trabalho calibrada para ~50 µs: o relógio
+ *         é consultado uma vez por unidade, não a cada iteração;
+ *   mem   taxa de alocação (--rate MB/s), padrão de toque das páginas
+ *         (seq/random/none), retenção por --hold segundos ou vazamento;
+ *   io    escrita ou leitura sequencial/aleatória em blocos, fsync a cada
+ *         N operações e O_DIRECT opcional;
+ *   fork  tempestade de fork/exit com taxa e paralelismo limitados.
+ *
+ * Ao terminar (prazo ou SIGINT/SIGTERM) imprime a vazão alcançada em linhas
+ * CHAVE:valor (ITERATIONS, MAX_ALLOC, TOTAL_BYTES e WRITES continuam com os
+ * nomes que os experimentos já procuram) ou em uma linha JSON com --json.
+ * Rodar o mesmo perfil com e sem o monitor dá o overhead como perda de vazão.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+
+#define WL_PAGE 4096
+#define WL_UNIT_NS 50000.0          // duração alvo de uma unidade de trabalho de CPU
+#define WL_MAX_THREADS 256
+
+typedef struct {
+    const char *profile;
+    double duration;                // segundos
+    int json;
+
+    /* cpu */
+    int threads;
+    double duty;                    // 0..100
+    double period_ms;
+
+    /* mem */
+    double rate_mb;                 // MB/s
+    size_t chunk;                   // bytes
+    const char *touch;              // seq | random | none
+    double hold;                    // s antes de liberar (sem --leak)
+    int leak;
+    size_t limit;                   // bytes, 0 = sem limite
+
+    /* io */
+    const char *file;
+    size_t file_size;
+    size_t block;
+    int random;
+    int read;
+    int fsync_every;
+    int direct;
+    int keep;
+
+    /* fork */
+    double fork_rate;               // forks/s, 0 = o mais rápido possível
+    double child_ms;
+    int parallel;
+} wl_opts_t;
+
+typedef struct {
+    double elapsed;
+    double ops;                     // unidade principal do perfil
+    const char *unit;
+} wl_result_t;
+
+static volatile sig_atomic_t g_stop = 0;
+
+static void on_signal(int sig) {
+    (void)sig;
+    g_stop = 1;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static double cpu_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static double thread_cpu_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void sleep_until(double t) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)t;
+    ts.tv_nsec = (long)((t - (double)ts.tv_sec) * 1e9);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR && !g_stop) {}
+}
+
+/* xorshift: cada iteração depende da anterior, então o laço não é vetorizado nem eliminado */
+static uint64_t spin(uint64_t n, uint64_t x) {
+    for (uint64_t i = 0; i < n; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    return x;
+}
+
+static uint64_t xorshift(uint64_t *s) {
+    *s = spin(1, *s);
+    return *s;
+}
+
+/* ===================== CPU ====================== */
+
+typedef struct {
+    const wl_opts_t *o;
+    uint64_t unit;                  // iterações por unidade calibrada
+    double start, end;
+    uint64_t iterations;
+    uint64_t sink;
+} cpu_worker_t;
+
+static _Atomic uint64_t g_sink;
+
+/* iterações de spin que levam ~WL_UNIT_NS nesta máquina */
+static uint64_t calibrate_unit(void) {
+    uint64_t n = 1024, x = 88172645463325252ULL;
+    for (;;) {
+        double t0 = now_s();
+        x = spin(n, x);
+        double dt = now_s() - t0;
+        if (dt >= 0.01) {
+            atomic_fetch_xor(&g_sink, x);
+            double per_iter = dt * 1e9 / (double)n;
+            uint64_t unit = (uint64_t)(WL_UNIT_NS / per_iter);
+            return unit ? unit : 1;
+        }
+        n *= 2;
+    }
+}
+
+static void *cpu_worker(void *arg) {
+    cpu_worker_t *w = arg;
+    double period = w->o->period_ms / 1000.0;
+    double busy = period * w->o->duty / 100.0;
+    uint64_t x = 88172645463325252ULL ^ (uint64_t)(uintptr_t)w;
+    double t = w->start;
+
+    /* a cota do período é tempo de CPU da thread, não de relógio: com mais
+     * threads que núcleos cada uma ainda recebe --duty, até o fim do período */
+    while (!g_stop && t < w->end) {
+        double period_end = t + period < w->end ? t + period : w->end;
+        double budget_end = thread_cpu_s() + busy;
+        while (!g_stop && thread_cpu_s() < budget_end && now_s() < period_end) {
+            x = spin(w->unit, x);
+            w->iterations += w->unit;
+        }
+        t += period;
+        if (w->o->duty < 100.0 && !g_stop && t < w->end) sleep_until(t);
+    }
+    w->sink = x;
+    return NULL;
+}
+
+static int run_cpu(const wl_opts_t *o, wl_result_t *r) {
+    if (o->threads < 1 || o->threads > WL_MAX_THREADS || o->duty <= 0 || o->duty > 100 || o->period_ms <= 0) {
+        fprintf(stderr, "cpu: --threads 1..%d, --duty 0..100 e --period > 0\n", WL_MAX_THREADS);
+        return -1;
+    }
+    uint64_t unit = calibrate_unit();
+    cpu_worker_t w[WL_MAX_THREADS];
+    pthread_t th[WL_MAX_THREADS];
+    double c0 = cpu_s(), start = now_s();
+
+    int started = 0;
+    for (int i = 0; i < o->threads; i++) {
+        w[i] = (cpu_worker_t){ .o = o, .unit = unit, .start = start, .end = start + o->duration };
+        if (pthread_create(&th[i], NULL, cpu_worker, &w[i]) != 0) {
+            perror("pthread_create");
+            g_stop = 1;
+            break;
+        }
+        started++;
+    }
+    uint64_t total = 0;
+    for (int i = 0; i < started; i++) {
+        pthread_join(th[i], NULL);
+        total += w[i].iterations;
+        atomic_fetch_xor(&g_sink, w[i].sink);
+    }
+    r->elapsed = now_s() - start;
+    r->ops = (double)total;
+    r->unit = "iter";
+
+    double duty = r->elapsed > 0 ? 100.0 * (cpu_s() - c0) / (r->elapsed * started) : 0;
+    if (!o->json) {
+        printf("UNIT_ITERS:%llu\n", (unsigned long long)unit);
+        printf("DUTY_ACHIEVED:%.1f\n", duty);
+        printf("ITERATIONS:%llu\n", (unsigned long long)total);
+    }
+    return 0;
+}
+
+/* ===================== MEMÓRIA ====================== */
+
+typedef struct {
+    char *p;
+    double t;
+} mem_chunk_t;
+
+/* toca uma vez cada página do bloco na ordem pedida; devolve páginas tocadas */
+static size_t touch_pages(char *p, size_t len, const char *mode, uint64_t *rng) {
+    size_t pages = len / WL_PAGE;
+    if (pages == 0 || strcmp(mode, "none") == 0) return 0;
+    if (strcmp(mode, "random") == 0) {
+        // passo ímpar sobre uma potência de 2 >= pages percorre todos os índices uma vez
+        size_t span = 1;
+        while (span < pages) span <<= 1;
+        size_t step = (size_t)(xorshift(rng) | 1) & (span - 1);
+        size_t idx = (size_t)xorshift(rng) & (span - 1);
+        for (size_t i = 0; i < span; i++) {
+            if (idx < pages) p[idx * WL_PAGE] = (char)i;
+            idx = (idx + (step | 1)) & (span - 1);
+        }
+    } else {
+        for (size_t i = 0; i < pages; i++) p[i * WL_PAGE] = (char)i;
+    }
+    return pages;
+}
+
+static int run_mem(const wl_opts_t *o, wl_result_t *r) {
+    if (o->rate_mb <= 0 || o->chunk < WL_PAGE ||
+        (strcmp(o->touch, "seq") != 0 && strcmp(o->touch, "random") != 0 && strcmp(o->touch, "none") != 0)) {
+        fprintf(stderr, "mem: --rate > 0, --chunk >= 4 KB e --touch seq|random|none\n");
+        return -1;
+    }
+    size_t cap = 1024, head = 0, tail = 0;      // fila de blocos vivos (FIFO por idade)
+    mem_chunk_t *live = malloc(cap * sizeof(*live));
+    if (!live) {
+        perror("malloc");
+        return -1;
+    }
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    size_t allocated = 0, current = 0, max_current = 0, touched = 0, failed = 0;
+    double start = now_s(), end = start + o->duration, last_report = start;
+    double rate = o->rate_mb * 1024.0 * 1024.0;
+
+    while (!g_stop) {
+        double t = now_s();
+        if (t >= end) break;
+
+        // libera o que passou do tempo de retenção
+        while (!o->leak && head < tail && t - live[head].t >= o->hold) {
+            free(live[head].p);
+            current -= o->chunk;
+            head++;
+        }
+        if (head == tail) head = tail = 0;
+
+        double due = rate * (t - start);
+        if ((double)allocated + (double)o->chunk > due || (o->limit && current + o->chunk > o->limit)) {
+            sleep_until(t + 0.001);
+        } else {
+            char *p = malloc(o->chunk);
+            if (!p) {
+                failed++;
+                sleep_until(t + 0.01);
+                continue;
+            }
+            touched += touch_pages(p, o->chunk, o->touch, &rng);
+            if (tail == cap) {
+                if (head > 0) {
+                    memmove(live, live + head, (tail - head) * sizeof(*live));
+                    tail -= head;
+                    head = 0;
+                } else {
+                    mem_chunk_t *n = realloc(live, cap * 2 * sizeof(*live));
+                    if (!n) {
+                        free(p);
+                        failed++;
+                        continue;
+                    }
+                    live = n;
+                    cap *= 2;
+                }
+            }
+            live[tail++] = (mem_chunk_t){ p, t };
+            allocated += o->chunk;
+            current += o->chunk;
+            if (current > max_current) max_current = current;
+        }
+        // ALLOC periódico: se o processo morrer por OOM, a última linha fica no log
+        if (!o->json && t - last_report >= 1.0) {
+            printf("ALLOC:%zu\n", current);
+            fflush(stdout);
+            last_report = t;
+        }
+    }
+    r->elapsed = now_s() - start;
+    r->ops = (double)allocated;
+    r->unit = "B";
+    if (!o->json) {
+        printf("ALLOC:%zu\n", current);
+        printf("MAX_ALLOC:%zu\n", max_current);
+        printf("PAGES_TOUCHED:%zu\n", touched);
+        printf("ALLOC_FAILURES:%zu\n", failed);
+    }
+    for (size_t i = head; i < tail; i++) free(live[i].p);
+    free(live);
+    return 0;
+}
+
+/* ===================== I/O ====================== */
+
+static int run_io(const wl_opts_t *o, wl_result_t *r) {
+    if (o->block == 0 || o->file_size < o->block || (o->direct && o->block % WL_PAGE != 0)) {
+        fprintf(stderr, "io: --block > 0, --size >= --block (e --block múltiplo de 4 KB com --direct)\n");
+        return -1;
+    }
+    char *buf;
+    if (posix_memalign((void **)&buf, WL_PAGE, o->block) != 0) {
+        perror("posix_memalign");
+        return -1;
+    }
+    memset(buf, 'A', o->block);
+
+    int flags = O_CREAT | O_RDWR;
+    int fd = open(o->file, flags | (o->direct ? O_DIRECT : 0), 0644);
+    if (fd < 0 && o->direct && errno == EINVAL) {
+        fprintf(stderr, "Aviso: %s não aceita O_DIRECT; usando cache de páginas\n", o->file);
+        fd = open(o->file, flags, 0644);
+    }
+    if (fd < 0) {
+        perror(o->file);
+        free(buf);
+        return -1;
+    }
+
+    size_t blocks = o->file_size / o->block;
+    if (o->read) {
+        // a leitura precisa de um arquivo do tamanho pedido; o preenchimento não conta
+        struct stat st;
+        if (fstat(fd, &st) == 0 && (size_t)st.st_size < blocks * o->block) {
+            for (size_t i = 0; i < blocks && !g_stop; i++) {
+                if (pwrite(fd, buf, o->block, (off_t)(i * o->block)) != (ssize_t)o->block) {
+                    perror("pwrite");
+                    break;
+                }
+            }
+            fsync(fd);
+        }
+    }
+
+    uint64_t rng = 0x2545F4914F6CDD1DULL;
+    size_t ops = 0, bytes = 0, syncs = 0, seq = 0;
+    double start = now_s(), end = start + o->duration;
+    int rc = 0;
+    while (!g_stop && now_s() < end) {
+        size_t b = o->random ? (size_t)(xorshift(&rng) % blocks) : seq++ % blocks;
+        off_t off = (off_t)(b * o->block);
+        ssize_t n = o->read ? pread(fd, buf, o->block, off) : pwrite(fd, buf, o->block, off);
+        if (n < 0) {
+            perror(o->read ? "pread" : "pwrite");
+            rc = -1;
+            break;
+        }
+        ops++;
+        bytes += (size_t)n;
+        if (!o->read && o->fsync_every > 0 && ops % (size_t)o->fsync_every == 0) {
+            fsync(fd);
+            syncs++;
+        }
+    }
+    if (!o->read) {
+        fsync(fd);
+        syncs++;
+    }
+    r->elapsed = now_s() - start;
+    r->ops = (double)bytes;
+    r->unit = "B";
+    close(fd);
+    free(buf);
+    if (!o->keep) unlink(o->file);
+
+    if (!o->json) {
+        printf("TOTAL_BYTES:%zu\n", bytes);
+        printf("%s:%zu\n", o->read ? "READS" : "WRITES", ops);
+        printf("FSYNCS:%zu\n", syncs);
+        printf("IOPS:%.1f\n", r->elapsed > 0 ? (double)ops / r->elapsed : 0);
+    }
+    return rc;
+}
+
+/* ===================== FORK ====================== */
+
+static int run_fork(const wl_opts_t *o, wl_result_t *r) {
+    if (o->parallel < 1 || o->fork_rate < 0 || o->child_ms < 0) {
+        fprintf(stderr, "fork: --parallel >= 1, --rate >= 0 e --child-ms >= 0\n");
+        return -1;
+    }
+    size_t forks = 0, failed = 0;
+    int running = 0;
+    double start = now_s(), end = start + o->duration;
+    struct timespec child_sleep = { (time_t)(o->child_ms / 1000.0),
+                                    (long)(o->child_ms * 1e6) % 1000000000L };
+
+    while (!g_stop) {
+        double t = now_s();
+        if (t >= end) break;
+        while (running > 0 && waitpid(-1, NULL, WNOHANG) > 0) running--;
+        if (running >= o->parallel) {
+            if (wait(NULL) > 0) running--;
+            continue;
+        }
+        if (o->fork_rate > 0 && (double)forks >= o->fork_rate * (t - start)) {
+            sleep_until(start + (double)(forks + 1) / o->fork_rate);
+            continue;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            if (o->child_ms > 0) nanosleep(&child_sleep, NULL);
+            _exit(0);
+        }
+        if (pid < 0) {
+            failed++;
+            if (running > 0 && wait(NULL) > 0) running--;
+            continue;
+        }
+        forks++;
+        running++;
+    }
+    while (running > 0 && wait(NULL) > 0) running--;
+    r->elapsed = now_s() - start;
+    r->ops = (double)forks;
+    r->unit = "fork";
+    if (!o->json) {
+        printf("FORKS:%zu\n", forks);
+        printf("FORK_FAILURES:%zu\n", failed);
+    }
+    return 0;
+}
+
+/* ===================== CLI ====================== */
+
+static void usage(void) {
+    fprintf(stderr,
+            "Uso: rm_workload <cpu|mem|io|fork> [--duration s] [--json]\n"
+            "  cpu:  [--threads n] [--duty pct] [--period ms]\n"
+            "  mem:  [--rate MB/s] [--chunk KB] [--touch seq|random|none] [--hold s] [--leak] [--limit MB]\n"
+            "  io:   [--file caminho] [--size MB] [--block KB] [--pattern seq|random] [--read]\n"
+            "        [--fsync n] [--direct] [--keep]\n"
+            "  fork: [--rate n/s] [--child-ms ms] [--parallel n]\n");
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+    wl_opts_t o = {
+        .profile = argv[1], .duration = 5,
+        .threads = 1, .duty = 100, .period_ms = 100,
+        .rate_mb = 64, .chunk = 1 << 20, .touch = "seq", .hold = 1,
+        .file = "rm_workload.dat", .file_size = 64 << 20, .block = 64 << 10,
+        .parallel = 64,
+    };
+    int is_fork = strcmp(o.profile, "fork") == 0;
+
+    for (int i = 2; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(a, "--json") == 0) o.json = 1;
+        else if (strcmp(a, "--leak") == 0) o.leak = 1;
+        else if (strcmp(a, "--read") == 0) o.read = 1;
+        else if (strcmp(a, "--direct") == 0) o.direct = 1;
+        else if (strcmp(a, "--keep") == 0) o.keep = 1;
+        else if (!v) {
+            usage();
+            return 2;
+        } else {
+            i++;
+            if (strcmp(a, "--duration") == 0) o.duration = atof(v);
+            else if (strcmp(a, "--threads") == 0) o.threads = atoi(v);
+            else if (strcmp(a, "--duty") == 0) o.duty = atof(v);
+            else if (strcmp(a, "--period") == 0) o.period_ms = atof(v);
+            else if (strcmp(a, "--rate") == 0 && is_fork) o.fork_rate = atof(v);
+            else if (strcmp(a, "--rate") == 0) o.rate_mb = atof(v);
+            else if (strcmp(a, "--chunk") == 0) o.chunk = (size_t)atol(v) << 10;
+            else if (strcmp(a, "--touch") == 0) o.touch = v;
+            else if (strcmp(a, "--hold") == 0) o.hold = atof(v);
+            else if (strcmp(a, "--limit") == 0) o.limit = (size_t)atol(v) << 20;
+            else if (strcmp(a, "--file") == 0) o.file = v;
+            else if (strcmp(a, "--size") == 0) o.file_size = (size_t)atol(v) << 20;
+            else if (strcmp(a, "--block") == 0) o.block = (size_t)atol(v) << 10;
+            else if (strcmp(a, "--pattern") == 0) o.random = strcmp(v, "random") == 0;
+            else if (strcmp(a, "--fsync") == 0) o.fsync_every = atoi(v);
+            else if (strcmp(a, "--child-ms") == 0) o.child_ms = atof(v);
+            else if (strcmp(a, "--parallel") == 0) o.parallel = atoi(v);
+            else {
+                usage();
+                return 2;
+            }
+        }
+    }
+    if (o.duration <= 0) {
+        usage();
+        return 2;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    wl_result_t r = {0};
+    int rc;
+    if (strcmp(o.profile, "cpu") == 0) rc = run_cpu(&o, &r);
+    else if (strcmp(o.profile, "mem") == 0) rc = run_mem(&o, &r);
+    else if (strcmp(o.profile, "io") == 0) rc = run_io(&o, &r);
+    else if (is_fork) rc = run_fork(&o, &r);
+    else {
+        usage();
+        return 2;
+    }
+    if (rc != 0) return 1;
+
+    double thr = r.elapsed > 0 ? r.ops / r.elapsed : 0;
+    if (o.json) {
+        printf("{\"profile\":\"%s\",\"elapsed_s\":%.6f,\"ops\":%.0f,\"unit\":\"%s\",\"throughput\":%.3f}\n",
+               o.profile, r.elapsed, r.ops, r.unit, thr);
+    } else {
+        printf("ELAPSED:%.6f\n", r.elapsed);
+        printf("UNIT:%s/s\n", r.unit);
+        printf("THROUGHPUT:%.3f\n", thr);
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+#ifndef ANOMALY_H
+#define ANOMALY_H
+
+#include <stddef.h>
+#include "monitor.h"
+#include "cgroup.h"
+
+/*
+ * Motor de detecção de anomalias online com detectores plugáveis.
+ *
+ * Uma "série" é o par (alvo, métrica). O chamador preenche, a cada tick,
+ * uma linha de valores por alvo (anomaly_engine_row) e chama
+ * anomaly_engine_tick, que converte contadores em taxas e passa o vetor
+ * inteiro de séries por cada detector habilitado. O estado dos detectores
+ * é guardado em arrays separados (um por grandeza, indexados pela série),
+ * então cada detector é um laço simples sobre todas as séries de uma vez.
+ *
+ * Detectores disponíveis:
+ *   - "ewma":     média e variância com decaimento exponencial (esquece cargas antigas);
+ *   - "mad":      mediana e MAD numa janela deslizante (robusto a outliers);
+ *   - "seasonal": EWMA por faixa do período (ex: hora do dia);
+ *   - "zscore":   média/desvio globais de Welford (comportamento antigo).
+ *
+ * Um detector que ainda não tem histórico suficiente se abstém (z = NaN).
+ */
+
+#define ANOMALY_MAX_DETECTORS 4
+#define ANOMALY_METRIC_NAME_MAX 32
+#define ANOMALY_MAX_METRICS 64
+
+typedef enum {
+    ANOMALY_GAUGE,      // valor instantâneo (RSS, CPU%, PSI avg10)
+    ANOMALY_COUNTER     // contador acumulado; pontuado como taxa por segundo
+} anomaly_metric_kind_t;
+
+typedef struct {
+    char name[ANOMALY_METRIC_NAME_MAX];   // contadores recebem o sufixo "_per_s"
+    anomaly_metric_kind_t kind;
+} anomaly_metric_t;
+
+typedef struct {
+    const char *detectors;      // lista "ewma,mad" (NULL = padrão)
+    double threshold;           // |z| mínimo para reportar
+    int vote_all;               // 1: todos os detectores prontos devem concordar
+    unsigned warmup;            // amostras por série antes de reportar
+    double ewma_alpha;          // peso da amostra nova em "ewma"
+    int mad_window;             // tamanho da janela de "mad"
+    double seasonal_period_s;   // período de "seasonal" (s)
+    int seasonal_slots;         // faixas por período
+    double seasonal_alpha;      // peso da amostra nova em cada faixa
+} anomaly_config_t;
+
+/** Evento entregue ao callback de anomaly_engine_tick. */
+typedef struct {
+    double timestamp;
+    size_t target;              // índice do alvo (linha)
+    const char *metric;
+    double value;               // valor pontuado (taxa, para contadores)
+    double z;                   // escore combinado
+    char detectors[64];         // detectores acima do limiar, ex: "ewma+mad"
+} anomaly_event_t;
+
+typedef void (*anomaly_event_fn)(const anomaly_event_t *ev, void *ctx);
+
+/*
+ * Interface de um detector. update() pontua x[i] contra o estado atual
+ * (z[i], NaN = abstenção) e depois incorpora x[i]; valores NaN em x são
+ * ignorados.
+ */
+typedef struct {
+    const char *name;
+    void *(*create)(size_t nseries, const anomaly_config_t *cfg);
+    void  (*update)(void *state, const double *x, double ts, double *z, size_t n);
+    void  (*destroy)(void *state);
+} anomaly_detector_t;
+
+typedef struct {
+    anomaly_config_t cfg;
+    size_t ntargets;
+    size_t nmetrics;
+    size_t nseries;                          // ntargets * nmetrics
+    anomaly_metric_t metrics[ANOMALY_MAX_METRICS];
+
+    int ndetectors;
+    const anomaly_detector_t *det[ANOMALY_MAX_DETECTORS];
+    void *state[ANOMALY_MAX_DETECTORS];
+
+    double *raw;        // [nseries] valores brutos da amostra atual
+    double *prev;       // [nseries] valores brutos anteriores (contadores)
+    double *x;          // [nseries] valores pontuados (gauge ou taxa)
+    double *z;          // [ndetectors * nseries]
+    unsigned *seen;     // [nseries] amostras válidas vistas
+    double prev_ts;
+    int has_prev;
+} anomaly_engine_t;
+
+/** @brief Preenche a configuração padrão (ewma+mad, todos concordam, z >= 3). */
+void anomaly_config_default(anomaly_config_t *cfg);
+
+/** @brief Procura um detector registrado pelo nome (NULL se não existir). */
+const anomaly_detector_t *anomaly_detector_find(const char *name);
+
+/**
+ * @brief Cria o motor para ntargets alvos com as métricas dadas.
+ * @return 0 em sucesso, -1 se algum detector for desconhecido ou faltar memória.
+ */
+int anomaly_engine_init(anomaly_engine_t *e, size_t ntargets,
+                        const anomaly_metric_t *metrics, size_t nmetrics,
+                        const anomaly_config_t *cfg);
+
+/** @brief Libera o estado dos detectores. */
+void anomaly_engine_free(anomaly_engine_t *e);
+
+/** @brief Linha de valores brutos do alvo (nmetrics entradas; NaN = ausente). */
+double *anomaly_engine_row(anomaly_engine_t *e, size_t target);
+
+/**
+ * @brief Pontua todas as séries com os valores preenchidos nas linhas.
+ * @param fn Chamado uma vez por série anômala (pode ser NULL).
+ * @return Número de anomalias no tick.
+ */
+size_t anomaly_engine_tick(anomaly_engine_t *e, double ts, anomaly_event_fn fn, void *ctx);
+
+/**
+ * @brief Maior escore combinado do último tick, em módulo (mais fraco entre
+ * os detectores com vote_all, senão o mais forte). 0 se nada pontuado.
+ */
+double anomaly_engine_max_z(const anomaly_engine_t *e);
+
+/*
+ * Conjuntos de métricas prontos: todos os campos numéricos de proc_metrics_t
+ * (contadores acumulados viram taxas; os que já têm um campo _per_s são
+ * omitidos) e as métricas de cgroup v2 + PSI.
+ */
+size_t anomaly_proc_metrics(anomaly_metric_t *out, size_t max);
+void   anomaly_fill_proc(double *row, const proc_metrics_t *m);
+size_t anomaly_cgroup_metrics(anomaly_metric_t *out, size_t max);
+void   anomaly_fill_cgroup(double *row, const cgroup_metrics_t *cg);
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef BATCHREAD_H
+#define BATCHREAD_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+/*
+ * Leituras em lote de arquivos já abertos (/proc/<pid>/stat etc.).
+ *
+ * Com io_uring, todas as leituras de um tick viram SQEs de um único anel
+ * e são submetidas e colhidas com um io_uring_enter por lote (o anel
+ * comporta BATCHREAD_ENTRIES; acima disso, um enter a cada
+ * BATCHREAD_ENTRIES leituras). O padrão (AUTO) é um pread por arquivo:
+ * o /proc não tem leitura assíncrona, e no io_uring cada leitura vira
+ * trabalho de um worker io-wq que custa mais que o pread poupado; o lote
+ * io_uring só é usado quando pedido (URING). Em ambos os
+ * casos os arquivos ficam abertos entre ticks: o /proc devolve dados
+ * novos a cada leitura no offset 0.
+ *
+ * Implementado direto sobre as syscalls (sem liburing).
+ */
+
+#define BATCHREAD_ENTRIES 4096
+
+typedef enum { BATCHREAD_AUTO, BATCHREAD_URING, BATCHREAD_PREAD } batchread_backend_t;
+
+typedef struct {
+    int fd;
+    char *buf;
+    size_t size;                    // lê até size - 1 bytes e termina com '\0'
+    ssize_t result;                 // bytes lidos ou -errno
+} batchread_req_t;
+
+typedef struct {
+    batchread_backend_t backend;    // URING ou PREAD após batchread_init
+    int ring_fd;
+    void *sq_ptr, *cq_ptr;
+    size_t sq_len, cq_len;
+    void *sqes;
+    size_t sqes_len;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    void *cqes;
+    unsigned entries;
+    struct iovec *iov;              // um por SQE em voo
+
+    size_t syscalls;                // io_uring_enter (ou pread) do último lote
+} batchread_t;
+
+/**
+ * @brief Prepara o backend pedido (AUTO usa pread).
+ * @return 0 em sucesso, -1 se URING foi exigido e não está disponível.
+ */
+int batchread_init(batchread_t *b, batchread_backend_t want);
+
+/**
+ * @brief Lê todos os pedidos do offset 0 e espera terminarem.
+ * @return 0 em sucesso, -1 em erro do anel (os resultados por pedido ficam em result).
+ */
+int batchread_run(batchread_t *b, batchread_req_t *reqs, size_t n);
+
+void batchread_free(batchread_t *b);
+
+const char *batchread_backend_name(const batchread_t *b);
+
+/** @brief "auto", "uring" ou "pread". @return backend ou -1 se inválido. */
+int batchread_backend_parse(const char *s);
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef BLOCKINDEX_H
+#define BLOCKINDEX_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "monitor.h"
+#include "export.h"
+
+/*
+ * Índice esparso por blocos, gravado ao lado da gravação em <arquivo>.idx.
+ *
+ * A cada BLOCK_INDEX_ROWS linhas fecha-se um bloco com: posição (byte) da
+ * primeira linha no arquivo de dados, número de linhas, primeiro/último
+ * timestamp e min/max de cada campo da tabela de export.h (NaN para
+ * colunas que não foram gravadas). --query usa esses limites para pular
+ * blocos inteiros sem lê-los.
+ *
+ * Layout: block_index_header_t seguido de nblocks registros de tamanho
+ * fixo (block_index_entry_t + 2 * nfields doubles: min[], max[]).
+ */
+
+#define BLOCK_INDEX_MAGIC "RMI1"
+#define BLOCK_INDEX_VERSION 1
+#define BLOCK_INDEX_ROWS 1024
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t nfields;       // campos na tabela quando o índice foi gravado
+    uint32_t block_rows;
+    uint64_t nblocks;
+    uint64_t data_size;     // tamanho do arquivo de dados (detecta índice velho)
+} block_index_header_t;
+
+typedef struct {
+    uint64_t offset;        // byte da primeira linha/registro do bloco
+    uint32_t rows;
+    uint32_t reserved;
+    double ts_first;
+    double ts_last;
+} block_index_entry_t;
+
+/* bloco em memória (min/max apontam para arrays de nfields) */
+typedef struct {
+    block_index_entry_t e;
+    double *min;
+    double *max;
+} block_index_block_t;
+
+typedef struct {
+    FILE *fp;
+    size_t nfields;
+    unsigned char present[METRIC_FIELD_MAX];   // 1 se a coluna existe nos dados
+    block_index_entry_t cur;       // bloco aberto
+    double cur_min[METRIC_FIELD_MAX];
+    double cur_max[METRIC_FIELD_MAX];
+    uint64_t nblocks;
+} block_index_writer_t;
+
+typedef struct {
+    block_index_header_t h;
+    block_index_block_t *blocks;   // [h.nblocks]
+    double *minmax;                // armazenamento de min/max de todos os blocos
+} block_index_t;
+
+/** @brief Caminho do índice de uma gravação ("<data>.idx"). */
+void block_index_path(const char *data_filename, char *out, size_t out_size);
+
+/**
+ * @brief Cria <data>.idx. present marca as colunas gravadas (NULL = todas).
+ * @return 0 em sucesso, -1 em erro.
+ */
+int block_index_open(block_index_writer_t *w, const char *data_filename,
+                     const unsigned char *present);
+
+/** @brief Registra uma linha que começa no byte offset do arquivo de dados. */
+void block_index_add(block_index_writer_t *w, const proc_metrics_t *m, uint64_t offset);
+
+/**
+ * @brief Fecha o último bloco e grava o cabeçalho.
+ * @param data_size Tamanho final do arquivo de dados.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int block_index_close(block_index_writer_t *w, uint64_t data_size);
+
+/**
+ * @brief Carrega o índice de uma gravação.
+ * @return 0 em sucesso, -1 se ausente, inválido ou desatualizado.
+ */
+int block_index_load(const char *data_filename, block_index_t *idx);
+
+void block_index_free(block_index_t *idx);
+
+#endif
@@ -29,6 +29,23 @@ typedef struct {
     unsigned long long wios;            // Total de operações de escrita
 } cgroup_io_metrics_t;
 
+/**
+ * Pressure Stall Information de um recurso (cpu.pressure, memory.pressure,
+ * io.pressure ou /proc/pressure/<recurso>).
+ */
+typedef struct {
+    double some_avg10;                  // % do tempo com alguma tarefa parada (janela 10 s)
+    double full_avg10;                  // % do tempo com todas as tarefas paradas
+    unsigned long long some_total;      // tempo total parado (us)
+    unsigned long long full_total;
+} cgroup_psi_resource_t;
+
+typedef struct {
+    cgroup_psi_resource_t cpu;
+    cgroup_psi_resource_t mem;
+    cgroup_psi_resource_t io;
+} cgroup_psi_metrics_t;
+
 /**
  * Estrutura principal que agrega todas as métricas do cgroup.
  */
@@ -36,9 +53,15 @@ typedef struct {
     cgroup_cpu_metrics_t cpu;
     cgroup_mem_metrics_t mem;
     cgroup_io_metrics_t io;
+    cgroup_psi_metrics_t psi;
 } cgroup_metrics_t;
 
 
+/**
+ * @brief Troca a raiz do cgroupfs (padrão /sys/fs/cgroup; NULL restaura).
+ */
+void cgroup_set_root(const char* root);
+
 /**
  * @brief Obtém o caminho base do sistema de arquivos cgroup v2.
  * Normalmente /sys/fs/cgroup
@@ -83,6 +106,15 @@ int cgroup_set_cpu_limit(const char* relative_path, long max_usec, long period_u
  */
 int cgroup_set_memory_limit(const char* relative_path, long limit_bytes);
 
+/**
+ * @brief Define memory.high (soft limit): acima dele o kernel faz reclaim
+ *        e atrasa as alocações do grupo, mas não mata por OOM.
+ * @param relative_path O nome do cgroup.
+ * @param limit_bytes Limite de memória em bytes.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int cgroup_set_memory_high(const char* relative_path, long limit_bytes);
+
 /**
  * @brief Lê todas as métricas (CPU, Mem, IO) de um cgroup.
  * @param relative_path O nome do cgroup.
@@ -91,6 +123,25 @@ int cgroup_set_memory_limit(const char* relative_path, long limit_bytes);
  */
 int cgroup_read_metrics(const char* relative_path, cgroup_metrics_t* metrics);
 
+/**
+ * @brief Lê o limite memory.max de um cgroup.
+ * @param limit_bytes Recebe o limite em bytes, ou 0 se for "max" (sem limite).
+ * @return 0 em sucesso, -1 em erro.
+ */
+int cgroup_read_memory_max(const char* relative_path, unsigned long long* limit_bytes);
+
+/**
+ * @brief Lê um arquivo de pressão no formato PSI ("some avg10=... total=...").
+ * @return 0 em sucesso, -1 se o arquivo não existir ou não puder ser lido.
+ */
+int cgroup_read_psi_file(const char* path, cgroup_psi_resource_t* psi);
+
+/**
+ * @brief Lê a pressão do sistema inteiro em /proc/pressure/{cpu,memory,io}.
+ * @return 0 se ao menos um recurso foi lido, -1 caso contrário.
+ */
+int cgroup_read_system_pressure(cgroup_psi_metrics_t* psi);
+
 /**
  * @brief Gera um relatório formatado no console com as métricas de um cgroup.
  * @param relative_path O nome do cgroup.
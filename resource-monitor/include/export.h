@@ -0,0 +1,170 @@
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "monitor.h"
+#include "sketch.h"
+
+/*
+ * Tabela de colunas exportáveis de proc_metrics_t e seleção de campos
+ * (--fields) compartilhada por todos os exportadores.
+ */
+
+typedef enum {
+    FIELD_F64,      // double (formatado em ponto fixo)
+    FIELD_PID,      // pid_t
+    FIELD_ULONG,    // unsigned long
+    FIELD_ULLONG    // unsigned long long
+} field_kind_t;
+
+typedef struct {
+    const char *name;        // nome do campo (JSON e --fields), ex: "cpu_percent"
+    const char *csv_header;  // cabeçalho CSV, ex: "CPU%"
+    field_kind_t kind;
+    size_t offset;           // offsetof(proc_metrics_t, ...)
+    int decimals;            // casas decimais para FIELD_F64
+} metric_field_t;
+
+#define METRIC_FIELD_MAX 64
+
+/**
+ * Seleção ordenada de colunas (índices na tabela de campos).
+ * Timestamp e PID são sempre incluídos como chaves.
+ */
+typedef struct {
+    int idx[METRIC_FIELD_MAX];
+    int count;
+} field_selection_t;
+
+/**
+ * @brief Retorna a tabela de campos conhecidos.
+ * @param count Recebe o número de entradas.
+ */
+const metric_field_t *metric_fields(size_t *count);
+
+/**
+ * @brief Procura um campo pelo nome.
+ * @return Índice na tabela ou -1 se não existir.
+ */
+int metric_field_find(const char *name);
+
+/**
+ * @brief Lê o valor de um campo de uma amostra como double.
+ */
+double metric_field_value(const proc_metrics_t *m, const metric_field_t *f);
+
+/**
+ * @brief Grava v (convertido para o tipo do campo) numa amostra.
+ */
+void metric_field_set(proc_metrics_t *m, const metric_field_t *f, double v);
+
+/**
+ * @brief Interpreta uma lista "cpu_percent,rss_kb,...".
+ *
+ * Aceita também grupos: "default" (colunas originais, também usado para
+ * NULL ou ""), "perf", "sched", "net", "fd", "tcp" e "all".
+ * @return 0 em sucesso, -1 se algum campo for desconhecido.
+ */
+int field_selection_parse(const char *spec, field_selection_t *sel);
+
+/**
+ * @brief Define a seleção usada por export_metrics_csv/json.
+ * @return 0 em sucesso, -1 se a lista for inválida (seleção não muda).
+ */
+int export_set_fields(const char *spec);
+
+/** @brief Seleção atualmente em uso pelos exportadores. */
+const field_selection_t *export_get_fields(void);
+
+/*
+ * Supressão de amostras repetidas (run-length): uma linha só é gravada se
+ * algum campo selecionado mudou mais que epsilon (fração do valor do campo
+ * na última linha gravada do mesmo PID; 0 = qualquer mudança) em relação a ela, se passou heartbeat_s desde ela, ou se é a última
+ * amostra do PID. Os arquivos levam os parâmetros (interval/epsilon/heartbeat)
+ * para que os leitores possam reexpandir a série.
+ */
+typedef struct {
+    int enabled;
+    double epsilon;      // variação relativa mínima para gravar (0.05 = 5%)
+    double heartbeat_s;  // grava ao menos uma linha a cada N s (0 = nunca)
+    double interval_s;   // intervalo de amostragem (para reexpansão)
+} export_suppression_t;
+
+/** @brief Ativa/desativa a supressão usada por export_metrics_csv/json. */
+void export_set_suppression(const export_suppression_t *cfg);
+
+/** @brief Configuração de supressão atual. */
+const export_suppression_t *export_get_suppression(void);
+
+/**
+ * @brief Marca quais amostras devem ser gravadas segundo a supressão.
+ * @param keep Vetor de count bytes preenchido com 0/1.
+ * @return Número de amostras mantidas, ou -1 em erro de alocação.
+ */
+long export_mark_kept(const proc_metrics_t *data, size_t count,
+                      const field_selection_t *sel,
+                      const export_suppression_t *cfg, unsigned char *keep);
+
+/*
+ * Escritor CSV com buffer próprio e formatação manual de inteiros e
+ * ponto fixo (evita o parsing de formato do fprintf a cada coluna).
+ */
+typedef struct {
+    FILE *fp;
+    char *buf;
+    size_t len;
+    size_t cap;
+    unsigned long long flushed;   // bytes já enviados ao arquivo
+    int owns_fp;                  // 0: fp pertence ao chamador (ex: stdout)
+} csv_writer_t;
+
+int  csv_writer_open(csv_writer_t *w, const char *filename);
+/** @brief Usa um FILE* já aberto; csv_writer_close não o fecha. */
+int  csv_writer_attach(csv_writer_t *w, FILE *fp);
+/** @brief Posição (bytes desde o início) do próximo caractere escrito. */
+unsigned long long csv_writer_offset(const csv_writer_t *w);
+void csv_put_str(csv_writer_t *w, const char *s);
+void csv_put_char(csv_writer_t *w, char c);
+void csv_put_u64(csv_writer_t *w, unsigned long long v);
+void csv_put_i64(csv_writer_t *w, long long v);
+void csv_put_fixed(csv_writer_t *w, double v, int decimals);
+void csv_put_field(csv_writer_t *w, const proc_metrics_t *m, const metric_field_t *f);
+int  csv_writer_close(csv_writer_t *w);
+
+/*
+ * Formato binário .rmb: cabeçalho de 32 bytes seguido de registros
+ * proc_metrics_t crus (record_size bytes cada), na ordem de gravação.
+ * Pode ser mapeado em memória e lido sem cópia por uma máquina com a
+ * mesma ABI (record_size e versão são verificados); registros menores,
+ * gravados antes de campos novos entrarem no fim da struct, são copiados
+ * com os campos ausentes em zero. --fields e --suppress
+ * não se aplicam: todas as amostras e campos são gravados.
+ */
+#define RMB_MAGIC "RMB1"
+#define RMB_VERSION 1
+
+typedef struct {
+    char magic[4];          // "RMB1"
+    uint32_t version;
+    uint32_t header_size;   // sizeof(rmb_header_t)
+    uint32_t record_size;   // sizeof(proc_metrics_t)
+    uint64_t count;         // registros gravados
+    uint64_t reserved;
+} rmb_header_t;
+
+/**
+ * @brief Exporta as amostras no formato binário .rmb.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int export_metrics_rmb(const char *filename, const proc_metrics_t *data, size_t count);
+
+/**
+ * @brief Exporta o resumo de quantis (p50/p90/p99/max) de um ou mais alvos.
+ * CSV: PID,metric,count,mean,p50,p90,p99,max. JSON se o nome terminar em .json.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int export_summary(const char *filename, const metric_summary_t *sums, size_t count);
+
+#endif
@@ -33,17 +33,120 @@ typedef struct {
     double rchar_per_s;
     double wchar_per_s;
     double syscalls_per_s;
+
+    /* Contadores perf_event_open (--perf, perfcount.h): taxas por segundo
+       sobre o tempo medido entre leituras, 0 sem --perf;
+       cycles/instructions/cache_misses/ipc só com PMU.
+       Ficam no fim: registros .rmb antigos são um prefixo deste layout. */
+    double task_clock_ms_per_s;        // CPU contado pelo kernel (ms por segundo)
+    double ctx_switches_per_s;
+    double cpu_migrations_per_s;
+    double page_faults_per_s;
+    double cycles_per_s;
+    double instructions_per_s;
+    double cache_misses_per_s;
+    double ipc;                        // instructions / cycles
+
+    /* Escalonador (schedstat somado nas threads): ms por segundo na CPU e
+       prontos para rodar esperando na fila de execução */
+    double cpu_run_ms_per_s;
+    double cpu_wait_ms_per_s;
+    double wait_per_slice_us;          // espera média por entrada na CPU
+
+    /* Rede do netns do alvo (net/dev sem lo, net/snmp): compartilhada com
+       os demais processos do mesmo namespace */
+    double net_rx_bytes_per_s;
+    double net_tx_bytes_per_s;
+    double net_rx_packets_per_s;
+    double net_tx_packets_per_s;
+    double net_drops_per_s;            // descartes e erros, rx + tx
+    double tcp_retrans_per_s;
+
+    /* Descritores abertos (/proc/<pid>/fd) por tipo e, com --fd-sockets,
+       os sockets TCP do alvo por estado (net/tcp e net/tcp6) */
+    unsigned long fd_count;
+    unsigned long fd_files;
+    unsigned long fd_sockets;
+    unsigned long fd_pipes;
+    unsigned long fd_eventfds;
+    unsigned long fd_anon;             // epoll, timerfd, signalfd, io_uring...
+    unsigned long fd_limit;            // limite soft de "Max open files" (0 = ilimitado)
+    double fd_growth_per_s;
+    unsigned long tcp_established;
+    unsigned long tcp_listen;
+    unsigned long tcp_close_wait;      // o par fechou e o alvo não: vazamento típico
+    unsigned long tcp_other;           // SYN_*, FIN_WAIT*, LAST_ACK, CLOSING
 } proc_metrics_t;
 
 
 // --- Protótipos dos módulos ---
+/* Linhas [CPU]/[MEM] dos coletores (padrão: ligadas; o monitor as desliga na thread de coleta) */
+void monitor_set_verbose(int on);
+int monitor_is_verbose(void);
+/* Raiz do procfs lida pelos coletores (padrão /proc; --proc-root aponta para uma árvore sintética) */
+void monitor_set_proc_root(const char *root);
+const char *monitor_proc_root(void);
 int monitor_cpu_usage(pid_t pid, double *cpu_percent);
+
+/* /proc/<pid>/task/<tid>/schedstat: ns na CPU, ns esperando na fila de
+   execução (run delay) e entradas na CPU de cada thread. O CPU% não separa
+   "ocioso" de "pronto mas sem CPU" (cpu.max, vizinhos barulhentos). */
+typedef struct {
+    pid_t tid;
+    unsigned long long run_ns, wait_ns, slices;
+} sched_task_t;
+
+typedef struct {
+    sched_task_t *prev, *cur;   // leituras ordenadas por TID
+    size_t nprev, cap;
+    int primed;
+} schedstat_state_t;
+
+/**
+ * @brief Soma das threads de pid desde a chamada anterior com o mesmo st
+ *        (zeros na primeira). Threads novas contam inteiras; as que
+ *        terminaram perdem só o último intervalo.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int monitor_schedstat(pid_t pid, schedstat_state_t *st, double *run_ms, double *wait_ms,
+                      unsigned long long *slices);
+void monitor_schedstat_free(schedstat_state_t *st);
 int monitor_memory_usage(pid_t pid,
                          unsigned long *rss_kb,
                          unsigned long *vmsize_kb,
                          unsigned long *minflt,
                          unsigned long *majflt,
                          unsigned long *swap_kb);
+int monitor_mem_available(unsigned long *mem_available_kb, unsigned long *mem_total_kb);
+
+/* /proc/<pid>/smaps_rollup (kB): PSS divide cada página compartilhada entre
+   os processos que a mapeiam, então a soma entre workers pré-fork não conta
+   duas vezes o que o RSS conta; USS = Private_Clean + Private_Dirty. */
+typedef struct {
+    unsigned long rss_kb;
+    unsigned long pss_kb;
+    unsigned long pss_anon_kb;      // Pss_Anon/File/Shmem: kernel >= 5.0 (0 antes)
+    unsigned long pss_file_kb;
+    unsigned long pss_shmem_kb;
+    unsigned long shared_clean_kb;
+    unsigned long shared_dirty_kb;
+    unsigned long private_clean_kb;
+    unsigned long private_dirty_kb;
+    unsigned long swap_kb;
+    unsigned long swap_pss_kb;
+    unsigned long referenced_kb;    // acessadas desde o último clear_refs (ver wss.h)
+} smaps_rollup_t;
+
+/**
+ * @brief Lê /proc/<pid>/smaps_rollup. Bem mais caro que status: o kernel
+ *        percorre todas as VMAs do alvo (sob o mmap_lock dele).
+ * @return 0 em sucesso, -1 em erro.
+ */
+int monitor_smaps_rollup(pid_t pid, smaps_rollup_t *out);
+
+/** @brief Filhos diretos de pid (task/<pid>/children). @return Quantidade gravada em out, -1 em erro. */
+int monitor_children(pid_t pid, pid_t *out, size_t max);
+
 int monitor_io_usage(pid_t pid,
                      unsigned long long *rchar,
                      unsigned long long *wchar,
@@ -51,6 +154,142 @@ int monitor_io_usage(pid_t pid,
                      unsigned long long *write_bytes,
                      unsigned long long *syscalls);
 
+/* Rede do namespace de rede do alvo: /proc/<pid>/net/dev (somado nas
+   interfaces, sem lo) e /proc/<pid>/net/snmp. São contadores do netns, não
+   do processo: todos os processos do mesmo netns leem os mesmos valores. */
+typedef struct {
+    unsigned long long rx_bytes, tx_bytes;
+    unsigned long long rx_packets, tx_packets;
+    unsigned long long rx_drops, tx_drops;
+    unsigned long long rx_errs, tx_errs;
+    unsigned long long tcp_in_segs, tcp_out_segs, tcp_retrans;
+    unsigned long long udp_in, udp_out, udp_errs;
+    int ifaces;                     // interfaces somadas
+} net_counters_t;
+
+typedef struct {
+    double rx_bytes_per_s, tx_bytes_per_s;
+    double rx_packets_per_s, tx_packets_per_s;
+    double drops_per_s;             // descartes e erros, rx + tx
+    double tcp_retrans_per_s;
+} net_rates_t;
+
+/** @brief Lê net/dev e net/snmp vistos por pid. @return 0 em sucesso, -1 em erro. */
+int monitor_net_usage(pid_t pid, net_counters_t *out);
+
+/** @brief Inode do namespace de rede de pid (o "net:[N]" de ns/net), 0 se ilegível. */
+unsigned long monitor_netns(pid_t pid);
+
+/*
+ * Leituras de rede deduplicadas por netns: dentro de um tick
+ * (netns_cache_begin), o primeiro alvo de cada namespace lê net/dev e
+ * net/snmp e os demais recebem a mesma leitura. As taxas vêm da leitura
+ * anterior do mesmo namespace. Sem o inode (ns/net ilegível) a chave é o
+ * PID, e aquele alvo lê sozinho.
+ */
+typedef struct {
+    unsigned long netns;
+    pid_t pid;                      // chave só quando netns == 0
+    unsigned long gen;              // tick da última leitura
+    double t;                       // relógio monotônico da última leitura (s)
+    net_counters_t cur, prev;
+    int has_prev;
+    net_rates_t rates;
+} netns_entry_t;
+
+typedef struct {
+    netns_entry_t *e;               // ordenadas por (netns, pid)
+    size_t n, cap;
+    unsigned long gen;
+    size_t reads;                   // namespaces lidos no tick
+    size_t hits;                    // alvos servidos por uma leitura já feita no tick
+} netns_cache_t;
+
+/** @brief Começa um tick: esquece os namespaces que não foram lidos no anterior. */
+void netns_cache_begin(netns_cache_t *c);
+
+/**
+ * @brief Contadores e taxas do netns de pid neste tick (taxas zeradas na
+ *        primeira leitura do namespace).
+ * @return 0 em sucesso, -1 em erro.
+ */
+int netns_cache_read(netns_cache_t *c, pid_t pid, unsigned long netns, net_counters_t *out,
+                     net_rates_t *rates);
+void netns_cache_free(netns_cache_t *c);
+
+/* Descritores do alvo: a listagem de /proc/<pid>/fd (getdents64) dá o
+   total; o readlink de cada entrada ("/caminho", "socket:[ino]",
+   "pipe:[ino]", "anon_inode:[eventfd]", ...) dá o tipo. */
+typedef enum {
+    FD_FILE,
+    FD_SOCKET,
+    FD_PIPE,
+    FD_EVENTFD,
+    FD_ANON,                        // demais anon_inode (epoll, timerfd, signalfd, io_uring)
+    FD_OTHER,                       // namespaces, pidfd de kernels antigos, ...
+    FD_NTYPES
+} fd_type_t;
+
+typedef struct {
+    int fd;
+    int type;                       // fd_type_t
+    unsigned long ino;              // inode do socket (0 nos demais tipos)
+} fd_entry_t;
+
+/*
+ * Estado entre leituras: o tipo de um número de descritor que continua na
+ * listagem é reaproveitado, então só os descritores novos custam um
+ * readlink. Um número fechado e reaberto com outro tipo entre dois ticks
+ * só é reclassificado na releitura completa, a cada FD_RECHECK_TICKS.
+ */
+#define FD_RECHECK_TICKS 16
+
+typedef struct {
+    fd_entry_t *prev, *cur;         // listagens ordenadas por número
+    size_t nprev, cap;
+    unsigned long *sockets;         // inodes dos sockets do último tick, ordenados
+    size_t nsockets, sockets_cap;
+    unsigned long ticks;
+    size_t readlinks;               // readlinks feitos no último tick
+    unsigned long limit;            // relido junto com a releitura completa
+} fd_state_t;
+
+typedef struct {
+    unsigned long count;
+    unsigned long by_type[FD_NTYPES];
+    unsigned long limit;            // "Max open files" soft (0 = ilimitado ou ilegível)
+} fd_counts_t;
+
+/** @brief Tipo pelo alvo do link; *ino recebe o inode de "socket:[ino]". */
+fd_type_t monitor_fd_classify(const char *link, unsigned long *ino);
+
+/**
+ * @brief Conta e classifica os descritores de pid (st guarda a listagem
+ *        anterior; zerado na primeira chamada).
+ * @return 0 em sucesso, -1 em erro.
+ */
+int monitor_fd_usage(pid_t pid, fd_state_t *st, fd_counts_t *out);
+void monitor_fd_free(fd_state_t *st);
+
+/** @brief Limite soft de descritores (/proc/<pid>/limits, 0 = unlimited). @return 0 em sucesso, -1 em erro. */
+int monitor_fd_limit(pid_t pid, unsigned long *soft);
+
+/* Sockets TCP do alvo por estado: linhas de net/tcp e net/tcp6 (do netns
+   inteiro) cujo inode está entre os sockets abertos pelo alvo. TIME_WAIT
+   não aparece: o socket já não tem descritor (inode 0). */
+typedef struct {
+    unsigned long established;
+    unsigned long listen;
+    unsigned long close_wait;
+    unsigned long other;
+} tcp_states_t;
+
+/**
+ * @brief Estados dos sockets de inodes (ordenados) em net/tcp e net/tcp6 de pid.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int monitor_tcp_states(pid_t pid, const unsigned long *inodes, size_t n, tcp_states_t *out);
+
 int export_metrics_csv(const char *filename, const proc_metrics_t *data, size_t count);
 int export_metrics_json(const char *filename, const proc_metrics_t *data, size_t count);
 
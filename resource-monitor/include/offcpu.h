@@ -0,0 +1,141 @@
+#ifndef OFFCPU_H
+#define OFFCPU_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include "batchread.h"
+
+/*
+ * Perfil off-CPU por amostragem (--offcpu).
+ *
+ * A cada tick, o estado de cada thread do alvo sai de task/<tid>/stat;
+ * das que não estão em R, task/<tid>/syscall (número da syscall em que a
+ * thread dorme, -1 fora de syscall) e task/<tid>/wchan (função do kernel
+ * em que ela espera) dizem onde está bloqueada. Cada amostra de thread
+ * soma 1 no histograma (categoria, estado, syscall, wchan); amostras vezes
+ * o intervalo real entre ticks estimam os segundos de thread em cada ponto.
+ *
+ * Para 100 Hz com milhares de threads, os descritores ficam abertos entre
+ * ticks e cada tick lê só task/<tid>/schedstat de todas (três números,
+ * ~5x mais barato que stat); stat, syscall e wchan são relidos apenas
+ * das threads cujo contador de entradas na CPU ou tempo de CPU mudou. Uma
+ * thread que não rodou desde o tick anterior continua onde estava: as mil
+ * threads de um pool parado no mesmo futex custam uma leitura cada. (Uma
+ * thread acordada que ainda espera na fila conta como bloqueada até
+ * rodar.) Cada fase é um lote do batchread; "auto" aqui é pread, que
+ * sai mais barato que io_uring para arquivos de /proc. A lista
+ * de threads é relida uma vez por segundo; threads mais novas que isso
+ * ainda não aparecem.
+ */
+
+#define OFFCPU_MAX_ENTRIES 4096     // chaves distintas no histograma (potência de 2)
+#define OFFCPU_WCHAN_MAX 48
+#define OFFCPU_STAT_BUF 512
+#define OFFCPU_SYSCALL_BUF 160
+
+typedef enum {
+    OFFCPU_RUNNING,         // R: na CPU ou na fila de execução
+    OFFCPU_IO_WAIT,         // D em syscall (disco, fsync, NFS) ou espera de AIO/io_uring
+    OFFCPU_PAGE_FAULT,      // bloqueada fora de syscall: falta de página
+    OFFCPU_FUTEX,           // locks e variáveis de condição
+    OFFCPU_POLL,            // poll/select/epoll
+    OFFCPU_SLEEP,           // nanosleep
+    OFFCPU_READ_WRITE,      // read/write/recv/accept em S (socket, pipe, terminal)
+    OFFCPU_OTHER,
+    OFFCPU_NCATEGORIES
+} offcpu_cat_t;
+
+typedef struct {
+    offcpu_cat_t cat;
+    char state;
+    long sysno;                     // -1 fora de syscall, -2 desconhecido
+    char wchan[OFFCPU_WCHAN_MAX];
+    uint64_t samples;               // 0 = posição livre
+} offcpu_entry_t;
+
+typedef struct {
+    pid_t tid;
+    int sched_fd, stat_fd, syscall_fd, wchan_fd;
+    char sched[96];
+    char stat[OFFCPU_STAT_BUF];
+    char syscall[OFFCPU_SYSCALL_BUF];
+    char wchan[OFFCPU_WCHAN_MAX];
+    unsigned long long run_ns, pcount;  // schedstat da última leitura
+    int known;                          // state/sysno/wchan valem enquanto ela não rodar
+    int stale;                          // rodou: relê stat, syscall e wchan neste tick
+    char state;
+    long sysno;
+} offcpu_thread_t;
+
+typedef struct {
+    pid_t pid;
+    pid_t self_tid;                 // a thread que amostra, se o alvo é o próprio processo
+    double hz;
+    offcpu_thread_t *threads;       // ordenadas por TID
+    size_t nthreads;
+    batchread_t io;
+    batchread_req_t *reqs;
+    size_t reqs_cap;
+
+    offcpu_entry_t entries[OFFCPU_MAX_ENTRIES];
+    size_t nentries;
+    uint64_t dropped;               // amostras sem posição livre no histograma
+    uint64_t cat_samples[OFFCPU_NCATEGORIES];
+    uint64_t samples;               // amostras de thread
+    uint64_t ticks, missed_ticks;
+    uint64_t rereads;               // threads relidas (stat/syscall/wchan)
+    double elapsed_s;               // duração real da amostragem
+    double tick_ms_sum, tick_ms_max;
+    size_t syscalls;                // io_uring_enter/pread somados
+} offcpu_t;
+
+/** @brief Nome da categoria ("io_wait", "futex", ...). */
+const char *offcpu_cat_name(offcpu_cat_t c);
+
+/** @brief Nome da syscall (tabela das que importam aqui) ou NULL. */
+const char *offcpu_syscall_name(long sysno);
+
+/**
+ * @brief Categoria de uma amostra: estado de stat, número da syscall
+ *        (-1 fora de syscall, -2 sem leitura) e wchan ("" ou "0" sem ele).
+ */
+offcpu_cat_t offcpu_classify(char state, long sysno, const char *wchan);
+
+/**
+ * @brief Prepara o perfil de pid (backend de leitura e limite de descritores).
+ * @return 0 em sucesso, -1 em erro.
+ */
+int offcpu_init(offcpu_t *o, pid_t pid, double hz, batchread_backend_t backend);
+
+/** @brief Relê task/ e abre os descritores das threads novas. @return Threads, -1 em erro. */
+int offcpu_refresh(offcpu_t *o);
+
+/** @brief Um tick: lê e classifica todas as threads. @return 0 em sucesso, -1 se o alvo saiu. */
+int offcpu_sample(offcpu_t *o);
+
+/**
+ * @brief Amostra a o->hz por duration_s segundos (0 = até *running zerar).
+ * @return 0 em sucesso, -1 em erro.
+ */
+int offcpu_run(offcpu_t *o, double duration_s, volatile int *running);
+
+/** @brief Segundos representados por uma amostra de thread (intervalo real entre ticks). */
+double offcpu_sample_s(const offcpu_t *o);
+
+/** @brief Entradas do histograma em ordem decrescente de amostras. @return Quantidade gravada. */
+size_t offcpu_sorted(const offcpu_t *o, const offcpu_entry_t **out, size_t max);
+
+/** @brief Totais por categoria e as max_rows chaves mais frequentes. */
+void offcpu_print(const offcpu_t *o, FILE *fp, size_t max_rows);
+
+/**
+ * @brief Grava category,state,syscall,wchan,samples,thread_seconds,pct.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int offcpu_write_csv(const offcpu_t *o, const char *path);
+
+void offcpu_free(offcpu_t *o);
+
+#endif
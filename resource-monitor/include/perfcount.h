@@ -0,0 +1,68 @@
+#ifndef PERFCOUNT_H
+#define PERFCOUNT_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include "monitor.h"
+
+/*
+ * Contadores do kernel por perf_event_open (--perf).
+ *
+ * Cada thread existente do alvo recebe um grupo com page-faults como líder
+ * e task-clock, context-switches e cpu-migrations como membros; com PMU
+ * (máquina física ou VM que a expõe), cycles, instructions e cache-misses
+ * entram no mesmo grupo. Um único read() por grupo devolve todos os
+ * valores do mesmo instante (PERF_FORMAT_GROUP), em vez de interpretar
+ * texto de stat/status. Com inherit, threads e filhos criados depois da
+ * abertura somam no grupo da thread que os criou.
+ *
+ * Se o PMU multiplexar o grupo, os valores são escalados por
+ * tempo habilitado / tempo contando no intervalo. Com
+ * perf_event_paranoid >= 2 e sem CAP_PERFMON, a abertura é refeita só com
+ * eventos de usuário (exclude_kernel).
+ */
+
+#define PERFCOUNT_MAX_GROUPS 256    // threads do alvo com grupo próprio
+
+typedef enum {
+    PERFC_PAGE_FAULTS,      // líder do grupo
+    PERFC_TASK_CLOCK,       // ns
+    PERFC_CTX_SWITCHES,
+    PERFC_CPU_MIGRATIONS,
+    PERFC_CYCLES,
+    PERFC_INSTRUCTIONS,
+    PERFC_CACHE_MISSES,
+    PERFC_NCOUNTERS
+} perfc_id_t;
+
+typedef struct {
+    int fds[PERFCOUNT_MAX_GROUPS];          // líder (page-faults) de cada grupo
+    int member_fds[PERFCOUNT_MAX_GROUPS][PERFC_NCOUNTERS];
+    int ngroups;
+    int nmembers;                           // eventos por grupo (ordem de leitura)
+    perfc_id_t order[PERFC_NCOUNTERS];
+    int has_hw;                             // cycles/instructions/cache-misses abertos
+    int user_only;                          // abertos com exclude_kernel
+    double last[PERFC_NCOUNTERS];           // soma escalada na última leitura
+    double last_t;                          // CLOCK_MONOTONIC da última leitura (s)
+    int primed;
+} perfcount_t;
+
+/**
+ * @brief Abre os grupos para todas as threads de pid.
+ * @param want_hw Tenta também os eventos de hardware.
+ * @return 0 em sucesso, -1 se nem os contadores de software abrirem.
+ */
+int perfcount_open(perfcount_t *pc, pid_t pid, int want_hw);
+
+/**
+ * @brief Lê os grupos (um read() cada) e grava em m as taxas por segundo
+ *        desde a leitura anterior, pelo tempo medido entre as duas (zeros
+ *        na primeira).
+ * @return 0 em sucesso, -1 em erro.
+ */
+int perfcount_read(perfcount_t *pc, proc_metrics_t *m);
+
+void perfcount_close(perfcount_t *pc);
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef PROCFIXTURE_H
+#define PROCFIXTURE_H
+
+#include <sys/types.h>
+
+/*
+ * Árvores sintéticas de /proc e cgroupfs (--make-fixture).
+ *
+ * Gera <raiz>/proc com N processos (PIDs first_pid, first_pid + T, ...,
+ * cada um com T threads em task/<tid>) e <raiz>/cgroup com G cgroups
+ * folha em resource_monitor/gNNN, nos mesmos formatos que o kernel usa
+ * para stat, status, statm, io, schedstat, cgroup, ns/, net/dev, net/snmp,
+ * net/tcp, net/tcp6, fd/, limits, /proc/stat, meminfo, pressure/,
+ * cpu.stat, memory.stat, memory.current, io.stat e *.pressure. Os
+ * processos de um mesmo cgroup compartilham um namespace de rede (como os
+ * de um contêiner) e veem os mesmos contadores; net/tcp de cada processo
+ * lista só os sockets dele, mais uma linha em TIME_WAIT e uma de outro
+ * processo, que os coletores devem ignorar.
+ *
+ * Os contadores são funções determinísticas do índice do processo e do
+ * tick: gravar de novo com um tick maior faz a árvore "andar" (CPU, faltas
+ * de página, I/O e trocas de contexto crescem; parte dos processos vaza
+ * memória e sockets em CLOSE_WAIT), e os testes conferem os valores exatos com
+ * procfixture_proc_values. Usar com --proc-root <raiz>/proc e
+ * --cgroup-root <raiz>/cgroup.
+ */
+
+#define PROCFIXTURE_JIFFIES_PER_TICK 800   // /proc/stat: 8 CPUs x 100 Hz x 1 s por tick
+
+typedef struct {
+    size_t nprocs;          // processos
+    int threads;            // threads por processo (>= 1)
+    int ngroups;            // cgroups folha (processo i vai para g(i % ngroups))
+    pid_t first_pid;        // 0 = 1000
+    unsigned long tick;     // instante dos contadores
+} procfixture_config_t;
+
+/* Valores de um processo num tick (o que os coletores devem ler) */
+typedef struct {
+    pid_t pid;
+    char comm[16];
+    char state;
+    unsigned long utime, stime;         // jiffies
+    unsigned long minflt, majflt;
+    unsigned long rss_kb, vmsize_kb, swap_kb;
+    unsigned long voluntary_ctxt, nonvoluntary_ctxt;
+    unsigned long long run_delay_ms;    // schedstat: espera na fila, somada nas threads
+    unsigned long long rchar, wchar, syscr, syscw, read_bytes, write_bytes;
+    unsigned long long starttime;
+    unsigned long pidns;
+    unsigned long netns;                // um por cgroup; sem cgroup, o do host
+    unsigned long long net_rx_bytes, net_tx_bytes;      // eth0 do netns (lo fica de fora)
+    unsigned long long net_rx_packets, net_tx_packets;
+    unsigned long long net_drops;       // rx_drop de eth0
+    unsigned long long tcp_retrans;
+    unsigned long fd_count, fd_files, fd_sockets, fd_pipes, fd_eventfds, fd_anon;
+    unsigned long fd_limit;             // "Max open files" soft
+    unsigned long tcp_established, tcp_listen, tcp_close_wait;  // sockets do processo
+    int group;
+} procfixture_proc_t;
+
+/** @brief PID do i-ésimo processo. */
+pid_t procfixture_pid(const procfixture_config_t *cfg, size_t i);
+
+/** @brief Valores do i-ésimo processo no tick de cfg. */
+void procfixture_proc_values(const procfixture_config_t *cfg, size_t i, procfixture_proc_t *v);
+
+/**
+ * @brief Cria (ou atualiza para cfg->tick) a árvore em root/proc e root/cgroup.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int procfixture_write(const char *root, const procfixture_config_t *cfg);
+
+/** @brief Remove a árvore criada por procfixture_write. @return 0 em sucesso, -1 em erro. */
+int procfixture_remove(const char *root);
+
+#endif
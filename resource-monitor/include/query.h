@@ -0,0 +1,61 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "monitor.h"
+
+/*
+ * Consultas por intervalo de tempo sobre gravações CSV/.rmb (--query).
+ *
+ * Com o índice <arquivo>.idx (blockindex.h), só os blocos cujo intervalo
+ * de tempo, faixa de PID e min/max das colunas podem satisfazer o filtro
+ * são lidos. Sem índice, o arquivo é varrido uma vez e o índice é criado.
+ */
+
+typedef enum {
+    QUERY_GT, QUERY_GE, QUERY_LT, QUERY_LE, QUERY_EQ, QUERY_NE
+} query_op_t;
+
+typedef struct {
+    int field;              // índice na tabela de export.h
+    query_op_t op;
+    double value;
+} query_pred_t;
+
+#define QUERY_MAX_PREDS 8
+
+typedef struct {
+    double from;            // -INFINITY = sem limite
+    double to;              // INFINITY = sem limite
+    int has_pid;
+    pid_t pid;
+    query_pred_t preds[QUERY_MAX_PREDS];   // combinados com E
+    int npreds;
+} query_t;
+
+typedef struct {
+    size_t blocks_total;
+    size_t blocks_read;
+    size_t rows_scanned;
+    size_t rows_matched;
+    int indexed;            // 1 se o índice existente foi usado
+} query_stats_t;
+
+/** @brief Consulta sem filtros (todo o arquivo). */
+void query_init(query_t *q);
+
+/**
+ * @brief Acrescenta condições "campo>valor" (>, >=, <, <=, ==, =, !=),
+ * separadas por vírgula.
+ * @return 0 em sucesso, -1 se o campo ou o operador forem inválidos.
+ */
+int query_add_where(query_t *q, const char *expr);
+
+/**
+ * @brief Executa a consulta e escreve as linhas encontradas em CSV.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int query_run(const char *path, const query_t *q, FILE *out, query_stats_t *stats);
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stddef.h>
+#include "monitor.h"
+#include "anomaly.h"
+#include "export.h"
+
+/*
+ * Reprocessamento offline (--replay): carrega uma gravação (.rmb, .csv ou
+ * .json), separa as séries por PID e passa cada uma pelo mesmo pipeline do
+ * modo ao vivo (motor de anomalias e sketches de --summary), com as séries
+ * distribuídas entre threads.
+ *
+ * Arquivos .rmb são mapeados em memória e lidos sem cópia; CSV é
+ * interpretado direto do mapeamento (sem ler linha a linha com stdio).
+ * Gravações com supressão (--suppress) são reexpandidas na hora.
+ */
+
+typedef struct {
+    const proc_metrics_t *samples;  // amostras (no mapeamento ou em owned)
+    size_t count;
+    double interval_s;              // > 0 se a gravação tem supressão a reexpandir
+
+    void *map;                      // mapeamento do arquivo (NULL se não houver)
+    size_t map_len;
+    proc_metrics_t *owned;          // amostras decodificadas de CSV/JSON
+} replay_data_t;
+
+typedef struct {
+    int anomaly;                    // roda o motor de anomalias
+    anomaly_config_t anomaly_cfg;
+    int summary;                    // p50/p90/p99/max por PID
+    int threads;                    // 0 = um por núcleo
+} replay_options_t;
+
+/**
+ * @brief Mapeia o arquivo inteiro (somente leitura) em d->map/d->map_len.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int replay_map_file(const char *path, replay_data_t *d);
+
+/* Layout de um CSV de métricas (compartilhado com --query). */
+typedef struct {
+    int col_field[METRIC_FIELD_MAX];          // campo de cada coluna (-1 = desconhecida)
+    int ncols;
+    unsigned char present[METRIC_FIELD_MAX];  // 1 se o campo tem coluna
+    double interval_s;                        // da linha "# rm-suppressed", se houver
+} csv_layout_t;
+
+/**
+ * @brief Lê comentários e cabeçalho de um CSV em memória [p, end).
+ * @return Início da primeira linha de dados, ou NULL se faltar Timestamp/PID.
+ */
+const char *replay_csv_layout(const char *p, const char *end, csv_layout_t *lay);
+
+/**
+ * @brief Interpreta a linha que começa em p (colunas ausentes ficam 0).
+ * @param is_row Recebe 0 para linhas vazias ou comentários.
+ * @return Início da próxima linha.
+ */
+const char *replay_csv_row(const char *p, const char *end, const csv_layout_t *lay,
+                           proc_metrics_t *m, int *is_row);
+
+/**
+ * @brief Carrega uma gravação pela extensão (.rmb, .json, senão CSV).
+ * @return 0 em sucesso, -1 em erro.
+ */
+int replay_load(const char *path, replay_data_t *d);
+
+/** @brief Libera o mapeamento e as amostras decodificadas. */
+void replay_free(replay_data_t *d);
+
+/**
+ * @brief Reprocessa a gravação. Anomalias vão para <path>.replay.anomalies.jsonl
+ * e o resumo para <path>.replay.summary.csv.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int replay_run(const char *path, const replay_options_t *opt);
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef ROLLUP_H
+#define ROLLUP_H
+
+#include <stddef.h>
+#include "monitor.h"
+#include "export.h"
+
+/*
+ * Armazenamento de amostras com memória fixa para o modo de longa duração.
+ *
+ * - tier "raw": as últimas N amostras completas (buffer circular);
+ * - tiers "10s" e "1m": agregados por janela com min/max/média/último de
+ *   cada métrica selecionada em --fields (export_get_fields() no momento de
+ *   rollup_store_init). Os contadores acumulados de
+ *   64 bits (rchar, syscalls, ciclos...) ficam em double, porque em float
+ *   perdem unidades acima de 2^24; as demais métricas ficam em float.
+ *
+ * Todos os buffers são alocados em rollup_store_init e nunca crescem:
+ * quando cheios, a entrada mais antiga é sobrescrita. Com os padrões
+ * abaixo, os campos padrão e 1 amostra/s o store ocupa cerca de 5 MB.
+ */
+
+#define ROLLUP_DEFAULT_RAW_MINUTES 10.0
+#define ROLLUP_DEFAULT_10S_HOURS   6.0     // 2160 janelas
+#define ROLLUP_DEFAULT_1M_DAYS     7.0     // 10080 janelas
+
+typedef enum {
+    ROLLUP_TIER_RAW = 0,
+    ROLLUP_TIER_10S,
+    ROLLUP_TIER_1M,
+    ROLLUP_TIER_COUNT
+} rollup_tier_id_t;
+
+typedef struct {
+    double resolution_s;   // largura da janela (s)
+    size_t cap;            // número máximo de janelas guardadas
+    size_t head;           // próxima posição de escrita
+    size_t count;          // janelas válidas (<= cap)
+    double *start_ts;      // [cap] início de cada janela
+    unsigned *samples;     // [cap] amostras agregadas na janela
+    float *min;            // [cap * nnarrow] métricas em float
+    float *max;
+    float *mean;
+    float *last;
+    double *wmin;          // [cap * nwide] contadores de 64 bits
+    double *wmax;
+    double *wmean;
+    double *wlast;
+
+    // janela aberta (ainda recebendo amostras)
+    double acc_start;
+    unsigned acc_n;
+    double *acc_sum;       // [nmetrics]
+    double *acc_min;
+    double *acc_max;
+    double *acc_last;
+} rollup_tier_t;
+
+typedef struct {
+    pid_t pid;
+
+    proc_metrics_t *raw;   // [raw_cap]
+    size_t raw_cap;
+    size_t raw_head;
+    size_t raw_count;
+
+    rollup_tier_t tiers[ROLLUP_TIER_COUNT]; // tiers[ROLLUP_TIER_RAW] não é usado
+
+    int nmetrics;                     // métricas agregadas
+    int metric_idx[METRIC_FIELD_MAX]; // índices na tabela de export.h
+    int nnarrow, nwide;               // métricas guardadas em float / em double
+    int wide[METRIC_FIELD_MAX];       // 1 se a métrica k fica em double
+    int col[METRIC_FIELD_MAX];        // coluna de k no vetor float ou double
+} rollup_store_t;
+
+/**
+ * @brief Aloca o armazenamento com capacidades fixas.
+ * @param raw_cap Amostras brutas guardadas (>= 1).
+ * @param cap_10s Janelas de 10 s guardadas (0 desativa o tier).
+ * @param cap_1m  Janelas de 1 min guardadas (0 desativa o tier).
+ * @return 0 em sucesso, -1 em erro de alocação.
+ */
+int rollup_store_init(rollup_store_t *st, pid_t pid, size_t raw_cap, size_t cap_10s, size_t cap_1m);
+
+/** @brief Libera os buffers. */
+void rollup_store_free(rollup_store_t *st);
+
+/** @brief Insere uma amostra em todos os tiers. */
+void rollup_store_add(rollup_store_t *st, const proc_metrics_t *m);
+
+/** @brief Última amostra bruta inserida (NULL se vazio). */
+const proc_metrics_t *rollup_store_last(const rollup_store_t *st);
+
+/**
+ * @brief Copia as amostras brutas em ordem cronológica.
+ * @return Número de amostras copiadas.
+ */
+size_t rollup_store_raw_copy(const rollup_store_t *st, proc_metrics_t *out, size_t max);
+
+/**
+ * @brief Lê uma janela fechada de um tier agregado.
+ * @param slot Posição no buffer circular (< cap).
+ * @param min,max,mean,last Recebem nmetrics valores cada.
+ */
+void rollup_tier_window(const rollup_store_t *st, const rollup_tier_t *t, size_t slot,
+                        double *min, double *max, double *mean, double *last);
+
+/** @brief Bytes alocados pelo armazenamento (constante após init). */
+size_t rollup_store_bytes(const rollup_store_t *st);
+
+/**
+ * @brief Converte "raw", "10s" ou "1m" no identificador do tier.
+ * @return Identificador ou -1 se inválido.
+ */
+int rollup_tier_parse(const char *name);
+
+/**
+ * @brief Exporta um tier para CSV, JSON ou .rmb (pela extensão do arquivo).
+ * O tier bruto usa export_metrics_csv/json/rmb; os agregados geram colunas
+ * <campo>_min, <campo>_max, <campo>_mean, <campo>_last para os campos
+ * selecionados em --fields. A janela ainda aberta também é exportada.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int rollup_export(const rollup_store_t *st, rollup_tier_id_t tier, const char *filename);
+
+#endif
@@ -0,0 +1,214 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include "monitor.h"
+#include "cgroup.h"
+#include "perfcount.h"
+
+/*
+ * Coleta desacoplada da saída.
+ *
+ * Uma thread de amostragem (opcionalmente fixada num núcleo) acorda em
+ * horários absolutos (CLOCK_MONOTONIC), lê /proc e o cgroup, calcula as
+ * taxas e publica a amostra pronta num anel SPSC sem locks. O consumidor
+ * (thread principal: terminal, ncurses, anomalias, exportação) retira as
+ * amostras no seu ritmo; se ele travar, o anel absorve o atraso e a
+ * cadência da coleta não muda. Com o anel cheio a amostra mais nova é
+ * descartada e contada.
+ *
+ * Com orçamento de overhead (max_overhead_pct > 0), a thread mede o CPU
+ * do processo do monitor a cada tick (CLOCK_PROCESS_CPUTIME_ID) e ajusta
+ * a própria cadência: acima do orçamento, corta um coletor opcional por
+ * tick na ordem de sampler_shed_t e, sem mais nada para cortar, alarga o
+ * intervalo; com folga, aperta o intervalo e depois religa os coletores
+ * na ordem inversa. Dentro do que o orçamento permite, o intervalo segue o
+ * sinal: mais curto quando o consumidor avisa que os escores de anomalia
+ * estão subindo (sampler_hint), mais longo com o alvo ocioso.
+ *
+ * smaps_rollup (PSS/USS) fica fora desse caminho: o kernel percorre todas
+ * as VMAs do alvo a cada leitura, o que custa de microssegundos a dezenas
+ * de milissegundos conforme o mapa de memória. Uma segunda thread lê o
+ * alvo (e os filhos diretos) na própria cadência, mede o CPU gasto em cada
+ * passada e alarga o intervalo para ficar abaixo de SAMPLER_SMAPS_SHARE_PCT
+ * de um núcleo; por já ter teto próprio, é o último cortado pelo orçamento. A
+ * coleta rápida só copia os últimos totais publicados. A thread lenta não
+ * usa SCHED_IDLE: a leitura segura o mmap_lock do alvo, e um leitor sem
+ * CPU no meio dela travaria os page faults do próprio processo medido.
+ */
+
+#define SAMPLER_RING_DEFAULT 1024   // potência de 2
+
+/* Coletores opcionais, na ordem em que o orçamento os corta */
+typedef enum {
+    SAMPLER_SHED_SCHED,             // schedstat de cada thread
+    SAMPLER_SHED_FD,                // getdents64 + readlink de /proc/<pid>/fd (e net/tcp)
+    SAMPLER_SHED_NET,               // net/dev e net/snmp do netns
+    SAMPLER_SHED_PERF,              // read() dos grupos perf_event_open
+    SAMPLER_SHED_CGROUP,            // cgroup/PSI e MemAvailable
+    SAMPLER_SHED_SMAPS,             // passadas da thread lenta de smaps_rollup
+    SAMPLER_SHED_COUNT
+} sampler_shed_t;
+
+#define SAMPLER_SHED_BIT(c) (1u << (c))
+
+/** @brief Nome curto do coletor opcional (ex: "schedstat"). */
+const char *sampler_shed_name(sampler_shed_t c);
+
+typedef struct {
+    proc_metrics_t m;               // amostra com taxas já calculadas
+    cgroup_metrics_t cg;            // cgroup ou PSI do sistema (se collect_cgroup)
+    unsigned long mem_avail_kb;     // MemAvailable (se collect_cgroup)
+    unsigned long mem_total_kb;
+    unsigned long long cg_mem_max;  // memory.max do cgroup (0 = sem limite)
+    double lag_ms;                  // atraso do despertar em relação ao previsto
+    int cg_valid;                   // cgroup/PSI lidos nesta amostra (0 se cortados pelo orçamento)
+    unsigned shed;                  // coletores cortados pelo orçamento nesta amostra (SAMPLER_SHED_BIT)
+    long interval_ms;               // intervalo vigente quando a amostra foi coletada
+    smaps_rollup_t smaps;           // soma do alvo e dos filhos na última passada lenta
+    int smaps_procs;                // processos somados em smaps (0 = ainda sem leitura)
+} sample_item_t;
+
+/* Anel de produtor único / consumidor único: cada índice só é escrito por um lado */
+typedef struct {
+    sample_item_t *slots;
+    size_t mask;
+    _Alignas(64) atomic_size_t head;    // próxima escrita (produtor)
+    _Alignas(64) atomic_size_t tail;    // próxima leitura (consumidor)
+} spsc_ring_t;
+
+/** @return 0 em sucesso, -1 se capacity não for potência de 2 ou faltar memória. */
+int spsc_ring_init(spsc_ring_t *r, size_t capacity);
+void spsc_ring_free(spsc_ring_t *r);
+
+/** @brief Produtor: slot livre para preencher, ou NULL se o anel estiver cheio. */
+sample_item_t *spsc_ring_reserve(spsc_ring_t *r);
+/** @brief Produtor: publica o slot obtido em spsc_ring_reserve. */
+void spsc_ring_commit(spsc_ring_t *r);
+/** @brief Consumidor: próximo item, ou NULL se vazio. */
+const sample_item_t *spsc_ring_peek(spsc_ring_t *r);
+/** @brief Consumidor: libera o item obtido em spsc_ring_peek. */
+void spsc_ring_release(spsc_ring_t *r);
+
+typedef struct {
+    pid_t pid;
+    long interval_ms;
+    size_t max_samples;             // 0 = sem limite
+    const char *cgroup_name;        // NULL = pressão do sistema
+    int collect_cgroup;             // lê cgroup/PSI e memória disponível
+    int pin_cpu;                    // núcleo da thread de coleta (-1 = livre)
+    size_t ring_capacity;           // 0 = SAMPLER_RING_DEFAULT
+    double max_overhead_pct;        // CPU do monitor em % de um núcleo (0 = intervalo fixo)
+    long min_interval_ms;           // 0 = interval_ms / 4 (mínimo 250 ms)
+    long max_interval_ms;           // 0 = interval_ms * 8
+    long smaps_interval_ms;         // cadência mínima de smaps_rollup (0 = desligado)
+    int smaps_children;             // soma também os filhos diretos do alvo
+    const char *smaps_csv;          // uma linha por processo e passada (NULL = não grava)
+    int perf;                       // contadores perf_event_open nas amostras (perfcount.h)
+    int schedstat;                  // espera na fila de CPU (task/<tid>/schedstat de cada thread)
+    int net;                        // tráfego do netns do alvo (net/dev e net/snmp)
+    int fds;                        // descritores abertos por tipo e limite (/proc/<pid>/fd)
+    int fd_sockets;                 // estados TCP dos sockets do alvo (net/tcp e net/tcp6; requer fds)
+} sampler_config_t;
+
+/*
+ * Controlador do intervalo adaptativo. O orçamento define um piso
+ * (floor_ms) que sobe 1,5x por tick acima do limite e desce 0,8x após
+ * alguns ticks com folga; o sinal escolhe o alvo (mínimo se urgente,
+ * 4x o base se ocioso, senão o base) e o intervalo é o alvo limitado
+ * ao piso. Antes de subir o piso, cada tick acima do limite corta o
+ * próximo coletor opcional ligado; com folga e o piso já no mínimo, cada
+ * aperto religa o último cortado.
+ */
+#define SAMPLER_CALM_TICKS 5        // ticks com folga antes de apertar
+#define SAMPLER_IDLE_TICKS 3        // ticks ociosos antes de alargar pelo sinal
+
+typedef struct {
+    double budget_pct;
+    long base_ms, min_ms, max_ms;
+    long floor_ms;
+    long interval_ms;
+    unsigned optional;              // coletores opcionais ligados (SAMPLER_SHED_BIT)
+    unsigned shed;                  // os que o orçamento cortou
+    double overhead_pct;            // média móvel exponencial do CPU do monitor
+    int calm;                       // ticks seguidos abaixo de metade do orçamento
+    int idle;                       // ticks seguidos com o alvo ocioso
+    size_t widened, tightened;      // ajustes do piso
+} sampler_budget_t;
+
+void sampler_budget_init(sampler_budget_t *b, double budget_pct, long base_ms,
+                         long min_ms, long max_ms, unsigned optional);
+
+/** @brief Incorpora a medição do tick. @return Próximo intervalo em ms. */
+long sampler_budget_update(sampler_budget_t *b, double overhead_pct, int urgent, int target_idle);
+
+#define SAMPLER_SMAPS_SHARE_PCT 1.0 // CPU máximo da thread lenta, em % de um núcleo
+#define SAMPLER_SMAPS_MAX_PROCS 256 // filhos lidos por passada
+
+/**
+ * @brief Intervalo da próxima passada de smaps_rollup: o configurado, ou
+ *        o necessário para que cost_ms caiba em share_pct de um núcleo.
+ */
+long sampler_smaps_interval(long base_ms, double cost_ms, double share_pct);
+
+typedef struct {
+    size_t passes;                  // passadas concluídas
+    size_t skipped;                 // passadas puladas (orçamento cortou smaps_rollup)
+    size_t failed;                  // leituras de processo que falharam
+    double cost_ms_sum;             // CPU da thread lenta somado nas passadas
+    double cost_ms_max;
+    long interval_ms;               // intervalo vigente
+} sampler_smaps_stats_t;
+typedef struct {
+    sampler_config_t cfg;
+    spsc_ring_t ring;
+    sem_t ready;                    // um post por amostra publicada (e um no fim)
+    pthread_t thread;
+    pthread_mutex_t lock;           // só para acordar a coleta ao parar
+    pthread_cond_t wake;
+    atomic_int stop;
+    atomic_int done;
+    atomic_size_t produced;
+    atomic_size_t dropped;
+    double max_lag_ms;              // válido após sampler_finish
+    atomic_int urgent;              // dica do consumidor (sampler_hint)
+    sampler_budget_t budget;        // estado do intervalo adaptativo (lido após sampler_finish)
+    atomic_uint shed;               // cópia de budget.shed para a thread lenta
+    int smaps_running;
+    pthread_t smaps_thread;
+    pthread_mutex_t smaps_lock;     // protege smaps_last/smaps_procs
+    smaps_rollup_t smaps_last;
+    int smaps_procs;
+    sampler_smaps_stats_t smaps;    // lido após sampler_finish
+    perfcount_t perf;               // grupos abertos pela thread de coleta
+    int perf_ok;                    // 1 se os grupos abriram (lido após sampler_finish)
+    schedstat_state_t sched;        // schedstat por thread da leitura anterior
+    netns_cache_t net;              // contadores de rede da leitura anterior
+    fd_state_t fd;                  // listagem de descritores da leitura anterior
+} sampler_t;
+
+/**
+ * @brief Inicia a thread de coleta.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int sampler_start(sampler_t *s, const sampler_config_t *cfg);
+
+/**
+ * @brief Retira a próxima amostra, esperando até timeout_ms.
+ * @return 1 com amostra em out, 0 se o tempo acabou, -1 se a coleta terminou e o anel está vazio.
+ */
+int sampler_next(sampler_t *s, sample_item_t *out, long timeout_ms);
+
+/** @brief Avisa a coleta de que os escores de anomalia estão subindo (1) ou não (0). */
+void sampler_hint(sampler_t *s, int urgent);
+
+/** @brief Pede o fim da coleta (não bloqueia). */
+void sampler_stop(sampler_t *s);
+
+/** @brief Para a coleta, aguarda a thread e libera o anel. */
+void sampler_finish(sampler_t *s);
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef SELFSTATS_H
+#define SELFSTATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * Custo do próprio monitor (--self-stats).
+ *
+ * Cada coletor é cercado por selfstats_begin/selfstats_end, que registram
+ * por chamada o tempo gasto (CLOCK_MONOTONIC, vDSO), as syscalls de
+ * leitura/escrita e os bytes lidos (deltas de syscr/syscw/rchar em
+ * /proc/thread-self/io, descontada a própria sonda). Open/close não
+ * aparecem em /proc/<tid>/io e não entram na contagem. A cada tick, o
+ * CPU% e o RSS do processo do monitor também são registrados.
+ *
+ * Os valores vão para histogramas log-lineares de memória fixa (8
+ * sub-buckets lineares por potência de 2, erro relativo <= 12,5%), sem
+ * log() nem alocação no caminho quente. Desligado, begin/end retornam
+ * logo no teste do flag.
+ *
+ * Cada coletor é instrumentado por uma única thread (a de coleta; o
+ * smaps_rollup na thread lenta; o exportador na principal), então os
+ * histogramas não usam locks.
+ */
+
+#define SELF_HIST_SUB 8                             // sub-buckets por potência de 2
+#define SELF_HIST_BUCKETS (2 * SELF_HIST_SUB + 60 * SELF_HIST_SUB)
+
+typedef struct {
+    uint64_t counts[SELF_HIST_BUCKETS];
+    uint64_t n;
+    uint64_t sum;
+    uint64_t max;
+} self_hist_t;
+
+void self_hist_record(self_hist_t *h, uint64_t v);
+/** @brief Quantil q em [0,1] (limite superior do bucket, no máximo max). 0 se vazio. */
+uint64_t self_hist_quantile(const self_hist_t *h, double q);
+double self_hist_mean(const self_hist_t *h);
+
+typedef enum {
+    SELF_CPU,           // monitor_cpu_usage
+    SELF_MEM,           // monitor_memory_usage
+    SELF_IO,            // monitor_io_usage
+    SELF_SCHED,         // monitor_schedstat (task/<tid>/schedstat de cada thread)
+    SELF_NET,           // net/dev + net/snmp do netns do alvo (netns_cache_read)
+    SELF_FD,            // /proc/<pid>/fd e, com --fd-sockets, net/tcp{,6}
+    SELF_PERF,          // perfcount_read (um read() por grupo)
+    SELF_CGROUP,        // cgroup_read_metrics / PSI / memória disponível
+    SELF_SMAPS,         // monitor_smaps_rollup (thread lenta, um processo por chamada)
+    SELF_EXPORT,        // exportadores (CSV/JSON/.rmb, resumo)
+    SELF_TICK,          // coleta completa de uma amostra (inclui as sondas internas)
+    SELF_NCOLLECTORS
+} self_collector_t;
+
+typedef struct {
+    self_hist_t time_ns;
+    self_hist_t syscalls;
+    self_hist_t bytes;
+} self_collector_stats_t;
+
+typedef struct {
+    struct timespec t0;
+    unsigned long long syscalls;
+    unsigned long long rchar;
+    unsigned long long probe_bytes;     // bytes lidos pela sonda de begin
+    int ok;                             // leitura de /proc/thread-self/io funcionou
+    int active;
+} self_probe_t;
+
+void selfstats_enable(int on);
+int selfstats_enabled(void);
+
+void selfstats_begin(self_probe_t *p);
+void selfstats_end(self_probe_t *p, self_collector_t which);
+
+/** @brief CPU% e RSS do processo do monitor desde o último tick. */
+void selfstats_tick(void);
+
+/** @brief Fecha a sonda da thread atual (chamar antes de a thread sair). */
+void selfstats_thread_done(void);
+
+const self_collector_stats_t *selfstats_collector(self_collector_t which);
+const char *selfstats_collector_name(self_collector_t which);
+
+/** @brief Tabela de custo por coletor no terminal. */
+void selfstats_print(FILE *out);
+
+/**
+ * @brief Grava <base>.selfstats.csv (coletor,métrica,count,mean,p50,p90,p99,max).
+ * @return 0 em sucesso, -1 em erro.
+ */
+int selfstats_write(const char *base);
+
+#endif
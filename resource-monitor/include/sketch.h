@@ -0,0 +1,65 @@
+#ifndef SKETCH_H
+#define SKETCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "monitor.h"
+
+/*
+ * DDSketch: sketch de quantis com erro relativo garantido (alpha) e
+ * memória fixa. Valores positivos caem em buckets logarítmicos de base
+ * gamma = (1 + alpha) / (1 - alpha); zero (e negativos) vão para um
+ * contador separado. Quando a faixa de chaves excede DDS_MAX_BINS, os
+ * buckets mais baixos são colapsados (os quantis altos continuam exatos
+ * dentro de alpha). Dois sketches com o mesmo alpha podem ser mesclados.
+ */
+
+#define DDS_MAX_BINS 1024
+#define DDS_DEFAULT_ALPHA 0.01
+
+typedef struct {
+    double gamma;
+    double log_gamma;
+    int offset;                 // chave de bins[0]
+    int min_key;                // menor chave ocupada
+    int max_key;                // maior chave ocupada
+    int has_bins;
+    uint32_t bins[DDS_MAX_BINS];
+    uint64_t zero_count;        // valores <= 0 (ou menores que o indexável)
+    uint64_t count;
+    double sum;
+    double min;
+    double max;
+} ddsketch_t;
+
+void   ddsketch_init(ddsketch_t *s, double alpha);
+void   ddsketch_add(ddsketch_t *s, double v);
+/** @return 0 em sucesso, -1 se os alphas forem diferentes. */
+int    ddsketch_merge(ddsketch_t *dst, const ddsketch_t *src);
+/** @brief Quantil q em [0,1] (0.5 = mediana). Retorna 0 se vazio. */
+double ddsketch_quantile(const ddsketch_t *s, double q);
+double ddsketch_mean(const ddsketch_t *s);
+
+/*
+ * Conjunto de sketches de um alvo (PID): CPU%, RSS, taxas de I/O e espera
+ * na fila de CPU, atualizado a cada amostra.
+ */
+#define SUMMARY_MAX_METRICS 8
+
+typedef struct {
+    pid_t pid;
+    int nmetrics;
+    int field_idx[SUMMARY_MAX_METRICS];   // índices na tabela de export.h
+    ddsketch_t sk[SUMMARY_MAX_METRICS];
+} metric_summary_t;
+
+void metric_summary_init(metric_summary_t *ms, pid_t pid);
+void metric_summary_add(metric_summary_t *ms, const proc_metrics_t *m);
+/** @return 0 em sucesso, -1 se os conjuntos forem incompatíveis. */
+int  metric_summary_merge(metric_summary_t *dst, const metric_summary_t *src);
+/** @brief Nome do campo da métrica k (ex: "cpu_percent"). */
+const char *metric_summary_name(const metric_summary_t *ms, int k);
+/** @brief Imprime p50/p90/p99/max no terminal. */
+void metric_summary_print(const metric_summary_t *ms);
+
+#endif
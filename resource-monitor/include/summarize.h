@@ -0,0 +1,29 @@
+#ifndef SUMMARIZE_H
+#define SUMMARIZE_H
+
+/*
+ * Agregação nativa dos experimentos (--summarize <dir>).
+ *
+ * Detecta o experimento pelo arquivo de resultados presente no diretório
+ * (mesma ordem de scripts/visualize.py) e grava o CSV agregado que o
+ * script de plots consome, lendo cada arquivo uma única vez:
+ *
+ *   experiment2_results.csv -> exp2_time_agg.csv, exp2_isolation_heat.csv
+ *   exp3_results.csv        -> exp3_agg.csv (utilização da cota de CPU)
+ *   exp4_results.csv        -> exp4_agg.csv (alocação x limite, failcnt, OOM)
+ *   exp5_results.csv        -> exp5_agg.csv (vazão x limite de I/O)
+ *   overhead_summary.csv    -> aggregated_summary.csv (overhead por intervalo)
+ *                              e latency_per_run.csv (a partir de metrics_*.csv)
+ *
+ * Percentis das amostras de metrics_*.csv (CPU%, latência de amostragem)
+ * vêm de DDSketch (erro relativo de 1%); a mediana do exp2 é exata.
+ */
+
+/**
+ * @brief Agrega o experimento em dir e grava os CSVs em out_dir
+ * (NULL = <dir>/plots, criado se preciso).
+ * @return 0 em sucesso, -1 em erro.
+ */
+int summarize_experiment(const char *dir, const char *out_dir);
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef TOP_H
+#define TOP_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "monitor.h"
+#include "workpool.h"
+#include "batchread.h"
+
+/*
+ * Painel estilo top para todos os processos (--top).
+ *
+ * Uma thread coletora varre /proc no intervalo configurado (um read() de
+ * /proc/<pid>/stat por processo; cgroup e namespace só na primeira vez
+ * que o PID aparece) e publica um quadro completo. A interface não
+ * dirige a coleta: ela copia o último quadro publicado quando há um
+ * novo, monta a visão (filtro, ordenação, agrupamento) e, no ncurses,
+ * reescreve só as linhas da tela cujo texto mudou.
+ *
+ * Com muitos processos, a leitura de cada PID vira uma tarefa do pool de
+ * coleta (workpool.h): um PID lento não segura os demais e o quadro só é
+ * publicado quando o tick inteiro terminou.
+ *
+ * O /proc/<pid>/stat de cada processo fica aberto entre ticks; com
+ * io_uring (batchread.h) as leituras do tick inteiro saem num lote só, e
+ * sem ele cada tarefa faz um pread no próprio descritor.
+ *
+ * A rede é do namespace, não do processo: depois da varredura, net/dev e
+ * net/snmp são lidos uma vez por netns (netns_cache_t), pelo primeiro
+ * processo de cada um, e as taxas vão para todas as linhas do namespace.
+ */
+
+#define TOP_SPARK_LEN 16
+#define TOP_STAT_BUF 1024           // bytes lidos de /proc/<pid>/stat
+#define TOP_POOL_MIN_TARGETS 256     // com workers = 0, abaixo disso a varredura é serial
+
+typedef struct {
+    pid_t pid;
+    char comm[32];
+    char state;                     // R, S, D, Z...
+    double cpu_percent;             // 100% = um núcleo
+    unsigned long rss_kb;
+    int threads;
+    double minflt_per_s;
+    double majflt_per_s;
+    char cgroup[128];               // caminho no cgroup v2 ("/" se desconhecido)
+    unsigned long pidns;            // inode do namespace de PID (0 se ilegível)
+    unsigned long netns;            // inode do namespace de rede (0 se ilegível)
+    double net_rx_per_s;            // bytes/s do netns inteiro (iguais nas linhas do mesmo netns)
+    double net_tx_per_s;
+    float spark[TOP_SPARK_LEN];     // histórico de CPU%, mais antigo primeiro
+} top_row_t;
+
+typedef struct {
+    top_row_t *rows;
+    size_t count;
+    size_t cap;
+    double timestamp;
+    unsigned long generation;       // incrementa a cada quadro publicado
+    double cpu_total;               // soma de cpu_percent
+    double scan_ms;                 // custo da última varredura
+    int workers;                    // threads usadas na varredura
+    size_t steals;                  // roubos de trabalho na varredura
+    const char *io_backend;         // "io_uring" ou "pread"
+    size_t io_syscalls;             // syscalls de leitura de stat na varredura
+    size_t net_reads;               // namespaces de rede lidos na varredura
+} top_frame_t;
+
+/* estado de um PID entre varreduras (interno ao coletor) */
+typedef struct {
+    top_row_t row;
+    unsigned long long starttime;   // distingue PIDs reutilizados
+    unsigned long long jiffies;
+    unsigned long long minflt;
+    unsigned long long majflt;
+    int stat_fd;                    // /proc/<pid>/stat aberto (-1 se não houver)
+} top_proc_t;
+
+typedef struct {
+    long interval_ms;
+    const char *proc_root;          // NULL = /proc (--proc-root)
+    top_proc_t *procs;              // ordenado por PID
+    size_t nprocs;
+    double last_scan;               // relógio monotônico da última varredura (s)
+    int workers;                    // 0 = automático (um por núcleo), 1 = serial
+    workpool_t pool;
+    int pool_ready;
+    int io_backend;                 // batchread_backend_t pedido (AUTO = io_uring se houver)
+    batchread_t io;
+    int io_ready;
+    char *statbuf;                  // TOP_STAT_BUF bytes por PID
+    batchread_req_t *reqs;
+    size_t buf_cap;
+    netns_cache_t net;
+
+    pthread_t thread;
+    pthread_mutex_t lock;           // protege published
+    pthread_cond_t wake;
+    atomic_int stop;
+    int started;
+    top_frame_t published;
+} top_collector_t;
+
+/** @return 0 em sucesso, -1 em erro. */
+int top_collector_init(top_collector_t *c, long interval_ms);
+
+/** @brief Uma varredura de /proc seguida da publicação do quadro. */
+int top_collector_scan(top_collector_t *c);
+
+/** @brief Inicia a thread coletora. @return 0 em sucesso, -1 em erro. */
+int top_collector_start(top_collector_t *c);
+
+/**
+ * @brief Copia o quadro publicado para out se ele for mais novo que out->generation.
+ * @return 1 se copiou, 0 se não há quadro novo, -1 sem memória.
+ */
+int top_snapshot(top_collector_t *c, top_frame_t *out);
+
+/** @brief Para a thread (se iniciada) e libera o coletor. */
+void top_collector_free(top_collector_t *c);
+
+void top_frame_free(top_frame_t *f);
+
+/* ===================== VISÃO ====================== */
+
+typedef enum { TOP_SORT_CPU, TOP_SORT_MEM, TOP_SORT_PID, TOP_SORT_THREADS, TOP_SORT_NAME } top_sort_t;
+typedef enum { TOP_GROUP_NONE, TOP_GROUP_CGROUP, TOP_GROUP_PIDNS, TOP_GROUP_NETNS } top_group_t;
+
+typedef struct {
+    top_sort_t sort;
+    int reverse;                    // inverte a ordem padrão da coluna
+    top_group_t group;
+    char filter[64];                // substring em comando ou cgroup ("" = todos)
+    int hide_idle;                  // esconde processos com 0% de CPU
+} top_view_t;
+
+/* linha da tela: cabeçalho de grupo ou processo */
+typedef struct {
+    int is_group;
+    const top_row_t *row;           // NULL em cabeçalhos de grupo
+    char key[128];                  // cgroup, "pidns:<inode>" ou "netns:<inode>" nos grupos
+    double cpu_percent;             // soma no grupo
+    unsigned long rss_kb;           // soma no grupo
+    int nprocs;
+    int has_net;                    // grupo por netns: taxas de rede do namespace
+    double net_rx_per_s, net_tx_per_s;
+} top_line_t;
+
+void top_view_default(top_view_t *v);
+
+/**
+ * @brief Filtra, ordena e agrupa o quadro. Grupos são ordenados pelo total
+ * da coluna de ordenação e seus processos vêm logo abaixo do cabeçalho.
+ * @return Número de linhas escritas em out (no máximo max).
+ */
+size_t top_view_build(const top_view_t *v, const top_frame_t *f, top_line_t *out, size_t max);
+
+/** @brief Cabeçalho das colunas, alinhado com top_format_line. */
+void top_format_header(char *buf, size_t size, int width);
+
+/** @brief Texto de uma linha (UTF-8, até width colunas de tela). */
+void top_format_line(const top_line_t *l, char *buf, size_t size, int width);
+
+/**
+ * @brief Executa o painel até 'q' ou Ctrl+C (ncurses; sem ncurses, imprime
+ * as linhas mais ativas a cada quadro, como top -b).
+ * @return 0 em sucesso, -1 em erro.
+ */
+int top_run(double interval_s, int workers, int io_backend, const char *proc_root);
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef TREND_H
+#define TREND_H
+
+/*
+ * Tendência de crescimento online (RSS, memory.current) e previsão do
+ * tempo até atingir um limite.
+ *
+ * Duas estimativas do coeficiente angular são mantidas em memória fixa:
+ *   - mínimos quadrados com peso exponencial (meia-vida configurável),
+ *     atualizado em O(1) por amostra;
+ *   - Theil–Sen (mediana das inclinações entre pares) sobre uma janela de
+ *     TREND_WINDOW pontos espaçados, robusta a picos isolados (ex: GC).
+ * A previsão usa a robusta quando a janela tem pontos suficientes.
+ */
+
+#define TREND_WINDOW 32
+
+typedef struct {
+    double half_life_s;
+    double step_s;              // espaçamento mínimo entre pontos da janela
+
+    double t0;                  // origem do tempo (primeira amostra)
+    double last_t;
+    double last_y;
+    unsigned long n;
+
+    // somas ponderadas (mínimos quadrados exponenciais), t relativo a t0
+    double sw, swt, swy, swtt, swty;
+
+    // janela circular para Theil–Sen
+    double wt[TREND_WINDOW];
+    double wy[TREND_WINDOW];
+    int wn;
+    int whead;
+} trend_t;
+
+typedef struct {
+    double slope;               // unidades/s usada na previsão
+    double slope_ls;            // mínimos quadrados exponenciais
+    double slope_robust;        // Theil–Sen (NaN se a janela for curta)
+    double level;               // nível estimado no último instante
+    double t;                   // último instante
+} trend_estimate_t;
+
+/** @brief Inicializa com a meia-vida (s) dos pesos; a janela cobre ~2 meias-vidas. */
+void trend_init(trend_t *tr, double half_life_s);
+
+/** @brief Acrescenta o ponto (t, y). Amostras fora de ordem são ignoradas. */
+void trend_add(trend_t *tr, double t, double y);
+
+/**
+ * @brief Estima inclinação e nível atuais.
+ * @return 0 em sucesso, -1 se ainda não houver pontos suficientes.
+ */
+int trend_estimate(const trend_t *tr, trend_estimate_t *est);
+
+/**
+ * @brief Segundos até o nível atingir limit no ritmo atual.
+ * @return Tempo em s (0 se já atingiu) ou INFINITY se não está crescendo.
+ */
+double trend_time_to(const trend_estimate_t *est, double limit);
+
+#endif
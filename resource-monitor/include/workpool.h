@@ -0,0 +1,63 @@
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/*
+ * Pool fixo de threads para a coleta de muitos alvos por tick.
+ *
+ * Cada tick entrega N tarefas (índices 0..N-1). Elas começam repartidas
+ * em faixas contíguas, uma deque por worker; cada worker consome a sua
+ * pela frente e, quando esvazia, rouba a metade de trás da deque de
+ * outro worker. Um alvo lento (status enorme, processo em D, leitura de
+ * /proc travada) prende só o worker que o está lendo: o resto da faixa
+ * dele é roubado pelos ociosos. workpool_run só retorna quando todas as
+ * tarefas do tick terminaram (barreira), então o chamador publica o
+ * tick inteiro com um único timestamp.
+ */
+
+typedef void (*workpool_fn)(void *ctx, size_t index);
+
+/* deque de um worker: faixa [lo, hi) de índices ainda não iniciados */
+typedef struct {
+    _Alignas(64) pthread_mutex_t lock;
+    size_t lo;
+    size_t hi;
+} workpool_deque_t;
+
+typedef struct {
+    int nworkers;
+    pthread_t *threads;
+    workpool_deque_t *deques;
+
+    pthread_mutex_t lock;           // estado do tick abaixo
+    pthread_cond_t start;
+    pthread_cond_t done;
+    unsigned long tick;             // incrementa a cada workpool_run
+    int active;                     // workers ainda trabalhando no tick
+    int quit;
+    workpool_fn fn;
+    void *ctx;
+
+    atomic_size_t steals;           // roubos no último tick
+    double last_run_ms;             // duração do último tick
+} workpool_t;
+
+/**
+ * @brief Cria o pool com nworkers threads (0 = uma por núcleo).
+ * @return 0 em sucesso, -1 em erro.
+ */
+int workpool_init(workpool_t *p, int nworkers);
+
+/**
+ * @brief Executa fn(ctx, i) para i em 0..ntasks-1 e espera todas terminarem.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int workpool_run(workpool_t *p, size_t ntasks, workpool_fn fn, void *ctx);
+
+/** @brief Encerra e aguarda as threads do pool. */
+void workpool_free(workpool_t *p);
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef WSS_H
+#define WSS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * Estimativa do working set (--wss).
+ *
+ * O RSS diz quanto está residente, não quanto o processo usa: páginas
+ * tocadas uma vez na inicialização continuam contando. Para o working set
+ * de uma janela, as páginas do alvo são marcadas como "não acessadas" no
+ * início e contadas as que perderam a marca no fim.
+ *
+ * - idle: /proc/<pid>/pagemap dá o PFN de cada página presente e
+ *   /sys/kernel/mm/page_idle/bitmap (1 bit por PFN) recebe a marca. Exige
+ *   CONFIG_IDLE_PAGE_TRACKING e CAP_SYS_ADMIN (sem ele o pagemap devolve
+ *   PFN 0). Não altera nada visível ao alvo além dos bits de acesso.
+ * - refs: escreve 1 em /proc/<pid>/clear_refs e, no fim, soma Referenced
+ *   de smaps_rollup. Só exige poder fazer ptrace no alvo, mas zera os bits
+ *   de acesso de todas as páginas dele, o que o reclaim vê como páginas
+ *   frias durante a janela.
+ * - auto: idle se disponível, senão refs.
+ *
+ * O pagemap é lido em lotes de WSS_PAGEMAP_BATCH entradas por pread, e os
+ * PFNs ordenados viram trechos contínuos do bitmap (palavras de 64 bits,
+ * o único acesso que o kernel aceita) de até WSS_BITMAP_BATCH_WORDS
+ * palavras: lacunas curtas entre PFNs são lidas junto, que custa menos
+ * que outra syscall.
+ */
+
+#define WSS_PAGEMAP_BATCH 65536         // entradas de 8 bytes por pread (512 KiB)
+#define WSS_BITMAP_BATCH_WORDS 32768    // palavras de 64 bits por pread/pwrite (256 KiB)
+#define WSS_BITMAP_MAX_GAP 512          // palavras de lacuna absorvidas num trecho (4 KiB)
+
+typedef enum {
+    WSS_AUTO,
+    WSS_IDLE,
+    WSS_REFS
+} wss_method_t;
+
+typedef struct {
+    wss_method_t method;        // método efetivamente usado
+    double window_s;            // duração real da janela
+    unsigned long wss_kb;       // acessado na janela
+    unsigned long rss_kb;       // residente no fim da janela
+    size_t pages;               // páginas presentes examinadas (idle)
+    size_t syscalls;            // preads/pwrites em pagemap e bitmap (idle)
+    double scan_ms;             // tempo de marcar + conferir, fora a janela
+} wss_result_t;
+
+/* Trecho do bitmap: palavras [word, word + nwords) */
+typedef struct {
+    uint64_t word;
+    size_t nwords;
+} wss_run_t;
+
+/** @return Método ou -1 se o nome for inválido. */
+int wss_method_parse(const char *name);
+const char *wss_method_name(wss_method_t m);
+
+/**
+ * @brief Agrupa PFNs ordenados (sem repetição) em trechos do bitmap.
+ * @return Número de trechos gravados em runs (no máximo max_runs).
+ */
+size_t wss_plan_runs(const uint64_t *pfns, size_t n, size_t max_words, size_t max_gap,
+                     wss_run_t *runs, size_t max_runs);
+
+/**
+ * @brief Mede o working set de pid durante window_s segundos (bloqueia).
+ *        Em auto, cai para refs quando idle não é permitido.
+ * @return 0 em sucesso, -1 em erro.
+ */
+int wss_measure(pid_t pid, double window_s, wss_method_t method, wss_result_t *out);
+
+#endif
@@ -32,192 +32,43 @@ fi
 # Ensure DURATION is always defined (avoid unbound variable when running under sudo)
 : ${DURATION:=5}
 
-WORKLOAD_SRC="$ROOT_DIR/tests/bench_cpu.c"
-WORKLOAD_BIN="$ROOT_DIR/tests/bench_cpu"
 MONITOR_BIN="$ROOT_DIR/resource_monitor"
 
-# If no bench_cpu.c in tests, create a temporary CPU-bound workload in /tmp
-# If no bench_cpu.c in tests, create a temporary CPU-bound workload in repo tmp/
-ensure_workload() {
-  if [ -f "$WORKLOAD_SRC" ]; then
-    return 0
-  fi
-  TMPDIR="$ROOT_DIR/tmp"
-  mkdir -p "$TMPDIR"
-  TEMP_SRC="$TMPDIR/bench_cpu_tmp.c"
-  TEMP_BIN="$TMPDIR/bench_cpu_tmp"
-  cat > "$TEMP_SRC" <<'CEOF'
-#include <stdio.h>
-#include <stdlib.h>
-#include <time.h>
-#include <stdint.h>
-#include <unistd.h>
-int main(int argc, char **argv) {
-    int duration = argc>1 ? atoi(argv[1]) : 5;
-    volatile uint64_t counter = 0;
-    time_t end = time(NULL) + duration;
-    while (time(NULL) < end) {
-        // busy loop doing small work
-        for (int i=0;i<1000;i++) counter += i;
-    }
-    printf("ITERATIONS:%llu\n", (unsigned long long)counter);
-    return 0;
-}
-CEOF
-  gcc -O2 -o "$TEMP_BIN" "$TEMP_SRC" -lm || return 1
-  WORKLOAD_BIN="$TEMP_BIN"
-  return 0
-}
-
-# Ensure memory workload (allocating until OOM or stop)
-ensure_mem_workload() {
-  TMPDIR="$ROOT_DIR/tmp"
-  mkdir -p "$TMPDIR"
-  MEM_SRC="$TMPDIR/mem_alloc.c"
-  MEM_BIN="$TMPDIR/mem_alloc"
-  if [ -f "$MEM_BIN" ]; then
-    return 0
-  fi
-  cat > "$MEM_SRC" <<'CEOF'
-  #include <stdio.h>
-  #include <stdlib.h>
-  #include <string.h>
-  #include <time.h>
-  #include <unistd.h>
-  #include <sys/types.h>
-    EXP1_DIR="$OUTDIR/experiment1"
-    mkdir -p "$EXP1_DIR"
-
-    echo "[exp1] Running overhead experiment (duration=${DURATION}s) -> $EXP1_DIR"
-    # compile or ensure workload
-
-      gcc -O2 -o "$WORKLOAD_BIN" "$WORKLOAD_SRC" -lm || { echo "Failed to compile workload" >&2; return 1; }
-    else
-      ensure_workload || { echo "Failed to create temporary workload" >&2; return 1; }
-    fi
+# Native workload generator (make rm_workload): cpu/mem/io/fork profiles that
+# print the achieved throughput (THROUGHPUT:<ops/s>) when they finish.
+RM_WORKLOAD="$ROOT_DIR/rm_workload"
+WORKLOAD_CMD=("$RM_WORKLOAD" cpu --duration)
 
-    SUMMARY="$EXP1_DIR/overhead_summary.csv"
-    echo "mode,interval,run,elapsed_sec,percent_cpu" > "$SUMMARY"
-
-    INTERVALS=(1 0.5 0.2)
-    for interval in "${INTERVALS[@]}"; do
-      for run in 1 2 3; do
-        echo "[exp1] baseline interval=$interval run=$run"
-        /usr/bin/time -v -o "$EXP1_DIR/baseline_${interval}_${run}.time" "$WORKLOAD_BIN" "$DURATION" || true
-        elapsed_line=$(grep -E "Elapsed |Elapsed \(wall clock\)" -m1 "$EXP1_DIR/baseline_${interval}_${run}.time" || true)
-        elapsed_val=$(echo "$elapsed_line" | sed -E 's/.*: (.*)/\1/')
-        if [ -z "$elapsed_val" ]; then elapsed_sec=0; else elapsed_sec=$(echo "$elapsed_val" | awk -F: '{ if (NF==3) printf("%.3f", $1*3600 + $2*60 + $3); else if (NF==2) printf("%.3f", $1*60 + $2); else printf("%.3f", $1) }'); fi
-        pct_val=$(grep "Percent of CPU" -m1 "$EXP1_DIR/baseline_${interval}_${run}.time" | sed -E 's/[^0-9]*([0-9]+\.?[0-9]*).*/\1/' || true)
-        echo "baseline,$interval,$run,$elapsed_sec,$pct_val" >> "$SUMMARY"
-
-        echo "[exp1] monitored interval=$interval run=$run"
-        "$WORKLOAD_BIN" "$DURATION" &
-        wl_pid=$!
-        sleep 0.2
-        if [ -x "$MONITOR_BIN" ]; then
-          "$MONITOR_BIN" "$wl_pid" "$EXP1_DIR/metrics_${interval}_${run}.csv" "$interval" &
-          mon_pid=$!
-        else
-          mon_pid=""
-        fi
-        wait $wl_pid || true
-        sleep 0.5
-        if [ -n "${mon_pid}" ] && kill -0 "$mon_pid" 2>/dev/null; then kill "$mon_pid" || true; fi
-
-        if [ -f "$EXP1_DIR/metrics_${interval}_${run}.csv" ]; then
-          first_ts=$(awk -F, 'NR==2{print $1; exit}' "$EXP1_DIR/metrics_${interval}_${run}.csv")
-          last_ts=$(awk -F, 'END{print $1}' "$EXP1_DIR/metrics_${interval}_${run}.csv")
-          if [ -n "$first_ts" ] && [ -n "$last_ts" ]; then
-            elapsed_mon=$(awk "BEGIN{ if(\"$first_ts\"==\"\" || \"$last_ts\"==\"\") print 0; else printf(\"%.6f\", ($last_ts) - ($first_ts)) }")
-          else
-            elapsed_mon=0
-          fi
-          avg_cpu=$(awk -F, 'NR>1{sum+=$3; count++} END{if(count>0) printf("%.2f", sum/count); else print "0"}' "$EXP1_DIR/metrics_${interval}_${run}.csv")
-        else
-          elapsed_mon=0
-          avg_cpu=0
-        fi
-        echo "monitored,$interval,$run,$elapsed_mon,$avg_cpu" >> "$SUMMARY"
-      done
-    done
-
-    echo "[exp1] Done. Summary: $SUMMARY"
-ensure_io_workload() {
-  TMPDIR="$ROOT_DIR/tmp"
-  mkdir -p "$TMPDIR"
-  IO_SRC="$TMPDIR/io_workload.c"
-  IO_BIN="$TMPDIR/io_workload"
-  if [ -f "$IO_BIN" ]; then
+# Build rm_workload with the repo Makefile if it is missing
+ensure_workload() {
+  if [ -x "$RM_WORKLOAD" ]; then
     return 0
   fi
-  cat > "$IO_SRC" <<'CEOF'
-#define _POSIX_C_SOURCE 200809L
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <time.h>
-#include <unistd.h>
-#include <fcntl.h>
-#include <stdint.h>
-int main(int argc, char **argv) {
-    const char *path = argc>1 ? argv[1] : "/tmp/io_work.out";
-    int duration = argc>2 ? atoi(argv[2]) : 5;
-    size_t block = argc>3 ? (size_t)atoi(argv[3]) : 65536; // 64KB
-    char *buf = malloc(block);
-    if (!buf) return 2;
-    memset(buf, 'A', block);
-    int fd = open(path, O_CREAT|O_TRUNC|O_WRONLY, 0644);
-    if (fd<0) { perror("open"); return 2; }
-    struct timespec start, now;
-    clock_gettime(CLOCK_MONOTONIC, &start);
-    long total = 0;
-    long writes = 0;
-    while (1) {
-        if (write(fd, buf, block) != (ssize_t)block) break;
-        total += block; writes++;
-        if (writes % 10 == 0) {
-            fsync(fd);
-        }
-        clock_gettime(CLOCK_MONOTONIC, &now);
-        double elapsed = (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec)/1e9;
-        if (elapsed >= duration) break;
-    }
-    fsync(fd);
-    close(fd);
-    printf("TOTAL_BYTES:%ld\n", total);
-    printf("WRITES:%ld\n", writes);
-    return 0;
-}
-CEOF
-  gcc -O2 -o "$IO_BIN" "$IO_SRC" -lm || return 1
-  return 0
+  make -C "$ROOT_DIR" rm_workload >/dev/null || return 1
 }
 
 run_experiment() {
   echo "[exp1] Running overhead experiment (duration=${DURATION}s) -> $OUTDIR/experiment1"
-  # compile or ensure workload
-  if [ -f "$WORKLOAD_SRC" ]; then
-    gcc -O2 -o "$WORKLOAD_BIN" "$WORKLOAD_SRC" -lm || { echo "Failed to compile workload" >&2; return 1; }
-  else
-    ensure_workload || { echo "Failed to create temporary workload" >&2; return 1; }
-  fi
+  ensure_workload || { echo "Failed to build rm_workload" >&2; return 1; }
 
+  # throughput = rm_workload iterations/s; monitored vs baseline gives the overhead as throughput loss
   SUMMARY="$OUTDIR/overhead_summary.csv"
-  echo "mode,interval,run,elapsed_sec,percent_cpu" > "$SUMMARY"
+  echo "mode,interval,run,elapsed_sec,percent_cpu,throughput" > "$SUMMARY"
 
   INTERVALS=(1 0.5 0.2)
   for interval in "${INTERVALS[@]}"; do
     for run in 1 2 3; do
       echo "[exp1] baseline interval=$interval run=$run"
-      /usr/bin/time -v -o "$OUTDIR/baseline_${interval}_${run}.time" "$WORKLOAD_BIN" "$DURATION" || true
+      /usr/bin/time -v -o "$OUTDIR/baseline_${interval}_${run}.time" "${WORKLOAD_CMD[@]}" "$DURATION" > "$OUTDIR/baseline_${interval}_${run}.log" || true
+      thr=$(grep -Eo 'THROUGHPUT:[0-9.]+' "$OUTDIR/baseline_${interval}_${run}.log" | tail -1 | cut -d: -f2 || true)
       elapsed_line=$(grep -E "Elapsed |Elapsed \(wall clock\)" -m1 "$OUTDIR/baseline_${interval}_${run}.time" || true)
       elapsed_val=$(echo "$elapsed_line" | sed -E 's/.*: (.*)/\1/')
       if [ -z "$elapsed_val" ]; then elapsed_sec=0; else elapsed_sec=$(echo "$elapsed_val" | awk -F: '{ if (NF==3) printf("%.3f", $1*3600 + $2*60 + $3); else if (NF==2) printf("%.3f", $1*60 + $2); else printf("%.3f", $1) }'); fi
       pct_val=$(grep "Percent of CPU" -m1 "$OUTDIR/baseline_${interval}_${run}.time" | sed -E 's/[^0-9]*([0-9]+\.?[0-9]*).*/\1/' || true)
-      echo "baseline,$interval,$run,$elapsed_sec,$pct_val" >> "$SUMMARY"
+      echo "baseline,$interval,$run,$elapsed_sec,$pct_val,$thr" >> "$SUMMARY"
 
       echo "[exp1] monitored interval=$interval run=$run"
-      "$WORKLOAD_BIN" "$DURATION" &
+      "${WORKLOAD_CMD[@]}" "$DURATION" > "$OUTDIR/monitored_${interval}_${run}.log" &
       wl_pid=$!
       sleep 0.2
       if [ -x "$MONITOR_BIN" ]; then
@@ -243,7 +94,8 @@ run_experiment() {
         elapsed_mon=0
         avg_cpu=0
       fi
-      echo "monitored,$interval,$run,$elapsed_mon,$avg_cpu" >> "$SUMMARY"
+      thr=$(grep -Eo 'THROUGHPUT:[0-9.]+' "$OUTDIR/monitored_${interval}_${run}.log" | tail -1 | cut -d: -f2 || true)
+      echo "monitored,$interval,$run,$elapsed_mon,$avg_cpu,$thr" >> "$SUMMARY"
     done
   done
 
@@ -343,7 +195,7 @@ PY
 
       # Run workload and measure CPU via /proc/<pid>/stat sampling with python
       LOG_FILE="$EXP3_DIR/workload_limit_${lim}_trial_${t}.log"
-      "$WORKLOAD_BIN" 5 > "$LOG_FILE" 2>&1 &
+      "${WORKLOAD_CMD[@]}" 5 > "$LOG_FILE" 2>&1 &
       wpid=$!
       # add to cgroup if possible
       if [ -d "$CG_DIR" ] && [ -w "$CG_DIR" ]; then
@@ -481,8 +333,7 @@ fi
 DURATION="${DURATION:-5}"
 
 # Workload and monitor locations
-WORKLOAD_SRC="$RESOURCE_MONITOR_DIR/tests/bench_cpu.c"
-WORKLOAD_BIN="$RESOURCE_MONITOR_DIR/tests/bench_cpu"
+WORKLOAD_CMD=("$RESOURCE_MONITOR_DIR/rm_workload" cpu --duration)
 MONITOR_BIN="$RESOURCE_MONITOR_DIR/resource_monitor"
 
 INTERVALS=(1 0.5 0.2)
@@ -490,17 +341,10 @@ INTERVALS=(1 0.5 0.2)
 run_experiment() {
   echo "Running overhead experiment (duration=${DURATION}s) -> $OUTDIR"
 
-  # compile workload if source exists
-  if [ -f "$WORKLOAD_SRC" ]; then
-    echo "Compiling workload: $WORKLOAD_SRC -> $WORKLOAD_BIN"
-    gcc -O2 -o "$WORKLOAD_BIN" "$WORKLOAD_SRC" -lm || {
-      echo "Failed to compile workload" >&2
-      return 1
-    }
-  else
-    echo "Workload source not found: $WORKLOAD_SRC" >&2
+  make -C "$RESOURCE_MONITOR_DIR" rm_workload >/dev/null || {
+    echo "Failed to build rm_workload" >&2
     return 1
-  fi
+  }
 
   if [ ! -x "$MONITOR_BIN" ]; then
     echo "Warning: monitor binary not found or not executable: $MONITOR_BIN" >&2
@@ -514,7 +358,7 @@ run_experiment() {
     for run in 1 2 3; do
       echo "--- Baseline run #$run (no monitor), interval=${interval} ---"
       # Time workload in foreground to get a baseline
-      /usr/bin/time -v -o "$OUTDIR/baseline_${interval}_${run}.time" "$WORKLOAD_BIN" "$DURATION" || true
+      /usr/bin/time -v -o "$OUTDIR/baseline_${interval}_${run}.time" "${WORKLOAD_CMD[@]}" "$DURATION" || true
 
       # extract elapsed and percent CPU robustly
       elapsed_line=$(grep -E "Elapsed |Elapsed \(wall clock\)" -m1 "$OUTDIR/baseline_${interval}_${run}.time" || true)
@@ -529,7 +373,7 @@ run_experiment() {
 
       echo "--- Monitored run #$run (interval=${interval}) ---"
       # Start workload in background
-      "$WORKLOAD_BIN" "$DURATION" &
+      "${WORKLOAD_CMD[@]}" "$DURATION" &
       wl_pid=$!
       sleep 0.2
 
@@ -603,10 +447,7 @@ run_experiment4() {
   echo "[exp4] Memory limit experiment -> $OUTDIR/experiment4"
   EXP4_DIR="$OUTDIR/experiment4"
   mkdir -p "$EXP4_DIR"
-  # Ensure mem workload is compiled into repo-local tmp/ (no sudo redirection issues)
-  TMPDIR="$RESOURCE_MONITOR_DIR/tmp"
-  mkdir -p "$TMPDIR"
-  ensure_mem_workload || { echo "Failed to build mem workload" >&2; return 1; }
+  make -C "$RESOURCE_MONITOR_DIR" rm_workload >/dev/null || { echo "Failed to build rm_workload" >&2; return 1; }
 
   # cgroup v2 target directory (best-effort). This script attempts to write
   # to /sys/fs/cgroup. Running the experiment with `sudo` is recommended so
@@ -643,7 +484,8 @@ run_experiment4() {
 
     LOG="$EXP4_DIR/mem_trial_${t}.log"
     # run workload inside cgroup if possible
-    "$TMPDIR/mem_alloc" 0 > "$LOG" 2>&1 &
+    # leak at 50 MB/s until the memory limit kills it; ALLOC: is printed every second
+    "$RESOURCE_MONITOR_DIR/rm_workload" mem --rate 50 --leak --duration 10 > "$LOG" 2>&1 &
     wpid=$!
     # move to cgroup
     if [ -d "$CG_DIR" ]; then
@@ -686,10 +528,7 @@ run_experiment5() {
   echo "[exp5] I/O limit experiment -> $OUTDIR/experiment5"
   EXP5_DIR="$OUTDIR/experiment5"
   mkdir -p "$EXP5_DIR"
-  # Ensure I/O workload is compiled into repo-local tmp/ to avoid sudo redirection issues
-  TMPDIR="$RESOURCE_MONITOR_DIR/tmp"
-  mkdir -p "$TMPDIR"
-  ensure_io_workload || { echo "Failed to build io workload" >&2; return 1; }
+  make -C "$RESOURCE_MONITOR_DIR" rm_workload >/dev/null || { echo "Failed to build rm_workload" >&2; return 1; }
 
   # cgroup v2 directory; best-effort writes are attempted. Running with sudo
   # is recommended so io.max and cgroup.procs can be written.
@@ -729,8 +568,8 @@ run_experiment5() {
 
       LOG="$EXP5_DIR/io_limit_${lim}_trial_${t}.log"
       OUTF="$EXP5_DIR/io_out_${lim}_${t}.dat"
-      # run workload (uses repo-local tmp/io_workload)
-      "$TMPDIR/io_workload" "$OUTF" 5 65536 > "$LOG" 2>&1 &
+      # sequential 64 KB writes with fsync every 10 blocks
+      "$RESOURCE_MONITOR_DIR/rm_workload" io --file "$OUTF" --duration 5 --block 64 --fsync 10 > "$LOG" 2>&1 &
       wpid=$!
       # move to cgroup
       if [ -d "$CG_DIR" ]; then
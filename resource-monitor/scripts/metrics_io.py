@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+"""
+scripts/metrics_io.py
+
+Readers for the metrics files written by resource_monitor (CSV and JSON),
+using only the standard library so both the plotting code and the converter
+can share them.
+
+Recordings made with `--suppress <eps> [--heartbeat N]` only store samples
+whose selected metrics changed. They carry their parameters:
+  - CSV:  a first line `# rm-suppressed interval=1 epsilon=0 heartbeat=60`
+  - JSON: an object `{"suppression": {...}, "samples": [...]}`
+`read_metrics(..., expand=True)` re-inserts the skipped samples by repeating
+the last stored row of each PID every `interval` seconds. `epsilon` is
+relative to each field's last stored value (0 = any change), the same rule
+as export_mark_kept in src/export.c; `suppress_rows` applies it here.
+
+Usage (converter):
+  python3 scripts/metrics_io.py in.csv out.csv          # re-expand
+  python3 scripts/metrics_io.py in.json out.csv         # JSON -> CSV
+  python3 scripts/metrics_io.py in.csv out.csv --suppress 0.05 [--heartbeat 60]
+"""
+import csv
+import json
+import sys
+from pathlib import Path
+
+SUPPRESSED_TAG = '# rm-suppressed'
+
+# JSON field name -> CSV header written by export_metrics_csv, in the order of
+# the field table in src/export.c (keep both in sync when adding a column)
+CSV_HEADERS = {
+    'timestamp': 'Timestamp', 'pid': 'PID', 'cpu_percent': 'CPU%',
+    'threads': 'Threads', 'voluntary_ctxt': 'VolCtx', 'involuntary_ctxt': 'InvCtx',
+    'rss_kb': 'RSS(kB)', 'vmsize_kb': 'VSZ(kB)', 'minflt': 'MinFlt', 'majflt': 'MajFlt',
+    'swap_kb': 'Swap(kB)', 'rchar': 'RChar', 'wchar': 'WChar', 'read_bytes': 'ReadBytes',
+    'write_bytes': 'WriteBytes', 'syscalls': 'Syscalls', 'rchar_per_s': 'RChar/s',
+    'wchar_per_s': 'WChar/s', 'read_bytes_per_s': 'ReadBytes/s',
+    'write_bytes_per_s': 'WriteBytes/s', 'syscalls_per_s': 'Syscalls/s',
+    'task_clock_ms_per_s': 'TaskClock(ms/s)', 'ctx_switches_per_s': 'CtxSw/s',
+    'cpu_migrations_per_s': 'Migrations/s', 'page_faults_per_s': 'PageFaults/s',
+    'cycles_per_s': 'Cycles/s', 'instructions_per_s': 'Instructions/s',
+    'cache_misses_per_s': 'CacheMisses/s', 'ipc': 'IPC',
+    'cpu_run_ms_per_s': 'CpuRun(ms/s)', 'cpu_wait_ms_per_s': 'CpuWait(ms/s)',
+    'wait_per_slice_us': 'WaitPerSlice(us)',
+    'net_rx_bytes_per_s': 'NetRx(B/s)', 'net_tx_bytes_per_s': 'NetTx(B/s)',
+    'net_rx_packets_per_s': 'NetRxPkts/s', 'net_tx_packets_per_s': 'NetTxPkts/s',
+    'net_drops_per_s': 'NetDrops/s', 'tcp_retrans_per_s': 'TcpRetrans/s',
+    'fd_count': 'Fds', 'fd_files': 'FdFiles', 'fd_sockets': 'FdSockets', 'fd_pipes': 'FdPipes',
+    'fd_eventfds': 'FdEventfds', 'fd_anon': 'FdAnon', 'fd_limit': 'FdLimit',
+    'fd_growth_per_s': 'FdGrowth/s', 'tcp_established': 'TcpEstab', 'tcp_listen': 'TcpListen',
+    'tcp_close_wait': 'TcpCloseWait', 'tcp_other': 'TcpOther',
+}
+
+
+def parse_suppression_line(line: str):
+    """Parse `# rm-suppressed k=v ...` into a dict of floats (None if not a tag)."""
+    if not line.startswith(SUPPRESSED_TAG):
+        return None
+    params = {}
+    for tok in line[len(SUPPRESSED_TAG):].split():
+        if '=' in tok:
+            k, v = tok.split('=', 1)
+            try:
+                params[k] = float(v)
+            except ValueError:
+                pass
+    return params
+
+
+def expand_rows(header, rows, interval, ts_col=0, pid_col=1):
+    """Re-insert suppressed samples: between two stored rows of the same PID,
+    repeat the earlier row every `interval` seconds."""
+    if not interval or interval <= 0:
+        return rows
+    last_by_pid = {}
+    out = []
+    for row in rows:
+        try:
+            ts = float(row[ts_col])
+        except (ValueError, IndexError):
+            out.append(row)
+            continue
+        pid = row[pid_col] if len(row) > pid_col else None
+        prev = last_by_pid.get(pid)
+        if prev is not None:
+            prev_ts, prev_row = prev
+            t = prev_ts + interval
+            # same type as the stored timestamp: text in CSV, a number in JSON
+            as_text = isinstance(prev_row[ts_col], str)
+            while t < ts - interval / 2.0:
+                filler = list(prev_row)
+                if as_text:
+                    filler[ts_col] = f"{t:.0f}" if float(t).is_integer() else f"{t:g}"
+                else:
+                    filler[ts_col] = t
+                out.append(filler)
+                t += interval
+        out.append(row)
+        last_by_pid[pid] = (ts, row)
+    return out
+
+
+def _num(v):
+    try:
+        return float(v)
+    except (TypeError, ValueError):
+        return None
+
+
+def row_changed(row, ref, epsilon, skip=()):
+    """True if any column moved more than `epsilon` times its value in `ref`
+    (export_mark_kept's rule); non-numeric cells compare as text."""
+    for i, (a, b) in enumerate(zip(row, ref)):
+        if i in skip:
+            continue
+        va, vb = _num(a), _num(b)
+        if va is None or vb is None:
+            if a != b:
+                return True
+        elif abs(va - vb) > epsilon * abs(vb):
+            return True
+    return False
+
+
+def suppress_rows(rows, epsilon, heartbeat=0.0, ts_col=0, pid_col=1):
+    """Keep only the rows `--suppress epsilon --heartbeat N` would have written:
+    the first and last row of each PID, rows that changed beyond `epsilon`
+    relative to the last kept row of that PID, and heartbeats."""
+    last_idx = {}
+    for i, row in enumerate(rows):
+        last_idx[row[pid_col]] = i
+    kept_by_pid = {}
+    out = []
+    skip = (ts_col, pid_col)
+    for i, row in enumerate(rows):
+        pid = row[pid_col]
+        ref = kept_by_pid.get(pid)
+        keep = (ref is None or i == last_idx[pid] or row_changed(row, ref, epsilon, skip) or
+                (heartbeat > 0 and _num(row[ts_col]) - _num(ref[ts_col]) >= heartbeat))
+        if keep:
+            kept_by_pid[pid] = row
+            out.append(row)
+    return out
+
+
+def _min_step(rows, ts_col=0, pid_col=1):
+    """Smallest positive timestamp step within a PID (the sampling interval)."""
+    prev, step = {}, None
+    for row in rows:
+        ts = _num(row[ts_col])
+        if ts is None:
+            continue
+        p = prev.get(row[pid_col])
+        if p is not None and ts > p and (step is None or ts - p < step):
+            step = ts - p
+        prev[row[pid_col]] = ts
+    return step or 1.0
+
+
+def read_metrics_csv(path, expand=True):
+    """Return (header, rows, suppression_params_or_None) for a metrics CSV."""
+    path = Path(path)
+    with path.open('r', encoding='utf-8', newline='') as fh:
+        first = fh.readline()
+        params = parse_suppression_line(first)
+        if params is None:
+            fh.seek(0)
+        reader = csv.reader(line for line in fh if not line.startswith('#'))
+        header = next(reader, [])
+        rows = [r for r in reader if r]
+    if params is not None and expand:
+        rows = expand_rows(header, rows, params.get('interval', 0.0))
+    return header, rows, params
+
+
+def read_metrics_json(path, expand=True):
+    """Return (header, rows, suppression_params_or_None) for a metrics JSON."""
+    with Path(path).open('r', encoding='utf-8') as fh:
+        doc = json.load(fh)
+    params = None
+    samples = doc
+    if isinstance(doc, dict):
+        params = doc.get('suppression')
+        samples = doc.get('samples', [])
+    keys = list(samples[0].keys()) if samples else []
+    header = [CSV_HEADERS.get(k, k) for k in keys]
+    rows = [[s.get(k, '') for k in keys] for s in samples]
+    if params is not None and expand and 'timestamp' in keys and 'pid' in keys:
+        rows = expand_rows(header, rows, params.get('interval', 0.0),
+                           ts_col=keys.index('timestamp'), pid_col=keys.index('pid'))
+    return header, rows, params
+
+
+def read_metrics(path, expand=True):
+    p = str(path)
+    if p.endswith('.json'):
+        return read_metrics_json(path, expand=expand)
+    return read_metrics_csv(path, expand=expand)
+
+
+def main(argv):
+    args = argv[1:]
+    opts = {'--suppress': None, '--heartbeat': 0.0}
+    try:
+        for name in opts:
+            if name in args:
+                i = args.index(name)
+                opts[name] = float(args[i + 1])
+                del args[i:i + 2]
+    except (IndexError, ValueError):
+        args = []
+    if len(args) != 2:
+        print(__doc__.strip().split('Usage (converter):')[-1], file=sys.stderr)
+        return 1
+    header, rows, _ = read_metrics(args[0], expand=True)
+    epsilon = opts['--suppress']
+    with open(args[1], 'w', encoding='utf-8', newline='') as fh:
+        if epsilon is not None:
+            interval = _min_step(rows)
+            heartbeat = opts['--heartbeat']
+            rows = suppress_rows(rows, epsilon, heartbeat)
+            fh.write(f"{SUPPRESSED_TAG} interval={interval:g} epsilon={epsilon:g} "
+                     f"heartbeat={heartbeat:g}\n")
+        w = csv.writer(fh, lineterminator='\n')
+        w.writerow(header)
+        w.writerows(rows)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
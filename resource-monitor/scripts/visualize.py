@@ -16,8 +16,15 @@ The script computes:
  - sampling latency statistics from per-run files metrics_<interval>_<run>.csv
  - saves plots and a summary CSV
 
+The aggregation itself is done by `resource_monitor --summarize <dir>` when
+the binary has been built (it streams every metrics file once and writes the
+aggregate CSVs); the pandas implementation below is only the fallback. Set
+RM_NO_NATIVE_SUMMARY=1 to force the pandas path.
+
 """
 import argparse
+import os
+import subprocess
 import sys
 from pathlib import Path
 import pandas as pd
@@ -27,6 +34,8 @@ import seaborn as sns
 import logging
 import json
 
+from metrics_io import read_metrics
+
 logging.basicConfig(level=logging.INFO, format="%(levelname)s: %(message)s")
 sns.set(style="whitegrid")
 
@@ -43,13 +52,33 @@ def discover_metrics_files(experiment_dir: Path):
     return sorted(experiment_dir.glob("metrics_*.csv"))
 
 
+def load_metrics_frame(metrics_file: Path, expand: bool = True) -> pd.DataFrame:
+    """Load a resource_monitor CSV/JSON into a DataFrame.
+
+    Recordings made with --suppress are re-expanded to one row per interval
+    unless expand=False. The suppression parameters (or None) are stored in
+    df.attrs['suppression'].
+    """
+    header, rows, params = read_metrics(metrics_file, expand=expand)
+    df = pd.DataFrame(rows, columns=header)
+    for c in df.columns:
+        df[c] = pd.to_numeric(df[c], errors='coerce')
+    df.attrs['suppression'] = params
+    return df
+
+
 def compute_latency_stats(metrics_file: Path):
     try:
-        df = pd.read_csv(metrics_file, header=0)
+        df = load_metrics_frame(metrics_file, expand=False)
     except Exception as e:
         logging.warning(f"Failed to read {metrics_file}: {e}")
         return None
 
+    if df.attrs.get('suppression') is not None:
+        # suppressed recordings do not keep every sample time
+        logging.info(f"Skipping latency stats for suppressed recording {metrics_file.name}")
+        return None
+
     if df.shape[0] < 2:
         return None
 
@@ -74,6 +103,38 @@ def compute_latency_stats(metrics_file: Path):
     return stats
 
 
+def native_summarize(experiment_dir: Path, out_dir: Path) -> bool:
+    """Write the aggregate CSVs with `resource_monitor --summarize`.
+
+    Returns False when the binary is missing or fails, so callers fall back
+    to aggregating with pandas.
+    """
+    if os.environ.get('RM_NO_NATIVE_SUMMARY'):
+        return False
+    binary = Path(__file__).resolve().parents[1] / 'resource_monitor'
+    if not binary.exists():
+        return False
+    try:
+        res = subprocess.run([str(binary), '--summarize', str(experiment_dir), '--out', str(out_dir)],
+                             capture_output=True, text=True, timeout=600)
+    except Exception as e:
+        logging.warning(f"Native summarize failed: {e}")
+        return False
+    if res.returncode != 0:
+        logging.warning(f"Native summarize failed: {res.stderr.strip()}")
+        return False
+    logging.info(f"Aggregates computed by {binary.name} --summarize")
+    return True
+
+
+def read_native_agg(out_dir: Path, name: str, native: bool):
+    """Aggregate CSV written by native_summarize(), or None."""
+    p = out_dir / name
+    if not native or not p.exists():
+        return None
+    return pd.read_csv(p)
+
+
 def ensure_out_dir(p: Path):
     p.mkdir(parents=True, exist_ok=True)
     return p
@@ -178,6 +239,7 @@ def summarize_and_plot(experiment_dir: Path, out_dir: Path, save_formats=('png',
       - Experiment 2: presence of `experiment2_results.csv`
       - Experiment 3: presence of `exp3_results.csv`
     """
+    native = native_summarize(experiment_dir, out_dir)
     exp2_csv = experiment_dir / 'experiment2_results.csv'
     exp3_csv = experiment_dir / 'exp3_results.csv'
     exp4_csv = experiment_dir / 'exp4_results.csv'
@@ -185,16 +247,16 @@ def summarize_and_plot(experiment_dir: Path, out_dir: Path, save_formats=('png',
     overhead_csv = experiment_dir / 'overhead_summary.csv'
 
     if exp2_csv.exists():
-        summarize_and_plot_exp2(experiment_dir, out_dir, save_formats=save_formats)
+        summarize_and_plot_exp2(experiment_dir, out_dir, save_formats=save_formats, native=native)
         return
     if exp3_csv.exists():
-        summarize_and_plot_exp3(experiment_dir, out_dir, save_formats=save_formats)
+        summarize_and_plot_exp3(experiment_dir, out_dir, save_formats=save_formats, native=native)
         return
     if exp4_csv.exists():
-        summarize_and_plot_exp4(experiment_dir, out_dir, save_formats=save_formats)
+        summarize_and_plot_exp4(experiment_dir, out_dir, save_formats=save_formats, native=native)
         return
     if exp5_csv.exists():
-        summarize_and_plot_exp5(experiment_dir, out_dir, save_formats=save_formats)
+        summarize_and_plot_exp5(experiment_dir, out_dir, save_formats=save_formats, native=native)
         return
     if overhead_csv.exists():
         # fallback to original experiment 1 handling
@@ -210,8 +272,17 @@ def summarize_and_plot(experiment_dir: Path, out_dir: Path, save_formats=('png',
         if 'interval' in df.columns:
             df['interval'] = pd.to_numeric(df['interval'], errors='coerce')
 
+        # rm_workload throughput is valid even when /usr/bin/time produced nothing
+        thr_df = df.copy()
         df = df.dropna(subset=['elapsed_sec','percent_cpu'])
 
+        agg = read_native_agg(out_dir, 'aggregated_summary.csv', native)
+        latency_df = read_native_agg(out_dir, 'latency_per_run.csv', native)
+        if agg is not None and latency_df is not None:
+            plot_and_save(agg, df, latency_df, out_dir, formats=save_formats)
+            logging.info(f'Results saved to {out_dir}')
+            return
+
         # aggregated
         m = df.groupby(['interval','mode']).agg(
             runs=('run','count'),
@@ -252,6 +323,20 @@ def summarize_and_plot(experiment_dir: Path, out_dir: Path, save_formats=('png',
             agg['cpu_monitored'] = np.nan
             agg['cpu_overhead_pct'] = np.nan
 
+        # rm_workload throughput (optional column): overhead as throughput loss
+        if 'throughput' in thr_df.columns:
+            thr_df['throughput'] = pd.to_numeric(thr_df['throughput'], errors='coerce')
+            pivot_thr = thr_df.groupby(['interval', 'mode'])['throughput'].mean().unstack('mode')
+            pivot_thr = pivot_thr.reindex(pivot_elapsed.index)
+            if 'baseline' in pivot_thr.columns and 'monitored' in pivot_thr.columns:
+                agg['throughput_baseline'] = pivot_thr['baseline'].values
+                agg['throughput_monitored'] = pivot_thr['monitored'].values
+                agg['throughput_loss_pct'] = np.where(
+                    agg['throughput_baseline'] > 0,
+                    100.0 * (agg['throughput_baseline'] - agg['throughput_monitored']) / agg['throughput_baseline'],
+                    np.nan
+                )
+
         agg = agg.sort_values('interval')
 
         logging.info('Aggregated table:')
@@ -438,7 +523,7 @@ def start_flask_server(root_dir: Path, host: str = '127.0.0.1', port: int = 5000
     app.run(host=host, port=port, debug=False)
 
 
-def summarize_and_plot_exp2(experiment_dir: Path, out_dir: Path, save_formats=('png',)):
+def summarize_and_plot_exp2(experiment_dir: Path, out_dir: Path, save_formats=('png',), native=False):
     csvp = experiment_dir / 'experiment2_results.csv'
     logging.info(f"Loading Experiment 2 CSV: {csvp}")
     try:
@@ -484,8 +569,10 @@ def summarize_and_plot_exp2(experiment_dir: Path, out_dir: Path, save_formats=('
 
     # Mean times bar
     try:
-        agg = df.groupby('combo').time_us.agg(['mean','median','std','count']).reset_index()
-        agg.to_csv(out_dir / 'exp2_time_agg.csv', index=False)
+        agg = read_native_agg(out_dir, 'exp2_time_agg.csv', native)
+        if agg is None:
+            agg = df.groupby('combo').time_us.agg(['mean','median','std','count']).reset_index()
+            agg.to_csv(out_dir / 'exp2_time_agg.csv', index=False)
         fig, ax = plt.subplots()
         ax.bar(agg['combo'], agg['mean'])
         ax.set_xlabel('combo')
@@ -503,6 +590,10 @@ def summarize_and_plot_exp2(experiment_dir: Path, out_dir: Path, save_formats=('
     try:
         flags = ['isol_pid','isol_net','isol_mnt']
         heat = {}
+        native_heat = read_native_agg(out_dir, 'exp2_isolation_heat.csv', native)
+        if native_heat is not None:
+            heat = {c: native_heat.set_index('combo')[c] for c in flags if c in native_heat.columns}
+            flags = []
         truthy = set(['yes', 'true', '1', 'y', 't'])
         for c in flags:
             if c in df.columns:
@@ -524,7 +615,7 @@ def summarize_and_plot_exp2(experiment_dir: Path, out_dir: Path, save_formats=('
     logging.info(f'Experiment 2 results saved to {out_dir}')
 
 
-def summarize_and_plot_exp3(experiment_dir: Path, out_dir: Path, save_formats=('png',)):
+def summarize_and_plot_exp3(experiment_dir: Path, out_dir: Path, save_formats=('png',), native=False):
     csvp = experiment_dir / 'exp3_results.csv'
     logging.info(f"Loading Experiment 3 CSV: {csvp}")
     df = pd.read_csv(csvp)
@@ -535,14 +626,16 @@ def summarize_and_plot_exp3(experiment_dir: Path, out_dir: Path, save_formats=('
 
     ensure_out_dir(out_dir)
     try:
-        agg = df.groupby('limit_cores').agg(
-            trials=('trial','count'),
-            mean_measured_pct=('measured_cpu_pct','mean'),
-            std_measured_pct=('measured_cpu_pct','std'),
-            mean_throughput=('throughput_iters','mean')
-        ).reset_index()
-        # Save aggregate
-        agg.to_csv(out_dir / 'exp3_agg.csv', index=False)
+        agg = read_native_agg(out_dir, 'exp3_agg.csv', native)
+        if agg is None:
+            agg = df.groupby('limit_cores').agg(
+                trials=('trial','count'),
+                mean_measured_pct=('measured_cpu_pct','mean'),
+                std_measured_pct=('measured_cpu_pct','std'),
+                mean_throughput=('throughput_iters','mean')
+            ).reset_index()
+            # Save aggregate
+            agg.to_csv(out_dir / 'exp3_agg.csv', index=False)
 
         # measured vs configured
         fig, ax = plt.subplots()
@@ -573,7 +666,7 @@ def summarize_and_plot_exp3(experiment_dir: Path, out_dir: Path, save_formats=('
     logging.info(f'Experiment 3 results saved to {out_dir}')
 
 
-def summarize_and_plot_exp4(experiment_dir: Path, out_dir: Path, save_formats=('png',)):
+def summarize_and_plot_exp4(experiment_dir: Path, out_dir: Path, save_formats=('png',), native=False):
     csvp = experiment_dir / 'exp4_results.csv'
     logging.info(f"Loading Experiment 4 CSV: {csvp}")
     df = pd.read_csv(csvp)
@@ -621,14 +714,16 @@ def summarize_and_plot_exp4(experiment_dir: Path, out_dir: Path, save_formats=('
 
     ensure_out_dir(out_dir)
     try:
-        agg = df.groupby('limit_bytes').agg(
-            trials=('trial','count'),
-            mean_max_alloc=('max_alloc_bytes','mean'),
-            std_max_alloc=('max_alloc_bytes','std'),
-            total_failcnt=('failcnt','sum'),
-            total_oom=('oom_kills','sum')
-        ).reset_index()
-        agg.to_csv(out_dir / 'exp4_agg.csv', index=False)
+        agg = read_native_agg(out_dir, 'exp4_agg.csv', native)
+        if agg is None:
+            agg = df.groupby('limit_bytes').agg(
+                trials=('trial','count'),
+                mean_max_alloc=('max_alloc_bytes','mean'),
+                std_max_alloc=('max_alloc_bytes','std'),
+                total_failcnt=('failcnt','sum'),
+                total_oom=('oom_kills','sum')
+            ).reset_index()
+            agg.to_csv(out_dir / 'exp4_agg.csv', index=False)
 
         # plot max allocated (use categorical x positions for consistent spacing)
         fig, ax = plt.subplots()
@@ -668,7 +763,7 @@ def summarize_and_plot_exp4(experiment_dir: Path, out_dir: Path, save_formats=('
     logging.info(f'Experiment 4 results saved to {out_dir}')
 
 
-def summarize_and_plot_exp5(experiment_dir: Path, out_dir: Path, save_formats=('png',)):
+def summarize_and_plot_exp5(experiment_dir: Path, out_dir: Path, save_formats=('png',), native=False):
     csvp = experiment_dir / 'exp5_results.csv'
     logging.info(f"Loading Experiment 5 CSV: {csvp}")
     df = pd.read_csv(csvp)
@@ -679,13 +774,15 @@ def summarize_and_plot_exp5(experiment_dir: Path, out_dir: Path, save_formats=('
 
     ensure_out_dir(out_dir)
     try:
-        agg = df.groupby('limit_bps').agg(
-            trials=('trial','count'),
-            mean_measured_bps=('measured_bps','mean'),
-            std_measured_bps=('measured_bps','std'),
-            mean_latency_us=('avg_write_latency_us','mean')
-        ).reset_index()
-        agg.to_csv(out_dir / 'exp5_agg.csv', index=False)
+        agg = read_native_agg(out_dir, 'exp5_agg.csv', native)
+        if agg is None:
+            agg = df.groupby('limit_bps').agg(
+                trials=('trial','count'),
+                mean_measured_bps=('measured_bps','mean'),
+                std_measured_bps=('measured_bps','std'),
+                mean_latency_us=('avg_write_latency_us','mean')
+            ).reset_index()
+            agg.to_csv(out_dir / 'exp5_agg.csv', index=False)
 
         # measured vs config - plot against categorical x positions to avoid huge x spacing
         fig, ax = plt.subplots()
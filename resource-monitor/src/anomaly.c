@@ -0,0 +1,542 @@
+/*
+ * src/anomaly.c
+ *
+ * Motor de anomalias: registro de detectores, conversão de contadores em
+ * taxas, combinação dos escores (todos/qualquer) e os conjuntos de métricas
+ * de processo e de cgroup/PSI.
+ */
+
+#include "anomaly.h"
+#include "export.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <math.h>
+
+/*
+ * Desvio mínimo usado no denominador: evita escores infinitos em séries
+ * constantes (ex: 0 page faults/s) sem esconder saltos reais. Metade da
+ * unidade da métrica ou 2% do nível atual, o que for maior.
+ */
+#define ANOMALY_SD_FLOOR_ABS 0.5
+#define ANOMALY_SD_FLOOR_REL 0.02
+
+static inline double sd_floor(double sd, double center) {
+    double f = ANOMALY_SD_FLOOR_REL * fabs(center);
+    if (f < ANOMALY_SD_FLOOR_ABS) f = ANOMALY_SD_FLOOR_ABS;
+    return sd > f ? sd : f;
+}
+
+/* ===================== EWMA / EWMVAR ====================== */
+
+typedef struct {
+    double alpha;
+    double *mean;
+    double *var;
+    unsigned *n;
+} ewma_state_t;
+
+static void ewma_destroy(void *p) {
+    ewma_state_t *s = p;
+    if (!s) return;
+    free(s->mean);
+    free(s->var);
+    free(s->n);
+    free(s);
+}
+
+static void *ewma_create(size_t nseries, const anomaly_config_t *cfg) {
+    ewma_state_t *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    s->alpha = (cfg->ewma_alpha > 0.0 && cfg->ewma_alpha < 1.0) ? cfg->ewma_alpha : 0.1;
+    s->mean = calloc(nseries, sizeof(double));
+    s->var = calloc(nseries, sizeof(double));
+    s->n = calloc(nseries, sizeof(unsigned));
+    if (!s->mean || !s->var || !s->n) { ewma_destroy(s); return NULL; }
+    return s;
+}
+
+static void ewma_update(void *p, const double *restrict x, double ts, double *restrict z, size_t n) {
+    (void)ts;
+    ewma_state_t *s = p;
+    const double a = s->alpha;
+    double *restrict mean = s->mean;
+    double *restrict var = s->var;
+    unsigned *restrict cnt = s->n;
+
+    for (size_t i = 0; i < n; i++) {
+        double xi = x[i];
+        if (isnan(xi)) { z[i] = NAN; continue; }
+        if (cnt[i] == 0) {
+            mean[i] = xi;
+            var[i] = 0.0;
+            cnt[i] = 1;
+            z[i] = NAN;
+            continue;
+        }
+        double d = xi - mean[i];
+        z[i] = cnt[i] >= 2 ? d / sd_floor(sqrt(var[i]), mean[i]) : NAN;
+        mean[i] += a * d;
+        var[i] = (1.0 - a) * (var[i] + a * d * d);
+        cnt[i]++;
+    }
+}
+
+/* ===================== MEDIANA / MAD ====================== */
+
+typedef struct {
+    int window;
+    float *win;         // [nseries * window]
+    unsigned *n;        // amostras inseridas por série
+    float *tmp;         // [window] área de trabalho
+} mad_state_t;
+
+static void mad_destroy(void *p) {
+    mad_state_t *s = p;
+    if (!s) return;
+    free(s->win);
+    free(s->n);
+    free(s->tmp);
+    free(s);
+}
+
+static void *mad_create(size_t nseries, const anomaly_config_t *cfg) {
+    mad_state_t *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    s->window = cfg->mad_window >= 5 ? cfg->mad_window : 31;
+    s->win = calloc(nseries * (size_t)s->window, sizeof(float));
+    s->n = calloc(nseries, sizeof(unsigned));
+    s->tmp = calloc((size_t)s->window, sizeof(float));
+    if (!s->win || !s->n || !s->tmp) { mad_destroy(s); return NULL; }
+    return s;
+}
+
+/* k-ésimo menor elemento de a[0..n) (quickselect, reordena a) */
+static float select_kth(float *a, int n, int k) {
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        float pivot = a[(lo + hi) / 2];
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (a[i] < pivot) i++;
+            while (a[j] > pivot) j--;
+            if (i <= j) {
+                float t = a[i]; a[i] = a[j]; a[j] = t;
+                i++; j--;
+            }
+        }
+        if (k <= j) hi = j;
+        else if (k >= i) lo = i;
+        else break;
+    }
+    return a[k];
+}
+
+static void mad_update(void *p, const double *restrict x, double ts, double *restrict z, size_t n) {
+    (void)ts;
+    mad_state_t *s = p;
+    const int w = s->window;
+
+    for (size_t i = 0; i < n; i++) {
+        double xi = x[i];
+        if (isnan(xi)) { z[i] = NAN; continue; }
+        float *win = s->win + i * (size_t)w;
+        int filled = s->n[i] < (unsigned)w ? (int)s->n[i] : w;
+
+        if (filled >= 5) {
+            memcpy(s->tmp, win, (size_t)filled * sizeof(float));
+            float med = select_kth(s->tmp, filled, filled / 2);
+            for (int k = 0; k < filled; k++) s->tmp[k] = fabsf(win[k] - med);
+            float mad = select_kth(s->tmp, filled, filled / 2);
+            /* 1.4826 * MAD estima o desvio padrão para dados normais */
+            z[i] = (xi - med) / sd_floor(1.4826 * mad, med);
+        } else {
+            z[i] = NAN;
+        }
+        win[s->n[i] % (unsigned)w] = (float)xi;
+        s->n[i]++;
+    }
+}
+
+/* ===================== SAZONAL ====================== */
+
+typedef struct {
+    double alpha;
+    double slot_s;      // largura de cada faixa
+    int slots;
+    double *mean;       // [nseries * slots]
+    double *var;
+    unsigned *n;
+} seasonal_state_t;
+
+static void seasonal_destroy(void *p) {
+    seasonal_state_t *s = p;
+    if (!s) return;
+    free(s->mean);
+    free(s->var);
+    free(s->n);
+    free(s);
+}
+
+static void *seasonal_create(size_t nseries, const anomaly_config_t *cfg) {
+    seasonal_state_t *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    s->slots = cfg->seasonal_slots > 0 ? cfg->seasonal_slots : 24;
+    double period = cfg->seasonal_period_s > 0.0 ? cfg->seasonal_period_s : 86400.0;
+    s->slot_s = period / s->slots;
+    s->alpha = (cfg->seasonal_alpha > 0.0 && cfg->seasonal_alpha < 1.0) ? cfg->seasonal_alpha : 0.2;
+    size_t cells = nseries * (size_t)s->slots;
+    s->mean = calloc(cells, sizeof(double));
+    s->var = calloc(cells, sizeof(double));
+    s->n = calloc(cells, sizeof(unsigned));
+    if (!s->mean || !s->var || !s->n) { seasonal_destroy(s); return NULL; }
+    return s;
+}
+
+static void seasonal_update(void *p, const double *restrict x, double ts, double *restrict z, size_t n) {
+    seasonal_state_t *s = p;
+    /* todas as séries do tick caem na mesma faixa: percorre a coluna da faixa */
+    size_t slot = (size_t)fmod(floor(ts / s->slot_s), (double)s->slots);
+    const double a = s->alpha;
+
+    for (size_t i = 0; i < n; i++) {
+        double xi = x[i];
+        if (isnan(xi)) { z[i] = NAN; continue; }
+        size_t c = i * (size_t)s->slots + slot;
+        if (s->n[c] == 0) {
+            s->mean[c] = xi;
+            s->var[c] = 0.0;
+            s->n[c] = 1;
+            z[i] = NAN;
+            continue;
+        }
+        double d = xi - s->mean[c];
+        z[i] = s->n[c] >= 3 ? d / sd_floor(sqrt(s->var[c]), s->mean[c]) : NAN;
+        s->mean[c] += a * d;
+        s->var[c] = (1.0 - a) * (s->var[c] + a * d * d);
+        s->n[c]++;
+    }
+}
+
+/* ===================== Z-SCORE GLOBAL (WELFORD) ====================== */
+
+typedef struct {
+    double *mean;
+    double *m2;
+    unsigned long *n;
+} zscore_state_t;
+
+static void zscore_destroy(void *p) {
+    zscore_state_t *s = p;
+    if (!s) return;
+    free(s->mean);
+    free(s->m2);
+    free(s->n);
+    free(s);
+}
+
+static void *zscore_create(size_t nseries, const anomaly_config_t *cfg) {
+    (void)cfg;
+    zscore_state_t *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    s->mean = calloc(nseries, sizeof(double));
+    s->m2 = calloc(nseries, sizeof(double));
+    s->n = calloc(nseries, sizeof(unsigned long));
+    if (!s->mean || !s->m2 || !s->n) { zscore_destroy(s); return NULL; }
+    return s;
+}
+
+static void zscore_update(void *p, const double *restrict x, double ts, double *restrict z, size_t n) {
+    (void)ts;
+    zscore_state_t *s = p;
+    for (size_t i = 0; i < n; i++) {
+        double xi = x[i];
+        if (isnan(xi)) { z[i] = NAN; continue; }
+        if (s->n[i] >= 2) {
+            double sd = sqrt(s->m2[i] / (double)(s->n[i] - 1));
+            z[i] = sd > 0.0 ? (xi - s->mean[i]) / sd : 0.0;
+        } else {
+            z[i] = NAN;
+        }
+        s->n[i]++;
+        double d = xi - s->mean[i];
+        s->mean[i] += d / (double)s->n[i];
+        s->m2[i] += d * (xi - s->mean[i]);
+    }
+}
+
+/* ===================== REGISTRO ====================== */
+
+static const anomaly_detector_t k_detectors[] = {
+    { "ewma",     ewma_create,     ewma_update,     ewma_destroy },
+    { "mad",      mad_create,      mad_update,      mad_destroy },
+    { "seasonal", seasonal_create, seasonal_update, seasonal_destroy },
+    { "zscore",   zscore_create,   zscore_update,   zscore_destroy },
+};
+
+const anomaly_detector_t *anomaly_detector_find(const char *name) {
+    for (size_t i = 0; i < sizeof(k_detectors) / sizeof(k_detectors[0]); i++)
+        if (strcmp(k_detectors[i].name, name) == 0) return &k_detectors[i];
+    return NULL;
+}
+
+void anomaly_config_default(anomaly_config_t *cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->detectors = "ewma,mad";
+    cfg->threshold = 3.0;
+    cfg->vote_all = 1;
+    cfg->warmup = 10;
+    cfg->ewma_alpha = 0.1;
+    cfg->mad_window = 31;
+    cfg->seasonal_period_s = 86400.0;
+    cfg->seasonal_slots = 24;
+    cfg->seasonal_alpha = 0.2;
+}
+
+/* ===================== MOTOR ====================== */
+
+int anomaly_engine_init(anomaly_engine_t *e, size_t ntargets,
+                        const anomaly_metric_t *metrics, size_t nmetrics,
+                        const anomaly_config_t *cfg) {
+    memset(e, 0, sizeof(*e));
+    if (cfg) e->cfg = *cfg;
+    else anomaly_config_default(&e->cfg);
+    if (!e->cfg.detectors || !*e->cfg.detectors) e->cfg.detectors = "ewma,mad";
+
+    if (nmetrics > ANOMALY_MAX_METRICS) nmetrics = ANOMALY_MAX_METRICS;
+    memcpy(e->metrics, metrics, nmetrics * sizeof(anomaly_metric_t));
+    e->ntargets = ntargets;
+    e->nmetrics = nmetrics;
+    e->nseries = ntargets * nmetrics;
+
+    char list[128], *save = NULL;
+    snprintf(list, sizeof(list), "%s", e->cfg.detectors);
+    for (char *tok = strtok_r(list, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+        while (*tok == ' ') tok++;
+        const anomaly_detector_t *d = anomaly_detector_find(tok);
+        if (!d) {
+            fprintf(stderr, "Detector de anomalia desconhecido: %s (use ewma, mad, seasonal ou zscore)\n", tok);
+            anomaly_engine_free(e);
+            return -1;
+        }
+        if (e->ndetectors >= ANOMALY_MAX_DETECTORS) break;
+        e->det[e->ndetectors] = d;
+        e->state[e->ndetectors] = d->create(e->nseries, &e->cfg);
+        if (!e->state[e->ndetectors]) { anomaly_engine_free(e); return -1; }
+        e->ndetectors++;
+    }
+    if (e->ndetectors == 0) { anomaly_engine_free(e); return -1; }
+
+    e->raw = malloc(e->nseries * sizeof(double));
+    e->prev = malloc(e->nseries * sizeof(double));
+    e->x = malloc(e->nseries * sizeof(double));
+    e->z = malloc((size_t)e->ndetectors * e->nseries * sizeof(double));
+    e->seen = calloc(e->nseries, sizeof(unsigned));
+    if (!e->raw || !e->prev || !e->x || !e->z || !e->seen) {
+        anomaly_engine_free(e);
+        return -1;
+    }
+    for (size_t i = 0; i < e->nseries; i++) e->raw[i] = e->prev[i] = NAN;
+    return 0;
+}
+
+void anomaly_engine_free(anomaly_engine_t *e) {
+    for (int d = 0; d < e->ndetectors; d++)
+        if (e->state[d]) e->det[d]->destroy(e->state[d]);
+    free(e->raw);
+    free(e->prev);
+    free(e->x);
+    free(e->z);
+    free(e->seen);
+    e->raw = e->prev = e->x = e->z = NULL;
+    e->seen = NULL;
+    e->ndetectors = 0;
+}
+
+double *anomaly_engine_row(anomaly_engine_t *e, size_t target) {
+    return e->raw + target * e->nmetrics;
+}
+
+size_t anomaly_engine_tick(anomaly_engine_t *e, double ts, anomaly_event_fn fn, void *ctx) {
+    const size_t n = e->nseries;
+    const size_t nm = e->nmetrics;
+    double dt = e->has_prev ? ts - e->prev_ts : 0.0;
+
+    /* gauges passam direto; contadores viram taxa (NaN no primeiro tick ou após reset) */
+    for (size_t i = 0; i < n; i++) {
+        double r = e->raw[i];
+        if (e->metrics[i % nm].kind == ANOMALY_COUNTER) {
+            double p = e->prev[i];
+            e->x[i] = (dt > 0.0 && !isnan(p) && !isnan(r) && r >= p) ? (r - p) / dt : NAN;
+            e->prev[i] = r;
+        } else {
+            e->x[i] = r;
+        }
+    }
+    e->prev_ts = ts;
+    e->has_prev = 1;
+
+    for (int d = 0; d < e->ndetectors; d++)
+        e->det[d]->update(e->state[d], e->x, ts, e->z + (size_t)d * n, n);
+
+    const double thr = e->cfg.threshold;
+    size_t events = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (isnan(e->x[i])) continue;
+        if (++e->seen[i] <= e->cfg.warmup) continue;
+
+        int ready = 0, over = 0, sign = 0, agree = 1;
+        double best = 0.0;
+        for (int d = 0; d < e->ndetectors; d++) {
+            double zd = e->z[(size_t)d * n + i];
+            if (isnan(zd)) continue;
+            ready++;
+            if (fabs(zd) < thr) continue;
+            int sg = zd > 0 ? 1 : -1;
+            if (over && sg != sign) agree = 0;
+            sign = sg;
+            over++;
+            /* todos: reporta o escore mais fraco entre os que concordam; qualquer: o mais forte */
+            if (over == 1 || (e->cfg.vote_all ? fabs(zd) < fabs(best) : fabs(zd) > fabs(best)))
+                best = zd;
+        }
+        if (!ready || !over) continue;
+        if (e->cfg.vote_all && (over < ready || !agree)) continue;
+
+        events++;
+        if (!fn) continue;
+        anomaly_event_t ev;
+        ev.timestamp = ts;
+        ev.target = i / nm;
+        ev.metric = e->metrics[i % nm].name;
+        ev.value = e->x[i];
+        ev.z = best;
+        ev.detectors[0] = '\0';
+        size_t len = 0;
+        for (int d = 0; d < e->ndetectors; d++) {
+            double zd = e->z[(size_t)d * n + i];
+            if (isnan(zd) || fabs(zd) < thr) continue;
+            int w = snprintf(ev.detectors + len, sizeof(ev.detectors) - len, "%s%s",
+                             len ? "+" : "", e->det[d]->name);
+            if (w < 0 || (size_t)w >= sizeof(ev.detectors) - len) break;
+            len += (size_t)w;
+        }
+        fn(&ev, ctx);
+    }
+    return events;
+}
+
+double anomaly_engine_max_z(const anomaly_engine_t *e) {
+    const size_t n = e->nseries;
+    double top = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        if (isnan(e->x[i]) || e->seen[i] <= e->cfg.warmup) continue;
+        int ready = 0;
+        double s = 0.0;
+        for (int d = 0; d < e->ndetectors; d++) {
+            double zd = fabs(e->z[(size_t)d * n + i]);
+            if (isnan(zd)) continue;
+            if (!ready++ || (e->cfg.vote_all ? zd < s : zd > s)) s = zd;
+        }
+        if (ready && s > top) top = s;
+    }
+    return top;
+}
+
+/* ===================== CONJUNTOS DE MÉTRICAS ====================== */
+
+/* campos acumulados de proc_metrics_t */
+static const char *k_proc_counters[] = {
+    "voluntary_ctxt", "involuntary_ctxt", "minflt", "majflt",
+    "rchar", "wchar", "read_bytes", "write_bytes", "syscalls",
+};
+
+/* 1 se o campo entra no motor; *kind recebe o tipo */
+static int proc_field_kind(const metric_field_t *f, anomaly_metric_kind_t *kind) {
+    if (strcmp(f->name, "timestamp") == 0 || strcmp(f->name, "pid") == 0) return 0;
+    *kind = ANOMALY_GAUGE;
+    for (size_t i = 0; i < sizeof(k_proc_counters) / sizeof(k_proc_counters[0]); i++) {
+        if (strcmp(f->name, k_proc_counters[i]) != 0) continue;
+        char rate[ANOMALY_METRIC_NAME_MAX];
+        snprintf(rate, sizeof(rate), "%s_per_s", f->name);
+        if (metric_field_find(rate) >= 0) return 0;   // a taxa já é um campo
+        *kind = ANOMALY_COUNTER;
+        break;
+    }
+    return 1;
+}
+
+static void metric_set(anomaly_metric_t *m, const char *name, anomaly_metric_kind_t kind) {
+    snprintf(m->name, sizeof(m->name), "%s%s", name, kind == ANOMALY_COUNTER ? "_per_s" : "");
+    m->kind = kind;
+}
+
+size_t anomaly_proc_metrics(anomaly_metric_t *out, size_t max) {
+    size_t nf, n = 0;
+    const metric_field_t *fields = metric_fields(&nf);
+    for (size_t i = 0; i < nf && n < max; i++) {
+        anomaly_metric_kind_t kind;
+        if (!proc_field_kind(&fields[i], &kind)) continue;
+        metric_set(&out[n++], fields[i].name, kind);
+    }
+    return n;
+}
+
+void anomaly_fill_proc(double *row, const proc_metrics_t *m) {
+    size_t nf, n = 0;
+    const metric_field_t *fields = metric_fields(&nf);
+    for (size_t i = 0; i < nf && n < ANOMALY_MAX_METRICS; i++) {
+        anomaly_metric_kind_t kind;
+        if (!proc_field_kind(&fields[i], &kind)) continue;
+        row[n++] = metric_field_value(m, &fields[i]);
+    }
+}
+
+typedef struct {
+    const char *name;
+    anomaly_metric_kind_t kind;
+    int is_double;      // 1: double, 0: unsigned long long
+    size_t offset;      // offsetof(cgroup_metrics_t, ...)
+} cgroup_field_t;
+
+#define CG_U64(n, k, f) { n, k, 0, offsetof(cgroup_metrics_t, f) }
+#define CG_F64(n, f)    { n, ANOMALY_GAUGE, 1, offsetof(cgroup_metrics_t, f) }
+
+static const cgroup_field_t k_cgroup_fields[] = {
+    CG_U64("cg_cpu_usage_usec", ANOMALY_COUNTER, cpu.usage_usec),
+    CG_U64("cg_mem_current",    ANOMALY_GAUGE,   mem.current),
+    CG_U64("cg_mem_anon",       ANOMALY_GAUGE,   mem.anon),
+    CG_U64("cg_mem_file",       ANOMALY_GAUGE,   mem.file),
+    CG_U64("cg_pgfault",        ANOMALY_COUNTER, mem.pgfault),
+    CG_U64("cg_pgmajfault",     ANOMALY_COUNTER, mem.pgmajfault),
+    CG_U64("cg_io_rbytes",      ANOMALY_COUNTER, io.rbytes),
+    CG_U64("cg_io_wbytes",      ANOMALY_COUNTER, io.wbytes),
+    CG_U64("cg_io_rios",        ANOMALY_COUNTER, io.rios),
+    CG_U64("cg_io_wios",        ANOMALY_COUNTER, io.wios),
+    CG_F64("psi_cpu_some",      psi.cpu.some_avg10),
+    CG_F64("psi_mem_some",      psi.mem.some_avg10),
+    CG_F64("psi_mem_full",      psi.mem.full_avg10),
+    CG_F64("psi_io_some",       psi.io.some_avg10),
+    CG_F64("psi_io_full",       psi.io.full_avg10),
+};
+
+#define CG_FIELD_COUNT (sizeof(k_cgroup_fields) / sizeof(k_cgroup_fields[0]))
+
+size_t anomaly_cgroup_metrics(anomaly_metric_t *out, size_t max) {
+    size_t n = 0;
+    for (size_t i = 0; i < CG_FIELD_COUNT && n < max; i++)
+        metric_set(&out[n++], k_cgroup_fields[i].name, k_cgroup_fields[i].kind);
+    return n;
+}
+
+void anomaly_fill_cgroup(double *row, const cgroup_metrics_t *cg) {
+    const char *base = (const char *)cg;
+    for (size_t i = 0; i < CG_FIELD_COUNT; i++) {
+        const cgroup_field_t *f = &k_cgroup_fields[i];
+        if (f->is_double)
+            row[i] = *(const double *)(base + f->offset);
+        else
+            row[i] = (double)*(const unsigned long long *)(base + f->offset);
+    }
+}
@@ -0,0 +1,148 @@
+/*
+ * src/blockindex.c
+ *
+ * Índice esparso (<arquivo>.idx) com limites de tempo e min/max por coluna
+ * para cada bloco de BLOCK_INDEX_ROWS linhas.
+ */
+
+#include "blockindex.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/stat.h>
+
+void block_index_path(const char *data_filename, char *out, size_t out_size) {
+    snprintf(out, out_size, "%s.idx", data_filename);
+}
+
+static void block_reset(block_index_writer_t *w) {
+    memset(&w->cur, 0, sizeof(w->cur));
+    for (size_t f = 0; f < w->nfields; f++) {
+        w->cur_min[f] = w->present[f] ? INFINITY : NAN;
+        w->cur_max[f] = w->present[f] ? -INFINITY : NAN;
+    }
+}
+
+int block_index_open(block_index_writer_t *w, const char *data_filename,
+                     const unsigned char *present) {
+    memset(w, 0, sizeof(*w));
+    metric_fields(&w->nfields);
+    if (w->nfields > METRIC_FIELD_MAX) w->nfields = METRIC_FIELD_MAX;
+    for (size_t f = 0; f < w->nfields; f++) w->present[f] = present ? present[f] : 1;
+
+    char path[512];
+    block_index_path(data_filename, path, sizeof(path));
+    w->fp = fopen(path, "wb");
+    if (!w->fp) return -1;
+
+    /* cabeçalho provisório; nblocks e data_size são gravados no close */
+    block_index_header_t h;
+    memset(&h, 0, sizeof(h));
+    if (fwrite(&h, sizeof(h), 1, w->fp) != 1) {
+        fclose(w->fp);
+        w->fp = NULL;
+        return -1;
+    }
+    block_reset(w);
+    return 0;
+}
+
+static void block_flush(block_index_writer_t *w) {
+    if (!w->fp || w->cur.rows == 0) return;
+    fwrite(&w->cur, sizeof(w->cur), 1, w->fp);
+    fwrite(w->cur_min, sizeof(double), w->nfields, w->fp);
+    fwrite(w->cur_max, sizeof(double), w->nfields, w->fp);
+    w->nblocks++;
+    block_reset(w);
+}
+
+void block_index_add(block_index_writer_t *w, const proc_metrics_t *m, uint64_t offset) {
+    if (!w->fp) return;
+    const metric_field_t *fields = metric_fields(NULL);
+
+    if (w->cur.rows == 0) {
+        w->cur.offset = offset;
+        w->cur.ts_first = m->timestamp;
+    }
+    w->cur.ts_last = m->timestamp;
+    for (size_t f = 0; f < w->nfields; f++) {
+        if (!w->present[f]) continue;
+        double v = metric_field_value(m, &fields[f]);
+        if (v < w->cur_min[f]) w->cur_min[f] = v;
+        if (v > w->cur_max[f]) w->cur_max[f] = v;
+    }
+    if (++w->cur.rows == BLOCK_INDEX_ROWS) block_flush(w);
+}
+
+int block_index_close(block_index_writer_t *w, uint64_t data_size) {
+    if (!w->fp) return -1;
+    block_flush(w);
+
+    block_index_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, BLOCK_INDEX_MAGIC, 4);
+    h.version = BLOCK_INDEX_VERSION;
+    h.nfields = (uint32_t)w->nfields;
+    h.block_rows = BLOCK_INDEX_ROWS;
+    h.nblocks = w->nblocks;
+    h.data_size = data_size;
+
+    int rc = 0;
+    if (fseek(w->fp, 0, SEEK_SET) != 0 || fwrite(&h, sizeof(h), 1, w->fp) != 1) rc = -1;
+    if (ferror(w->fp)) rc = -1;
+    if (fclose(w->fp) != 0) rc = -1;
+    w->fp = NULL;
+    return rc;
+}
+
+int block_index_load(const char *data_filename, block_index_t *idx) {
+    memset(idx, 0, sizeof(*idx));
+
+    struct stat st;
+    if (stat(data_filename, &st) != 0) return -1;
+
+    char path[512];
+    block_index_path(data_filename, path, sizeof(path));
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+
+    size_t nf;
+    metric_fields(&nf);
+    block_index_header_t *h = &idx->h;
+    if (fread(h, sizeof(*h), 1, f) != 1 || memcmp(h->magic, BLOCK_INDEX_MAGIC, 4) != 0 ||
+        h->version != BLOCK_INDEX_VERSION || h->nfields != nf ||
+        h->data_size != (uint64_t)st.st_size) {
+        /* ausente, de outra versão da tabela de campos, ou os dados mudaram */
+        fclose(f);
+        return -1;
+    }
+
+    size_t nb = (size_t)h->nblocks;
+    idx->blocks = calloc(nb ? nb : 1, sizeof(block_index_block_t));
+    idx->minmax = malloc((nb ? nb : 1) * 2 * nf * sizeof(double));
+    if (!idx->blocks || !idx->minmax) {
+        fclose(f);
+        block_index_free(idx);
+        return -1;
+    }
+    for (size_t b = 0; b < nb; b++) {
+        block_index_block_t *blk = &idx->blocks[b];
+        blk->min = idx->minmax + b * 2 * nf;
+        blk->max = blk->min + nf;
+        if (fread(&blk->e, sizeof(blk->e), 1, f) != 1 ||
+            fread(blk->min, sizeof(double), nf, f) != nf ||
+            fread(blk->max, sizeof(double), nf, f) != nf) {
+            fclose(f);
+            block_index_free(idx);
+            return -1;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+void block_index_free(block_index_t *idx) {
+    free(idx->blocks);
+    free(idx->minmax);
+    memset(idx, 0, sizeof(*idx));
+}
@@ -1,4 +1,5 @@
 #include "cgroup.h"
+#include "monitor.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -12,8 +13,9 @@
 #define CGROUP_V2_BASE "/sys/fs/cgroup"
 #define MONITOR_BASE_DIR "resource_monitor"
 
-// Buffer global para construir caminhos
-static char g_cgroup_base_path[256];
+// Raiz do cgroupfs (--cgroup-root) e buffer global para construir caminhos
+static char g_cgroup_root[256] = CGROUP_V2_BASE;
+static char g_cgroup_base_path[300];
 static int g_base_path_initialized = 0;
 static int g_is_cgroup_v2 = -1; /* -1 = unknown, 0 = v1, 1 = v2 */
 
@@ -26,10 +28,12 @@ static int g_is_cgroup_v2 = -1; /* -1 = unknown, 0 = v1, 1 = v2 */
 static const char* get_monitor_base_path() {
     if (!g_base_path_initialized) {
         snprintf(g_cgroup_base_path, sizeof(g_cgroup_base_path), "%s/%s",
-                 CGROUP_V2_BASE, MONITOR_BASE_DIR);
+                 g_cgroup_root, MONITOR_BASE_DIR);
         g_base_path_initialized = 1;
         /* Detect cgroup v2 by presence of cgroup.controllers file */
-        if (access("/sys/fs/cgroup/cgroup.controllers", F_OK) == 0) {
+        char controllers[300];
+        snprintf(controllers, sizeof(controllers), "%s/cgroup.controllers", g_cgroup_root);
+        if (access(controllers, F_OK) == 0) {
             g_is_cgroup_v2 = 1;
         } else {
             g_is_cgroup_v2 = 0;
@@ -87,18 +91,11 @@ static int parse_stat_file(const char* path, const char* keys[], unsigned long l
 
     while (fgets(line, sizeof(line), f)) {
         // io.stat usa "=", cpu.stat e memory.stat usam espaço
-        if (sscanf(line, "%127s %llu", key_buf, &val_buf) == 2 || 
-            sscanf(line, "%127[^=]=%llu", key_buf, &val_buf) == 2) 
-        {
-            for (int i = 0; i < count; i++) {
-                if (strcmp(key_buf, keys[i]) == 0) {
-                    *(targets[i]) = val_buf;
-                    break;
-                }
-            }
-        } else if (strstr(line, "rbytes=") || strstr(line, "wbytes=")) {
+        if (strstr(line, "rbytes=") || strstr(line, "wbytes=")) {
             // Caso especial para io.stat (agregação de múltiplos discos)
             // Ex: 8:0 rbytes=123 wbytes=456 ...
+            // Testado antes do caso genérico, que casaria "8:0 rbytes" como chave
+            // e descartaria a linha inteira.
             char *p = line;
             while ((p = strstr(p, "rbytes="))) {
                 if (sscanf(p, "rbytes=%llu", &val_buf) == 1) *(targets[0]) += val_buf; // rbytes
@@ -119,6 +116,15 @@ static int parse_stat_file(const char* path, const char* keys[], unsigned long l
                 if (sscanf(p, "wios=%llu", &val_buf) == 1) *(targets[3]) += val_buf; // wios
                 p++;
             }
+        } else if (sscanf(line, "%127s %llu", key_buf, &val_buf) == 2 ||
+                   sscanf(line, "%127[^=]=%llu", key_buf, &val_buf) == 2)
+        {
+            for (int i = 0; i < count; i++) {
+                if (strcmp(key_buf, keys[i]) == 0) {
+                    *(targets[i]) = val_buf;
+                    break;
+                }
+            }
         }
     }
 
@@ -129,6 +135,13 @@ static int parse_stat_file(const char* path, const char* keys[], unsigned long l
 
 // --- Implementação das Funções Públicas (cgroup.h) ---
 
+void cgroup_set_root(const char* root) {
+    snprintf(g_cgroup_root, sizeof(g_cgroup_root), "%s", root && *root ? root : CGROUP_V2_BASE);
+    size_t n = strlen(g_cgroup_root);
+    while (n > 1 && g_cgroup_root[n - 1] == '/') g_cgroup_root[--n] = '\0';
+    g_base_path_initialized = 0;
+}
+
 const char* cgroup_get_base_path(void) {
     return get_monitor_base_path();
 }
@@ -232,6 +245,21 @@ int cgroup_set_memory_limit(const char* relative_path, long limit_bytes) {
     return 0;
 }
 
+int cgroup_set_memory_high(const char* relative_path, long limit_bytes) {
+    char path[512];
+    char value[64];
+    build_full_path(path, sizeof(path), relative_path);
+    snprintf(value, sizeof(value), "%ld", limit_bytes);
+
+    if (write_cgroup_file(path, "memory.high", value) != 0) {
+        fprintf(stderr, "Falha ao definir memory.high para '%s'\n", relative_path);
+        return -1;
+    }
+
+    printf("memory.high para '%s' definido como %ld bytes\n", relative_path, limit_bytes);
+    return 0;
+}
+
 int cgroup_read_metrics(const char* relative_path, cgroup_metrics_t* metrics) {
     char cgroup_path[512];
     char stat_path[512];
@@ -299,9 +327,78 @@ int cgroup_read_metrics(const char* relative_path, cgroup_metrics_t* metrics) {
     unsigned long long* io_targets[] = {&metrics->io.rbytes, &metrics->io.wbytes, &metrics->io.rios, &metrics->io.wios};
     parse_stat_file(stat_path, io_keys, io_targets, 4);
 
+    // 4. Pressure (cpu.pressure, memory.pressure, io.pressure) - opcional (CONFIG_PSI)
+    const char* psi_files[] = {"cpu.pressure", "memory.pressure", "io.pressure"};
+    cgroup_psi_resource_t* psi_targets[] = {&metrics->psi.cpu, &metrics->psi.mem, &metrics->psi.io};
+    for (int i = 0; i < 3; i++) {
+        int n = snprintf(stat_path, sizeof(stat_path), "%s/%s", cgroup_path, psi_files[i]);
+        if (n < 0 || (size_t)n >= sizeof(stat_path)) continue;
+        cgroup_read_psi_file(stat_path, psi_targets[i]);
+    }
+
+    return 0;
+}
+
+int cgroup_read_memory_max(const char* relative_path, unsigned long long* limit_bytes) {
+    char cgroup_path[512];
+    char file_path[512];
+    build_full_path(cgroup_path, sizeof(cgroup_path), relative_path);
+    int n = snprintf(file_path, sizeof(file_path), "%s/memory.max", cgroup_path);
+    if (n < 0 || (size_t)n >= sizeof(file_path)) return -1;
+
+    FILE* f = fopen(file_path, "r");
+    if (!f) return -1;
+    char buf[64];
+    int ret = -1;
+    if (fgets(buf, sizeof(buf), f)) {
+        if (strncmp(buf, "max", 3) == 0) {
+            *limit_bytes = 0;
+            ret = 0;
+        } else if (sscanf(buf, "%llu", limit_bytes) == 1) {
+            ret = 0;
+        }
+    }
+    fclose(f);
+    return ret;
+}
+
+int cgroup_read_psi_file(const char* path, cgroup_psi_resource_t* psi) {
+    FILE* f = fopen(path, "r");
+    if (!f) return -1;
+
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        char kind[8];
+        double avg10 = 0.0, avg60 = 0.0, avg300 = 0.0;
+        unsigned long long total = 0;
+        if (sscanf(line, "%7s avg10=%lf avg60=%lf avg300=%lf total=%llu",
+                   kind, &avg10, &avg60, &avg300, &total) != 5)
+            continue;
+        if (strcmp(kind, "some") == 0) {
+            psi->some_avg10 = avg10;
+            psi->some_total = total;
+        } else if (strcmp(kind, "full") == 0) {
+            psi->full_avg10 = avg10;
+            psi->full_total = total;
+        }
+    }
+    fclose(f);
     return 0;
 }
 
+int cgroup_read_system_pressure(cgroup_psi_metrics_t* psi) {
+    memset(psi, 0, sizeof(*psi));
+    int ok = 0;
+    char path[300];
+    snprintf(path, sizeof(path), "%s/pressure/cpu", monitor_proc_root());
+    if (cgroup_read_psi_file(path, &psi->cpu) == 0) ok = 1;
+    snprintf(path, sizeof(path), "%s/pressure/memory", monitor_proc_root());
+    if (cgroup_read_psi_file(path, &psi->mem) == 0) ok = 1;
+    snprintf(path, sizeof(path), "%s/pressure/io", monitor_proc_root());
+    if (cgroup_read_psi_file(path, &psi->io) == 0) ok = 1;
+    return ok ? 0 : -1;
+}
+
 int cgroup_generate_report(const char* relative_path) {
     cgroup_metrics_t metrics;
     if (cgroup_read_metrics(relative_path, &metrics) != 0) {
@@ -328,6 +425,11 @@ int cgroup_generate_report(const char* relative_path) {
     printf("  IOPS Leitura: %llu\n", metrics.io.rios);
     printf("  IOPS Escrita: %llu\n", metrics.io.wios);
 
+    printf("\n[Pressure (some/full avg10 %%)]\n");
+    printf("  CPU:     %.2f / %.2f\n", metrics.psi.cpu.some_avg10, metrics.psi.cpu.full_avg10);
+    printf("  Memória: %.2f / %.2f\n", metrics.psi.mem.some_avg10, metrics.psi.mem.full_avg10);
+    printf("  I/O:     %.2f / %.2f\n", metrics.psi.io.some_avg10, metrics.psi.io.full_avg10);
+
     printf("===================================================\n");
     return 0;
 }
\ No newline at end of file
@@ -3,25 +3,44 @@
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
 #include "monitor.h"
 
 static unsigned long long last_total_jiffies = 0;
 static unsigned long long last_process_jiffies = 0;
+static int g_verbose = 1;
+
+#ifndef PROC_PATH_PREFIX
+#define PROC_PATH_PREFIX "/proc"
+#endif
+static char g_proc_root[256] = PROC_PATH_PREFIX;
+
+void monitor_set_verbose(int on) { g_verbose = on; }
+int monitor_is_verbose(void) { return g_verbose; }
+
+void monitor_set_proc_root(const char *root) {
+    snprintf(g_proc_root, sizeof(g_proc_root), "%s", root && *root ? root : PROC_PATH_PREFIX);
+    size_t n = strlen(g_proc_root);
+    while (n > 1 && g_proc_root[n - 1] == '/') g_proc_root[--n] = '\0';
+}
+
+const char *monitor_proc_root(void) { return g_proc_root; }
 
 /**
  * Lê e calcula o uso de CPU (%), tempo de usuário/sistema,
  * número de threads e trocas de contexto do processo.
  */
 int monitor_cpu_usage(pid_t pid, double *cpu_percent) {
-    char path[64];
-    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    char path[300];
+    snprintf(path, sizeof(path), "%s/%d/stat", g_proc_root, pid);
 
     FILE *fp = fopen(path, "r");
     if (!fp) {
         if (errno == ENOENT)
             fprintf(stderr, "⚠️  Processo %d não encontrado (terminou?)\n", pid);
         else if (errno == EACCES)
-            fprintf(stderr, "🔒 Sem permissão para ler /proc/%d/stat\n", pid);
+            fprintf(stderr, "🔒 Sem permissão para ler %s\n", path);
         *cpu_percent = 0.0;
         return -1;
     }
@@ -41,7 +60,7 @@ int monitor_cpu_usage(pid_t pid, double *cpu_percent) {
         *cpu_percent = 0.0;
         return -1;
     }
-    for (int i = 0; i < 11; i++) {
+    for (int i = 0; i < 10; i++) {   // ppid .. cmajflt (campos 4-13)
         if (fscanf(fp, "%511s", buffer) != 1) { fclose(fp); *cpu_percent = 0.0; return -1; }
     }
     if (fscanf(fp, "%lu %lu", &utime, &stime) != 2) { fclose(fp); *cpu_percent = 0.0; return -1; }
@@ -52,7 +71,8 @@ int monitor_cpu_usage(pid_t pid, double *cpu_percent) {
     // -------------------------------------------------------------
     // Lê tempo total de CPU do sistema
     // -------------------------------------------------------------
-    fp = fopen("/proc/stat", "r");
+    snprintf(path, sizeof(path), "%s/stat", g_proc_root);
+    fp = fopen(path, "r");
     if (!fp) {
         perror("Erro ao ler /proc/stat");
         *cpu_percent = 0.0;
@@ -75,7 +95,8 @@ int monitor_cpu_usage(pid_t pid, double *cpu_percent) {
     // -------------------------------------------------------------
     // Calcula % de uso de CPU (média desde a última medição)
     // -------------------------------------------------------------
-    if (last_total_jiffies != 0 && last_process_jiffies != 0) {
+    // só o total do sistema marca "já medido": um processo recém-criado tem 0 jiffies
+    if (last_total_jiffies != 0) {
         unsigned long long total_diff = total_jiffies - last_total_jiffies;
         unsigned long long proc_diff = process_jiffies - last_process_jiffies;
         *cpu_percent = 100.0 * ((double)proc_diff / (double)total_diff);
@@ -89,11 +110,11 @@ int monitor_cpu_usage(pid_t pid, double *cpu_percent) {
     // -------------------------------------------------------------
     // Métricas adicionais: context switches e threads
     // -------------------------------------------------------------
-    snprintf(path, sizeof(path), "/proc/%d/status", pid);
+    snprintf(path, sizeof(path), "%s/%d/status", g_proc_root, pid);
     fp = fopen(path, "r");
     if (!fp) {
         if (errno == EACCES)
-            fprintf(stderr, "🔒 Sem permissão para ler /proc/%d/status\n", pid);
+            fprintf(stderr, "🔒 Sem permissão para ler %s\n", path);
         return 0; // já temos CPU%; continuar sem extras
     }
 
@@ -115,10 +136,107 @@ int monitor_cpu_usage(pid_t pid, double *cpu_percent) {
     double user_time_sec = utime / hz;
     double sys_time_sec = stime / hz;
 
-    printf("[CPU] %.2f%% | user=%.2fs | sys=%.2fs | threads=%d | ctxt(v/nv)=%lu/%lu\n",
+    if (g_verbose)
+        printf("[CPU] %.2f%% | user=%.2fs | sys=%.2fs | threads=%d | ctxt(v/nv)=%lu/%lu\n",
            *cpu_percent, user_time_sec, sys_time_sec,
            threads, voluntary_ctxt, nonvoluntary_ctxt);
 
     return 0;
 }
 
+
+/* ===================== SCHEDSTAT ====================== */
+
+static int read_schedstat(const char *path, sched_task_t *t) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    char buf[128];
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) return -1;
+    buf[n] = '\0';
+    return sscanf(buf, "%llu %llu %llu", &t->run_ns, &t->wait_ns, &t->slices) == 3 ? 0 : -1;
+}
+
+static int cmp_tid(const void *a, const void *b) {
+    pid_t x = ((const sched_task_t *)a)->tid, y = ((const sched_task_t *)b)->tid;
+    return x < y ? -1 : x > y;
+}
+
+static int sched_push(schedstat_state_t *st, size_t n, const sched_task_t *t) {
+    if (n == st->cap) {
+        size_t cap = st->cap ? st->cap * 2 : 64;
+        sched_task_t *p = realloc(st->prev, cap * sizeof(*p));
+        if (!p) return -1;
+        st->prev = p;
+        sched_task_t *c = realloc(st->cur, cap * sizeof(*c));
+        if (!c) return -1;
+        st->cur = c;
+        st->cap = cap;
+    }
+    st->cur[n] = *t;
+    return 0;
+}
+
+int monitor_schedstat(pid_t pid, schedstat_state_t *st, double *run_ms, double *wait_ms,
+                      unsigned long long *slices) {
+    *run_ms = *wait_ms = 0.0;
+    *slices = 0;
+
+    /* /proc/<pid>/schedstat é só da thread principal: soma task/<tid> */
+    char path[320];
+    snprintf(path, sizeof(path), "%s/%d/task", g_proc_root, pid);
+    DIR *d = opendir(path);
+    if (!d) return -1;
+    size_t n = 0;
+    struct dirent *e;
+    while ((e = readdir(d))) {
+        sched_task_t t;
+        t.tid = (pid_t)atoi(e->d_name);
+        if (t.tid <= 0) continue;
+        snprintf(path, sizeof(path), "%s/%d/task/%d/schedstat", g_proc_root, pid, t.tid);
+        if (read_schedstat(path, &t) != 0) continue;    // thread saiu entre readdir e open
+        if (sched_push(st, n, &t) != 0) {
+            closedir(d);
+            return -1;
+        }
+        n++;
+    }
+    closedir(d);
+    if (n == 0) return -1;
+    qsort(st->cur, n, sizeof(sched_task_t), cmp_tid);
+
+    if (st->primed) {
+        unsigned long long run = 0, wait = 0, sl = 0;
+        for (size_t i = 0; i < n; i++) {
+            const sched_task_t *c = &st->cur[i];
+            const sched_task_t *p = bsearch(c, st->prev, st->nprev, sizeof(sched_task_t), cmp_tid);
+            /* TID reutilizado volta a contar do zero */
+            if (p && c->run_ns >= p->run_ns && c->wait_ns >= p->wait_ns && c->slices >= p->slices) {
+                run += c->run_ns - p->run_ns;
+                wait += c->wait_ns - p->wait_ns;
+                sl += c->slices - p->slices;
+            } else {
+                run += c->run_ns;
+                wait += c->wait_ns;
+                sl += c->slices;
+            }
+        }
+        *run_ms = (double)run / 1e6;
+        *wait_ms = (double)wait / 1e6;
+        *slices = sl;
+    }
+
+    sched_task_t *tmp = st->prev;
+    st->prev = st->cur;
+    st->cur = tmp;
+    st->nprev = n;
+    st->primed = 1;
+    return 0;
+}
+
+void monitor_schedstat_free(schedstat_state_t *st) {
+    free(st->prev);
+    free(st->cur);
+    memset(st, 0, sizeof(*st));
+}
@@ -0,0 +1,694 @@
+/*
+ * src/export.c
+ *
+ * Exportadores CSV/JSON de proc_metrics_t.
+ *
+ * As colunas são descritas por uma tabela (nome, cabeçalho, tipo, offset),
+ * o que permite projetar apenas os campos pedidos em --fields. O CSV é
+ * montado num buffer próprio com formatação manual de inteiros e ponto
+ * fixo, e escrito em blocos grandes com fwrite.
+ */
+
+#include "export.h"
+#include "blockindex.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <math.h>
+#include <json-c/json.h>
+
+#define CSV_BUF_SIZE (64 * 1024)
+#define CSV_MAX_CELL 64  /* maior célula formatada por csv_put_* numérico */
+
+#define F(name, hdr, kind, dec) { #name, hdr, kind, offsetof(proc_metrics_t, name), dec }
+
+static const metric_field_t g_fields[] = {
+    F(timestamp,         "Timestamp",    FIELD_F64,    0),
+    F(pid,               "PID",          FIELD_PID,    0),
+    F(cpu_percent,       "CPU%",         FIELD_F64,    2),
+    F(threads,           "Threads",      FIELD_ULONG,  0),
+    F(voluntary_ctxt,    "VolCtx",       FIELD_ULONG,  0),
+    F(involuntary_ctxt,  "InvCtx",       FIELD_ULONG,  0),
+    F(rss_kb,            "RSS(kB)",      FIELD_ULONG,  0),
+    F(vmsize_kb,         "VSZ(kB)",      FIELD_ULONG,  0),
+    F(minflt,            "MinFlt",       FIELD_ULONG,  0),
+    F(majflt,            "MajFlt",       FIELD_ULONG,  0),
+    F(swap_kb,           "Swap(kB)",     FIELD_ULONG,  0),
+    F(rchar,             "RChar",        FIELD_ULLONG, 0),
+    F(wchar,             "WChar",        FIELD_ULLONG, 0),
+    F(read_bytes,        "ReadBytes",    FIELD_ULLONG, 0),
+    F(write_bytes,       "WriteBytes",   FIELD_ULLONG, 0),
+    F(syscalls,          "Syscalls",     FIELD_ULLONG, 0),
+    F(rchar_per_s,       "RChar/s",      FIELD_F64,    2),
+    F(wchar_per_s,       "WChar/s",      FIELD_F64,    2),
+    F(read_bytes_per_s,  "ReadBytes/s",  FIELD_F64,    2),
+    F(write_bytes_per_s, "WriteBytes/s", FIELD_F64,    2),
+    F(syscalls_per_s,    "Syscalls/s",   FIELD_F64,    2),
+    F(task_clock_ms_per_s, "TaskClock(ms/s)", FIELD_F64, 3),
+    F(ctx_switches_per_s, "CtxSw/s",     FIELD_F64,    2),
+    F(cpu_migrations_per_s, "Migrations/s", FIELD_F64, 2),
+    F(page_faults_per_s, "PageFaults/s", FIELD_F64,    2),
+    F(cycles_per_s,      "Cycles/s",     FIELD_F64,    0),
+    F(instructions_per_s, "Instructions/s", FIELD_F64, 0),
+    F(cache_misses_per_s, "CacheMisses/s", FIELD_F64,  2),
+    F(ipc,               "IPC",          FIELD_F64,    3),
+    F(cpu_run_ms_per_s,  "CpuRun(ms/s)", FIELD_F64,    2),
+    F(cpu_wait_ms_per_s, "CpuWait(ms/s)", FIELD_F64,   2),
+    F(wait_per_slice_us, "WaitPerSlice(us)", FIELD_F64, 2),
+    F(net_rx_bytes_per_s, "NetRx(B/s)",  FIELD_F64,    2),
+    F(net_tx_bytes_per_s, "NetTx(B/s)",  FIELD_F64,    2),
+    F(net_rx_packets_per_s, "NetRxPkts/s", FIELD_F64,  2),
+    F(net_tx_packets_per_s, "NetTxPkts/s", FIELD_F64,  2),
+    F(net_drops_per_s,   "NetDrops/s",   FIELD_F64,    2),
+    F(tcp_retrans_per_s, "TcpRetrans/s", FIELD_F64,    2),
+    F(fd_count,          "Fds",          FIELD_ULONG,  0),
+    F(fd_files,          "FdFiles",      FIELD_ULONG,  0),
+    F(fd_sockets,        "FdSockets",    FIELD_ULONG,  0),
+    F(fd_pipes,          "FdPipes",      FIELD_ULONG,  0),
+    F(fd_eventfds,       "FdEventfds",   FIELD_ULONG,  0),
+    F(fd_anon,           "FdAnon",       FIELD_ULONG,  0),
+    F(fd_limit,          "FdLimit",      FIELD_ULONG,  0),
+    F(fd_growth_per_s,   "FdGrowth/s",   FIELD_F64,    2),
+    F(tcp_established,   "TcpEstab",     FIELD_ULONG,  0),
+    F(tcp_listen,        "TcpListen",    FIELD_ULONG,  0),
+    F(tcp_close_wait,    "TcpCloseWait", FIELD_ULONG,  0),
+    F(tcp_other,         "TcpOther",     FIELD_ULONG,  0),
+};
+
+#undef F
+
+#define N_FIELDS (sizeof(g_fields) / sizeof(g_fields[0]))
+
+/* índices fixos das colunas-chave */
+#define FIELD_IDX_TIMESTAMP 0
+#define FIELD_IDX_PID       1
+
+static field_selection_t g_selection;
+static int g_selection_initialized = 0;
+static export_suppression_t g_suppression = {0, 0.0, 0.0, 1.0};
+
+/* ===================== TABELA DE CAMPOS ====================== */
+
+const metric_field_t *metric_fields(size_t *count) {
+    if (count) *count = N_FIELDS;
+    return g_fields;
+}
+
+int metric_field_find(const char *name) {
+    for (size_t i = 0; i < N_FIELDS; i++) {
+        if (strcmp(g_fields[i].name, name) == 0) return (int)i;
+    }
+    return -1;
+}
+
+double metric_field_value(const proc_metrics_t *m, const metric_field_t *f) {
+    const char *base = (const char *)m + f->offset;
+    switch (f->kind) {
+        case FIELD_F64:    return *(const double *)base;
+        case FIELD_PID:    return (double)*(const pid_t *)base;
+        case FIELD_ULONG:  return (double)*(const unsigned long *)base;
+        case FIELD_ULLONG: return (double)*(const unsigned long long *)base;
+    }
+    return 0.0;
+}
+
+void metric_field_set(proc_metrics_t *m, const metric_field_t *f, double v) {
+    char *base = (char *)m + f->offset;
+    switch (f->kind) {
+        case FIELD_F64:    *(double *)base = v; break;
+        case FIELD_PID:    *(pid_t *)base = (pid_t)v; break;
+        case FIELD_ULONG:  *(unsigned long *)base = v > 0.0 ? (unsigned long)v : 0; break;
+        case FIELD_ULLONG: *(unsigned long long *)base = v > 0.0 ? (unsigned long long)v : 0; break;
+    }
+}
+
+/* ===================== SELEÇÃO (--fields) ====================== */
+
+static int selection_has(const field_selection_t *sel, int idx) {
+    for (int i = 0; i < sel->count; i++)
+        if (sel->idx[i] == idx) return 1;
+    return 0;
+}
+
+/* Grupos aceitos em --fields: faixas contíguas da tabela, de first a last. */
+typedef struct {
+    const char *name;
+    const char *first;
+    const char *last;
+} field_group_t;
+
+static const field_group_t g_groups[] = {
+    { "default", "timestamp",          "syscalls_per_s" },
+    { "perf",    "task_clock_ms_per_s", "ipc" },
+    { "sched",   "cpu_run_ms_per_s",   "wait_per_slice_us" },
+    { "net",     "net_rx_bytes_per_s", "tcp_retrans_per_s" },
+    { "fd",      "fd_count",           "fd_growth_per_s" },
+    { "tcp",     "tcp_established",    "tcp_other" },
+    { "all",     "timestamp",          "tcp_other" },
+};
+
+static void selection_add(field_selection_t *sel, int idx) {
+    if (!selection_has(sel, idx) && sel->count < METRIC_FIELD_MAX)
+        sel->idx[sel->count++] = idx;
+}
+
+/* Acrescenta o grupo `name`; retorna 0 se não for um grupo. */
+static int selection_add_group(field_selection_t *sel, const char *name) {
+    for (size_t g = 0; g < sizeof(g_groups) / sizeof(g_groups[0]); g++) {
+        if (strcmp(g_groups[g].name, name) != 0) continue;
+        int first = metric_field_find(g_groups[g].first);
+        int last = metric_field_find(g_groups[g].last);
+        for (int i = first; i >= 0 && i <= last; i++) selection_add(sel, i);
+        return 1;
+    }
+    return 0;
+}
+
+int field_selection_parse(const char *spec, field_selection_t *sel) {
+    field_selection_t tmp;
+    tmp.count = 0;
+    tmp.idx[tmp.count++] = FIELD_IDX_TIMESTAMP;
+    tmp.idx[tmp.count++] = FIELD_IDX_PID;
+
+    if (!spec || spec[0] == '\0') spec = "default";
+
+    const char *p = spec;
+    while (*p) {
+        const char *end = strchr(p, ',');
+        size_t len = end ? (size_t)(end - p) : strlen(p);
+        char name[64];
+        if (len > 0) {
+            if (len >= sizeof(name)) {
+                fprintf(stderr, "Campo muito longo em --fields: %.*s\n", (int)len, p);
+                return -1;
+            }
+            memcpy(name, p, len);
+            name[len] = '\0';
+            int idx = metric_field_find(name);
+            if (idx >= 0) {
+                selection_add(&tmp, idx);
+            } else if (!selection_add_group(&tmp, name)) {
+                fprintf(stderr, "Campo desconhecido em --fields: %s\n", name);
+                return -1;
+            }
+        }
+        if (!end) break;
+        p = end + 1;
+    }
+
+    *sel = tmp;
+    return 0;
+}
+
+int export_set_fields(const char *spec) {
+    field_selection_t sel;
+    if (field_selection_parse(spec, &sel) != 0) return -1;
+    g_selection = sel;
+    g_selection_initialized = 1;
+    return 0;
+}
+
+const field_selection_t *export_get_fields(void) {
+    if (!g_selection_initialized) {
+        field_selection_parse(NULL, &g_selection);
+        g_selection_initialized = 1;
+    }
+    return &g_selection;
+}
+
+/* ===================== SUPRESSÃO (RUN-LENGTH) ====================== */
+
+void export_set_suppression(const export_suppression_t *cfg) {
+    if (cfg) g_suppression = *cfg;
+    else g_suppression.enabled = 0;
+}
+
+const export_suppression_t *export_get_suppression(void) {
+    return &g_suppression;
+}
+
+/* Mapa PID -> (última gravada, última amostra), endereçamento aberto. */
+typedef struct {
+    pid_t pid;
+    int used;
+    size_t last_kept;
+    size_t last_seen;
+} pid_slot_t;
+
+static pid_slot_t *pid_slot(pid_slot_t *tab, size_t cap, pid_t pid) {
+    size_t h = ((size_t)(unsigned)pid * 2654435761u) & (cap - 1);
+    while (tab[h].used && tab[h].pid != pid) h = (h + 1) & (cap - 1);
+    return &tab[h];
+}
+
+/* epsilon é relativo ao valor gravado de cada campo: as colunas têm unidades
+   muito diferentes (kB, %, contadores), e um limite absoluto único seria
+   grosso demais para umas e fino demais para outras. Com 0, qualquer mudança
+   conta; partindo de 0, também. scripts/metrics_io.py usa a mesma regra. */
+static int row_changed(const proc_metrics_t *a, const proc_metrics_t *b,
+                       const field_selection_t *sel, double eps) {
+    for (int c = 0; c < sel->count; c++) {
+        int idx = sel->idx[c];
+        if (idx == FIELD_IDX_TIMESTAMP || idx == FIELD_IDX_PID) continue;
+        double va = metric_field_value(a, &g_fields[idx]);
+        double vb = metric_field_value(b, &g_fields[idx]);
+        if (fabs(va - vb) > eps * fabs(vb)) return 1;
+    }
+    return 0;
+}
+
+long export_mark_kept(const proc_metrics_t *data, size_t count,
+                      const field_selection_t *sel,
+                      const export_suppression_t *cfg, unsigned char *keep) {
+    if (!cfg || !cfg->enabled) {
+        memset(keep, 1, count);
+        return (long)count;
+    }
+
+    size_t cap = 16;
+    while (cap < count * 2) cap <<= 1;
+    pid_slot_t *tab = calloc(cap, sizeof(*tab));
+    if (!tab) return -1;
+
+    /* 1ª passada: última amostra de cada PID (sempre gravada) */
+    for (size_t i = 0; i < count; i++) {
+        pid_slot_t *s = pid_slot(tab, cap, data[i].pid);
+        s->used = 1;
+        s->pid = data[i].pid;
+        s->last_seen = i;
+    }
+    for (size_t i = 0; i < cap; i++) tab[i].last_kept = (size_t)-1;
+
+    long kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        pid_slot_t *s = pid_slot(tab, cap, data[i].pid);
+        int k;
+        if (s->last_kept == (size_t)-1 || i == s->last_seen) {
+            k = 1;
+        } else {
+            const proc_metrics_t *ref = &data[s->last_kept];
+            k = row_changed(&data[i], ref, sel, cfg->epsilon) ||
+                (cfg->heartbeat_s > 0.0 &&
+                 data[i].timestamp - ref->timestamp >= cfg->heartbeat_s);
+        }
+        keep[i] = (unsigned char)k;
+        if (k) {
+            s->last_kept = i;
+            kept++;
+        }
+    }
+
+    free(tab);
+    return kept;
+}
+
+/* ===================== ESCRITOR CSV ====================== */
+
+static void csv_flush(csv_writer_t *w) {
+    if (w->len > 0 && w->fp) {
+        if (fwrite(w->buf, 1, w->len, w->fp) != w->len) {
+            /* erro reportado em csv_writer_close via ferror */
+        }
+    }
+    w->flushed += w->len;
+    w->len = 0;
+}
+
+static inline void csv_reserve(csv_writer_t *w, size_t n) {
+    if (w->len + n > w->cap) csv_flush(w);
+}
+
+int csv_writer_open(csv_writer_t *w, const char *filename) {
+    memset(w, 0, sizeof(*w));
+    w->fp = fopen(filename, "w");
+    if (!w->fp) return -1;
+    w->buf = malloc(CSV_BUF_SIZE);
+    if (!w->buf) {
+        fclose(w->fp);
+        w->fp = NULL;
+        return -1;
+    }
+    w->cap = CSV_BUF_SIZE;
+    w->owns_fp = 1;
+    /* o buffer do stdio seria redundante: escrevemos blocos de 64 KiB */
+    setvbuf(w->fp, NULL, _IONBF, 0);
+    return 0;
+}
+
+int csv_writer_attach(csv_writer_t *w, FILE *fp) {
+    memset(w, 0, sizeof(*w));
+    w->buf = malloc(CSV_BUF_SIZE);
+    if (!w->buf) return -1;
+    w->fp = fp;
+    w->cap = CSV_BUF_SIZE;
+    return 0;
+}
+
+unsigned long long csv_writer_offset(const csv_writer_t *w) {
+    return w->flushed + w->len;
+}
+
+void csv_put_char(csv_writer_t *w, char c) {
+    csv_reserve(w, 1);
+    w->buf[w->len++] = c;
+}
+
+void csv_put_str(csv_writer_t *w, const char *s) {
+    size_t n = strlen(s);
+    if (n > w->cap) {
+        csv_flush(w);
+        if (fwrite(s, 1, n, w->fp) != n) { /* ver csv_writer_close */ }
+        return;
+    }
+    csv_reserve(w, n);
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+}
+
+static const char k_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/* Escreve v em decimal em out (sem terminador). Retorna o número de dígitos. */
+static size_t u64_to_dec(unsigned long long v, char *out) {
+    char tmp[24];
+    char *p = tmp + sizeof(tmp);
+    while (v >= 100) {
+        unsigned idx = (unsigned)(v % 100) * 2;
+        v /= 100;
+        *--p = k_digit_pairs[idx + 1];
+        *--p = k_digit_pairs[idx];
+    }
+    if (v >= 10) {
+        unsigned idx = (unsigned)v * 2;
+        *--p = k_digit_pairs[idx + 1];
+        *--p = k_digit_pairs[idx];
+    } else {
+        *--p = (char)('0' + v);
+    }
+    size_t n = (size_t)(tmp + sizeof(tmp) - p);
+    memcpy(out, p, n);
+    return n;
+}
+
+void csv_put_u64(csv_writer_t *w, unsigned long long v) {
+    csv_reserve(w, CSV_MAX_CELL);
+    w->len += u64_to_dec(v, w->buf + w->len);
+}
+
+void csv_put_i64(csv_writer_t *w, long long v) {
+    csv_reserve(w, CSV_MAX_CELL);
+    if (v < 0) {
+        w->buf[w->len++] = '-';
+        w->len += u64_to_dec(0ULL - (unsigned long long)v, w->buf + w->len);
+    } else {
+        w->len += u64_to_dec((unsigned long long)v, w->buf + w->len);
+    }
+}
+
+static const double k_pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6 };
+
+void csv_put_fixed(csv_writer_t *w, double v, int decimals) {
+    csv_reserve(w, CSV_MAX_CELL);
+    if (decimals < 0) decimals = 0;
+
+    /* abaixo de 2^52 a parte fracionária de a*10^d é exata; fora disso (ou NaN/inf): snprintf */
+    double a = fabs(v), p = decimals <= 6 ? k_pow10[decimals] : 0.0;
+    if (decimals > 6 || !isfinite(v) || a * p >= 4e15) {
+        int n = snprintf(w->buf + w->len, CSV_MAX_CELL, "%.*f", decimals, v);
+        if (n > 0) w->len += (n < CSV_MAX_CELL) ? (size_t)n : CSV_MAX_CELL - 1;
+        return;
+    }
+
+    /* arredonda como o printf: pelo valor binário exato, empate para o par.
+       Só num empate aparente (.5) o erro do produto decide, e fma o dá exato. */
+    double scaled = a * p;
+    double fl = floor(scaled), rest = scaled - fl;
+    unsigned long long mag = (unsigned long long)fl;
+    if (rest > 0.5) {
+        mag++;
+    } else if (rest == 0.5) {
+        double err = fma(a, p, -scaled);
+        if (err > 0.0 || (err == 0.0 && (mag & 1))) mag++;
+    }
+    if (signbit(v)) w->buf[w->len++] = '-';     // como o printf: -0.001 vira "-0.00"
+
+    if (decimals == 0) {
+        w->len += u64_to_dec(mag, w->buf + w->len);
+        return;
+    }
+
+    unsigned long long div = (unsigned long long)k_pow10[decimals];
+    w->len += u64_to_dec(mag / div, w->buf + w->len);
+    w->buf[w->len++] = '.';
+    unsigned long long frac = mag % div;
+    for (int d = decimals - 1; d >= 0; d--) {
+        w->buf[w->len + (size_t)d] = (char)('0' + frac % 10);
+        frac /= 10;
+    }
+    w->len += (size_t)decimals;
+}
+
+void csv_put_field(csv_writer_t *w, const proc_metrics_t *m, const metric_field_t *f) {
+    const char *base = (const char *)m + f->offset;
+    switch (f->kind) {
+        case FIELD_F64:    csv_put_fixed(w, *(const double *)base, f->decimals); break;
+        case FIELD_PID:    csv_put_i64(w, *(const pid_t *)base); break;
+        case FIELD_ULONG:  csv_put_u64(w, *(const unsigned long *)base); break;
+        case FIELD_ULLONG: csv_put_u64(w, *(const unsigned long long *)base); break;
+    }
+}
+
+int csv_writer_close(csv_writer_t *w) {
+    int rc = 0;
+    if (w->fp) {
+        csv_flush(w);
+        if (ferror(w->fp)) rc = -1;
+        if (w->owns_fp ? fclose(w->fp) != 0 : fflush(w->fp) != 0) rc = -1;
+    }
+    free(w->buf);
+    memset(w, 0, sizeof(*w));
+    return rc;
+}
+
+/* ===================== EXPORTAÇÃO CSV ====================== */
+
+int export_metrics_csv(const char *filename, const proc_metrics_t *data, size_t count) {
+    const field_selection_t *sel = export_get_fields();
+    const export_suppression_t *sup = export_get_suppression();
+    unsigned char *keep = NULL;
+
+    if (sup->enabled) {
+        keep = malloc(count ? count : 1);
+        if (!keep || export_mark_kept(data, count, sel, sup, keep) < 0) {
+            free(keep);
+            return -1;
+        }
+    }
+
+    csv_writer_t w;
+    if (csv_writer_open(&w, filename) != 0) {
+        free(keep);
+        return -1;
+    }
+
+    if (sup->enabled) {
+        char meta[160];
+        snprintf(meta, sizeof(meta), "# rm-suppressed interval=%g epsilon=%g heartbeat=%g\n",
+                 sup->interval_s, sup->epsilon, sup->heartbeat_s);
+        csv_put_str(&w, meta);
+    }
+
+    for (int c = 0; c < sel->count; c++) {
+        if (c > 0) csv_put_char(&w, ',');
+        csv_put_str(&w, g_fields[sel->idx[c]].csv_header);
+    }
+    csv_put_char(&w, '\n');
+
+    /* índice de blocos para --query (opcional: falha não impede a exportação) */
+    unsigned char present[METRIC_FIELD_MAX] = {0};
+    for (int c = 0; c < sel->count; c++) present[sel->idx[c]] = 1;
+    block_index_writer_t bi;
+    int indexed = block_index_open(&bi, filename, present) == 0;
+
+    for (size_t i = 0; i < count; i++) {
+        if (keep && !keep[i]) continue;
+        if (indexed) block_index_add(&bi, &data[i], csv_writer_offset(&w));
+        for (int c = 0; c < sel->count; c++) {
+            if (c > 0) csv_put_char(&w, ',');
+            csv_put_field(&w, &data[i], &g_fields[sel->idx[c]]);
+        }
+        csv_put_char(&w, '\n');
+    }
+
+    free(keep);
+    unsigned long long size = csv_writer_offset(&w);
+    int rc = csv_writer_close(&w);
+    if (indexed && block_index_close(&bi, size) != 0)
+        fprintf(stderr, "Aviso: não foi possível gravar o índice de %s\n", filename);
+    return rc;
+}
+
+/* ===================== EXPORTAÇÃO BINÁRIA (.rmb) ====================== */
+
+int export_metrics_rmb(const char *filename, const proc_metrics_t *data, size_t count) {
+    FILE *f = fopen(filename, "wb");
+    if (!f) {
+        perror("Erro ao criar arquivo RMB");
+        return -1;
+    }
+
+    rmb_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, RMB_MAGIC, 4);
+    h.version = RMB_VERSION;
+    h.header_size = sizeof(rmb_header_t);
+    h.record_size = sizeof(proc_metrics_t);
+    h.count = count;
+
+    int rc = 0;
+    if (fwrite(&h, sizeof(h), 1, f) != 1) rc = -1;
+    if (rc == 0 && count && fwrite(data, sizeof(proc_metrics_t), count, f) != count) rc = -1;
+    if (fclose(f) != 0) rc = -1;
+    if (rc != 0) {
+        fprintf(stderr, "Erro ao gravar %s\n", filename);
+        return rc;
+    }
+
+    block_index_writer_t bi;
+    if (block_index_open(&bi, filename, NULL) == 0) {
+        for (size_t i = 0; i < count; i++)
+            block_index_add(&bi, &data[i], sizeof(h) + i * sizeof(proc_metrics_t));
+        if (block_index_close(&bi, sizeof(h) + count * sizeof(proc_metrics_t)) != 0)
+            fprintf(stderr, "Aviso: não foi possível gravar o índice de %s\n", filename);
+    }
+    return 0;
+}
+
+/* ===================== EXPORTAÇÃO JSON ====================== */
+
+static struct json_object *field_to_json(const proc_metrics_t *m, const metric_field_t *f) {
+    const char *base = (const char *)m + f->offset;
+    switch (f->kind) {
+        case FIELD_F64:    return json_object_new_double(*(const double *)base);
+        case FIELD_PID:    return json_object_new_int(*(const pid_t *)base);
+        case FIELD_ULONG:  return json_object_new_int64((int64_t)*(const unsigned long *)base);
+        case FIELD_ULLONG: return json_object_new_int64((int64_t)*(const unsigned long long *)base);
+    }
+    return NULL;
+}
+
+int export_metrics_json(const char *filename, const proc_metrics_t *data, size_t count) {
+    const field_selection_t *sel = export_get_fields();
+    const export_suppression_t *sup = export_get_suppression();
+    unsigned char *keep = NULL;
+
+    if (sup->enabled) {
+        keep = malloc(count ? count : 1);
+        if (!keep || export_mark_kept(data, count, sel, sup, keep) < 0) {
+            free(keep);
+            return -1;
+        }
+    }
+
+    struct json_object *jarray = json_object_new_array();
+
+    for (size_t i = 0; i < count; i++) {
+        if (keep && !keep[i]) continue;
+        struct json_object *jobj = json_object_new_object();
+        for (int c = 0; c < sel->count; c++) {
+            const metric_field_t *f = &g_fields[sel->idx[c]];
+            json_object_object_add(jobj, f->name, field_to_json(&data[i], f));
+        }
+        json_object_array_add(jarray, jobj);
+    }
+    free(keep);
+
+    /* com supressão, o array vai dentro de um objeto que carrega os parâmetros */
+    struct json_object *root = jarray;
+    if (sup->enabled) {
+        struct json_object *meta = json_object_new_object();
+        json_object_object_add(meta, "interval", json_object_new_double(sup->interval_s));
+        json_object_object_add(meta, "epsilon", json_object_new_double(sup->epsilon));
+        json_object_object_add(meta, "heartbeat", json_object_new_double(sup->heartbeat_s));
+        root = json_object_new_object();
+        json_object_object_add(root, "suppression", meta);
+        json_object_object_add(root, "samples", jarray);
+    }
+
+    FILE *f = fopen(filename, "w");
+    if (!f) {
+        json_object_put(root);
+        return -1;
+    }
+
+    fprintf(f, "%s\n", json_object_to_json_string_ext(root, JSON_C_TO_STRING_PRETTY));
+    fclose(f);
+    json_object_put(root);
+    return 0;
+}
+
+/* ===================== RESUMO (QUANTIS) ====================== */
+
+static int export_summary_json(const char *filename, const metric_summary_t *sums, size_t count) {
+    struct json_object *jarray = json_object_new_array();
+    for (size_t i = 0; i < count; i++) {
+        for (int k = 0; k < sums[i].nmetrics; k++) {
+            const ddsketch_t *sk = &sums[i].sk[k];
+            struct json_object *o = json_object_new_object();
+            json_object_object_add(o, "pid", json_object_new_int(sums[i].pid));
+            json_object_object_add(o, "metric", json_object_new_string(metric_summary_name(&sums[i], k)));
+            json_object_object_add(o, "count", json_object_new_int64((int64_t)sk->count));
+            json_object_object_add(o, "mean", json_object_new_double(ddsketch_mean(sk)));
+            json_object_object_add(o, "p50", json_object_new_double(ddsketch_quantile(sk, 0.50)));
+            json_object_object_add(o, "p90", json_object_new_double(ddsketch_quantile(sk, 0.90)));
+            json_object_object_add(o, "p99", json_object_new_double(ddsketch_quantile(sk, 0.99)));
+            json_object_object_add(o, "max", json_object_new_double(sk->max));
+            json_object_array_add(jarray, o);
+        }
+    }
+
+    FILE *f = fopen(filename, "w");
+    if (!f) {
+        json_object_put(jarray);
+        return -1;
+    }
+    fprintf(f, "%s\n", json_object_to_json_string_ext(jarray, JSON_C_TO_STRING_PRETTY));
+    fclose(f);
+    json_object_put(jarray);
+    return 0;
+}
+
+int export_summary(const char *filename, const metric_summary_t *sums, size_t count) {
+    if (strstr(filename, ".json")) return export_summary_json(filename, sums, count);
+
+    csv_writer_t w;
+    if (csv_writer_open(&w, filename) != 0) return -1;
+    csv_put_str(&w, "PID,metric,count,mean,p50,p90,p99,max\n");
+    for (size_t i = 0; i < count; i++) {
+        for (int k = 0; k < sums[i].nmetrics; k++) {
+            const ddsketch_t *sk = &sums[i].sk[k];
+            csv_put_i64(&w, sums[i].pid);
+            csv_put_char(&w, ',');
+            csv_put_str(&w, metric_summary_name(&sums[i], k));
+            csv_put_char(&w, ',');
+            csv_put_u64(&w, sk->count);
+            csv_put_char(&w, ','); csv_put_fixed(&w, ddsketch_mean(sk), 2);
+            csv_put_char(&w, ','); csv_put_fixed(&w, ddsketch_quantile(sk, 0.50), 2);
+            csv_put_char(&w, ','); csv_put_fixed(&w, ddsketch_quantile(sk, 0.90), 2);
+            csv_put_char(&w, ','); csv_put_fixed(&w, ddsketch_quantile(sk, 0.99), 2);
+            csv_put_char(&w, ','); csv_put_fixed(&w, sk->max, 2);
+            csv_put_char(&w, '\n');
+        }
+    }
+    return csv_writer_close(&w);
+}
@@ -0,0 +1,186 @@
+/*
+ * src/fd_monitor.c
+ *
+ * Inventário de descritores do alvo: total e tipo de cada entrada de
+ * /proc/<pid>/fd, mais o limite de "Max open files".
+ */
+
+#define _GNU_SOURCE
+#include "monitor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/syscall.h>
+
+#define FD_DENTS_BUF 8192
+#define FD_LINK_MAX 64              // o prefixo basta para classificar: caminhos longos saem truncados
+
+/* getdents64 direto: opendir aloca um buffer de 32 kB a cada tick */
+struct fd_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+fd_type_t monitor_fd_classify(const char *link, unsigned long *ino) {
+    *ino = 0;
+    if (link[0] == '/') return FD_FILE;
+    if (strncmp(link, "socket:[", 8) == 0) {
+        *ino = strtoul(link + 8, NULL, 10);
+        return FD_SOCKET;
+    }
+    if (strncmp(link, "pipe:[", 6) == 0) return FD_PIPE;
+    if (strcmp(link, "anon_inode:[eventfd]") == 0) return FD_EVENTFD;
+    if (strncmp(link, "anon_inode:", 11) == 0) return FD_ANON;
+    return FD_OTHER;
+}
+
+int monitor_fd_limit(pid_t pid, unsigned long *soft) {
+    char path[300], buf[4096];
+    snprintf(path, sizeof(path), "%s/%d/limits", monitor_proc_root(), pid);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    ssize_t len = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (len <= 0) return -1;
+    buf[len] = '\0';
+    /* "Max open files            1024                 1048576              files" */
+    const char *line = strstr(buf, "Max open files");
+    char val[32];
+    if (!line || sscanf(line + 14, "%31s", val) != 1) return -1;
+    *soft = strcmp(val, "unlimited") == 0 ? 0 : strtoul(val, NULL, 10);
+    return 0;
+}
+
+static int grow(fd_state_t *st, size_t need) {
+    if (need <= st->cap) return 0;
+    size_t cap = st->cap ? st->cap : 64;
+    while (cap < need) cap *= 2;
+    fd_entry_t *p = realloc(st->prev, cap * sizeof(*p));
+    if (!p) return -1;
+    st->prev = p;
+    fd_entry_t *c = realloc(st->cur, cap * sizeof(*c));
+    if (!c) return -1;
+    st->cur = c;
+    st->cap = cap;
+    return 0;
+}
+
+static int cmp_fd(const void *a, const void *b) {
+    const fd_entry_t *x = a, *y = b;
+    return (x->fd > y->fd) - (x->fd < y->fd);
+}
+
+static int cmp_ino(const void *a, const void *b) {
+    unsigned long x = *(const unsigned long *)a, y = *(const unsigned long *)b;
+    return (x > y) - (x < y);
+}
+
+int monitor_fd_usage(pid_t pid, fd_state_t *st, fd_counts_t *out) {
+    char path[300];
+    memset(out, 0, sizeof(*out));
+    snprintf(path, sizeof(path), "%s/%d/fd", monitor_proc_root(), pid);
+    int dfd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dfd < 0) {
+        if (errno == EACCES)
+            fprintf(stderr, "🔒 Sem permissão para ler %s\n", path);
+        return -1;
+    }
+
+    /* 1) listagem: números em st->cur, em ordem crescente como o kernel entrega */
+    char buf[FD_DENTS_BUF] __attribute__((aligned(8)));
+    int self = pid == getpid();     // no próprio processo, dfd aparece na listagem
+    size_t n = 0;
+    int sorted = 1;
+    long got;
+    while ((got = syscall(SYS_getdents64, dfd, buf, sizeof(buf))) > 0) {
+        for (long off = 0; off < got;) {
+            const struct fd_dirent64 *d = (const struct fd_dirent64 *)(buf + off);
+            off += d->d_reclen;
+            if (d->d_name[0] < '0' || d->d_name[0] > '9') continue;     // "." e ".."
+            int num = atoi(d->d_name);
+            if (self && num == dfd) continue;
+            if (grow(st, n + 1) != 0) {
+                close(dfd);
+                return -1;
+            }
+            st->cur[n].fd = num;
+            st->cur[n].type = -1;
+            if (n > 0 && st->cur[n].fd < st->cur[n - 1].fd) sorted = 0;
+            n++;
+        }
+    }
+    if (got < 0) {
+        close(dfd);
+        return -1;
+    }
+    if (!sorted) qsort(st->cur, n, sizeof(*st->cur), cmp_fd);
+
+    /* 2) tipos: reaproveitados da listagem anterior (caminhada em paralelo),
+          readlink só para números novos ou na releitura completa */
+    int full = st->ticks % FD_RECHECK_TICKS == 0;
+    size_t j = 0, nsock = 0;
+    st->readlinks = 0;
+    for (size_t i = 0; i < n; i++) {
+        fd_entry_t *e = &st->cur[i];
+        if (!full) {
+            while (j < st->nprev && st->prev[j].fd < e->fd) j++;
+            if (j < st->nprev && st->prev[j].fd == e->fd) {
+                e->type = st->prev[j].type;
+                e->ino = st->prev[j].ino;
+            }
+        }
+        if (e->type < 0) {
+            char name[16], link[FD_LINK_MAX];
+            snprintf(name, sizeof(name), "%d", e->fd);
+            ssize_t len = readlinkat(dfd, name, link, sizeof(link) - 1);
+            st->readlinks++;
+            if (len < 0) {
+                e->type = FD_OTHER;     // fechado entre a listagem e o readlink
+                e->ino = 0;
+            } else {
+                link[len] = '\0';
+                e->type = (int)monitor_fd_classify(link, &e->ino);
+            }
+        }
+        out->by_type[e->type]++;
+        if (e->type == FD_SOCKET) nsock++;
+    }
+    close(dfd);
+    out->count = (unsigned long)n;
+
+    /* inodes dos sockets ordenados, para cruzar com net/tcp */
+    if (nsock > st->sockets_cap) {
+        unsigned long *s = realloc(st->sockets, nsock * sizeof(*s));
+        if (!s) return -1;
+        st->sockets = s;
+        st->sockets_cap = nsock;
+    }
+    st->nsockets = 0;
+    for (size_t i = 0; i < n; i++)
+        if (st->cur[i].type == FD_SOCKET) st->sockets[st->nsockets++] = st->cur[i].ino;
+    qsort(st->sockets, st->nsockets, sizeof(*st->sockets), cmp_ino);
+
+    if (full && monitor_fd_limit(pid, &st->limit) != 0) st->limit = 0;
+    out->limit = st->limit;
+
+    fd_entry_t *t = st->prev;
+    st->prev = st->cur;
+    st->cur = t;
+    st->nprev = n;
+    st->ticks++;
+    return 0;
+}
+
+void monitor_fd_free(fd_state_t *st) {
+    free(st->prev);
+    free(st->cur);
+    free(st->sockets);
+    memset(st, 0, sizeof(*st));
+}
@@ -19,15 +19,15 @@ int monitor_io_usage(pid_t pid,
                      unsigned long long *write_bytes,
                      unsigned long long *syscr)
 {
-    char path[64];
-    snprintf(path, sizeof(path), "/proc/%d/io", pid);
+    char path[300];
+    snprintf(path, sizeof(path), "%s/%d/io", monitor_proc_root(), pid);
 
     FILE *fp = fopen(path, "r");
     if (!fp) {
         if (errno == ENOENT)
             fprintf(stderr, "⚠️  Processo %d não encontrado (terminou?)\n", pid);
         else if (errno == EACCES)
-            fprintf(stderr, "🔒 Sem permissão para ler /proc/%d/io\n", pid);
+            fprintf(stderr, "🔒 Sem permissão para ler %s\n", path);
 
         *rchar = *wchar = *read_bytes = *write_bytes = *syscr = 0;
         return -1;
@@ -1,21 +1,44 @@
 #include "monitor.h"
 #include "namespace.h"
 #include "cgroup.h"
+#include "export.h"
+#include "rollup.h"
+#include "sketch.h"
+#include "anomaly.h"
+#include "trend.h"
+#include "replay.h"
+#include "query.h"
+#include "summarize.h"
+#include "sampler.h"
+#include "top.h"
+#include "batchread.h"
+#include "selfstats.h"
+#include "procfixture.h"
+#include "wss.h"
+#include "offcpu.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <signal.h>
 #include <unistd.h>
 #include <time.h>
 #include <string.h>
-#include <json-c/json.h>
 #include <errno.h>
 #include <math.h>
+#include <stdarg.h>
 
 #ifdef USE_NCURSES
 #include <ncurses.h>
 #endif
 
 int check_process_exists(pid_t pid) {
+    /* árvore sintética (--proc-root): basta o diretório do PID existir */
+    if (strcmp(monitor_proc_root(), "/proc") != 0) {
+        char path[300];
+        snprintf(path, sizeof(path), "%s/%d", monitor_proc_root(), pid);
+        if (access(path, F_OK) == 0) return 1;
+        fprintf(stderr, "Erro: processo %d não existe em %s.\n", pid, monitor_proc_root());
+        return 0;
+    }
     if (kill(pid, 0) == 0) {
         return 1;
     } else {
@@ -29,89 +52,6 @@ int check_process_exists(pid_t pid) {
     }
 }
 
-/* ===================== EXPORTAÇÃO CSV ====================== */
-
-int export_metrics_csv(const char *filename, const proc_metrics_t *data, size_t count) {
-    FILE *f = fopen(filename, "w");
-    if (!f) return -1;
-
-    fprintf(f,
-        "Timestamp,PID,CPU%%,Threads,VolCtx,InvCtx,"
-        "RSS(kB),VSZ(kB),MinFlt,MajFlt,Swap(kB),"
-        "RChar,WChar,ReadBytes,WriteBytes,Syscalls,"
-        "RChar/s,WChar/s,ReadBytes/s,WriteBytes/s,Syscalls/s\n");
-
-    for (size_t i = 0; i < count; i++) {
-        fprintf(f,
-            "%.0f,%d,%.2f,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,"
-            "%llu,%llu,%llu,%llu,%llu,"
-            "%.2f,%.2f,%.2f,%.2f,%.2f\n",
-            data[i].timestamp, data[i].pid, data[i].cpu_percent,
-            data[i].threads, data[i].voluntary_ctxt, data[i].involuntary_ctxt,
-            data[i].rss_kb, data[i].vmsize_kb, data[i].minflt,
-            data[i].majflt, data[i].swap_kb,
-            data[i].rchar, data[i].wchar,
-            data[i].read_bytes, data[i].write_bytes, data[i].syscalls,
-            data[i].rchar_per_s, data[i].wchar_per_s,
-            data[i].read_bytes_per_s, data[i].write_bytes_per_s,
-            data[i].syscalls_per_s);
-    }
-
-    fclose(f);
-    return 0;
-}
-
-/* ===================== EXPORTAÇÃO JSON ====================== */
-
-int export_metrics_json(const char *filename, const proc_metrics_t *data, size_t count) {
-    struct json_object *jarray = json_object_new_array();
-
-    for (size_t i = 0; i < count; i++) {
-        struct json_object *jobj = json_object_new_object();
-
-        json_object_object_add(jobj, "timestamp", json_object_new_double(data[i].timestamp));
-        json_object_object_add(jobj, "pid", json_object_new_int(data[i].pid));
-        json_object_object_add(jobj, "cpu_percent", json_object_new_double(data[i].cpu_percent));
-
-        json_object_object_add(jobj, "threads", json_object_new_int64(data[i].threads));
-        json_object_object_add(jobj, "voluntary_ctxt", json_object_new_int64(data[i].voluntary_ctxt));
-        json_object_object_add(jobj, "involuntary_ctxt", json_object_new_int64(data[i].involuntary_ctxt));
-
-        json_object_object_add(jobj, "rss_kb", json_object_new_int64(data[i].rss_kb));
-        json_object_object_add(jobj, "vmsize_kb", json_object_new_int64(data[i].vmsize_kb));
-
-        json_object_object_add(jobj, "minflt", json_object_new_int64(data[i].minflt));
-        json_object_object_add(jobj, "majflt", json_object_new_int64(data[i].majflt));
-        json_object_object_add(jobj, "swap_kb", json_object_new_int64(data[i].swap_kb));
-
-        json_object_object_add(jobj, "rchar", json_object_new_int64(data[i].rchar));
-        json_object_object_add(jobj, "wchar", json_object_new_int64(data[i].wchar));
-        json_object_object_add(jobj, "read_bytes", json_object_new_int64(data[i].read_bytes));
-        json_object_object_add(jobj, "write_bytes", json_object_new_int64(data[i].write_bytes));
-        json_object_object_add(jobj, "syscalls", json_object_new_int64(data[i].syscalls));
-
-        /* taxas por segundo (derivadas entre amostras) */
-        json_object_object_add(jobj, "rchar_per_s", json_object_new_double(data[i].rchar_per_s));
-        json_object_object_add(jobj, "wchar_per_s", json_object_new_double(data[i].wchar_per_s));
-        json_object_object_add(jobj, "read_bytes_per_s", json_object_new_double(data[i].read_bytes_per_s));
-        json_object_object_add(jobj, "write_bytes_per_s", json_object_new_double(data[i].write_bytes_per_s));
-        json_object_object_add(jobj, "syscalls_per_s", json_object_new_double(data[i].syscalls_per_s));
-
-        json_object_array_add(jarray, jobj);
-    }
-
-    FILE *f = fopen(filename, "w");
-    if (!f) {
-        json_object_put(jarray);
-        return -1;
-    }
-
-    fprintf(f, "%s\n", json_object_to_json_string_ext(jarray, JSON_C_TO_STRING_PRETTY));
-    fclose(f);
-    json_object_put(jarray);
-    return 0;
-}
-
 /* ===================== TESTES ====================== */
 
 void run_tests() {
@@ -147,31 +87,118 @@ void run_tests() {
 static volatile int running = 1;
 void handle_sigint(int sig __attribute__((unused))) { running = 0; }
 
-/* Simple running statistics (Welford) for online z-score */
+/* Anomalias: uma linha JSON por evento em <saida>.anomalies.jsonl */
 typedef struct {
-    unsigned long count;
-    double mean;
-    double m2;
-} running_stats_t;
-
-static void rs_init(running_stats_t *rs){ rs->count = 0; rs->mean = 0.0; rs->m2 = 0.0; }
-static void rs_update(running_stats_t *rs, double x){
-    rs->count++;
-    double delta = x - rs->mean;
-    rs->mean += delta / rs->count;
-    double delta2 = x - rs->mean;
-    rs->m2 += delta * delta2;
+    FILE *fp;
+    const char *key;        // "pid" ou "cgroup"
+    char label[128];        // valor da chave
+    int quoted;             // 1 se label é string
+    int ui;                 // ncurses ativo: o aviso vai para alert e o painel o desenha
+    char alert[192];        // último aviso
+} anomaly_sink_t;
+
+/* Aviso no terminal: com o ncurses dono da tela, um printf corromperia o painel */
+static void sink_alert(anomaly_sink_t *sink, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(sink->alert, sizeof(sink->alert), fmt, ap);
+    va_end(ap);
+    if (!sink->ui) printf("%s\n", sink->alert);
 }
-static double rs_variance(running_stats_t *rs){ return (rs->count > 1) ? (rs->m2 / (rs->count - 1)) : 0.0; }
-static double rs_stddev(running_stats_t *rs){ return sqrt(rs_variance(rs)); }
-static double rs_zscore(running_stats_t *rs, double x){
-    double sd = rs_stddev(rs);
-    if (sd <= 0.0) return 0.0;
-    return (x - rs->mean) / sd;
+
+static void report_anomaly(const anomaly_event_t *ev, void *ctx) {
+    anomaly_sink_t *sink = ctx;
+    sink_alert(sink, "!! Anomaly detected (%s %s) ts=%.0f value=%.2f z=%.2f [%s]",
+               sink->label, ev->metric, ev->timestamp, ev->value, ev->z, ev->detectors);
+    if (sink->fp)
+        fprintf(sink->fp, "{\"timestamp\": %.0f, \"%s\": %s%s%s, \"metric\": \"%s\", "
+                "\"value\": %.6f, \"z\": %.6f, \"detectors\": \"%s\"}\n",
+                ev->timestamp, sink->key, sink->quoted ? "\"" : "", sink->label,
+                sink->quoted ? "\"" : "", ev->metric, ev->value, ev->z, ev->detectors);
+}
+
+/* Previsão de OOM: tendência de uma série de memória contra o seu limite */
+#define OOM_REPORT_EVERY_S 30.0
+
+typedef struct {
+    const char *metric;     // "rss_bytes" ou "cg_mem_current"
+    trend_t tr;
+    trend_estimate_t est;
+    int has_est;
+    double limit;           // bytes (0 = desconhecido)
+    double eta_s;           // INFINITY se não cresce
+    double last_report;
+} oom_watch_t;
+
+/* 1 se o limite será atingido dentro do horizonte e o último aviso já tem OOM_REPORT_EVERY_S */
+static int watch_update(oom_watch_t *w, double ts, double y, double limit, double horizon_s) {
+    trend_add(&w->tr, ts, y);
+    w->limit = limit;
+    w->has_est = trend_estimate(&w->tr, &w->est) == 0;
+    w->eta_s = (w->has_est && limit > 0.0) ? trend_time_to(&w->est, limit) : INFINITY;
+    if (w->eta_s > horizon_s) return 0;
+    if (w->last_report > 0.0 && ts - w->last_report < OOM_REPORT_EVERY_S) return 0;
+    w->last_report = ts;
+    return 1;
+}
+
+/* Linha JSONL da previsão; o texto já foi entregue por sink_alert */
+static void watch_report(const oom_watch_t *w, double ts, const char *type, anomaly_sink_t *sink) {
+    if (!sink->fp) return;
+    const char *method = isnan(w->est.slope_robust) ? "ewls" : "theil-sen";
+    fprintf(sink->fp, "{\"timestamp\": %.0f, \"%s\": %s%s%s, \"metric\": \"%s\", "
+            "\"type\": \"%s\", \"value\": %.0f, \"slope_per_s\": %.3f, "
+            "\"limit\": %.0f, \"eta_s\": %.1f, \"method\": \"%s\"}\n",
+            ts, sink->key, sink->quoted ? "\"" : "", sink->label, sink->quoted ? "\"" : "",
+            w->metric, type, w->est.level, w->est.slope, w->limit, w->eta_s, method);
+    fflush(sink->fp);
+}
+
+static void oom_watch_update(oom_watch_t *w, double ts, double bytes, double limit,
+                             double horizon_s, anomaly_sink_t *sink) {
+    if (!watch_update(w, ts, bytes, limit, horizon_s)) return;
+    sink_alert(sink, "!! OOM previsto (%s %s) em %.0f s: %+.1f KB/s, limite %.1f MB",
+               sink->label, w->metric, w->eta_s, w->est.slope / 1024.0, limit / (1024.0 * 1024.0));
+    watch_report(w, ts, "oom_prediction", sink);
+}
+
+/* Vazamento de descritores: a mesma tendência contra o limite de "Max open files" (EMFILE) */
+static void fd_watch_update(oom_watch_t *w, double ts, double fds, double limit,
+                            double horizon_s, anomaly_sink_t *sink) {
+    if (!watch_update(w, ts, fds, limit, horizon_s)) return;
+    sink_alert(sink, "!! Descritores esgotados (%s %s) em %.0f s: %+.2f fd/s, limite %.0f",
+               sink->label, w->metric, w->eta_s, w->est.slope, limit);
+    watch_report(w, ts, "fd_exhaustion_prediction", sink);
+}
+
+/* Coletores cortados pelo orçamento, ex: "schedstat,fd" */
+static const char *shed_list(unsigned shed, char *buf, size_t len) {
+    size_t n = 0;
+    buf[0] = '\0';
+    for (int c = 0; c < SAMPLER_SHED_COUNT && n < len; c++)
+        if (shed & SAMPLER_SHED_BIT(c))
+            n += (size_t)snprintf(buf + n, len - n, "%s%s", n ? "," : "", sampler_shed_name(c));
+    return buf;
 }
 
 int main(int argc, char *argv[]) {
-    
+
+    /* --proc-root/--cgroup-root valem para todos os modos: aplicados e retirados de argv */
+    int kept = 1;
+    for (int ai = 1; ai < argc; ai++) {
+        if (strcmp(argv[ai], "--proc-root") == 0 && ai + 1 < argc) {
+            monitor_set_proc_root(argv[++ai]);
+            continue;
+        }
+        if (strcmp(argv[ai], "--cgroup-root") == 0 && ai + 1 < argc) {
+            cgroup_set_root(argv[++ai]);
+            continue;
+        }
+        argv[kept++] = argv[ai];
+    }
+    argc = kept;
+    argv[argc] = NULL;
+
     if (argc == 2 && strcmp(argv[1], "--test") == 0) {
         run_tests();
         return 0;
@@ -204,6 +231,12 @@ int main(int argc, char *argv[]) {
         return cgroup_set_memory_limit(argv[2], limit_bytes);
     }
 
+    if (argc == 4 && strcmp(argv[1], "--cg-set-mem-high") == 0) {
+        // Uso: ./resource_monitor --cg-set-mem-high <nome_grupo> <limite_MB>
+        long limit_bytes = atol(argv[3]) * 1024 * 1024;
+        return cgroup_set_memory_high(argv[2], limit_bytes);
+    }
+
     if (argc == 4 && strcmp(argv[1], "--cg-set-cpu") == 0) {
         // Uso: ./resource_monitor --cg-set-cpu <nome_grupo> <percent>
         // Ex: 50 -> 50% de 1 core (50000us / 100000us)
@@ -265,34 +298,386 @@ int main(int argc, char *argv[]) {
         }
     }
 
-    /* New CLI flags: --ui (ncurses), --anomaly (enable online anomaly detection), --anomaly-threshold <float> */
+    /* New CLI flags: --ui (ncurses), --anomaly (enable online anomaly detection), --anomaly-threshold <float>,
+       --fields <lista> (colunas exportadas, ex: cpu_percent,rss_kb,write_bytes_per_s; aceita os grupos
+         default, perf, sched, net, fd, tcp e all; sem a opção: default mais os grupos dos coletores ligados),
+       --suppress <epsilon> [--heartbeat <s>] (grava só amostras em que algum campo variou mais que a
+         fração epsilon do próprio valor; não combina com --max-overhead, cujo intervalo variável
+         impede reexpandir a série),
+       --long-run [--raw-minutes N] [--tier-10s-hours H] [--tier-1m-days D] [--export-tier raw|10s|1m]
+         (roda sem limite de amostras com memória fixa: bruto recente + agregados 10 s / 1 min),
+       --summary (p50/p90/p99/max de CPU%, RSS, taxas de I/O e espera na fila de CPU, em <saida>.summary.csv|json;
+         liga --schedstat e --net),
+       --schedstat (soma task/<tid>/schedstat de todas as threads do alvo a cada amostra: tempo na CPU
+         e espera na fila de execução, colunas CpuRun(ms/s)/CpuWait(ms/s)/WaitPerSlice(us)),
+       --net (bytes, pacotes, descartes e retransmissões TCP do namespace de rede do alvo, de
+         /proc/<pid>/net/dev e net/snmp; colunas NetRx(B/s)...TcpRetrans/s),
+       --anomaly-detectors ewma,mad,seasonal,zscore --anomaly-vote all|any
+         (todas as métricas do processo + cgroup/PSI; --cgroup <grupo> usa o cgroup do
+         resource_monitor, senão a pressão do sistema em /proc/pressure),
+       --oom-horizon <s> [--trend-half-life <s>] (com --anomaly ou --ui: tendência do RSS, de
+         memory.current e, com --fds, dos descritores abertos; avisa quando o limite memory.max, a
+         memória do sistema ou o limite de "Max open files" do alvo será atingido),
+       --fds (lista /proc/<pid>/fd a cada amostra: descritores por tipo, limite e crescimento,
+         colunas Fds...FdGrowth/s),
+       --fd-sockets (liga --fds e cruza os sockets abertos pelo alvo com net/tcp e net/tcp6 do netns dele:
+         colunas TcpEstab/TcpListen/TcpCloseWait/TcpOther; o custo cresce com os sockets do netns),
+       --replay <gravação.csv|.json|.rmb> [--threads N] (reprocessa uma gravação com --anomaly/--summary;
+         a saída <arquivo>.rmb grava as amostras em binário para replay sem cópia),
+       --query <gravação.csv|.rmb> [--from T1] [--to T2] [--pid P] [--where cpu_percent>80,...] [--out f.csv]
+         (usa o índice de blocos <gravação>.idx para ler só os blocos que podem casar),
+       --summarize <dir. do experimento> [--out <dir>] (agrega os resultados de exp1..exp5 no CSV
+         que scripts/visualize.py consome; padrão <dir>/plots),
+       --perf (contadores perf_event_open por thread do alvo, lidos num read() por grupo a cada
+         amostra: task-clock, trocas de contexto, migrações, page faults e, com PMU, cycles,
+         instructions, cache-misses e IPC; entram nas colunas exportadas),
+       --wss <PID> [--wss-window s] [--wss-windows N] [--wss-method auto|idle|refs]
+         [--wss-apply <grupo> [--wss-headroom pct]] [--out f.csv] (working set: páginas acessadas em
+         cada janela, por page_idle/bitmap + pagemap ou clear_refs + Referenced; --wss-windows 0 mede
+         até Ctrl+C; --wss-apply grava memory.high = maior WSS + folga no cgroup do monitor),
+       --offcpu <PID> [--offcpu-hz N] [--offcpu-duration s] [--io-backend auto|uring|pread] [--out f.csv]
+         (perfil off-CPU: estado, syscall e wchan de cada thread a N Hz, padrão 100, por s segundos,
+         padrão 10, 0 = até Ctrl+C; histograma de onde as threads ficam bloqueadas — I/O, futex,
+         poll, sono, falta de página — sem eBPF nem depurador),
+       --pin-cpu <n> (fixa a thread de coleta no núcleo n; a saída roda na thread principal),
+       --proc-root <dir> --cgroup-root <dir> (em qualquer modo: raízes do procfs e do cgroupfs
+         lidas pelos coletores, padrão /proc e /sys/fs/cgroup),
+       --make-fixture <dir> [--procs N] [--task-threads T] [--groups G] [--tick K] [--follow <s>]
+         (gera <dir>/proc e <dir>/cgroup sintéticos com N processos de T threads em G cgroups;
+         contadores determinísticos no tick K; --follow reescreve a cada s segundos com o tick seguinte),
+       --max-overhead <pct>[%] (orçamento de CPU do próprio monitor, ex: 0.5%: acima dele corta, um
+         por tick, schedstat, fds, rede, perf, cgroup/PSI e smaps e depois alarga o intervalo; com
+         folga volta ao normal; amostra mais rápido quando
+         os escores de anomalia sobem e mais devagar com o alvo ocioso),
+       --smaps <s> [--smaps-children] (PSS/USS por /proc/<pid>/smaps_rollup numa thread própria, a
+         cada s segundos no mínimo; o intervalo alarga para o custo medido ficar abaixo de 1% de um
+         núcleo e é o último coletor cortado por --max-overhead; com --smaps-children soma os
+         filhos diretos (servidores pré-fork); uma linha por processo em <saida>.smaps.csv),
+       --top [intervalo] [--threads N] (painel de todos os processos: ordena, filtra e agrupa por
+         cgroup, namespace de PID ou de rede; coleta em thread própria e redesenha só as linhas que mudaram;
+         com muitos processos, a leitura de /proc é repartida num pool de N threads com roubo de
+         trabalho — padrão um por núcleo, 1 = serial),
+       --io-backend auto|uring|pread (com --top e --offcpu: uring lê o /proc/<pid>/stat de todos os
+         processos num lote io_uring por tick; auto usa pread, mais barato para o /proc),
+       --self-stats (tempo, syscalls e bytes lidos por chamada de cada coletor e do exportador, em
+         histogramas log-lineares, mais CPU% e RSS do próprio monitor; grava <saida>.selfstats.csv) */
     int ui_mode = 0;
     int anomaly_mode = 0;
-    double anomaly_threshold = 3.0;
+    anomaly_config_t anomaly_cfg;
+    anomaly_config_default(&anomaly_cfg);
+    const char *cgroup_name = NULL;
+    double oom_horizon = 600.0;
+    double trend_half_life = 120.0;
+    const char *replay_path = NULL;
+    int replay_threads = 0;
+    const char *query_path = NULL;
+    const char *query_out = NULL;
+    const char *summarize_dir = NULL;
+    const char *fixture_dir = NULL;
+    procfixture_config_t fixture = { 1000, 4, 16, 0, 0 };
+    double fixture_follow = 0.0;
+    query_t query;
+    query_init(&query);
+    export_suppression_t suppression = {0, 0.0, 0.0, 1.0};
+    int long_run = 0;
+    double raw_minutes = ROLLUP_DEFAULT_RAW_MINUTES;
+    double tier_10s_hours = ROLLUP_DEFAULT_10S_HOURS;
+    double tier_1m_days = ROLLUP_DEFAULT_1M_DAYS;
+    int export_tier = ROLLUP_TIER_RAW;
+    int summary_mode = 0;
+    int pin_cpu = -1;
+    double top_interval = 0.0;
+    int io_backend = BATCHREAD_AUTO;
+    int self_stats = 0;
+    double max_overhead = 0.0;
+    double smaps_interval = 0.0;
+    int smaps_children = 0;
+    int perf_mode = 0;
+    int sched_mode = 0;
+    int net_mode = 0;
+    int fd_mode = 0;
+    int fd_sockets = 0;
+    const char *fields_spec = NULL;
+    pid_t wss_pid = 0;
+    double wss_window = 10.0;
+    int wss_windows = 1;
+    int wss_method = WSS_AUTO;
+    const char *wss_apply = NULL;
+    double wss_headroom = 20.0;
+    pid_t offcpu_pid = 0;
+    double offcpu_hz = 100.0;
+    double offcpu_duration = 10.0;
 
     for (int ai = 1; ai < argc; ai++) {
         if (strcmp(argv[ai], "--ui") == 0) ui_mode = 1;
         if (strcmp(argv[ai], "--anomaly") == 0) anomaly_mode = 1;
         if (strcmp(argv[ai], "--anomaly-threshold") == 0 && ai + 1 < argc) {
-            anomaly_threshold = atof(argv[++ai]);
+            anomaly_cfg.threshold = atof(argv[++ai]);
+        }
+        if (strcmp(argv[ai], "--anomaly-detectors") == 0 && ai + 1 < argc) {
+            anomaly_cfg.detectors = argv[++ai];
+        }
+        if (strcmp(argv[ai], "--anomaly-vote") == 0 && ai + 1 < argc) {
+            const char *v = argv[++ai];
+            if (strcmp(v, "all") == 0) anomaly_cfg.vote_all = 1;
+            else if (strcmp(v, "any") == 0) anomaly_cfg.vote_all = 0;
+            else { fprintf(stderr, "Voto inválido: %s (use all ou any)\n", v); return 1; }
+        }
+        if (strcmp(argv[ai], "--cgroup") == 0 && ai + 1 < argc) cgroup_name = argv[++ai];
+        if (strcmp(argv[ai], "--oom-horizon") == 0 && ai + 1 < argc) oom_horizon = atof(argv[++ai]);
+        if (strcmp(argv[ai], "--trend-half-life") == 0 && ai + 1 < argc) trend_half_life = atof(argv[++ai]);
+        if (strcmp(argv[ai], "--replay") == 0 && ai + 1 < argc) replay_path = argv[++ai];
+        if (strcmp(argv[ai], "--threads") == 0 && ai + 1 < argc) replay_threads = atoi(argv[++ai]);
+        if (strcmp(argv[ai], "--query") == 0 && ai + 1 < argc) query_path = argv[++ai];
+        if (strcmp(argv[ai], "--from") == 0 && ai + 1 < argc) query.from = atof(argv[++ai]);
+        if (strcmp(argv[ai], "--to") == 0 && ai + 1 < argc) query.to = atof(argv[++ai]);
+        if (strcmp(argv[ai], "--pid") == 0 && ai + 1 < argc) {
+            query.has_pid = 1;
+            query.pid = atoi(argv[++ai]);
+        }
+        if (strcmp(argv[ai], "--where") == 0 && ai + 1 < argc) {
+            if (query_add_where(&query, argv[++ai]) != 0) return 1;
+        }
+        if (strcmp(argv[ai], "--out") == 0 && ai + 1 < argc) query_out = argv[++ai];
+        if (strcmp(argv[ai], "--summarize") == 0 && ai + 1 < argc) summarize_dir = argv[++ai];
+        if (strcmp(argv[ai], "--fields") == 0 && ai + 1 < argc) fields_spec = argv[++ai];
+        if (strcmp(argv[ai], "--suppress") == 0 && ai + 1 < argc) {
+            suppression.enabled = 1;
+            suppression.epsilon = atof(argv[++ai]);
+        }
+        if (strcmp(argv[ai], "--heartbeat") == 0 && ai + 1 < argc) {
+            suppression.heartbeat_s = atof(argv[++ai]);
+        }
+        if (strcmp(argv[ai], "--long-run") == 0) long_run = 1;
+        if (strcmp(argv[ai], "--summary") == 0) summary_mode = 1;
+        if (strcmp(argv[ai], "--self-stats") == 0) self_stats = 1;
+        if (strcmp(argv[ai], "--max-overhead") == 0 && ai + 1 < argc) {
+            max_overhead = atof(argv[++ai]);    // "0.5%" -> 0.5
+            if (max_overhead <= 0.0) {
+                fprintf(stderr, "Orçamento de overhead inválido: %s\n", argv[ai]);
+                return 1;
+            }
+        }
+        if (strcmp(argv[ai], "--smaps") == 0 && ai + 1 < argc) {
+            smaps_interval = atof(argv[++ai]);
+            if (smaps_interval <= 0.0) {
+                fprintf(stderr, "Intervalo de smaps inválido: %s\n", argv[ai]);
+                return 1;
+            }
         }
+        if (strcmp(argv[ai], "--smaps-children") == 0) smaps_children = 1;
+        if (strcmp(argv[ai], "--perf") == 0) perf_mode = 1;
+        if (strcmp(argv[ai], "--schedstat") == 0) sched_mode = 1;
+        if (strcmp(argv[ai], "--net") == 0) net_mode = 1;
+        if (strcmp(argv[ai], "--fds") == 0) fd_mode = 1;
+        if (strcmp(argv[ai], "--fd-sockets") == 0) fd_sockets = 1;
+        if (strcmp(argv[ai], "--wss") == 0 && ai + 1 < argc) wss_pid = atoi(argv[++ai]);
+        if (strcmp(argv[ai], "--wss-window") == 0 && ai + 1 < argc) wss_window = atof(argv[++ai]);
+        if (strcmp(argv[ai], "--wss-windows") == 0 && ai + 1 < argc) wss_windows = atoi(argv[++ai]);
+        if (strcmp(argv[ai], "--wss-method") == 0 && ai + 1 < argc) {
+            wss_method = wss_method_parse(argv[++ai]);
+            if (wss_method < 0) {
+                fprintf(stderr, "Método de WSS inválido: %s (use auto, idle ou refs)\n", argv[ai]);
+                return 1;
+            }
+        }
+        if (strcmp(argv[ai], "--wss-apply") == 0 && ai + 1 < argc) wss_apply = argv[++ai];
+        if (strcmp(argv[ai], "--wss-headroom") == 0 && ai + 1 < argc) wss_headroom = atof(argv[++ai]);
+        if (strcmp(argv[ai], "--offcpu") == 0 && ai + 1 < argc) offcpu_pid = atoi(argv[++ai]);
+        if (strcmp(argv[ai], "--offcpu-hz") == 0 && ai + 1 < argc) offcpu_hz = atof(argv[++ai]);
+        if (strcmp(argv[ai], "--offcpu-duration") == 0 && ai + 1 < argc) offcpu_duration = atof(argv[++ai]);
+        if (strcmp(argv[ai], "--pin-cpu") == 0 && ai + 1 < argc) pin_cpu = atoi(argv[++ai]);
+        if (strcmp(argv[ai], "--io-backend") == 0 && ai + 1 < argc) {
+            io_backend = batchread_backend_parse(argv[++ai]);
+            if (io_backend < 0) {
+                fprintf(stderr, "Backend de leitura inválido: %s (use auto, uring ou pread)\n", argv[ai]);
+                return 1;
+            }
+        }
+        if (strcmp(argv[ai], "--top") == 0) {
+            top_interval = 1.0;
+            if (ai + 1 < argc && atof(argv[ai + 1]) > 0.0) top_interval = atof(argv[++ai]);
+        }
+        if (strcmp(argv[ai], "--make-fixture") == 0 && ai + 1 < argc) fixture_dir = argv[++ai];
+        if (strcmp(argv[ai], "--procs") == 0 && ai + 1 < argc) fixture.nprocs = (size_t)atol(argv[++ai]);
+        if (strcmp(argv[ai], "--task-threads") == 0 && ai + 1 < argc) fixture.threads = atoi(argv[++ai]);
+        if (strcmp(argv[ai], "--groups") == 0 && ai + 1 < argc) fixture.ngroups = atoi(argv[++ai]);
+        if (strcmp(argv[ai], "--tick") == 0 && ai + 1 < argc) fixture.tick = strtoul(argv[++ai], NULL, 10);
+        if (strcmp(argv[ai], "--follow") == 0 && ai + 1 < argc) fixture_follow = atof(argv[++ai]);
+        if (strcmp(argv[ai], "--raw-minutes") == 0 && ai + 1 < argc) raw_minutes = atof(argv[++ai]);
+        if (strcmp(argv[ai], "--tier-10s-hours") == 0 && ai + 1 < argc) tier_10s_hours = atof(argv[++ai]);
+        if (strcmp(argv[ai], "--tier-1m-days") == 0 && ai + 1 < argc) tier_1m_days = atof(argv[++ai]);
+        if (strcmp(argv[ai], "--export-tier") == 0 && ai + 1 < argc) {
+            export_tier = rollup_tier_parse(argv[++ai]);
+            if (export_tier < 0) {
+                fprintf(stderr, "Tier inválido: %s (use raw, 10s ou 1m)\n", argv[ai]);
+                return 1;
+            }
+        }
+    }
+
+    /* a reexpansão da supressão repete a última linha a cada `interval`; com o
+       intervalo adaptativo o espaçamento real muda e a série sairia errada */
+    if (suppression.enabled && max_overhead > 0.0) {
+        fprintf(stderr, "--suppress não pode ser combinado com --max-overhead (intervalo variável)\n");
+        return 1;
+    }
+
+    /* o resumo inclui a espera na fila de CPU e o tráfego de rede */
+    if (summary_mode) sched_mode = net_mode = 1;
+    /* os estados TCP saem dos sockets listados em /proc/<pid>/fd */
+    if (fd_sockets) fd_mode = 1;
+
+    /* Sem --fields: as colunas originais mais as dos coletores opcionais ligados. */
+    char default_fields[64] = "default";
+    if (!fields_spec) {
+        if (perf_mode) strcat(default_fields, ",perf");
+        if (sched_mode) strcat(default_fields, ",sched");
+        if (net_mode) strcat(default_fields, ",net");
+        if (fd_mode) strcat(default_fields, ",fd");
+        if (fd_sockets) strcat(default_fields, ",tcp");
+        fields_spec = default_fields;
+    }
+    if (export_set_fields(fields_spec) != 0) return 1;
+
+    if (replay_path) {
+        replay_options_t ropt = { anomaly_mode, anomaly_cfg, summary_mode, replay_threads };
+        if (!anomaly_mode && !summary_mode)
+            fprintf(stderr, "Aviso: --replay sem --anomaly nem --summary só valida a gravação.\n");
+        return replay_run(replay_path, &ropt) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (fixture_dir) {
+        if (fixture.threads < 1) fixture.threads = 1;
+        if (procfixture_write(fixture_dir, &fixture) != 0) return EXIT_FAILURE;
+        printf("Árvore sintética em %s: %zu processos x %d threads, %d cgroups, tick %lu\n"
+               "Use: --proc-root %s/proc --cgroup-root %s/cgroup (PIDs %d..%d)\n",
+               fixture_dir, fixture.nprocs, fixture.threads, fixture.ngroups, fixture.tick, fixture_dir,
+               fixture_dir, procfixture_pid(&fixture, 0), procfixture_pid(&fixture, fixture.nprocs - 1));
+        while (fixture_follow > 0.0) {
+            usleep((useconds_t)(fixture_follow * 1e6));
+            fixture.tick++;
+            if (procfixture_write(fixture_dir, &fixture) != 0) return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    if (wss_pid > 0) {
+        if (!check_process_exists(wss_pid)) return EXIT_FAILURE;
+        if (wss_window <= 0.0) wss_window = 10.0;
+        FILE *wout = NULL;
+        if (query_out) {
+            wout = fopen(query_out, "w");
+            if (!wout) {
+                perror("Erro ao criar arquivo de saída");
+                return EXIT_FAILURE;
+            }
+            fprintf(wout, "timestamp,pid,method,window_s,wss_kb,rss_kb,pages,syscalls,scan_ms\n");
+        }
+        signal(SIGINT, handle_sigint);
+        unsigned long peak_kb = 0;
+        int rc = 0;
+        for (int w = 0; running && (wss_windows <= 0 || w < wss_windows); w++) {
+            wss_result_t r;
+            if (wss_measure(wss_pid, wss_window, (wss_method_t)wss_method, &r) != 0) {
+                rc = -1;
+                break;
+            }
+            if (r.wss_kb > peak_kb) peak_kb = r.wss_kb;
+            printf("[WSS] PID %d | janela %.1f s | ativo %lu KB de %lu KB residentes (%.1f%%) | "
+                   "método %s | varredura %.1f ms",
+                   wss_pid, r.window_s, r.wss_kb, r.rss_kb,
+                   r.rss_kb ? 100.0 * (double)r.wss_kb / (double)r.rss_kb : 0.0,
+                   wss_method_name(r.method), r.scan_ms);
+            if (r.method == WSS_IDLE) printf(" (%zu páginas, %zu syscalls)", r.pages, r.syscalls);
+            printf("\n");
+            fflush(stdout);
+            if (wout) {
+                fprintf(wout, "%ld,%d,%s,%.3f,%lu,%lu,%zu,%zu,%.3f\n", (long)time(NULL), wss_pid,
+                        wss_method_name(r.method), r.window_s, r.wss_kb, r.rss_kb, r.pages,
+                        r.syscalls, r.scan_ms);
+                fflush(wout);
+            }
+        }
+        if (wout) fclose(wout);
+        if (rc == 0 && wss_apply && peak_kb > 0) {
+            long page = sysconf(_SC_PAGESIZE);
+            long high = (long)((double)peak_kb * 1024.0 * (1.0 + wss_headroom / 100.0));
+            high = (high + page - 1) / page * page;
+            printf("Maior WSS %lu KB + %.0f%% de folga\n", peak_kb, wss_headroom);
+            rc = cgroup_set_memory_high(wss_apply, high);
+        }
+        return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (offcpu_pid > 0) {
+        if (!check_process_exists(offcpu_pid)) return EXIT_FAILURE;
+        if (offcpu_hz <= 0.0 || offcpu_hz > 1000.0) {
+            fprintf(stderr, "Frequência de amostragem inválida: %.1f (use 1 a 1000 Hz)\n", offcpu_hz);
+            return EXIT_FAILURE;
+        }
+        static offcpu_t oc;     // histograma de tamanho fixo: fora da pilha
+        if (offcpu_init(&oc, offcpu_pid, offcpu_hz, (batchread_backend_t)io_backend) != 0) return EXIT_FAILURE;
+        signal(SIGINT, handle_sigint);
+        printf("Amostrando %zu threads de %d a %.0f Hz%s...\n", oc.nthreads, offcpu_pid, offcpu_hz,
+               offcpu_duration > 0.0 ? "" : " (Ctrl+C encerra)");
+        int rc = offcpu_run(&oc, offcpu_duration, &running);
+        if (rc == 0) {
+            offcpu_print(&oc, stdout, 20);
+            if (query_out) rc = offcpu_write_csv(&oc, query_out);
+        }
+        offcpu_free(&oc);
+        return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (top_interval > 0.0)
+        return top_run(top_interval, replay_threads, io_backend, monitor_proc_root()) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    if (summarize_dir)
+        return summarize_experiment(summarize_dir, query_out) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    if (query_path) {
+        FILE *qout = query_out ? fopen(query_out, "w") : stdout;
+        if (!qout) {
+            perror("Erro ao criar arquivo de saída");
+            return EXIT_FAILURE;
+        }
+        query_stats_t qs;
+        int rc = query_run(query_path, &query, qout, &qs);
+        if (query_out) fclose(qout);
+        if (rc == 0)
+            fprintf(stderr, "Consulta: %zu de %zu blocos lidos%s, %zu linhas avaliadas, %zu encontradas\n",
+                    qs.blocks_read, qs.blocks_total, qs.indexed ? "" : " (índice criado agora)",
+                    qs.rows_scanned, qs.rows_matched);
+        return rc == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
     }
 
     if (argc < 3) { // [cite: 63]
-        fprintf(stderr, "Uso (Monitor PID): %s <PID> <arquivo_saida.csv|.json> [intervalo]\n", argv[0]);
+        fprintf(stderr, "Uso (Monitor PID): %s <PID> <arquivo_saida.csv|.json|.rmb> [intervalo]\n", argv[0]);
+        fprintf(stderr, "Uso (Consulta):    %s --query <gravação.csv|.rmb> [--from T1] [--to T2] [--pid P] [--where campo>valor] [--out f.csv]\n", argv[0]);
+        fprintf(stderr, "Uso (Resumo):      %s --summarize <dir. do experimento> [--out <dir>]\n", argv[0]);
+        fprintf(stderr, "Uso (Top):         %s --top [intervalo] [--threads N] [--io-backend auto|uring|pread]\n", argv[0]);
+        fprintf(stderr, "Uso (WSS):         %s --wss <PID> [--wss-window s] [--wss-windows N] [--wss-method auto|idle|refs] [--wss-apply <grupo> [--wss-headroom pct]] [--out f.csv]\n", argv[0]);
+        fprintf(stderr, "Uso (Off-CPU):     %s --offcpu <PID> [--offcpu-hz N] [--offcpu-duration s] [--io-backend auto|uring|pread] [--out f.csv]\n", argv[0]);
+        fprintf(stderr, "Uso (Fixture):     %s --make-fixture <dir> [--procs N] [--task-threads T] [--groups G] [--tick K] [--follow s]\n", argv[0]);
+        fprintf(stderr, "Uso (Replay):      %s --replay <gravação.csv|.json|.rmb> [--anomaly ...] [--summary] [--threads N]\n", argv[0]);
         fprintf(stderr, "Uso (Namespace):   %s --ns-list <PID> | --ns-find <tipo> <inode> | ...\n", argv[0]);
-        fprintf(stderr, "Uso (Cgroup):      %s --cg-create <grupo> | --cg-add-pid <grupo> <PID> | ...\n", argv[0]);
-        fprintf(stderr, "Uso: %s <PID> <arquivo_saida.csv|.json> [intervalo]\n", argv[0]);
+        fprintf(stderr, "Uso (Cgroup):      %s --cg-create <grupo> | --cg-add-pid <grupo> <PID> | --cg-set-mem-high <grupo> <MB> | ...\n", argv[0]);
+        fprintf(stderr, "Opções (Monitor):  --fields cpu_percent,rss_kb,... | --suppress <eps> [--heartbeat <s>] | --long-run [--export-tier raw|10s|1m] | --summary | --ui | --anomaly [--anomaly-threshold z] [--anomaly-detectors ewma,mad,seasonal,zscore] [--anomaly-vote all|any] [--cgroup <grupo>] [--oom-horizon s] | --pin-cpu <n> | --self-stats | --max-overhead <pct>%% | --smaps <s> [--smaps-children] | --perf\n");
+        fprintf(stderr, "Opções (todos):    --proc-root <dir> | --cgroup-root <dir>\n");
         return 1;
     }
     
     pid_t pid = atoi(argv[1]);
     const char *outfile = argv[2];
-    int interval = (argc >= 4) ? atoi(argv[3]) : 1;
+    int interval = (argc >= 4 && strncmp(argv[3], "--", 2) != 0) ? atoi(argv[3]) : 1;
 
     if (!check_process_exists(pid))
         return EXIT_FAILURE;
 
+    suppression.interval_s = interval;
+    export_set_suppression(&suppression);
+
     signal(SIGINT, handle_sigint);
 
     /* initialize ncurses UI if requested */
@@ -318,71 +703,145 @@ int main(int argc, char *argv[]) {
     if (!ui_mode)
         printf("Monitorando PID %d a cada %d s... (Ctrl+C para sair)\n", pid, interval);
 
-    proc_metrics_t *data = NULL;
-    size_t count = 0;
-
-    /* prepare anomaly detection state and anomalies output file */
-    running_stats_t rs_cpu;
-    running_stats_t rs_writebps;
-    rs_init(&rs_cpu);
-    rs_init(&rs_writebps);
-    FILE *anfp = NULL;
+    /* Armazenamento com memória fixa: buffer circular das amostras brutas
+       (1000 amostras no modo normal, as últimas --raw-minutes em --long-run)
+       e, em --long-run, agregados de 10 s e 1 min. */
+    size_t raw_cap = 1000, cap_10s = 0, cap_1m = 0;
+    if (long_run) {
+        raw_cap = (size_t)(raw_minutes * 60.0 / (interval > 0 ? interval : 1));
+        cap_10s = (size_t)(tier_10s_hours * 360.0);
+        cap_1m = (size_t)(tier_1m_days * 1440.0);
+    }
+    rollup_store_t store;
+    if (rollup_store_init(&store, pid, raw_cap, cap_10s, cap_1m) != 0) {
+        perror("Erro de alocação");
+        return EXIT_FAILURE;
+    }
+    if (long_run && !ui_mode)
+        printf("Modo longa duração: %zu amostras brutas, %zu janelas de 10 s, %zu de 1 min (%.1f MB)\n",
+               store.raw_cap, cap_10s, cap_1m, rollup_store_bytes(&store) / (1024.0 * 1024.0));
+
+    /* sketches de quantis (memória constante, atualizados a cada amostra) */
+    metric_summary_t summary;
+    metric_summary_init(&summary, pid);
+
+    /* motores de anomalia: um para as métricas do processo, outro para cgroup/PSI */
+    anomaly_engine_t an_proc, an_cg;
+    anomaly_sink_t sink_proc = {0}, sink_cg = {0};
+    sink_proc.key = "pid";
+    snprintf(sink_proc.label, sizeof(sink_proc.label), "%d", pid);
+    sink_cg.key = "cgroup";
+    snprintf(sink_cg.label, sizeof(sink_cg.label), "%s", cgroup_name ? cgroup_name : "system");
+    sink_cg.quoted = 1;
+    sink_proc.ui = sink_cg.ui = ui_mode;
     if (anomaly_mode) {
+        anomaly_metric_t metrics[ANOMALY_MAX_METRICS];
+        size_t nm = anomaly_proc_metrics(metrics, ANOMALY_MAX_METRICS);
+        if (anomaly_engine_init(&an_proc, 1, metrics, nm, &anomaly_cfg) != 0)
+            return EXIT_FAILURE;
+        nm = anomaly_cgroup_metrics(metrics, ANOMALY_MAX_METRICS);
+        if (anomaly_engine_init(&an_cg, 1, metrics, nm, &anomaly_cfg) != 0) {
+            anomaly_engine_free(&an_proc);
+            return EXIT_FAILURE;
+        }
+
         char anpath[512];
         snprintf(anpath, sizeof(anpath), "%s.anomalies.jsonl", outfile);
-        anfp = fopen(anpath, "w");
+        FILE *anfp = fopen(anpath, "w");
         if (!anfp) {
             fprintf(stderr, "Aviso: não foi possível abrir arquivo de anomalias %s: %s\n", anpath, strerror(errno));
-            anomaly_mode = 0; /* disable to avoid further errors */
         } else {
-            fprintf(anfp, "# JSON Lines: timestamp,metric,value,zscore\n");
+            fprintf(anfp, "# JSON Lines: timestamp,pid|cgroup,metric,value,z,detectors\n");
             fflush(anfp);
         }
+        sink_proc.fp = sink_cg.fp = anfp;
     }
 
-    while (running && count < 1000) {
-        data = realloc(data, (count + 1) * sizeof(proc_metrics_t));
-        if (!data) {
-            perror("Erro de alocação");
-            return EXIT_FAILURE;
-        }
-
-        proc_metrics_t *m = &data[count];
-        memset(m, 0, sizeof(*m));
-
-        m->pid = pid;
-        m->timestamp = time(NULL);
-
-        /* inicializa taxas para o caso de primeira amostra */
-        m->rchar_per_s = 0.0;
-        m->wchar_per_s = 0.0;
-        m->read_bytes_per_s = 0.0;
-        m->write_bytes_per_s = 0.0;
-        m->syscalls_per_s = 0.0;
-
-        /* COLETA COMPLETA */
-        monitor_cpu_usage(pid, &m->cpu_percent);
-        monitor_memory_usage(pid, &m->rss_kb, &m->vmsize_kb, &m->minflt, &m->majflt, &m->swap_kb);
-        monitor_io_usage(pid, &m->rchar, &m->wchar, &m->read_bytes, &m->write_bytes, &m->syscalls);
-
-         /* calcula taxas por segundo a partir da amostra anterior, se existir */
-         if (count > 0) {
-             proc_metrics_t *prev = &data[count - 1];
-             double dt = m->timestamp - prev->timestamp;
-             if (dt <= 0.0) dt = 1.0; /* fallback seguro */
+    /* tendência de memória e tempo até o limite (RSS do processo e memory.current do cgroup) */
+    int trend_mode = anomaly_mode || ui_mode;
+    oom_watch_t oom_rss = { .metric = "rss_bytes", .eta_s = INFINITY };
+    oom_watch_t oom_cg = { .metric = "cg_mem_current", .eta_s = INFINITY };
+    trend_init(&oom_rss.tr, trend_half_life);
+    trend_init(&oom_cg.tr, trend_half_life);
+    oom_watch_t fd_watch = { .metric = "fd_count", .eta_s = INFINITY };
+    trend_init(&fd_watch.tr, trend_half_life);
+
+    /* A coleta roda numa thread própria, em cadência fixa; este laço só
+       consome as amostras prontas (terminal/UI, anomalias, armazenamento),
+       de modo que uma saída lenta não atrasa a próxima leitura. */
+    char smaps_path[512];
+    snprintf(smaps_path, sizeof(smaps_path), "%s.smaps.csv", outfile);
+    sampler_config_t scfg = {
+        .pid = pid,
+        .interval_ms = (long)interval * 1000L,
+        .max_samples = long_run ? 0 : 1000,
+        .cgroup_name = cgroup_name,
+        .collect_cgroup = trend_mode,
+        .pin_cpu = pin_cpu,
+        .max_overhead_pct = max_overhead,
+        .smaps_interval_ms = (long)(smaps_interval * 1000.0),
+        .smaps_children = smaps_children,
+        .smaps_csv = smaps_interval > 0.0 ? smaps_path : NULL,
+        .perf = perf_mode,
+        .schedstat = sched_mode,
+        .net = net_mode,
+        .fds = fd_mode,
+        .fd_sockets = fd_sockets,
+    };
+    sampler_t sampler;
+    monitor_set_verbose(0);     // a thread de coleta não escreve no terminal
+    selfstats_enable(self_stats);
+    if (sampler_start(&sampler, &scfg) != 0) {
+        rollup_store_free(&store);
+        return EXIT_FAILURE;
+    }
+    sample_item_t item;
 
-             m->rchar_per_s = (double)(m->rchar - prev->rchar) / dt;
-             m->wchar_per_s = (double)(m->wchar - prev->wchar) / dt;
-             m->read_bytes_per_s = (double)(m->read_bytes - prev->read_bytes) / dt;
-             m->write_bytes_per_s = (double)(m->write_bytes - prev->write_bytes) / dt;
-             m->syscalls_per_s = (double)(m->syscalls - prev->syscalls) / dt;
-         }
+    for (;;) {
+#ifdef USE_NCURSES
+        if (ui_mode) {
+            int ch = getch();
+            if (ch == 'q' || ch == 'Q') running = 0;
+        }
+#endif
+        if (!running) sampler_stop(&sampler);   // a fila ainda é esvaziada abaixo
+        int got = sampler_next(&sampler, &item, 200);
+        if (got < 0) break;
+        if (got == 0) continue;
+
+        proc_metrics_t *m = &item.m;
+        const cgroup_metrics_t *cg = &item.cg;
+
+        if (trend_mode) {
+            /* a tendência do RSS anda a cada amostra; o limite (memory.max do cgroup, senão o
+               que ainda cabe na memória do sistema) vem da leitura de cgroup, e quando ela é
+               cortada pelo orçamento vale o último limite lido */
+            double rss_bytes = (double)m->rss_kb * 1024.0;
+            double rss_limit = oom_rss.limit;
+            if (item.cg_valid)
+                rss_limit = item.cg_mem_max ? (double)item.cg_mem_max
+                                            : rss_bytes + (double)item.mem_avail_kb * 1024.0;
+            oom_watch_update(&oom_rss, m->timestamp, rss_bytes, rss_limit, oom_horizon, &sink_proc);
+
+            /* o uso do cgroup só existe nas amostras em que ele foi lido */
+            if (cgroup_name && item.cg_valid) {
+                double cur = (double)cg->mem.current;
+                double cg_limit = item.cg_mem_max ? (double)item.cg_mem_max
+                                                  : cur + (double)item.mem_avail_kb * 1024.0;
+                oom_watch_update(&oom_cg, m->timestamp, cur, cg_limit, oom_horizon, &sink_cg);
+            }
+        }
+        if (trend_mode && fd_mode && m->fd_count > 0)
+            fd_watch_update(&fd_watch, m->timestamp, (double)m->fd_count, (double)m->fd_limit,
+                            oom_horizon, &sink_proc);
 
         if (ui_mode) {
 #ifdef USE_NCURSES
-            clear();
+            erase();    // só as células alteradas vão para o terminal
             attron(A_BOLD);
-            mvprintw(0, 0, "Resource Monitor - PID %d   Interval %d s", pid, interval);
+            char shed_buf[64];
+            mvprintw(0, 0, "Resource Monitor - PID %d   Interval %.2f s", pid, item.interval_ms / 1e3);
+            if (item.shed) printw("   (cortados: %s)", shed_list(item.shed, shed_buf, sizeof(shed_buf)));
             attroff(A_BOLD);
             mvprintw(2, 0, "Timestamp: %.0f", m->timestamp);
             mvprintw(4, 0, "CPU: ");
@@ -391,18 +850,61 @@ int main(int argc, char *argv[]) {
             else attron(COLOR_PAIR(3));
             mvprintw(4, 6, "%.2f%%", m->cpu_percent);
             attroff(COLOR_PAIR(1)); attroff(COLOR_PAIR(2)); attroff(COLOR_PAIR(3));
+            if (sched_mode) {
+                if (m->cpu_wait_ms_per_s > 0.5 * m->cpu_run_ms_per_s && m->cpu_wait_ms_per_s > 10.0)
+                    attron(COLOR_PAIR(3));
+                mvprintw(4, 18, "Run: %.1f ms/s   Fila: %.1f ms/s (%.0f us/fatia)",
+                         m->cpu_run_ms_per_s, m->cpu_wait_ms_per_s, m->wait_per_slice_us);
+                attroff(COLOR_PAIR(3));
+            }
 
             mvprintw(5, 0, "RSS: %lu KB   VSZ: %lu KB", m->rss_kb, m->vmsize_kb);
+            if (perf_mode)
+                mvprintw(9, 0, "TaskClock: %.1f ms/s  CtxSw/s: %.1f  Migr/s: %.1f  Faults/s: %.1f  IPC: %.2f",
+                         m->task_clock_ms_per_s, m->ctx_switches_per_s, m->cpu_migrations_per_s,
+                         m->page_faults_per_s, m->ipc);
+            if (item.smaps_procs > 0)
+                mvprintw(6, 0, "PSS: %lu KB   USS: %lu KB   Swap PSS: %lu KB   (%d processos)",
+                         item.smaps.pss_kb, item.smaps.private_clean_kb + item.smaps.private_dirty_kb,
+                         item.smaps.swap_pss_kb, item.smaps_procs);
             mvprintw(7, 0, "Read/s: %.2f  Write/s: %.2f", m->read_bytes_per_s, m->write_bytes_per_s);
             mvprintw(8, 0, "RChar/s: %.2f  WChar/s: %.2f  Sys/s: %.2f", m->rchar_per_s, m->wchar_per_s, m->syscalls_per_s);
             mvprintw(10, 0, "RChar/WChar: %llu/%llu  Read/Write: %llu/%llu  Syscalls: %llu", m->rchar, m->wchar, m->read_bytes, m->write_bytes, m->syscalls);
-            mvprintw(12, 0, "Press 'q' to quit.");
-            refresh();
-
-            int ch = getch();
-            if (ch == 'q' || ch == 'Q') {
-                running = 0;
+            oom_watch_t *ws[2] = { &oom_rss, &oom_cg };
+            for (int wi = 0; wi < 2; wi++) {
+                oom_watch_t *w = ws[wi];
+                if (!w->has_est) continue;
+                if (w->eta_s <= oom_horizon) attron(COLOR_PAIR(3));
+                if (isinf(w->eta_s))
+                    mvprintw(11 + wi, 0, "Trend %s: %+.1f KB/s  limite %.1f MB  (sem previsão de OOM)",
+                             w->metric, w->est.slope / 1024.0, w->limit / (1024.0 * 1024.0));
+                else
+                    mvprintw(11 + wi, 0, "Trend %s: %+.1f KB/s  limite %.1f MB  OOM em %.0f s",
+                             w->metric, w->est.slope / 1024.0, w->limit / (1024.0 * 1024.0), w->eta_s);
+                attroff(COLOR_PAIR(3));
+            }
+            if (net_mode)
+                mvprintw(13, 0, "Rede (netns): rx %.1f KB/s  tx %.1f KB/s  pkts %.0f/%.0f  drops %.1f/s  retrans %.1f/s",
+                         m->net_rx_bytes_per_s / 1024.0, m->net_tx_bytes_per_s / 1024.0, m->net_rx_packets_per_s,
+                         m->net_tx_packets_per_s, m->net_drops_per_s, m->tcp_retrans_per_s);
+            if (fd_mode) {
+                if (fd_watch.eta_s <= oom_horizon) attron(COLOR_PAIR(3));
+                mvprintw(14, 0, "FDs: %lu/%lu  (arquivos %lu  sockets %lu  pipes %lu  eventfd %lu  anon %lu)  %+.2f/s",
+                         m->fd_count, m->fd_limit, m->fd_files, m->fd_sockets, m->fd_pipes, m->fd_eventfds,
+                         m->fd_anon, m->fd_growth_per_s);
+                if (!isinf(fd_watch.eta_s)) printw("  esgota em %.0f s", fd_watch.eta_s);
+                attroff(COLOR_PAIR(3));
             }
+            if (fd_sockets)
+                mvprintw(15, 0, "TCP: %lu estab  %lu listen  %lu close_wait  %lu outros",
+                         m->tcp_established, m->tcp_listen, m->tcp_close_wait, m->tcp_other);
+            /* avisos de anomalia e de OOM em vez do printf do modo texto */
+            attron(COLOR_PAIR(3));
+            if (sink_proc.alert[0]) mvprintw(16, 0, "%s", sink_proc.alert);
+            if (sink_cg.alert[0]) mvprintw(17, 0, "%s", sink_cg.alert);
+            attroff(COLOR_PAIR(3));
+            mvprintw(18, 0, "Press 'q' to quit.");
+            refresh();
 #else
             /* fall back if built without ncurses */
             printf("[%.0f] CPU: %.2f%% | RSS: %lu KB | VSZ: %lu KB "
@@ -415,36 +917,50 @@ int main(int argc, char *argv[]) {
         } else {
             printf("[%.0f] CPU: %.2f%% | RSS: %lu KB | VSZ: %lu KB "
                 "| RChar/WChar: %llu/%llu | Read/Write: %llu/%llu | Syscalls: %llu "
-                "| RChar/s: %.2f | WChar/s: %.2f | Read/s: %.2f | Write/s: %.2f | Sys/s: %.2f\n",
+                "| RChar/s: %.2f | WChar/s: %.2f | Read/s: %.2f | Write/s: %.2f | Sys/s: %.2f",
                 m->timestamp, m->cpu_percent, m->rss_kb, m->vmsize_kb,
                 m->rchar, m->wchar, m->read_bytes, m->write_bytes, m->syscalls,
                 m->rchar_per_s, m->wchar_per_s, m->read_bytes_per_s, m->write_bytes_per_s, m->syscalls_per_s);
+            if (sched_mode) printf(" | Fila CPU: %.1f ms/s", m->cpu_wait_ms_per_s);
+            if (net_mode)
+                printf(" | Rede: rx %.1f tx %.1f KB/s",
+                       m->net_rx_bytes_per_s / 1024.0, m->net_tx_bytes_per_s / 1024.0);
+            if (fd_mode) printf(" | FDs: %lu (%+.1f/s)", m->fd_count, m->fd_growth_per_s);
+            if (fd_sockets)
+                printf(" | TCP: %lu estab, %lu close_wait", m->tcp_established, m->tcp_close_wait);
+            if (perf_mode) {
+                printf(" | TaskClock: %.1f ms/s | CtxSw/s: %.1f | Migr/s: %.1f | Faults/s: %.1f",
+                       m->task_clock_ms_per_s, m->ctx_switches_per_s, m->cpu_migrations_per_s,
+                       m->page_faults_per_s);
+                if (m->cycles_per_s > 0.0) printf(" | IPC: %.2f | CacheMiss/s: %.1f", m->ipc, m->cache_misses_per_s);
+            }
+            if (item.smaps_procs > 0)
+                printf(" | PSS: %lu KB | USS: %lu KB", item.smaps.pss_kb,
+                       item.smaps.private_clean_kb + item.smaps.private_dirty_kb);
+            printf("\n");
         }
 
-        /* Online anomaly detection (simple z-score on CPU% and write bytes/sec) */
+        /* Detecção online: todas as métricas do processo e do cgroup/PSI */
         if (anomaly_mode) {
-            double zcpu = 0.0, zw = 0.0;
-            if (rs_cpu.count >= 2) zcpu = rs_zscore(&rs_cpu, m->cpu_percent);
-            if (rs_writebps.count >= 2) zw = rs_zscore(&rs_writebps, m->write_bytes_per_s);
-
-            /* update stats after computing z so first stable values are not mis-detected */
-            rs_update(&rs_cpu, m->cpu_percent);
-            rs_update(&rs_writebps, m->write_bytes_per_s);
-
-            if (fabs(zcpu) >= anomaly_threshold) {
-                printf("!! Anomaly detected (CPU) ts=%.0f value=%.2f z=%.2f\n", m->timestamp, m->cpu_percent, zcpu);
-                if (anfp) fprintf(anfp, "{\"timestamp\": %.0f, \"metric\": \"cpu_percent\", \"value\": %.6f, \"z\": %.6f}\n", m->timestamp, m->cpu_percent, zcpu);
+            anomaly_fill_proc(anomaly_engine_row(&an_proc, 0), m);
+            anomaly_engine_tick(&an_proc, m->timestamp, report_anomaly, &sink_proc);
+            double maxz = anomaly_engine_max_z(&an_proc);
+            if (item.cg_valid) {
+                anomaly_fill_cgroup(anomaly_engine_row(&an_cg, 0), cg);
+                anomaly_engine_tick(&an_cg, m->timestamp, report_anomaly, &sink_cg);
+                double zc = anomaly_engine_max_z(&an_cg);
+                if (zc > maxz) maxz = zc;
             }
-            if (fabs(zw) >= anomaly_threshold) {
-                printf("!! Anomaly detected (write_bps) ts=%.0f value=%.2f z=%.2f\n", m->timestamp, m->write_bytes_per_s, zw);
-                if (anfp) fprintf(anfp, "{\"timestamp\": %.0f, \"metric\": \"write_bytes_per_s\", \"value\": %.6f, \"z\": %.6f}\n", m->timestamp, m->write_bytes_per_s, zw);
-            }
-            if (anfp) fflush(anfp);
+            /* escores subindo em direção ao limiar: a coleta encurta o intervalo */
+            sampler_hint(&sampler, maxz >= 0.5 * anomaly_cfg.threshold);
+
+            if (sink_proc.fp) fflush(sink_proc.fp);
         }
 
-        count++;
-        sleep(interval);
+        rollup_store_add(&store, m);
+        metric_summary_add(&summary, m);
     }
+    sampler_finish(&sampler);
 
     printf("\nEncerrando e exportando para %s...\n", outfile);
 
@@ -454,15 +970,60 @@ int main(int argc, char *argv[]) {
         endwin();
 #endif
     }
+    printf("Coleta: %zu amostras, %zu descartadas (fila cheia), atraso máximo do despertar %.1f ms\n",
+           atomic_load(&sampler.produced), atomic_load(&sampler.dropped), sampler.max_lag_ms);
+    if (max_overhead > 0.0) {
+        const sampler_budget_t *b = &sampler.budget;
+        char shed_buf[64];
+        printf("Orçamento: %.2f%% de CPU; intervalo final %ld ms (%ld..%ld), %zu alargamentos, "
+               "%zu apertos, coletores cortados: %s\n", b->budget_pct, b->interval_ms, b->min_ms, b->max_ms,
+               b->widened, b->tightened, b->shed ? shed_list(b->shed, shed_buf, sizeof(shed_buf)) : "nenhum");
+    }
+    if (perf_mode)
+        printf("perf: %s%s%s\n", sampler.perf_ok ? "contadores de software" : "indisponível",
+               sampler.perf.has_hw ? " + hardware (cycles/instructions/cache-misses)" : "",
+               sampler.perf.user_only ? ", só modo usuário (perf_event_paranoid)" : "");
+    if (smaps_interval > 0.0) {
+        const sampler_smaps_stats_t *st = &sampler.smaps;
+        printf("smaps_rollup: %zu passadas (%zu puladas pelo orçamento, %zu leituras falharam), "
+               "CPU médio %.2f ms, máximo %.2f ms, intervalo final %ld ms -> %s\n",
+               st->passes, st->skipped, st->failed,
+               st->passes ? st->cost_ms_sum / (double)st->passes : 0.0, st->cost_ms_max,
+               st->interval_ms, smaps_path);
+    }
 
-    if (strstr(outfile, ".csv"))
-        export_metrics_csv(outfile, data, count);
-    else if (strstr(outfile, ".json"))
-        export_metrics_json(outfile, data, count);
+    self_probe_t probe;
+    selfstats_begin(&probe);
+    if (strstr(outfile, ".csv") || strstr(outfile, ".json") || strstr(outfile, ".rmb"))
+        rollup_export(&store, (rollup_tier_id_t)export_tier, outfile);
     else
-        fprintf(stderr, "Formato não reconhecido (use .csv ou .json)\n");
+        fprintf(stderr, "Formato não reconhecido (use .csv, .json ou .rmb)\n");
+    selfstats_end(&probe, SELF_EXPORT);
+
+    if (summary_mode) {
+        char sumpath[512];
+        snprintf(sumpath, sizeof(sumpath), "%s.summary.%s", outfile,
+                 strstr(outfile, ".json") ? "json" : "csv");
+        metric_summary_print(&summary);
+        selfstats_begin(&probe);
+        if (export_summary(sumpath, &summary, 1) != 0)
+            fprintf(stderr, "Aviso: não foi possível gravar resumo em %s\n", sumpath);
+        selfstats_end(&probe, SELF_EXPORT);
+    }
+
+    if (self_stats) {
+        selfstats_print(stdout);
+        selfstats_write(outfile);
+        selfstats_thread_done();
+    }
+
+    if (anomaly_mode) {
+        if (sink_proc.fp) fclose(sink_proc.fp);
+        anomaly_engine_free(&an_proc);
+        anomaly_engine_free(&an_cg);
+    }
 
-    free(data);
+    rollup_store_free(&store);
     printf("Exportação concluída.\n");
     return EXIT_SUCCESS;
 }
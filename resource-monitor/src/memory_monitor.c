@@ -1,6 +1,9 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <errno.h>
 #include "monitor.h"
 
@@ -15,7 +18,7 @@ int monitor_memory_usage(
     unsigned long *majflt,
     unsigned long *swap_kb
 ) {
-    char path[128];
+    char path[300];
     FILE *fp;
     char line[256];
 
@@ -28,14 +31,14 @@ int monitor_memory_usage(
     // -------------------------------------------------------------
     // 1) Ler /proc/[pid]/status (RSS, VSZ, Swap)
     // -------------------------------------------------------------
-    snprintf(path, sizeof(path), "/proc/%d/status", pid);
+    snprintf(path, sizeof(path), "%s/%d/status", monitor_proc_root(), pid);
     fp = fopen(path, "r");
 
     if (!fp) {
         if (errno == ENOENT)
             fprintf(stderr, "⚠️  Processo %d não existe mais.\n", pid);
         else if (errno == EACCES)
-            fprintf(stderr, "🔒 Sem permissão para ler /proc/%d/status\n", pid);
+            fprintf(stderr, "🔒 Sem permissão para ler %s\n", path);
         return -1;
     }
 
@@ -53,7 +56,7 @@ int monitor_memory_usage(
     //   10 = minflt
     //   12 = majflt
     // -------------------------------------------------------------
-    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    snprintf(path, sizeof(path), "%s/%d/stat", monitor_proc_root(), pid);
     fp = fopen(path, "r");
 
     if (fp) {
@@ -87,7 +90,7 @@ int monitor_memory_usage(
     // 3) Fallback se RSS ou VSZ vierem zerados
     // -------------------------------------------------------------
     if (*rss_kb == 0 && *vmsize_kb == 0) {
-        snprintf(path, sizeof(path), "/proc/%d/statm", pid);
+        snprintf(path, sizeof(path), "%s/%d/statm", monitor_proc_root(), pid);
         fp = fopen(path, "r");
         if (fp) {
             unsigned long total_pages = 0, resident_pages = 0;
@@ -103,8 +106,104 @@ int monitor_memory_usage(
     // -------------------------------------------------------------
     // Imprimir métricas
     // -------------------------------------------------------------
-    printf("[MEM] RSS=%lu KB | VSZ=%lu KB | Swap=%lu KB | minflt=%lu | majflt=%lu\n",
+    if (monitor_is_verbose())
+        printf("[MEM] RSS=%lu KB | VSZ=%lu KB | Swap=%lu KB | minflt=%lu | majflt=%lu\n",
            *rss_kb, *vmsize_kb, *swap_kb, *minflt, *majflt);
 
     return 0;
 }
+
+/**
+ * Lê MemAvailable e MemTotal de /proc/meminfo.
+ */
+int monitor_mem_available(unsigned long *mem_available_kb, unsigned long *mem_total_kb) {
+    char path[300];
+    snprintf(path, sizeof(path), "%s/meminfo", monitor_proc_root());
+    FILE *fp = fopen(path, "r");
+    if (!fp) return -1;
+
+    char line[256];
+    int found = 0;
+    *mem_available_kb = 0;
+    *mem_total_kb = 0;
+    while (fgets(line, sizeof(line), fp) && found < 2) {
+        if (sscanf(line, "MemTotal: %lu kB", mem_total_kb) == 1) found++;
+        else if (sscanf(line, "MemAvailable: %lu kB", mem_available_kb) == 1) found++;
+    }
+    fclose(fp);
+    return found == 2 ? 0 : -1;
+}
+
+/**
+ * Lê /proc/[pid]/smaps_rollup de uma vez (o arquivo tem ~1 KB) e separa os
+ * campos por nome; campos ausentes em kernels antigos ficam em 0.
+ */
+int monitor_smaps_rollup(pid_t pid, smaps_rollup_t *out) {
+    static const struct {
+        const char *key;
+        size_t off;
+    } k_fields[] = {
+        { "Rss:", offsetof(smaps_rollup_t, rss_kb) },
+        { "Pss:", offsetof(smaps_rollup_t, pss_kb) },
+        { "Pss_Anon:", offsetof(smaps_rollup_t, pss_anon_kb) },
+        { "Pss_File:", offsetof(smaps_rollup_t, pss_file_kb) },
+        { "Pss_Shmem:", offsetof(smaps_rollup_t, pss_shmem_kb) },
+        { "Shared_Clean:", offsetof(smaps_rollup_t, shared_clean_kb) },
+        { "Shared_Dirty:", offsetof(smaps_rollup_t, shared_dirty_kb) },
+        { "Private_Clean:", offsetof(smaps_rollup_t, private_clean_kb) },
+        { "Private_Dirty:", offsetof(smaps_rollup_t, private_dirty_kb) },
+        { "Swap:", offsetof(smaps_rollup_t, swap_kb) },
+        { "SwapPss:", offsetof(smaps_rollup_t, swap_pss_kb) },
+        { "Referenced:", offsetof(smaps_rollup_t, referenced_kb) },
+    };
+    char path[300];
+    char buf[4096];
+
+    memset(out, 0, sizeof(*out));
+    snprintf(path, sizeof(path), "%s/%d/smaps_rollup", monitor_proc_root(), pid);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == EACCES)
+            fprintf(stderr, "🔒 Sem permissão para ler %s\n", path);
+        return -1;
+    }
+    size_t len = 0;
+    ssize_t n;
+    while (len < sizeof(buf) - 1 && (n = read(fd, buf + len, sizeof(buf) - 1 - len)) > 0)
+        len += (size_t)n;
+    close(fd);
+    if (len == 0) return -1;    // processo sem mm (kernel thread/zumbi)
+    buf[len] = '\0';
+
+    int found = 0;
+    for (char *line = buf; line && *line; ) {
+        char *next = strchr(line, '\n');
+        if (next) *next++ = '\0';
+        for (size_t i = 0; i < sizeof(k_fields) / sizeof(k_fields[0]); i++) {
+            size_t kl = strlen(k_fields[i].key);
+            if (strncmp(line, k_fields[i].key, kl) == 0) {
+                *(unsigned long *)((char *)out + k_fields[i].off) = strtoul(line + kl, NULL, 10);
+                found++;
+                break;
+            }
+        }
+        line = next;
+    }
+    return found > 0 ? 0 : -1;
+}
+
+/**
+ * Filhos diretos pela thread principal (/proc/[pid]/task/[pid]/children,
+ * CONFIG_PROC_CHILDREN): é quem faz o fork nos servidores pré-fork.
+ */
+int monitor_children(pid_t pid, pid_t *out, size_t max) {
+    char path[320];
+    snprintf(path, sizeof(path), "%s/%d/task/%d/children", monitor_proc_root(), pid, pid);
+    FILE *fp = fopen(path, "r");
+    if (!fp) return -1;
+    size_t n = 0;
+    int child;
+    while (n < max && fscanf(fp, "%d", &child) == 1) out[n++] = (pid_t)child;
+    fclose(fp);
+    return (int)n;
+}
@@ -14,6 +14,7 @@
  */
 
 #include "namespace.h"
+#include "monitor.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -22,9 +23,6 @@
 #include <sys/stat.h>
 #include <errno.h>
 
-#ifndef PROC_PATH_PREFIX
-#define PROC_PATH_PREFIX "/proc"
-#endif
 
 
 /* lista de tipos de namespace conhecida (não utilizada diretamente) */
@@ -67,7 +65,7 @@ int list_namespaces(int pid, NamespaceList *list) {
     if (!list) return -1;
 
     char path[256];
-    snprintf(path, sizeof(path), "%s/%d/ns", PROC_PATH_PREFIX, pid);
+    snprintf(path, sizeof(path), "%s/%d/ns", monitor_proc_root(), pid);
 
     DIR *dir = opendir(path);
     if (!dir) {
@@ -142,8 +140,8 @@ int find_processes_in_namespace(const char *ns_type, const char *inode) {
         int pid = atoi(entry->d_name);
         if (pid <= 0) continue;
 
-        char ns_path[128];
-        snprintf(ns_path, sizeof(ns_path), "%s/%d/ns/%s", PROC_PATH_PREFIX, pid, ns_type);
+        char ns_path[320];
+        snprintf(ns_path, sizeof(ns_path), "%s/%d/ns/%s", monitor_proc_root(), pid, ns_type);
 
         /* stat para verificar existência e permissões */
         struct stat st;
@@ -247,7 +245,7 @@ static int ns_map_add_pid(ns_map_entry_t *e, int pid) {
  * Retorna 0 em sucesso, -1 em erro.
  */
 int generate_namespace_report() {
-    DIR *proc = opendir(PROC_PATH_PREFIX);
+    DIR *proc = opendir(monitor_proc_root());
     if (!proc) {
         perror("opendir(/proc)");
         return -1;
@@ -0,0 +1,306 @@
+/*
+ * src/net_monitor.c
+ *
+ * Contadores de rede por namespace de rede (net/dev e net/snmp vistos pelo
+ * alvo), o cache que lê cada namespace uma vez por tick e os estados dos
+ * sockets TCP do alvo (net/tcp e net/tcp6).
+ */
+
+#define _GNU_SOURCE
+#include "monitor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <time.h>
+
+#define NET_READ_CHUNK 4096
+#define NET_LINE_MAX 1024           // linhas de net/snmp (Icmp passa de 300 bytes)
+
+typedef void (*line_fn)(char *line, void *ctx);
+
+/* Lê o arquivo em blocos e entrega cada linha completa, sem alocar: net/dev
+   de um host com centenas de veths passa de dezenas de kB. */
+static int read_lines(const char *path, line_fn fn, void *ctx) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == EACCES)
+            fprintf(stderr, "🔒 Sem permissão para ler %s\n", path);
+        return -1;
+    }
+    char buf[NET_READ_CHUNK + NET_LINE_MAX];
+    size_t len = 0;
+    ssize_t n;
+    int any = 0;
+    while ((n = read(fd, buf + len, NET_READ_CHUNK)) > 0) {
+        any = 1;
+        len += (size_t)n;
+        buf[len] = '\0';
+        char *line = buf, *nl;
+        while ((nl = strchr(line, '\n'))) {
+            *nl = '\0';
+            fn(line, ctx);
+            line = nl + 1;
+        }
+        len -= (size_t)(line - buf);
+        if (len >= NET_LINE_MAX) len = 0;       // linha longa demais: descarta
+        memmove(buf, line, len);
+    }
+    close(fd);
+    if (len > 0) {
+        buf[len] = '\0';
+        fn(buf, ctx);
+    }
+    return any ? 0 : -1;
+}
+
+/* "  eth0: rx_bytes rx_packets errs drop fifo frame compressed multicast tx_bytes tx_packets errs drop ..." */
+static void dev_line(char *line, void *ctx) {
+    net_counters_t *c = ctx;
+    char *colon = strchr(line, ':');
+    if (!colon) return;     // as duas linhas de cabeçalho
+    char *name = line;
+    while (*name == ' ') name++;
+    if ((size_t)(colon - name) == 2 && strncmp(name, "lo", 2) == 0) return;
+
+    unsigned long long v[16];
+    if (sscanf(colon + 1, "%llu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
+               &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7],
+               &v[8], &v[9], &v[10], &v[11], &v[12], &v[13], &v[14], &v[15]) != 16)
+        return;
+    c->rx_bytes += v[0];
+    c->rx_packets += v[1];
+    c->rx_errs += v[2];
+    c->rx_drops += v[3];
+    c->tx_bytes += v[8];
+    c->tx_packets += v[9];
+    c->tx_errs += v[10];
+    c->tx_drops += v[11];
+    c->ifaces++;
+}
+
+/* net/snmp vem em pares "Tcp: Nome1 Nome2 ..." / "Tcp: v1 v2 ..." */
+typedef struct {
+    net_counters_t *c;
+    char names[NET_LINE_MAX];       // linha de nomes pendente
+} snmp_ctx_t;
+
+static const struct {
+    const char *proto;
+    const char *name;
+    size_t off;
+} k_snmp[] = {
+    { "Tcp:", "InSegs", offsetof(net_counters_t, tcp_in_segs) },
+    { "Tcp:", "OutSegs", offsetof(net_counters_t, tcp_out_segs) },
+    { "Tcp:", "RetransSegs", offsetof(net_counters_t, tcp_retrans) },
+    { "Udp:", "InDatagrams", offsetof(net_counters_t, udp_in) },
+    { "Udp:", "OutDatagrams", offsetof(net_counters_t, udp_out) },
+    { "Udp:", "InErrors", offsetof(net_counters_t, udp_errs) },
+};
+
+static void snmp_line(char *line, void *ctx) {
+    snmp_ctx_t *s = ctx;
+    char *sp = strchr(line, ' ');
+    if (!sp) return;
+    size_t plen = (size_t)(sp - line);
+    /* valores: mesma sigla da linha de nomes guardada e começam por dígito ou '-' */
+    if (s->names[0] && strncmp(s->names, line, plen) == 0 && s->names[plen] == ' ' &&
+        (sp[1] == '-' || (sp[1] >= '0' && sp[1] <= '9'))) {
+        char *nsave, *vsave;
+        char *nt = strtok_r(s->names + plen, " ", &nsave);
+        char *vt = strtok_r(sp, " ", &vsave);
+        for (; nt && vt; nt = strtok_r(NULL, " ", &nsave), vt = strtok_r(NULL, " ", &vsave)) {
+            for (size_t i = 0; i < sizeof(k_snmp) / sizeof(k_snmp[0]); i++) {
+                if (strlen(k_snmp[i].proto) == plen && strncmp(k_snmp[i].proto, line, plen) == 0 &&
+                    strcmp(k_snmp[i].name, nt) == 0)
+                    *(unsigned long long *)((char *)s->c + k_snmp[i].off) = strtoull(vt, NULL, 10);
+            }
+        }
+        s->names[0] = '\0';
+        return;
+    }
+    snprintf(s->names, sizeof(s->names), "%s", line);
+}
+
+int monitor_net_usage(pid_t pid, net_counters_t *out) {
+    char path[300];
+    memset(out, 0, sizeof(*out));
+    snprintf(path, sizeof(path), "%s/%d/net/dev", monitor_proc_root(), pid);
+    if (read_lines(path, dev_line, out) != 0) return -1;
+    /* sem IPv4 no namespace não há snmp: ficam só as interfaces */
+    snmp_ctx_t s;
+    s.c = out;
+    s.names[0] = '\0';
+    snprintf(path, sizeof(path), "%s/%d/net/snmp", monitor_proc_root(), pid);
+    read_lines(path, snmp_line, &s);
+    return 0;
+}
+
+unsigned long monitor_netns(pid_t pid) {
+    char path[300], link[64];
+    snprintf(path, sizeof(path), "%s/%d/ns/net", monitor_proc_root(), pid);
+    ssize_t n = readlink(path, link, sizeof(link) - 1);
+    if (n <= 0) return 0;
+    link[n] = '\0';
+    const char *b = strchr(link, '[');
+    return b ? strtoul(b + 1, NULL, 10) : 0;
+}
+
+/* ===================== SOCKETS TCP DO ALVO ====================== */
+
+/* estados do kernel (include/net/tcp_states.h), em hexadecimal na coluna st */
+#define TCP_ST_ESTABLISHED 0x01
+#define TCP_ST_TIME_WAIT 0x06
+#define TCP_ST_CLOSE 0x07
+#define TCP_ST_CLOSE_WAIT 0x08
+#define TCP_ST_LISTEN 0x0A
+
+typedef struct {
+    const unsigned long *inodes;    // ordenados
+    size_t n;
+    tcp_states_t *out;
+} tcp_ctx_t;
+
+static int has_inode(const unsigned long *v, size_t n, unsigned long ino) {
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (v[mid] == ino) return 1;
+        if (v[mid] < ino) lo = mid + 1;
+        else hi = mid;
+    }
+    return 0;
+}
+
+/* "   0: 0100007F:1F90 00000000:0000 0A 00000000:00000000 00:00000000 00000000  1000  0 12345 ..." */
+static void tcp_line(char *line, void *ctx) {
+    tcp_ctx_t *t = ctx;
+    unsigned int st;
+    unsigned long ino;
+    if (sscanf(line, "%*s %*s %*s %x %*s %*s %*s %*s %*s %lu", &st, &ino) != 2) return;   // cabeçalho
+    if (ino == 0 || !has_inode(t->inodes, t->n, ino)) return;
+    switch (st) {
+    case TCP_ST_ESTABLISHED: t->out->established++; break;
+    case TCP_ST_LISTEN: t->out->listen++; break;
+    case TCP_ST_CLOSE_WAIT: t->out->close_wait++; break;
+    case TCP_ST_TIME_WAIT:
+    case TCP_ST_CLOSE: break;
+    default: t->out->other++; break;
+    }
+}
+
+int monitor_tcp_states(pid_t pid, const unsigned long *inodes, size_t n, tcp_states_t *out) {
+    memset(out, 0, sizeof(*out));
+    if (n == 0) return 0;           // sem sockets, nada a cruzar
+    char path[300];
+    tcp_ctx_t t = { inodes, n, out };
+    snprintf(path, sizeof(path), "%s/%d/net/tcp", monitor_proc_root(), pid);
+    int ok4 = read_lines(path, tcp_line, &t) == 0;
+    snprintf(path, sizeof(path), "%s/%d/net/tcp6", monitor_proc_root(), pid);
+    int ok6 = read_lines(path, tcp_line, &t) == 0;     // sem IPv6 no kernel não existe
+    return ok4 || ok6 ? 0 : -1;
+}
+
+/* ===================== CACHE POR NAMESPACE ====================== */
+
+static double mono_s(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec / 1e9;
+}
+
+static int key_cmp(unsigned long ns, pid_t pid, const netns_entry_t *e) {
+    if (ns != e->netns) return ns < e->netns ? -1 : 1;
+    return (pid > e->pid) - (pid < e->pid);
+}
+
+/* posição de (ns, pid) ou onde inserir; *found = 1 se existe */
+static size_t find_entry(const netns_cache_t *c, unsigned long ns, pid_t pid, int *found) {
+    size_t lo = 0, hi = c->n;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int r = key_cmp(ns, pid, &c->e[mid]);
+        if (r == 0) {
+            *found = 1;
+            return mid;
+        }
+        if (r < 0) hi = mid;
+        else lo = mid + 1;
+    }
+    *found = 0;
+    return lo;
+}
+
+static double delta(unsigned long long cur, unsigned long long prev, double dt) {
+    return cur >= prev ? (double)(cur - prev) / dt : 0.0;     // contador zerado (interface recriada)
+}
+
+static void compute_rates(netns_entry_t *e, double dt) {
+    net_rates_t *r = &e->rates;
+    const net_counters_t *a = &e->cur, *b = &e->prev;
+    memset(r, 0, sizeof(*r));
+    if (!e->has_prev || dt <= 0.0) return;
+    r->rx_bytes_per_s = delta(a->rx_bytes, b->rx_bytes, dt);
+    r->tx_bytes_per_s = delta(a->tx_bytes, b->tx_bytes, dt);
+    r->rx_packets_per_s = delta(a->rx_packets, b->rx_packets, dt);
+    r->tx_packets_per_s = delta(a->tx_packets, b->tx_packets, dt);
+    r->drops_per_s = delta(a->rx_drops + a->tx_drops + a->rx_errs + a->tx_errs,
+                           b->rx_drops + b->tx_drops + b->rx_errs + b->tx_errs, dt);
+    r->tcp_retrans_per_s = delta(a->tcp_retrans, b->tcp_retrans, dt);
+}
+
+void netns_cache_begin(netns_cache_t *c) {
+    size_t live = 0;
+    for (size_t i = 0; i < c->n; i++)
+        if (c->e[i].gen == c->gen) c->e[live++] = c->e[i];
+    c->n = live;
+    c->gen++;
+    c->reads = c->hits = 0;
+}
+
+int netns_cache_read(netns_cache_t *c, pid_t pid, unsigned long netns, net_counters_t *out,
+                     net_rates_t *rates) {
+    pid_t kpid = netns ? 0 : pid;
+    int found;
+    size_t i = find_entry(c, netns, kpid, &found);
+    if (found && c->e[i].gen == c->gen) {
+        c->hits++;
+    } else {
+        net_counters_t now;
+        if (monitor_net_usage(pid, &now) != 0) return -1;    // o próximo membro do netns tenta
+        double t = mono_s();
+        c->reads++;
+        if (!found) {
+            if (c->n == c->cap) {
+                size_t cap = c->cap ? c->cap * 2 : 16;
+                netns_entry_t *g = realloc(c->e, cap * sizeof(*g));
+                if (!g) return -1;
+                c->e = g;
+                c->cap = cap;
+            }
+            memmove(&c->e[i + 1], &c->e[i], (c->n - i) * sizeof(*c->e));
+            c->n++;
+            memset(&c->e[i], 0, sizeof(c->e[i]));
+            c->e[i].netns = netns;
+            c->e[i].pid = kpid;
+        }
+        netns_entry_t *e = &c->e[i];
+        e->prev = e->cur;
+        e->has_prev = found;
+        e->cur = now;
+        compute_rates(e, t - e->t);
+        e->t = t;
+        e->gen = c->gen;
+    }
+    if (out) *out = c->e[i].cur;
+    if (rates) *rates = c->e[i].rates;
+    return 0;
+}
+
+void netns_cache_free(netns_cache_t *c) {
+    free(c->e);
+    memset(c, 0, sizeof(*c));
+}
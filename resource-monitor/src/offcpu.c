@@ -0,0 +1,490 @@
+/*
+ * src/offcpu.c
+ *
+ * Perfil off-CPU por amostragem de stat, syscall e wchan de cada thread.
+ */
+
+#define _GNU_SOURCE
+#include "offcpu.h"
+#include "monitor.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+static const char *k_cat_names[OFFCPU_NCATEGORIES] = {
+    "running", "io_wait", "page_fault", "futex", "poll", "sleep", "read_write", "other"
+};
+
+const char *offcpu_cat_name(offcpu_cat_t c) {
+    return (unsigned)c < OFFCPU_NCATEGORIES ? k_cat_names[c] : "?";
+}
+
+/* ===================== CLASSIFICAÇÃO ====================== */
+
+typedef struct {
+    long nr;
+    const char *name;
+    offcpu_cat_t cat;
+} syscall_info_t;
+
+#define SC(n, c) { SYS_##n, #n, c }
+
+/* só as syscalls em que uma thread costuma dormir; o resto vira "other" */
+static const syscall_info_t k_syscalls[] = {
+    SC(futex, OFFCPU_FUTEX),
+#ifdef SYS_futex_waitv
+    SC(futex_waitv, OFFCPU_FUTEX),
+#endif
+#ifdef SYS_poll
+    SC(poll, OFFCPU_POLL),
+#endif
+#ifdef SYS_select
+    SC(select, OFFCPU_POLL),
+#endif
+#ifdef SYS_epoll_wait
+    SC(epoll_wait, OFFCPU_POLL),
+#endif
+#ifdef SYS_epoll_pwait2
+    SC(epoll_pwait2, OFFCPU_POLL),
+#endif
+    SC(ppoll, OFFCPU_POLL),
+    SC(pselect6, OFFCPU_POLL),
+    SC(epoll_pwait, OFFCPU_POLL),
+    SC(nanosleep, OFFCPU_SLEEP),
+    SC(clock_nanosleep, OFFCPU_SLEEP),
+#ifdef SYS_pause
+    SC(pause, OFFCPU_SLEEP),
+#endif
+    SC(read, OFFCPU_READ_WRITE),
+    SC(write, OFFCPU_READ_WRITE),
+    SC(readv, OFFCPU_READ_WRITE),
+    SC(writev, OFFCPU_READ_WRITE),
+    SC(pread64, OFFCPU_READ_WRITE),
+    SC(pwrite64, OFFCPU_READ_WRITE),
+    SC(recvfrom, OFFCPU_READ_WRITE),
+    SC(recvmsg, OFFCPU_READ_WRITE),
+    SC(sendto, OFFCPU_READ_WRITE),
+    SC(sendmsg, OFFCPU_READ_WRITE),
+    SC(accept, OFFCPU_READ_WRITE),
+    SC(accept4, OFFCPU_READ_WRITE),
+    SC(connect, OFFCPU_READ_WRITE),
+    SC(fsync, OFFCPU_IO_WAIT),
+    SC(fdatasync, OFFCPU_IO_WAIT),
+    SC(sync_file_range, OFFCPU_IO_WAIT),
+    SC(io_getevents, OFFCPU_IO_WAIT),
+#ifdef SYS_io_uring_enter
+    SC(io_uring_enter, OFFCPU_IO_WAIT),
+#endif
+    SC(wait4, OFFCPU_OTHER),
+    SC(waitid, OFFCPU_OTHER),
+    SC(rt_sigtimedwait, OFFCPU_OTHER),
+};
+
+static const syscall_info_t *syscall_find(long nr) {
+    for (size_t i = 0; i < sizeof(k_syscalls) / sizeof(k_syscalls[0]); i++)
+        if (k_syscalls[i].nr == nr) return &k_syscalls[i];
+    return NULL;
+}
+
+const char *offcpu_syscall_name(long sysno) {
+    const syscall_info_t *s = syscall_find(sysno);
+    return s ? s->name : NULL;
+}
+
+offcpu_cat_t offcpu_classify(char state, long sysno, const char *wchan) {
+    if (state == 'R') return OFFCPU_RUNNING;
+    if (state != 'S' && state != 'D') return OFFCPU_OTHER;     // T, t, Z, I...
+    if (sysno == -1) return OFFCPU_PAGE_FAULT;                  // bloqueada sem estar em syscall
+    if (sysno >= 0) {
+        const syscall_info_t *s = syscall_find(sysno);
+        offcpu_cat_t c = s ? s->cat : OFFCPU_OTHER;
+        /* read/write ou syscall qualquer em D: esperando o disco */
+        if (state == 'D' && (c == OFFCPU_READ_WRITE || c == OFFCPU_OTHER)) return OFFCPU_IO_WAIT;
+        return c;
+    }
+    /* syscall ilegível (sem permissão de ptrace): só o wchan */
+    if (wchan && *wchan && strcmp(wchan, "0") != 0) {
+        if (strstr(wchan, "futex")) return OFFCPU_FUTEX;
+        if (strstr(wchan, "poll") || strstr(wchan, "select")) return OFFCPU_POLL;
+        if (strstr(wchan, "nanosleep")) return OFFCPU_SLEEP;
+        if (strstr(wchan, "fault")) return OFFCPU_PAGE_FAULT;
+    }
+    return state == 'D' ? OFFCPU_IO_WAIT : OFFCPU_OTHER;
+}
+
+/* ===================== HISTOGRAMA ====================== */
+
+static uint64_t entry_hash(offcpu_cat_t cat, char state, long sysno, const char *wchan) {
+    uint64_t h = 1469598103934665603ULL;    // FNV-1a
+    h = (h ^ (uint64_t)cat) * 1099511628211ULL;
+    h = (h ^ (uint64_t)(unsigned char)state) * 1099511628211ULL;
+    h = (h ^ (uint64_t)sysno) * 1099511628211ULL;
+    for (const char *p = wchan; *p; p++) h = (h ^ (uint64_t)(unsigned char)*p) * 1099511628211ULL;
+    return h;
+}
+
+static void record(offcpu_t *o, char state, long sysno, const char *wchan) {
+    offcpu_cat_t cat = offcpu_classify(state, sysno, wchan);
+    o->cat_samples[cat]++;
+    o->samples++;
+    size_t mask = OFFCPU_MAX_ENTRIES - 1;
+    for (size_t i = entry_hash(cat, state, sysno, wchan) & mask, probes = 0; probes < OFFCPU_MAX_ENTRIES;
+         i = (i + 1) & mask, probes++) {
+        offcpu_entry_t *e = &o->entries[i];
+        if (e->samples == 0) {
+            /* tabela a 3/4: sondagens longas demais para o tick */
+            if (o->nentries >= OFFCPU_MAX_ENTRIES * 3 / 4) break;
+            e->cat = cat;
+            e->state = state;
+            e->sysno = sysno;
+            snprintf(e->wchan, sizeof(e->wchan), "%s", wchan);
+            e->samples = 1;
+            o->nentries++;
+            return;
+        }
+        if (e->cat == cat && e->state == state && e->sysno == sysno && strcmp(e->wchan, wchan) == 0) {
+            e->samples++;
+            return;
+        }
+    }
+    o->dropped++;
+}
+
+/* ===================== THREADS ====================== */
+
+static int open_task_file(pid_t pid, pid_t tid, const char *name) {
+    char path[320];
+    snprintf(path, sizeof(path), "%s/%d/task/%d/%s", monitor_proc_root(), pid, tid, name);
+    return open(path, O_RDONLY | O_CLOEXEC);
+}
+
+static void open_thread(offcpu_t *o, offcpu_thread_t *t, pid_t tid) {
+    memset(t, 0, sizeof(*t));
+    t->tid = tid;
+    t->sched_fd = open_task_file(o->pid, tid, "schedstat");
+    t->stat_fd = open_task_file(o->pid, tid, "stat");
+    t->syscall_fd = open_task_file(o->pid, tid, "syscall");
+    t->wchan_fd = open_task_file(o->pid, tid, "wchan");
+}
+
+static void close_thread(offcpu_thread_t *t) {
+    if (t->sched_fd >= 0) close(t->sched_fd);
+    if (t->stat_fd >= 0) close(t->stat_fd);
+    if (t->syscall_fd >= 0) close(t->syscall_fd);
+    if (t->wchan_fd >= 0) close(t->wchan_fd);
+}
+
+static int tid_cmp(const void *a, const void *b) {
+    pid_t x = *(const pid_t *)a, y = *(const pid_t *)b;
+    return (x > y) - (x < y);
+}
+
+int offcpu_refresh(offcpu_t *o) {
+    char path[320];
+    snprintf(path, sizeof(path), "%s/%d/task", monitor_proc_root(), o->pid);
+    DIR *d = opendir(path);
+    if (!d) return -1;
+    size_t cap = o->nthreads + 16, n = 0;
+    pid_t *tids = malloc(cap * sizeof(*tids));
+    struct dirent *e;
+    while (tids && (e = readdir(d))) {
+        pid_t tid = (pid_t)atoi(e->d_name);
+        if (tid <= 0) continue;
+        if (n == cap) {
+            cap *= 2;
+            pid_t *g = realloc(tids, cap * sizeof(*tids));
+            if (!g) break;
+            tids = g;
+        }
+        tids[n++] = tid;
+    }
+    closedir(d);
+    offcpu_thread_t *nt = tids ? malloc((n ? n : 1) * sizeof(*nt)) : NULL;
+    if (!nt || o->reqs_cap < 3 * n) {
+        size_t rc = 3 * n + 32;
+        batchread_req_t *r = nt ? realloc(o->reqs, rc * sizeof(*r)) : NULL;
+        if (r) {
+            o->reqs = r;
+            o->reqs_cap = rc;
+        } else {
+            free(nt);
+            free(tids);
+            return -1;
+        }
+    }
+    qsort(tids, n, sizeof(*tids), tid_cmp);
+
+    /* as duas listas ordenadas: mantém os descritores de quem continua */
+    size_t j = 0;
+    for (size_t i = 0; i < n; i++) {
+        while (j < o->nthreads && o->threads[j].tid < tids[i]) close_thread(&o->threads[j++]);
+        if (j < o->nthreads && o->threads[j].tid == tids[i])
+            nt[i] = o->threads[j++];
+        else
+            open_thread(o, &nt[i], tids[i]);
+    }
+    while (j < o->nthreads) close_thread(&o->threads[j++]);
+    free(o->threads);
+    free(tids);
+    o->threads = nt;
+    o->nthreads = n;
+    return (int)n;
+}
+
+int offcpu_init(offcpu_t *o, pid_t pid, double hz, batchread_backend_t backend) {
+    memset(o, 0, sizeof(*o));
+    o->pid = pid;
+    o->self_tid = pid == getpid() ? (pid_t)syscall(SYS_gettid) : 0;
+    o->hz = hz > 0.0 ? hz : 100.0;
+    /* quatro descritores por thread */
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+    if (batchread_init(&o->io, backend) != 0) batchread_init(&o->io, BATCHREAD_PREAD);
+    if (offcpu_refresh(o) <= 0) {
+        fprintf(stderr, "Erro ao listar as threads de %d\n", pid);
+        offcpu_free(o);
+        return -1;
+    }
+    return 0;
+}
+
+/* ===================== AMOSTRAGEM ====================== */
+
+/* "tid (comm) S ...": o comm pode ter espaços e parênteses */
+static char parse_state(const char *stat) {
+    const char *p = strrchr(stat, ')');
+    return p && p[1] == ' ' && p[2] ? p[2] : 0;
+}
+
+/* "nr arg1 ... sp pc", "-1 sp pc" fora de syscall ou "running" */
+static long parse_sysno(const char *buf) {
+    char *end;
+    long nr = strtol(buf, &end, 10);
+    return end == buf ? -2 : nr;
+}
+
+static void queue(offcpu_t *o, size_t *n, int fd, char *buf, size_t size) {
+    if (fd < 0) return;
+    o->reqs[(*n)++] = (batchread_req_t){ fd, buf, size, -1 };
+}
+
+/* resultado do próximo pedido da thread, na mesma ordem em que foram enfileirados */
+static int take(const offcpu_t *o, size_t *k, int fd) {
+    return fd >= 0 && o->reqs[(*k)++].result > 0;
+}
+
+int offcpu_sample(offcpu_t *o) {
+    /* fase 1: schedstat de todas, para saber quem rodou desde o tick anterior */
+    size_t nr = 0;
+    for (size_t i = 0; i < o->nthreads; i++)
+        if (o->threads[i].tid != o->self_tid)
+            queue(o, &nr, o->threads[i].sched_fd, o->threads[i].sched, sizeof(o->threads[i].sched));
+    batchread_run(&o->io, o->reqs, nr);
+    o->syscalls += o->io.syscalls;
+
+    size_t k = 0, alive = 0;
+    nr = 0;
+    for (size_t i = 0; i < o->nthreads; i++) {
+        offcpu_thread_t *t = &o->threads[i];
+        unsigned long long run, wait, pcount;
+        t->stale = 0;
+        if (t->tid == o->self_tid) continue;      // estaria sempre lendo /proc
+        if (!take(o, &k, t->sched_fd) || sscanf(t->sched, "%llu %llu %llu", &run, &wait, &pcount) != 3) {
+            t->state = 0;       // thread saiu
+            continue;
+        }
+        alive++;
+        if (t->known && run == t->run_ns && pcount == t->pcount) continue;
+        t->run_ns = run;
+        t->pcount = pcount;
+        t->stale = 1;
+    }
+    if (alive == 0) return -1;
+
+    /* fase 2: estado e ponto de espera só de quem rodou. Para uma thread na
+       CPU o syscall volta EAGAIN e o wchan 0, sem esperar por ela. */
+    for (size_t i = 0; i < o->nthreads; i++) {
+        offcpu_thread_t *t = &o->threads[i];
+        if (!t->stale) continue;
+        queue(o, &nr, t->stat_fd, t->stat, sizeof(t->stat));
+        queue(o, &nr, t->syscall_fd, t->syscall, sizeof(t->syscall));
+        queue(o, &nr, t->wchan_fd, t->wchan, sizeof(t->wchan));
+    }
+    if (nr > 0) {
+        batchread_run(&o->io, o->reqs, nr);
+        o->syscalls += o->io.syscalls;
+    }
+
+    k = 0;
+    for (size_t i = 0; i < o->nthreads; i++) {
+        offcpu_thread_t *t = &o->threads[i];
+        if (t->stale) {
+            int ok_stat = take(o, &k, t->stat_fd);
+            int ok_sys = take(o, &k, t->syscall_fd);
+            int ok_wchan = take(o, &k, t->wchan_fd);
+            t->state = ok_stat ? parse_state(t->stat) : 0;
+            t->sysno = ok_sys ? parse_sysno(t->syscall) : -2;
+            if (!ok_wchan) t->wchan[0] = '\0';
+            t->wchan[strcspn(t->wchan, "\n")] = '\0';
+            if (strcmp(t->wchan, "0") == 0) t->wchan[0] = '\0';
+            t->known = t->state != 0;
+            o->rereads++;
+        }
+        if (t->tid == o->self_tid || !t->known || !t->state) continue;
+        if (t->state == 'R')
+            record(o, 'R', -2, "");
+        else
+            record(o, t->state, t->sysno, t->wchan);
+    }
+    return 0;
+}
+
+double offcpu_sample_s(const offcpu_t *o) {
+    return o->ticks && o->elapsed_s > 0.0 ? o->elapsed_s / (double)o->ticks : 1.0 / o->hz;
+}
+
+static double mono_ms(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec * 1e3 + (double)t.tv_nsec / 1e6;
+}
+
+static void sleep_until_ms(double ms) {
+    struct timespec t = { (time_t)(ms / 1e3), (long)((ms - (double)(time_t)(ms / 1e3) * 1e3) * 1e6) };
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL);     // EINTR (Ctrl+C): o chamador confere *running
+}
+
+int offcpu_run(offcpu_t *o, double duration_s, volatile int *running) {
+    double period = 1e3 / o->hz;
+    double start = mono_ms(), next = start;
+    unsigned long refresh_every = o->hz >= 1.0 ? (unsigned long)o->hz : 1;
+    while (!running || *running) {
+        double t0 = mono_ms();
+        if (duration_s > 0.0 && t0 - start >= duration_s * 1e3) break;
+        /* lista de threads uma vez por segundo */
+        if (o->ticks > 0 && o->ticks % refresh_every == 0 && offcpu_refresh(o) < 0) break;
+        if (offcpu_sample(o) != 0) {
+            if (o->ticks == 0) return -1;
+            break;      // alvo terminou: fica o que foi amostrado
+        }
+        double cost = mono_ms() - t0;
+        o->ticks++;
+        o->tick_ms_sum += cost;
+        if (cost > o->tick_ms_max) o->tick_ms_max = cost;
+
+        /* ticks atrasados são pulados, não acumulados */
+        next += period;
+        double now = mono_ms();
+        while (next <= now) {
+            next += period;
+            o->missed_ticks++;
+        }
+        sleep_until_ms(next);
+    }
+    o->elapsed_s = (mono_ms() - start) / 1e3;
+    return 0;
+}
+
+/* ===================== SAÍDA ====================== */
+
+static int entry_cmp(const void *a, const void *b) {
+    const offcpu_entry_t *x = *(const offcpu_entry_t *const *)a, *y = *(const offcpu_entry_t *const *)b;
+    return (x->samples < y->samples) - (x->samples > y->samples);
+}
+
+size_t offcpu_sorted(const offcpu_t *o, const offcpu_entry_t **out, size_t max) {
+    const offcpu_entry_t *all[OFFCPU_MAX_ENTRIES];
+    size_t n = 0;
+    for (size_t i = 0; i < OFFCPU_MAX_ENTRIES; i++)
+        if (o->entries[i].samples) all[n++] = &o->entries[i];
+    qsort(all, n, sizeof(all[0]), entry_cmp);
+    if (n > max) n = max;
+    memcpy(out, all, n * sizeof(all[0]));
+    return n;
+}
+
+static void format_syscall(char state, long sysno, char *buf, size_t len) {
+    const char *name = offcpu_syscall_name(sysno);
+    if (state == 'R') snprintf(buf, len, "%s", "");     // não lido para threads na CPU
+    else if (sysno == -1) snprintf(buf, len, "-");
+    else if (sysno < 0) snprintf(buf, len, "?");
+    else if (name) snprintf(buf, len, "%s", name);
+    else snprintf(buf, len, "%ld", sysno);
+}
+
+void offcpu_print(const offcpu_t *o, FILE *fp, size_t max_rows) {
+    double total = o->samples ? (double)o->samples : 1.0;
+    double dt = offcpu_sample_s(o);
+    fprintf(fp, "Perfil off-CPU do PID %d: %llu ticks a %.0f Hz (%llu perdidos), %zu threads na última leitura\n",
+            o->pid, (unsigned long long)o->ticks, o->hz, (unsigned long long)o->missed_ticks, o->nthreads);
+    fprintf(fp, "Custo: %.3f ms/tick em média, %.3f ms no pior, %.1f syscalls/tick, %.1f threads relidas/tick (%s)\n",
+            o->ticks ? o->tick_ms_sum / (double)o->ticks : 0.0, o->tick_ms_max,
+            o->ticks ? (double)o->syscalls / (double)o->ticks : 0.0,
+            o->ticks ? (double)o->rereads / (double)o->ticks : 0.0, batchread_backend_name(&o->io));
+    fprintf(fp, "\n%-12s %10s %10s %7s\n", "categoria", "amostras", "thread-s", "%");
+    for (int c = 0; c < OFFCPU_NCATEGORIES; c++) {
+        if (!o->cat_samples[c]) continue;
+        fprintf(fp, "%-12s %10llu %10.2f %6.1f%%\n", offcpu_cat_name((offcpu_cat_t)c),
+                (unsigned long long)o->cat_samples[c], (double)o->cat_samples[c] * dt,
+                100.0 * (double)o->cat_samples[c] / total);
+    }
+
+    const offcpu_entry_t *top[64];
+    size_t n = offcpu_sorted(o, top, max_rows < 64 ? max_rows : 64);
+    fprintf(fp, "\n%7s %10s  %-1s  %-11s %-18s %s\n", "%", "thread-s", "E", "categoria", "syscall", "wchan");
+    for (size_t i = 0; i < n; i++) {
+        char sc[32];
+        format_syscall(top[i]->state, top[i]->sysno, sc, sizeof(sc));
+        fprintf(fp, "%6.1f%% %10.2f  %c  %-11s %-18s %s\n", 100.0 * (double)top[i]->samples / total,
+                (double)top[i]->samples * dt, top[i]->state, offcpu_cat_name(top[i]->cat), sc,
+                top[i]->wchan[0] ? top[i]->wchan : "-");
+    }
+    if (o->dropped)
+        fprintf(fp, "(%llu amostras sem lugar no histograma: só nos totais por categoria)\n",
+                (unsigned long long)o->dropped);
+}
+
+int offcpu_write_csv(const offcpu_t *o, const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror("Erro ao criar arquivo de saída");
+        return -1;
+    }
+    const offcpu_entry_t **all = malloc(OFFCPU_MAX_ENTRIES * sizeof(*all));
+    if (!all) {
+        fclose(f);
+        return -1;
+    }
+    size_t n = offcpu_sorted(o, all, OFFCPU_MAX_ENTRIES);
+    double total = o->samples ? (double)o->samples : 1.0;
+    double dt = offcpu_sample_s(o);
+    fprintf(f, "category,state,syscall,wchan,samples,thread_seconds,pct\n");
+    for (size_t i = 0; i < n; i++) {
+        char sc[32];
+        format_syscall(all[i]->state, all[i]->sysno, sc, sizeof(sc));
+        fprintf(f, "%s,%c,%s,%s,%llu,%.3f,%.2f\n", offcpu_cat_name(all[i]->cat), all[i]->state, sc,
+                all[i]->wchan, (unsigned long long)all[i]->samples, (double)all[i]->samples * dt,
+                100.0 * (double)all[i]->samples / total);
+    }
+    free(all);
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+void offcpu_free(offcpu_t *o) {
+    for (size_t i = 0; i < o->nthreads; i++) close_thread(&o->threads[i]);
+    free(o->threads);
+    free(o->reqs);
+    o->threads = NULL;
+    o->reqs = NULL;
+    o->nthreads = o->reqs_cap = 0;
+    batchread_free(&o->io);
+}
@@ -0,0 +1,164 @@
+/*
+ * src/perfcount.c
+ *
+ * Grupos perf_event_open por thread do alvo, lidos com um read() por grupo.
+ */
+
+#define _GNU_SOURCE
+#include "perfcount.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} k_events[PERFC_NCOUNTERS] = {
+    [PERFC_PAGE_FAULTS] = { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS },
+    [PERFC_TASK_CLOCK] = { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+    [PERFC_CTX_SWITCHES] = { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+    [PERFC_CPU_MIGRATIONS] = { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS },
+    [PERFC_CYCLES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    [PERFC_INSTRUCTIONS] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    [PERFC_CACHE_MISSES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+};
+
+static int event_open(perfc_id_t id, pid_t tid, int group_fd, int user_only) {
+    struct perf_event_attr a;
+    memset(&a, 0, sizeof(a));
+    a.size = sizeof(a);
+    a.type = k_events[id].type;
+    a.config = k_events[id].config;
+    a.inherit = 1;
+    a.exclude_hv = 1;
+    a.exclude_kernel = user_only;
+    a.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &a, tid, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+}
+
+/*
+ * Grupo de uma thread na ordem pc->order; hardware ausente deixa a ordem
+ * mais curta. O líder não é task-clock: com ele (PMU própria), os membros
+ * das threads herdadas não voltam para a leitura do grupo.
+ */
+static int open_group(perfcount_t *pc, pid_t tid, int g) {
+    int leader = event_open(PERFC_PAGE_FAULTS, tid, -1, pc->user_only);
+    if (leader < 0) return -1;
+    pc->fds[g] = leader;
+    for (int i = 1; i < pc->nmembers; i++) {
+        int fd = event_open(pc->order[i], tid, leader, pc->user_only);
+        if (fd < 0) {
+            for (int j = 1; j < i; j++) close(pc->member_fds[g][j]);
+            close(leader);
+            return -1;
+        }
+        pc->member_fds[g][i] = fd;
+    }
+    return 0;
+}
+
+static void close_group(perfcount_t *pc, int g) {
+    for (int i = 1; i < pc->nmembers; i++) close(pc->member_fds[g][i]);
+    close(pc->fds[g]);
+}
+
+int perfcount_open(perfcount_t *pc, pid_t pid, int want_hw) {
+    memset(pc, 0, sizeof(*pc));
+
+    /* permissão: com paranoid >= 2 só eventos de usuário */
+    int fd = event_open(PERFC_PAGE_FAULTS, pid, -1, 0);
+    if (fd < 0 && (errno == EACCES || errno == EPERM)) {
+        pc->user_only = 1;
+        fd = event_open(PERFC_PAGE_FAULTS, pid, -1, 1);
+    }
+    if (fd < 0) {
+        fprintf(stderr, "Aviso: perf_event_open indisponível para %d: %s\n", pid, strerror(errno));
+        return -1;
+    }
+    /* sem PMU (VMs em geral) os eventos de hardware falham com ENOENT/EOPNOTSUPP */
+    if (want_hw) {
+        int hw = event_open(PERFC_CYCLES, pid, fd, pc->user_only);
+        int ins = hw >= 0 ? event_open(PERFC_INSTRUCTIONS, pid, fd, pc->user_only) : -1;
+        int cm = ins >= 0 ? event_open(PERFC_CACHE_MISSES, pid, fd, pc->user_only) : -1;
+        pc->has_hw = cm >= 0;
+        if (cm >= 0) close(cm);
+        if (ins >= 0) close(ins);
+        if (hw >= 0) close(hw);
+    }
+    close(fd);
+
+    for (int i = PERFC_PAGE_FAULTS; i <= PERFC_CPU_MIGRATIONS; i++) pc->order[pc->nmembers++] = (perfc_id_t)i;
+    if (pc->has_hw)
+        for (int i = PERFC_CYCLES; i <= PERFC_CACHE_MISSES; i++) pc->order[pc->nmembers++] = (perfc_id_t)i;
+
+    char path[320];
+    snprintf(path, sizeof(path), "%s/%d/task", monitor_proc_root(), pid);
+    DIR *d = opendir(path);
+    if (d) {
+        struct dirent *e;
+        while ((e = readdir(d)) && pc->ngroups < PERFCOUNT_MAX_GROUPS) {
+            pid_t tid = (pid_t)atoi(e->d_name);
+            if (tid <= 0) continue;
+            if (open_group(pc, tid, pc->ngroups) == 0) pc->ngroups++;  // thread que saiu: ignora
+        }
+        if (e) fprintf(stderr, "Aviso: --perf limitado às primeiras %d threads de %d\n",
+                       PERFCOUNT_MAX_GROUPS, pid);
+        closedir(d);
+    } else if (open_group(pc, pid, 0) == 0) {
+        pc->ngroups = 1;
+    }
+    if (pc->ngroups == 0) {
+        fprintf(stderr, "Aviso: nenhum grupo perf aberto para %d\n", pid);
+        return -1;
+    }
+    return 0;
+}
+
+int perfcount_read(perfcount_t *pc, proc_metrics_t *m) {
+    /* nr, time_enabled, time_running, valores[nr] */
+    uint64_t buf[3 + PERFC_NCOUNTERS];
+    double now[PERFC_NCOUNTERS] = {0};
+    int ok = 0;
+    for (int g = 0; g < pc->ngroups; g++) {
+        ssize_t n = read(pc->fds[g], buf, sizeof(buf));
+        if (n < (ssize_t)(3 * sizeof(uint64_t)) || buf[0] != (uint64_t)pc->nmembers) continue;
+        double scale = buf[2] > 0 && buf[2] < buf[1] ? (double)buf[1] / (double)buf[2] : 1.0;
+        for (int i = 0; i < pc->nmembers; i++) now[pc->order[i]] += (double)buf[3 + i] * scale;
+        ok = 1;
+    }
+    if (!ok) return -1;
+
+    /* pelo tempo real entre leituras: vale também quando a leitura foi pulada (orçamento) */
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    double t = (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+    double dt = pc->primed ? t - pc->last_t : 0.0;
+    double d[PERFC_NCOUNTERS];
+    for (int i = 0; i < PERFC_NCOUNTERS; i++) {
+        d[i] = dt > 0.0 && now[i] > pc->last[i] ? (now[i] - pc->last[i]) / dt : 0.0;
+        pc->last[i] = now[i];
+    }
+    pc->last_t = t;
+    pc->primed = 1;
+
+    m->task_clock_ms_per_s = d[PERFC_TASK_CLOCK] / 1e6;
+    m->ctx_switches_per_s = d[PERFC_CTX_SWITCHES];
+    m->cpu_migrations_per_s = d[PERFC_CPU_MIGRATIONS];
+    m->page_faults_per_s = d[PERFC_PAGE_FAULTS];
+    m->cycles_per_s = d[PERFC_CYCLES];
+    m->instructions_per_s = d[PERFC_INSTRUCTIONS];
+    m->cache_misses_per_s = d[PERFC_CACHE_MISSES];
+    m->ipc = d[PERFC_CYCLES] > 0.0 ? d[PERFC_INSTRUCTIONS] / d[PERFC_CYCLES] : 0.0;
+    return 0;
+}
+
+void perfcount_close(perfcount_t *pc) {
+    for (int g = 0; g < pc->ngroups; g++) close_group(pc, g);
+    pc->ngroups = 0;
+}
@@ -0,0 +1,518 @@
+/*
+ * src/procfixture.c
+ *
+ * Gerador de árvores sintéticas de /proc e cgroupfs para testes e
+ * benchmarks em escala sem root.
+ */
+
+#define _GNU_SOURCE
+#include "procfixture.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <ftw.h>
+#include <sys/stat.h>
+
+#define FIXTURE_NCPUS 8
+#define FIXTURE_HZ 100
+#define FIXTURE_MEM_TOTAL_KB 16777216UL
+#define FIXTURE_HOST_NETNS 4026531833UL     // o mesmo inode de ns/net dos processos sem cgroup
+#define FIXTURE_FD_LIMIT 1024
+#define FIXTURE_MAX_LEAKED_SOCKETS 256
+#define FIXTURE_SOCKET_INO(pid, j) (100000000UL + (unsigned long)(pid) * 4096UL + (unsigned long)(j))
+
+static const char *k_comms[10] = {
+    "nginx", "postgres", "java", "python3", "node",
+    "redis-server", "bash", "sshd", "cron", "systemd-journal"
+};
+
+/* ===================== VALORES ====================== */
+
+pid_t procfixture_pid(const procfixture_config_t *cfg, size_t i) {
+    pid_t first = cfg->first_pid > 0 ? cfg->first_pid : 1000;
+    int t = cfg->threads > 0 ? cfg->threads : 1;
+    return first + (pid_t)(i * (size_t)t);      // as threads ocupam os TIDs seguintes
+}
+
+/*
+ * Classes por índice: 1 em 10 ocupado (50 jiffies/tick), 2 em 10 leves
+ * (5 jiffies/tick), o resto ocioso; a classe 1 também vaza 64 kB/tick e
+ * um socket em CLOSE_WAIT a cada 2 ticks.
+ */
+void procfixture_proc_values(const procfixture_config_t *cfg, size_t i, procfixture_proc_t *v) {
+    unsigned long t = cfg->tick;
+    unsigned long cls = i % 10;
+    unsigned long rate = cls == 0 ? 50 : cls < 3 ? 5 : 0;
+
+    memset(v, 0, sizeof(*v));
+    v->pid = procfixture_pid(cfg, i);
+    snprintf(v->comm, sizeof(v->comm), "%s", k_comms[i % 10]);
+    v->state = rate >= 50 ? 'R' : 'S';
+    v->utime = 100 + (i % 53) + rate * t * 3 / 4;
+    v->stime = 20 + (i % 17) + rate * t / 4;
+    v->minflt = 1000 + (i % 13) * 10 * t + rate * t;
+    v->majflt = i % 5 + (cls == 1 ? t / 8 : 0);
+    v->rss_kb = 4096 + (i % 97) * 512 + (cls == 1 ? t * 64 : 0);
+    v->vmsize_kb = v->rss_kb * 3 + 102400;
+    v->swap_kb = i % 7 == 6 ? 1024 : 0;
+    v->voluntary_ctxt = 100 + (i % 17) * t;
+    v->nonvoluntary_ctxt = (i % 3) * t + rate * t / 10;
+    v->run_delay_ms = 5 + i % 7 + rate * t * 2;     // ocupados disputam CPU: 100 ms de fila por tick
+    v->rchar = 16384 + (unsigned long long)(i % 11) * 4096 * t;
+    v->wchar = 8192 + (unsigned long long)(i % 7) * 1024 * t;
+    v->syscr = 64 + (i % 11) * t;
+    v->syscw = 32 + (i % 7) * t;
+    v->read_bytes = (unsigned long long)(i % 3) * 4096 * t;
+    v->write_bytes = (unsigned long long)(i % 5) * 4096 * t;
+    v->starttime = 1000 + i;
+    v->pidns = i % 4 == 3 ? 4026532200UL + i % 3 : 4026531836UL;
+    v->group = cfg->ngroups > 0 ? (int)(i % (size_t)cfg->ngroups) : -1;
+
+    /* rede por namespace: k = 0 é o host, k = g + 1 o netns do cgroup g */
+    unsigned long long k = (unsigned long long)(v->group + 1);
+    v->netns = v->group >= 0 ? 4026532500UL + (unsigned long)v->group : FIXTURE_HOST_NETNS;
+    v->net_rx_bytes = 1048576 * (k + 1) + 65536 * (k + 1) * t;
+    v->net_tx_bytes = 524288 * (k + 1) + 32768 * (k + 1) * t;
+    v->net_rx_packets = v->net_rx_bytes / 1024;
+    v->net_tx_packets = v->net_tx_bytes / 1024;
+    v->net_drops = (k % 3) * t;
+    v->tcp_retrans = (k % 2) * 2 * t;
+
+    /* descritores: stdin/out/err, log em metade, epoll, eventfd, pipe e os sockets */
+    unsigned long leaked = cls == 1 ? t / 2 : 0;
+    if (leaked > FIXTURE_MAX_LEAKED_SOCKETS) leaked = FIXTURE_MAX_LEAKED_SOCKETS;
+    v->fd_files = 3 + i % 2;
+    v->fd_anon = 1;
+    v->fd_eventfds = 1;
+    v->fd_pipes = 1;
+    v->tcp_listen = 1;
+    v->tcp_established = i % 3;
+    v->tcp_close_wait = leaked;
+    v->fd_sockets = v->tcp_listen + v->tcp_established + v->tcp_close_wait;
+    v->fd_count = v->fd_files + v->fd_anon + v->fd_eventfds + v->fd_pipes + v->fd_sockets;
+    v->fd_limit = FIXTURE_FD_LIMIT;
+}
+
+/* ===================== ESCRITA ====================== */
+
+static int put_file(const char *path, const char *buf, size_t len) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Erro ao criar %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    ssize_t n = write(fd, buf, len);
+    close(fd);
+    return n == (ssize_t)len ? 0 : -1;
+}
+
+static int make_dir(const char *path) {
+    if (mkdir(path, 0755) == 0 || errno == EEXIST) return 0;
+    fprintf(stderr, "Erro ao criar diretório %s: %s\n", path, strerror(errno));
+    return -1;
+}
+
+static int make_dirs(const char *path) {
+    char tmp[512];
+    snprintf(tmp, sizeof(tmp), "%s", path);
+    for (char *p = tmp + 1; *p; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        if (make_dir(tmp) != 0) return -1;
+        *p = '/';
+    }
+    return make_dir(tmp);
+}
+
+static int put_stat(const char *path, pid_t id, const procfixture_proc_t *v, unsigned long utime,
+                    unsigned long stime, int threads, long page_kb) {
+    char buf[512];
+    int n = snprintf(buf, sizeof(buf),
+                     "%d (%s) %c 1 %d %d 0 -1 4194560 %lu 0 %lu 0 %lu %lu 0 0 20 0 %d 0 %llu %lu %lu "
+                     "18446744073709551615 1 1 0 0 0 0 0 0 0 0 0 0 17 %d 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+                     id, v->comm, v->state, v->pid, v->pid, v->minflt, v->majflt, utime, stime, threads,
+                     v->starttime, v->vmsize_kb * 1024, v->rss_kb / (unsigned long)page_kb,
+                     (int)(v->pid % FIXTURE_NCPUS));
+    return put_file(path, buf, (size_t)n);
+}
+
+static int put_status(const char *path, pid_t id, const procfixture_proc_t *v, int threads) {
+    char buf[1024];
+    int n = snprintf(buf, sizeof(buf),
+                     "Name:\t%s\nUmask:\t0022\nState:\t%c (%s)\nTgid:\t%d\nNgid:\t0\nPid:\t%d\nPPid:\t1\n"
+                     "TracerPid:\t0\nUid:\t1000\t1000\t1000\t1000\nGid:\t1000\t1000\t1000\t1000\n"
+                     "FDSize:\t64\nVmPeak:\t%lu kB\nVmSize:\t%lu kB\nVmLck:\t0 kB\nVmHWM:\t%lu kB\n"
+                     "VmRSS:\t%lu kB\nRssAnon:\t%lu kB\nRssFile:\t%lu kB\nRssShmem:\t0 kB\nVmSwap:\t%lu kB\n"
+                     "Threads:\t%d\nvoluntary_ctxt_switches:\t%lu\nnonvoluntary_ctxt_switches:\t%lu\n",
+                     v->comm, v->state, v->state == 'R' ? "running" : "sleeping", v->pid, id,
+                     v->vmsize_kb, v->vmsize_kb, v->rss_kb, v->rss_kb, v->rss_kb * 3 / 4, v->rss_kb / 4,
+                     v->swap_kb, threads, v->voluntary_ctxt, v->nonvoluntary_ctxt);
+    return put_file(path, buf, (size_t)n);
+}
+
+/* parte da thread k num total dividido como o CPU: metade na principal (com o resto da divisão) */
+static unsigned long long thread_share(unsigned long long total, int threads, int k) {
+    if (threads == 1) return total;
+    unsigned long long other = total / 2 / (unsigned long long)(threads - 1);
+    return k == 0 ? total - other * (unsigned long long)(threads - 1) : other;
+}
+
+static int put_schedstat(const char *path, const procfixture_proc_t *v, int threads, int k) {
+    char buf[128];
+    int n = snprintf(buf, sizeof(buf), "%llu %llu %llu\n",
+                     thread_share((unsigned long long)(v->utime + v->stime) * (1000000000ULL / FIXTURE_HZ), threads, k),
+                     thread_share(v->run_delay_ms * 1000000ULL, threads, k),
+                     thread_share(v->voluntary_ctxt + v->nonvoluntary_ctxt, threads, k));
+    return put_file(path, buf, (size_t)n);
+}
+
+/* net/dev e net/snmp do netns do processo (iguais nos membros do mesmo netns) */
+static int put_net(const char *dir, const procfixture_proc_t *v) {
+    char path[400], buf[2048];
+    int n = snprintf(buf, sizeof(buf),
+                     "Inter-|   Receive                                                |  Transmit\n"
+                     " face |bytes    packets errs drop fifo frame compressed multicast|"
+                     "bytes    packets errs drop fifo colls carrier compressed\n"
+                     "    lo:  123456     789    0    0    0     0          0         0   "
+                     "123456     789    0    0    0     0       0          0\n"
+                     "  eth0: %llu %llu 0 %llu 0 0 0 0 %llu %llu 0 0 0 0 0 0\n",
+                     v->net_rx_bytes, v->net_rx_packets, v->net_drops, v->net_tx_bytes, v->net_tx_packets);
+    snprintf(path, sizeof(path), "%s/net/dev", dir);
+    if (put_file(path, buf, (size_t)n) != 0) return -1;
+
+    n = snprintf(buf, sizeof(buf),
+                 "Ip: Forwarding DefaultTTL InReceives InHdrErrors InAddrErrors ForwDatagrams\n"
+                 "Ip: 1 64 %llu 0 0 0\n"
+                 "Tcp: RtoAlgorithm RtoMin RtoMax MaxConn ActiveOpens PassiveOpens AttemptFails "
+                 "EstabResets CurrEstab InSegs OutSegs RetransSegs InErrs OutRsts InCsumErrors\n"
+                 "Tcp: 1 200 120000 -1 12 34 0 0 3 %llu %llu %llu 0 0 0\n"
+                 "Udp: InDatagrams NoPorts InErrors OutDatagrams RcvbufErrors SndbufErrors "
+                 "InCsumErrors IgnoredMulti MemErrors\n"
+                 "Udp: %llu 0 0 %llu 0 0 0 0 0\n",
+                 v->net_rx_packets, v->net_rx_packets, v->net_tx_packets, v->tcp_retrans,
+                 v->net_rx_packets / 8, v->net_tx_packets / 8);
+    snprintf(path, sizeof(path), "%s/net/snmp", dir);
+    return put_file(path, buf, (size_t)n);
+}
+
+/* fd/<n> na ordem de procfixture_proc_values; os sockets são 0 = LISTEN, depois
+   os ESTABLISHED e por fim os vazados. Regravar só acrescenta os links novos. */
+static int put_fds(const char *dir, const procfixture_proc_t *v) {
+    char path[400], link[96];
+    for (unsigned long k = 0; k < v->fd_count; k++) {
+        unsigned long f = k;
+        if (f < 3)
+            snprintf(link, sizeof(link), "/dev/null");
+        else if (f < v->fd_files)
+            snprintf(link, sizeof(link), "/var/log/%s.log", v->comm);
+        else if ((f -= v->fd_files) < v->fd_anon)
+            snprintf(link, sizeof(link), "anon_inode:[eventpoll]");
+        else if ((f -= v->fd_anon) < v->fd_eventfds)
+            snprintf(link, sizeof(link), "anon_inode:[eventfd]");
+        else if ((f -= v->fd_eventfds) < v->fd_pipes)
+            snprintf(link, sizeof(link), "pipe:[%lu]", 200000000UL + (unsigned long)v->pid);
+        else
+            snprintf(link, sizeof(link), "socket:[%lu]", FIXTURE_SOCKET_INO(v->pid, f - v->fd_pipes));
+        snprintf(path, sizeof(path), "%s/fd/%lu", dir, k);
+        if (symlink(link, path) != 0 && errno != EEXIST) return -1;
+    }
+    return 0;
+}
+
+static int tcp_entry(char *buf, size_t len, int sl, int st, unsigned long ino) {
+    return snprintf(buf, len, "%4d: 0100007F:%04X 0100007F:%04X %02X 00000000:00000000 00:00000000 "
+                    "00000000  1000        0 %lu 1 0000000000000000 20 4 30 10 -1\n",
+                    sl, 8000 + sl, 40000 + sl, st, ino);
+}
+
+/* net/tcp com os sockets do processo (menos o LISTEN, que fica em tcp6) */
+static int put_tcp(const char *dir, const procfixture_proc_t *v) {
+    static const char *hdr = "  sl  local_address rem_address   st tx_queue rx_queue tr tm->when "
+                             "retrnsmt   uid  timeout inode\n";
+    char path[400];
+    size_t cap = 512 + (v->fd_sockets + 2) * 160;
+    char *buf = malloc(cap);
+    if (!buf) return -1;
+    size_t n = (size_t)snprintf(buf, cap, "%s", hdr);
+    int sl = 0;
+    n += (size_t)tcp_entry(buf + n, cap - n, sl++, 0x06, 0);        // TIME_WAIT: sem descritor
+    n += (size_t)tcp_entry(buf + n, cap - n, sl++, 0x01, 99999999UL); // de outro processo
+    for (unsigned long j = 1; j < v->fd_sockets; j++)
+        n += (size_t)tcp_entry(buf + n, cap - n, sl++, j <= v->tcp_established ? 0x01 : 0x08,
+                               FIXTURE_SOCKET_INO(v->pid, j));
+    snprintf(path, sizeof(path), "%s/net/tcp", dir);
+    int rc = put_file(path, buf, n);
+    if (rc == 0) {
+        n = (size_t)snprintf(buf, cap, "%s", hdr);
+        n += (size_t)tcp_entry(buf + n, cap - n, 0, 0x0A, FIXTURE_SOCKET_INO(v->pid, 0));
+        snprintf(path, sizeof(path), "%s/net/tcp6", dir);
+        rc = put_file(path, buf, n);
+    }
+    free(buf);
+    return rc;
+}
+
+/* acumulados por cgroup a partir dos processos membros */
+typedef struct {
+    unsigned long long usage_usec, user_usec, system_usec;
+    unsigned long long anon, file, pgfault, pgmajfault;
+    unsigned long long rbytes, wbytes, rios, wios;
+    size_t nprocs;
+} group_acc_t;
+
+static int write_process(const char *proc, const procfixture_config_t *cfg, size_t i, long page_kb,
+                         int first, group_acc_t *groups) {
+    procfixture_proc_t v;
+    procfixture_proc_values(cfg, i, &v);
+    int threads = cfg->threads > 0 ? cfg->threads : 1;
+    char dir[320], path[400], buf[512];
+    int n;
+
+    snprintf(dir, sizeof(dir), "%s/%d", proc, v.pid);
+    if (first) {
+        if (make_dir(dir) != 0) return -1;
+        snprintf(path, sizeof(path), "%s/task", dir);
+        make_dir(path);
+        snprintf(path, sizeof(path), "%s/ns", dir);
+        make_dir(path);
+        snprintf(path, sizeof(path), "%s/net", dir);
+        make_dir(path);
+        snprintf(path, sizeof(path), "%s/fd", dir);
+        make_dir(path);
+        static const char *ns[] = { "cgroup", "ipc", "mnt", "net", "pid", "user", "uts" };
+        for (size_t k = 0; k < sizeof(ns) / sizeof(ns[0]); k++) {
+            char link[64];
+            unsigned long ino = strcmp(ns[k], "pid") == 0 ? v.pidns
+                              : strcmp(ns[k], "net") == 0 ? v.netns : 4026531830UL + k;
+            snprintf(link, sizeof(link), "%s:[%lu]", ns[k], ino);
+            snprintf(path, sizeof(path), "%s/ns/%s", dir, ns[k]);
+            if (symlink(link, path) != 0 && errno != EEXIST) return -1;
+        }
+        snprintf(path, sizeof(path), "%s/cgroup", dir);
+        n = v.group >= 0 ? snprintf(buf, sizeof(buf), "0::/resource_monitor/g%03d\n", v.group)
+                         : snprintf(buf, sizeof(buf), "0::/\n");
+        if (put_file(path, buf, (size_t)n) != 0) return -1;
+        snprintf(path, sizeof(path), "%s/limits", dir);
+        n = snprintf(buf, sizeof(buf),
+                     "Limit                     Soft Limit           Hard Limit           Units     \n"
+                     "Max cpu time              unlimited            unlimited            seconds   \n"
+                     "Max processes             63432                63432                processes \n"
+                     "Max open files            %-20lu 524288               files     \n"
+                     "Max locked memory         8388608              8388608              bytes     \n",
+                     v.fd_limit);
+        if (put_file(path, buf, (size_t)n) != 0) return -1;
+    }
+
+    snprintf(path, sizeof(path), "%s/stat", dir);
+    if (put_stat(path, v.pid, &v, v.utime, v.stime, threads, page_kb) != 0) return -1;
+    snprintf(path, sizeof(path), "%s/status", dir);
+    if (put_status(path, v.pid, &v, threads) != 0) return -1;
+    snprintf(path, sizeof(path), "%s/schedstat", dir);     // só a thread principal, como no kernel
+    if (put_schedstat(path, &v, threads, 0) != 0) return -1;
+
+    snprintf(path, sizeof(path), "%s/statm", dir);
+    n = snprintf(buf, sizeof(buf), "%lu %lu %lu 200 0 %lu 0\n", v.vmsize_kb / page_kb, v.rss_kb / page_kb,
+                 v.rss_kb / page_kb / 4, v.rss_kb / page_kb);
+    if (put_file(path, buf, (size_t)n) != 0) return -1;
+
+    snprintf(path, sizeof(path), "%s/io", dir);
+    n = snprintf(buf, sizeof(buf), "rchar: %llu\nwchar: %llu\nsyscr: %llu\nsyscw: %llu\n"
+                 "read_bytes: %llu\nwrite_bytes: %llu\ncancelled_write_bytes: 0\n",
+                 v.rchar, v.wchar, v.syscr, v.syscw, v.read_bytes, v.write_bytes);
+    if (put_file(path, buf, (size_t)n) != 0) return -1;
+
+    if (put_net(dir, &v) != 0) return -1;
+    if (put_tcp(dir, &v) != 0 || put_fds(dir, &v) != 0) return -1;
+
+    /* threads: a principal fica com metade do CPU, as demais dividem o resto */
+    for (int k = 0; k < threads; k++) {
+        pid_t tid = v.pid + k;
+        unsigned long ut = threads == 1 ? v.utime : k == 0 ? v.utime / 2 : v.utime / 2 / (unsigned long)(threads - 1);
+        unsigned long st = threads == 1 ? v.stime : k == 0 ? v.stime / 2 : v.stime / 2 / (unsigned long)(threads - 1);
+        char tdir[360];
+        snprintf(tdir, sizeof(tdir), "%s/task/%d", dir, tid);
+        if (first && make_dir(tdir) != 0) return -1;
+        snprintf(path, sizeof(path), "%s/stat", tdir);
+        if (put_stat(path, tid, &v, ut, st, threads, page_kb) != 0) return -1;
+        snprintf(path, sizeof(path), "%s/status", tdir);
+        if (put_status(path, tid, &v, threads) != 0) return -1;
+        snprintf(path, sizeof(path), "%s/schedstat", tdir);
+        if (put_schedstat(path, &v, threads, k) != 0) return -1;
+    }
+
+    if (v.group >= 0) {
+        group_acc_t *g = &groups[v.group];
+        g->user_usec += (unsigned long long)v.utime * (1000000 / FIXTURE_HZ);
+        g->system_usec += (unsigned long long)v.stime * (1000000 / FIXTURE_HZ);
+        g->usage_usec = g->user_usec + g->system_usec;
+        g->anon += (unsigned long long)v.rss_kb * 3 / 4 * 1024;
+        g->file += (unsigned long long)v.rss_kb / 4 * 1024;
+        g->pgfault += v.minflt + v.majflt;
+        g->pgmajfault += v.majflt;
+        g->rbytes += v.read_bytes;
+        g->wbytes += v.write_bytes;
+        g->rios += v.read_bytes / 4096;
+        g->wios += v.write_bytes / 4096;
+        g->nprocs++;
+    }
+    return 0;
+}
+
+static int write_pressure(const char *path, double some, unsigned long long total) {
+    char buf[256];
+    int n = snprintf(buf, sizeof(buf),
+                     "some avg10=%.2f avg60=%.2f avg300=%.2f total=%llu\n"
+                     "full avg10=%.2f avg60=%.2f avg300=%.2f total=%llu\n",
+                     some, some * 0.8, some * 0.5, total, some / 4, some / 5, some / 8, total / 4);
+    return put_file(path, buf, (size_t)n);
+}
+
+static int write_system(const char *proc, const procfixture_config_t *cfg, size_t running) {
+    unsigned long long t = cfg->tick;
+    char path[400], buf[2048];
+    int n;
+
+    /* 800 jiffies por tick no total, divididos entre as 8 CPUs */
+    unsigned long long user = 100000 + 300 * t, sys = 50000 + 100 * t, idle = 1000000 + 380 * t,
+                       iowait = 2000 + 20 * t;
+    n = snprintf(buf, sizeof(buf), "cpu  %llu 0 %llu %llu %llu 0 0 0 0 0\n", user, sys, idle, iowait);
+    for (int c = 0; c < FIXTURE_NCPUS; c++)
+        n += snprintf(buf + n, sizeof(buf) - (size_t)n, "cpu%d %llu 0 %llu %llu %llu 0 0 0 0 0\n", c,
+                      user / FIXTURE_NCPUS, sys / FIXTURE_NCPUS, idle / FIXTURE_NCPUS, iowait / FIXTURE_NCPUS);
+    n += snprintf(buf + n, sizeof(buf) - (size_t)n,
+                  "ctxt %llu\nbtime 1700000000\nprocesses %zu\nprocs_running %zu\nprocs_blocked 0\n",
+                  100000 + 5000 * t, cfg->nprocs, running);
+    snprintf(path, sizeof(path), "%s/stat", proc);
+    if (put_file(path, buf, (size_t)n) != 0) return -1;
+
+    unsigned long avail = 8388608UL - (unsigned long)(t * 1024 % 4194304UL);
+    n = snprintf(buf, sizeof(buf),
+                 "MemTotal:       %lu kB\nMemFree:        %lu kB\nMemAvailable:   %lu kB\n"
+                 "Buffers:          262144 kB\nCached:         %lu kB\nSwapCached:            0 kB\n"
+                 "SwapTotal:       2097152 kB\nSwapFree:        2097152 kB\n",
+                 FIXTURE_MEM_TOTAL_KB, avail / 2, avail, avail / 2);
+    snprintf(path, sizeof(path), "%s/meminfo", proc);
+    if (put_file(path, buf, (size_t)n) != 0) return -1;
+
+    static const char *res[] = { "cpu", "memory", "io" };
+    for (int r = 0; r < 3; r++) {
+        snprintf(path, sizeof(path), "%s/pressure/%s", proc, res[r]);
+        if (write_pressure(path, (double)((t + (unsigned long long)r * 7) % 40) / 4.0,
+                           (unsigned long long)(r + 1) * 1000 * t) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+static int write_groups(const char *cgroot, const procfixture_config_t *cfg, const group_acc_t *groups) {
+    char dir[400], path[480], buf[1024];
+    int n;
+
+    snprintf(path, sizeof(path), "%s/cgroup.controllers", cgroot);
+    if (put_file(path, "cpuset cpu io memory pids\n", 26) != 0) return -1;
+
+    for (int k = 0; k < cfg->ngroups; k++) {
+        const group_acc_t *g = &groups[k];
+        snprintf(dir, sizeof(dir), "%s/resource_monitor/g%03d", cgroot, k);
+        if (make_dir(dir) != 0) return -1;
+
+        snprintf(path, sizeof(path), "%s/cpu.stat", dir);
+        n = snprintf(buf, sizeof(buf), "usage_usec %llu\nuser_usec %llu\nsystem_usec %llu\n"
+                     "nr_periods 0\nnr_throttled 0\nthrottled_usec 0\n",
+                     g->usage_usec, g->user_usec, g->system_usec);
+        if (put_file(path, buf, (size_t)n) != 0) return -1;
+
+        snprintf(path, sizeof(path), "%s/memory.current", dir);
+        n = snprintf(buf, sizeof(buf), "%llu\n", g->anon + g->file);
+        if (put_file(path, buf, (size_t)n) != 0) return -1;
+
+        /* grupos ímpares com limite (2x o uso inicial), pares sem */
+        snprintf(path, sizeof(path), "%s/memory.max", dir);
+        n = k % 2 ? snprintf(buf, sizeof(buf), "%llu\n", (unsigned long long)(g->nprocs + 1) * 128 * 1024 * 1024)
+                  : snprintf(buf, sizeof(buf), "max\n");
+        if (put_file(path, buf, (size_t)n) != 0) return -1;
+
+        snprintf(path, sizeof(path), "%s/memory.stat", dir);
+        n = snprintf(buf, sizeof(buf), "anon %llu\nfile %llu\nkernel 1048576\nshmem 0\n"
+                     "file_mapped %llu\npgfault %llu\npgmajfault %llu\n",
+                     g->anon, g->file, g->file / 2, g->pgfault, g->pgmajfault);
+        if (put_file(path, buf, (size_t)n) != 0) return -1;
+
+        snprintf(path, sizeof(path), "%s/io.stat", dir);
+        n = snprintf(buf, sizeof(buf), "8:0 rbytes=%llu wbytes=%llu rios=%llu wios=%llu dbytes=0 dios=0\n",
+                     g->rbytes, g->wbytes, g->rios, g->wios);
+        if (put_file(path, buf, (size_t)n) != 0) return -1;
+
+        static const char *psi[] = { "cpu.pressure", "memory.pressure", "io.pressure" };
+        for (int r = 0; r < 3; r++) {
+            snprintf(path, sizeof(path), "%s/%s", dir, psi[r]);
+            if (write_pressure(path, (double)((cfg->tick + (unsigned long)(k + r)) % 20) / 2.0,
+                               g->usage_usec / (unsigned long long)(10 + r)) != 0)
+                return -1;
+        }
+    }
+
+    /* cgroup.procs: membros de cada grupo */
+    FILE **procs = calloc((size_t)cfg->ngroups, sizeof(FILE *));
+    if (!procs) return -1;
+    int rc = 0;
+    for (int k = 0; k < cfg->ngroups && rc == 0; k++) {
+        snprintf(path, sizeof(path), "%s/resource_monitor/g%03d/cgroup.procs", cgroot, k);
+        if (!(procs[k] = fopen(path, "w"))) rc = -1;
+    }
+    for (size_t i = 0; i < cfg->nprocs && rc == 0; i++)
+        fprintf(procs[i % (size_t)cfg->ngroups], "%d\n", procfixture_pid(cfg, i));
+    for (int k = 0; k < cfg->ngroups; k++)
+        if (procs[k]) fclose(procs[k]);
+    free(procs);
+    return rc;
+}
+
+int procfixture_write(const char *root, const procfixture_config_t *cfg) {
+    char proc[300], cgroot[300], path[400];
+    snprintf(proc, sizeof(proc), "%s/proc", root);
+    snprintf(cgroot, sizeof(cgroot), "%s/cgroup", root);
+    snprintf(path, sizeof(path), "%s/pressure", proc);
+    if (make_dirs(path) != 0) return -1;
+    snprintf(path, sizeof(path), "%s/resource_monitor", cgroot);
+    if (make_dirs(path) != 0) return -1;
+
+    /* primeira gravação cria diretórios, links de namespace e /proc/<pid>/cgroup */
+    snprintf(path, sizeof(path), "%s/%d", proc, procfixture_pid(cfg, 0));
+    int first = access(path, F_OK) != 0;
+
+    long page_kb = sysconf(_SC_PAGESIZE) / 1024;
+    if (page_kb <= 0) page_kb = 4;
+    group_acc_t *groups = calloc(cfg->ngroups > 0 ? (size_t)cfg->ngroups : 1, sizeof(*groups));
+    if (!groups) return -1;
+
+    size_t running = 0;
+    int rc = 0;
+    for (size_t i = 0; i < cfg->nprocs && rc == 0; i++) {
+        rc = write_process(proc, cfg, i, page_kb, first, groups);
+        if (i % 10 == 0) running++;
+    }
+    if (rc == 0) rc = write_system(proc, cfg, running);
+    if (rc == 0 && cfg->ngroups > 0) rc = write_groups(cgroot, cfg, groups);
+    free(groups);
+    return rc;
+}
+
+static int remove_entry(const char *path, const struct stat *sb, int flag, struct FTW *ftw) {
+    (void)sb; (void)flag; (void)ftw;
+    return remove(path) == 0 || errno == ENOENT ? 0 : -1;
+}
+
+int procfixture_remove(const char *root) {
+    char path[300];
+    int rc = 0;
+    snprintf(path, sizeof(path), "%s/proc", root);
+    if (access(path, F_OK) == 0 && nftw(path, remove_entry, 64, FTW_DEPTH | FTW_PHYS) != 0) rc = -1;
+    snprintf(path, sizeof(path), "%s/cgroup", root);
+    if (access(path, F_OK) == 0 && nftw(path, remove_entry, 64, FTW_DEPTH | FTW_PHYS) != 0) rc = -1;
+    rmdir(root);
+    return rc;
+}
@@ -0,0 +1,279 @@
+/*
+ * src/query.c
+ *
+ * --query: filtra uma gravação por tempo, PID e condições sobre colunas,
+ * pulando blocos pelo índice esparso.
+ */
+
+#include "query.h"
+#include "blockindex.h"
+#include "replay.h"
+#include "export.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+void query_init(query_t *q) {
+    memset(q, 0, sizeof(*q));
+    q->from = -INFINITY;
+    q->to = INFINITY;
+}
+
+int query_add_where(query_t *q, const char *expr) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", expr);
+    char *save = NULL;
+    for (char *tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+        while (*tok == ' ') tok++;
+        char *op = strpbrk(tok, "<>=!");
+        if (!op || op == tok) {
+            fprintf(stderr, "Condição inválida: %s (ex: cpu_percent>80)\n", tok);
+            return -1;
+        }
+
+        query_pred_t p;
+        const char *val;
+        if (op[0] == '>' && op[1] == '=')      { p.op = QUERY_GE; val = op + 2; }
+        else if (op[0] == '<' && op[1] == '=') { p.op = QUERY_LE; val = op + 2; }
+        else if (op[0] == '!' && op[1] == '=') { p.op = QUERY_NE; val = op + 2; }
+        else if (op[0] == '=' && op[1] == '=') { p.op = QUERY_EQ; val = op + 2; }
+        else if (op[0] == '>')                 { p.op = QUERY_GT; val = op + 1; }
+        else if (op[0] == '<')                 { p.op = QUERY_LT; val = op + 1; }
+        else if (op[0] == '=')                 { p.op = QUERY_EQ; val = op + 1; }
+        else {
+            fprintf(stderr, "Operador inválido em: %s\n", tok);
+            return -1;
+        }
+
+        char *end_name = op;
+        while (end_name > tok && end_name[-1] == ' ') end_name--;
+        *end_name = '\0';
+        p.field = metric_field_find(tok);
+        if (p.field < 0) {
+            fprintf(stderr, "Campo desconhecido em --where: %s\n", tok);
+            return -1;
+        }
+        char *endp;
+        p.value = strtod(val, &endp);
+        if (endp == val) {
+            fprintf(stderr, "Valor inválido em --where: %s\n", val);
+            return -1;
+        }
+        if (q->npreds >= QUERY_MAX_PREDS) {
+            fprintf(stderr, "Máximo de %d condições em --where\n", QUERY_MAX_PREDS);
+            return -1;
+        }
+        q->preds[q->npreds++] = p;
+    }
+    return 0;
+}
+
+static int pred_eval(const query_pred_t *p, double v) {
+    switch (p->op) {
+        case QUERY_GT: return v > p->value;
+        case QUERY_GE: return v >= p->value;
+        case QUERY_LT: return v < p->value;
+        case QUERY_LE: return v <= p->value;
+        case QUERY_EQ: return v == p->value;
+        case QUERY_NE: return v != p->value;
+    }
+    return 0;
+}
+
+/* 1 se algum valor em [min, max] pode satisfazer p (NaN = coluna sem limites) */
+static int pred_may_match(const query_pred_t *p, double min, double max) {
+    if (isnan(min) || isnan(max)) return 1;
+    switch (p->op) {
+        case QUERY_GT: return max > p->value;
+        case QUERY_GE: return max >= p->value;
+        case QUERY_LT: return min < p->value;
+        case QUERY_LE: return min <= p->value;
+        case QUERY_EQ: return min <= p->value && p->value <= max;
+        case QUERY_NE: return !(min == max && min == p->value);
+    }
+    return 1;
+}
+
+static int row_matches(const query_t *q, const proc_metrics_t *m) {
+    if (m->timestamp < q->from || m->timestamp > q->to) return 0;
+    if (q->has_pid && m->pid != q->pid) return 0;
+    const metric_field_t *fields = metric_fields(NULL);
+    for (int i = 0; i < q->npreds; i++)
+        if (!pred_eval(&q->preds[i], metric_field_value(m, &fields[q->preds[i].field])))
+            return 0;
+    return 1;
+}
+
+static int block_may_match(const query_t *q, const block_index_block_t *b, int pid_field) {
+    if (b->e.ts_last < q->from || b->e.ts_first > q->to) return 0;
+    if (q->has_pid && !isnan(b->min[pid_field]) &&
+        (q->pid < b->min[pid_field] || q->pid > b->max[pid_field]))
+        return 0;
+    for (int i = 0; i < q->npreds; i++) {
+        int f = q->preds[i].field;
+        if (!pred_may_match(&q->preds[i], b->min[f], b->max[f])) return 0;
+    }
+    return 1;
+}
+
+/* ===================== CSV ====================== */
+
+static int query_csv(const char *path, const query_t *q, FILE *out, query_stats_t *st) {
+    replay_data_t d;
+    memset(&d, 0, sizeof(d));
+    if (replay_map_file(path, &d) != 0) return -1;
+    const char *base = d.map;
+    const char *end = base + d.map_len;
+
+    csv_layout_t lay;
+    const char *data = replay_csv_layout(base, end, &lay);
+    if (!data) {
+        fprintf(stderr, "CSV sem colunas Timestamp/PID: %s\n", path);
+        replay_free(&d);
+        return -1;
+    }
+    const metric_field_t *fields = metric_fields(NULL);
+    for (int i = 0; i < q->npreds; i++) {
+        if (!lay.present[q->preds[i].field]) {
+            fprintf(stderr, "Coluna '%s' não foi gravada em %s\n", fields[q->preds[i].field].name, path);
+            replay_free(&d);
+            return -1;
+        }
+    }
+
+    /* cabeçalho (e linha de supressão) copiados como estão */
+    fwrite(base, 1, (size_t)(data - base), out);
+
+    proc_metrics_t m;
+    int is_row;
+    block_index_t idx;
+    if (block_index_load(path, &idx) == 0) {
+        st->indexed = 1;
+        st->blocks_total = idx.h.nblocks;
+        int pid_field = metric_field_find("pid");
+        for (size_t b = 0; b < idx.h.nblocks; b++) {
+            const block_index_block_t *blk = &idx.blocks[b];
+            if (!block_may_match(q, blk, pid_field)) continue;
+            if (blk->e.offset >= d.map_len) break;
+            st->blocks_read++;
+            const char *p = base + blk->e.offset;
+            for (uint32_t r = 0; r < blk->e.rows && p < end;) {
+                const char *line = p;
+                p = replay_csv_row(p, end, &lay, &m, &is_row);
+                if (!is_row) continue;
+                r++;
+                st->rows_scanned++;
+                if (row_matches(q, &m)) {
+                    fwrite(line, 1, (size_t)(p - line), out);
+                    st->rows_matched++;
+                }
+            }
+        }
+        block_index_free(&idx);
+    } else {
+        /* sem índice (ou desatualizado): varre tudo e cria o índice no caminho */
+        block_index_writer_t bi;
+        int build = block_index_open(&bi, path, lay.present) == 0;
+        const char *p = data;
+        while (p < end) {
+            const char *line = p;
+            p = replay_csv_row(p, end, &lay, &m, &is_row);
+            if (!is_row) continue;
+            st->rows_scanned++;
+            if (build) block_index_add(&bi, &m, (uint64_t)(line - base));
+            if (row_matches(q, &m)) {
+                fwrite(line, 1, (size_t)(p - line), out);
+                st->rows_matched++;
+            }
+        }
+        if (build) {
+            st->blocks_total = st->blocks_read = bi.nblocks + (bi.cur.rows ? 1 : 0);
+            block_index_close(&bi, d.map_len);
+        }
+    }
+
+    replay_free(&d);
+    return 0;
+}
+
+/* ===================== .RMB ====================== */
+
+static int query_rmb(const char *path, const query_t *q, FILE *out, query_stats_t *st) {
+    replay_data_t d;
+    if (replay_load(path, &d) != 0) return -1;
+
+    csv_writer_t w;
+    if (csv_writer_attach(&w, out) != 0) {
+        replay_free(&d);
+        return -1;
+    }
+    const field_selection_t *sel = export_get_fields();
+    const metric_field_t *fields = metric_fields(NULL);
+    for (int c = 0; c < sel->count; c++) {
+        if (c > 0) csv_put_char(&w, ',');
+        csv_put_str(&w, fields[sel->idx[c]].csv_header);
+    }
+    csv_put_char(&w, '\n');
+
+    const size_t hsize = ((const rmb_header_t *)d.map)->header_size;
+    const size_t rsize = ((const rmb_header_t *)d.map)->record_size;
+    block_index_t idx;
+    int indexed = block_index_load(path, &idx) == 0;
+    size_t nblocks = indexed ? idx.h.nblocks : (d.count + BLOCK_INDEX_ROWS - 1) / BLOCK_INDEX_ROWS;
+    int pid_field = metric_field_find("pid");
+    st->indexed = indexed;
+    st->blocks_total = nblocks;
+
+    for (size_t b = 0; b < nblocks; b++) {
+        size_t first, rows;
+        if (indexed) {
+            if (!block_may_match(q, &idx.blocks[b], pid_field)) continue;
+            first = (idx.blocks[b].e.offset - hsize) / rsize;
+            rows = idx.blocks[b].e.rows;
+        } else {
+            first = b * BLOCK_INDEX_ROWS;
+            rows = BLOCK_INDEX_ROWS;
+        }
+        if (first >= d.count) break;
+        if (first + rows > d.count) rows = d.count - first;
+        st->blocks_read++;
+        for (size_t i = first; i < first + rows; i++) {
+            const proc_metrics_t *m = &d.samples[i];
+            st->rows_scanned++;
+            if (!row_matches(q, m)) continue;
+            st->rows_matched++;
+            for (int c = 0; c < sel->count; c++) {
+                if (c > 0) csv_put_char(&w, ',');
+                csv_put_field(&w, m, &fields[sel->idx[c]]);
+            }
+            csv_put_char(&w, '\n');
+        }
+    }
+    int rc = csv_writer_close(&w);
+
+    if (indexed) {
+        block_index_free(&idx);
+    } else {
+        /* cria o índice para as próximas consultas */
+        block_index_writer_t bi;
+        if (block_index_open(&bi, path, NULL) == 0) {
+            for (size_t i = 0; i < d.count; i++)
+                block_index_add(&bi, &d.samples[i], hsize + i * rsize);
+            block_index_close(&bi, d.map_len);
+        }
+    }
+    replay_free(&d);
+    return rc;
+}
+
+int query_run(const char *path, const query_t *q, FILE *out, query_stats_t *stats) {
+    query_stats_t local;
+    if (!stats) stats = &local;
+    memset(stats, 0, sizeof(*stats));
+    if (strstr(path, ".rmb")) return query_rmb(path, q, out, stats);
+    if (strstr(path, ".json")) {
+        fprintf(stderr, "--query aceita apenas gravações .csv ou .rmb\n");
+        return -1;
+    }
+    return query_csv(path, q, out, stats);
+}
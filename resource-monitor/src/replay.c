@@ -0,0 +1,494 @@
+/*
+ * src/replay.c
+ *
+ * --replay: leitura de gravações (.rmb mapeado sem cópia, CSV a partir do
+ * mapeamento, JSON via json-c) e reprocessamento paralelo por série.
+ */
+
+#include "replay.h"
+#include "export.h"
+#include "sketch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <json-c/json.h>
+
+#define SUPPRESSED_TAG "# rm-suppressed"
+
+/* ===================== MAPEAMENTO ====================== */
+
+int replay_map_file(const char *path, replay_data_t *d) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror("Erro ao abrir gravação");
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        fprintf(stderr, "Gravação vazia ou ilegível: %s\n", path);
+        close(fd);
+        return -1;
+    }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror("Erro no mmap");
+        return -1;
+    }
+    madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+    d->map = p;
+    d->map_len = (size_t)st.st_size;
+    return 0;
+}
+
+/* ===================== .RMB ====================== */
+
+static int load_rmb(const char *path, replay_data_t *d) {
+    if (replay_map_file(path, d) != 0) return -1;
+
+    const rmb_header_t *h = d->map;
+    if (d->map_len < sizeof(*h) || memcmp(h->magic, RMB_MAGIC, 4) != 0 ||
+        h->version != RMB_VERSION || h->header_size < sizeof(*h) ||
+        h->header_size > d->map_len) {
+        fprintf(stderr, "Arquivo .rmb inválido: %s\n", path);
+        return -1;
+    }
+    /* campos novos entram no fim de proc_metrics_t: registro menor é de uma versão anterior */
+    if (h->record_size == 0 || h->record_size > sizeof(proc_metrics_t)) {
+        fprintf(stderr, "Arquivo .rmb gravado com outro layout (registro de %u bytes, esperado %zu)\n",
+                h->record_size, sizeof(proc_metrics_t));
+        return -1;
+    }
+
+    /* um arquivo truncado ainda pode ser lido até o último registro completo */
+    size_t avail = (d->map_len - h->header_size) / h->record_size;
+    d->count = (h->count && h->count < avail) ? (size_t)h->count : avail;
+    const char *rec = (const char *)d->map + h->header_size;
+    if (h->record_size == sizeof(proc_metrics_t)) {
+        d->samples = (const proc_metrics_t *)rec;
+        return 0;
+    }
+    /* layout antigo: copia cada registro e deixa os campos que faltam em zero */
+    d->owned = calloc(d->count ? d->count : 1, sizeof(proc_metrics_t));
+    if (!d->owned) return -1;
+    for (size_t i = 0; i < d->count; i++)
+        memcpy(&d->owned[i], rec + i * h->record_size, h->record_size);
+    d->samples = d->owned;
+    return 0;
+}
+
+/* ===================== CSV ====================== */
+
+/* índice do campo pelo cabeçalho CSV ("CPU%") ou pelo nome ("cpu_percent") */
+static int csv_column_field(const char *name, size_t len) {
+    size_t nf;
+    const metric_field_t *fields = metric_fields(&nf);
+    for (size_t i = 0; i < nf; i++) {
+        if ((strlen(fields[i].csv_header) == len && memcmp(fields[i].csv_header, name, len) == 0) ||
+            (strlen(fields[i].name) == len && memcmp(fields[i].name, name, len) == 0))
+            return (int)i;
+    }
+    return -1;
+}
+
+static const char *line_end(const char *p, const char *end) {
+    if (p >= end) return end;
+    const char *nl = memchr(p, '\n', (size_t)(end - p));
+    return nl ? nl : end;
+}
+
+const char *replay_csv_layout(const char *p, const char *end, csv_layout_t *lay) {
+    memset(lay, 0, sizeof(*lay));
+
+    /* linhas de comentário; a de supressão traz o intervalo */
+    while (p < end && *p == '#') {
+        const char *le = line_end(p, end);
+        size_t tag = sizeof(SUPPRESSED_TAG) - 1;
+        if ((size_t)(le - p) > tag && memcmp(p, SUPPRESSED_TAG, tag) == 0) {
+            char meta[256];
+            size_t n = (size_t)(le - p) < sizeof(meta) - 1 ? (size_t)(le - p) : sizeof(meta) - 1;
+            memcpy(meta, p, n);
+            meta[n] = '\0';
+            const char *iv = strstr(meta, "interval=");
+            if (iv) lay->interval_s = atof(iv + 9);
+        }
+        p = le < end ? le + 1 : end;
+    }
+
+    /* cabeçalho -> campo de cada coluna */
+    const metric_field_t *fields = metric_fields(NULL);
+    int has_ts = 0, has_pid = 0;
+    const char *le = line_end(p, end);
+    while (p < le && lay->ncols < METRIC_FIELD_MAX) {
+        const char *c = p;
+        while (c < le && *c != ',' && *c != '\r') c++;
+        int f = csv_column_field(p, (size_t)(c - p));
+        if (f >= 0) {
+            if (strcmp(fields[f].name, "timestamp") == 0) has_ts = 1;
+            if (strcmp(fields[f].name, "pid") == 0) has_pid = 1;
+            lay->present[f] = 1;
+        }
+        lay->col_field[lay->ncols++] = f;
+        p = (c < le && *c == ',') ? c + 1 : le;
+    }
+    if (!has_ts || !has_pid) return NULL;
+    return le < end ? le + 1 : end;
+}
+
+const char *replay_csv_row(const char *p, const char *end, const csv_layout_t *lay,
+                           proc_metrics_t *m, int *is_row) {
+    const char *le = line_end(p, end);
+    *is_row = le > p && *p != '#' && *p != '\r';
+    if (*is_row) {
+        const metric_field_t *fields = metric_fields(NULL);
+        memset(m, 0, sizeof(*m));
+        int col = 0;
+        while (p < le && col < lay->ncols) {
+            const char *c = p;
+            while (c < le && *c != ',') c++;
+            if (lay->col_field[col] >= 0) {
+                char num[64];
+                size_t len = (size_t)(c - p) < sizeof(num) - 1 ? (size_t)(c - p) : sizeof(num) - 1;
+                memcpy(num, p, len);
+                num[len] = '\0';
+                metric_field_set(m, &fields[lay->col_field[col]], strtod(num, NULL));
+            }
+            col++;
+            p = c < le ? c + 1 : le;
+        }
+    }
+    return le < end ? le + 1 : end;
+}
+
+static int load_csv(const char *path, replay_data_t *d) {
+    if (replay_map_file(path, d) != 0) return -1;
+    const char *p = d->map;
+    const char *end = p + d->map_len;
+
+    csv_layout_t lay;
+    p = replay_csv_layout(p, end, &lay);
+    if (!p) {
+        fprintf(stderr, "CSV sem colunas Timestamp/PID (agregados de tier não podem ser reprocessados): %s\n", path);
+        return -1;
+    }
+    d->interval_s = lay.interval_s;
+
+    /* dimensiona pelo número de linhas restantes */
+    size_t lines = 0;
+    for (const char *q = p; q < end; q = line_end(q, end) + 1) lines++;
+    d->owned = calloc(lines ? lines : 1, sizeof(proc_metrics_t));
+    if (!d->owned) return -1;
+
+    size_t n = 0;
+    while (p < end) {
+        int is_row;
+        p = replay_csv_row(p, end, &lay, &d->owned[n], &is_row);
+        if (is_row) n++;
+    }
+
+    d->samples = d->owned;
+    d->count = n;
+    /* os valores já foram copiados: o mapeamento não é mais necessário */
+    munmap(d->map, d->map_len);
+    d->map = NULL;
+    d->map_len = 0;
+    return 0;
+}
+
+/* ===================== JSON ====================== */
+
+static int load_json(const char *path, replay_data_t *d) {
+    struct json_object *root = json_object_from_file(path);
+    if (!root) {
+        fprintf(stderr, "JSON inválido: %s\n", path);
+        return -1;
+    }
+    struct json_object *arr = root, *tmp;
+    if (json_object_get_type(root) == json_type_object) {
+        if (json_object_object_get_ex(root, "suppression", &tmp) &&
+            json_object_object_get_ex(tmp, "interval", &tmp))
+            d->interval_s = json_object_get_double(tmp);
+        if (!json_object_object_get_ex(root, "samples", &arr)) arr = NULL;
+    }
+    if (!arr || json_object_get_type(arr) != json_type_array) {
+        fprintf(stderr, "JSON sem array de amostras: %s\n", path);
+        json_object_put(root);
+        return -1;
+    }
+
+    size_t len = json_object_array_length(arr), nf;
+    const metric_field_t *fields = metric_fields(&nf);
+    d->owned = calloc(len ? len : 1, sizeof(proc_metrics_t));
+    if (!d->owned) {
+        json_object_put(root);
+        return -1;
+    }
+    for (size_t i = 0; i < len; i++) {
+        struct json_object *o = json_object_array_get_idx(arr, i);
+        for (size_t f = 0; f < nf; f++)
+            if (json_object_object_get_ex(o, fields[f].name, &tmp))
+                metric_field_set(&d->owned[i], &fields[f], json_object_get_double(tmp));
+    }
+    json_object_put(root);
+    d->samples = d->owned;
+    d->count = len;
+    return 0;
+}
+
+int replay_load(const char *path, replay_data_t *d) {
+    memset(d, 0, sizeof(*d));
+    int rc;
+    if (strstr(path, ".rmb")) rc = load_rmb(path, d);
+    else if (strstr(path, ".json")) rc = load_json(path, d);
+    else rc = load_csv(path, d);
+    if (rc != 0) replay_free(d);
+    return rc;
+}
+
+void replay_free(replay_data_t *d) {
+    if (d->map) munmap(d->map, d->map_len);
+    free(d->owned);
+    memset(d, 0, sizeof(*d));
+}
+
+/* ===================== SÉRIES ====================== */
+
+typedef struct {
+    pid_t pid;
+    double ts;
+    size_t idx;
+} series_key_t;
+
+typedef struct {
+    double timestamp;
+    char metric[ANOMALY_METRIC_NAME_MAX];
+    double value;
+    double z;
+    char detectors[64];
+} replay_event_t;
+
+typedef struct {
+    pid_t pid;
+    const size_t *idx;          // índices em replay_data_t.samples, em ordem de tempo
+    size_t n;
+
+    replay_event_t *events;
+    size_t nevents;
+    size_t cap_events;
+    metric_summary_t summary;
+    int failed;
+} replay_series_t;
+
+typedef struct {
+    const replay_data_t *d;
+    const replay_options_t *opt;
+    replay_series_t *series;
+    size_t nseries;
+    atomic_size_t next;
+} replay_job_t;
+
+static int cmp_key(const void *a, const void *b) {
+    const series_key_t *x = a, *y = b;
+    if (x->pid != y->pid) return x->pid < y->pid ? -1 : 1;
+    if (x->ts != y->ts) return x->ts < y->ts ? -1 : 1;
+    return (x->idx > y->idx) - (x->idx < y->idx);
+}
+
+static void collect_event(const anomaly_event_t *ev, void *ctx) {
+    replay_series_t *s = ctx;
+    if (s->nevents == s->cap_events) {
+        size_t cap = s->cap_events ? s->cap_events * 2 : 64;
+        replay_event_t *p = realloc(s->events, cap * sizeof(*p));
+        if (!p) { s->failed = 1; return; }
+        s->events = p;
+        s->cap_events = cap;
+    }
+    replay_event_t *e = &s->events[s->nevents++];
+    e->timestamp = ev->timestamp;
+    snprintf(e->metric, sizeof(e->metric), "%s", ev->metric);
+    e->value = ev->value;
+    e->z = ev->z;
+    snprintf(e->detectors, sizeof(e->detectors), "%s", ev->detectors);
+}
+
+static void feed_sample(replay_series_t *s, anomaly_engine_t *eng, const replay_options_t *opt,
+                        const proc_metrics_t *m) {
+    if (opt->anomaly) {
+        anomaly_fill_proc(anomaly_engine_row(eng, 0), m);
+        anomaly_engine_tick(eng, m->timestamp, collect_event, s);
+    }
+    if (opt->summary) metric_summary_add(&s->summary, m);
+}
+
+static void process_series(const replay_job_t *job, replay_series_t *s) {
+    const replay_options_t *opt = job->opt;
+    anomaly_engine_t eng;
+    if (opt->anomaly) {
+        anomaly_metric_t metrics[ANOMALY_MAX_METRICS];
+        size_t nm = anomaly_proc_metrics(metrics, ANOMALY_MAX_METRICS);
+        if (anomaly_engine_init(&eng, 1, metrics, nm, &opt->anomaly_cfg) != 0) {
+            s->failed = 1;
+            return;
+        }
+    }
+    metric_summary_init(&s->summary, s->pid);
+
+    const double iv = job->d->interval_s;
+    const proc_metrics_t *prev = NULL;
+    for (size_t k = 0; k < s->n; k++) {
+        const proc_metrics_t *m = &job->d->samples[s->idx[k]];
+        /* gravação com supressão: repete a última amostra nos intervalos omitidos */
+        if (prev && iv > 0.0) {
+            proc_metrics_t fill = *prev;
+            for (double t = prev->timestamp + iv; t < m->timestamp - iv / 2.0; t += iv) {
+                fill.timestamp = t;
+                feed_sample(s, &eng, opt, &fill);
+            }
+        }
+        feed_sample(s, &eng, opt, m);
+        prev = m;
+    }
+    if (opt->anomaly) anomaly_engine_free(&eng);
+}
+
+static void *replay_worker(void *arg) {
+    replay_job_t *job = arg;
+    for (;;) {
+        size_t i = atomic_fetch_add(&job->next, 1);
+        if (i >= job->nseries) break;
+        process_series(job, &job->series[i]);
+    }
+    return NULL;
+}
+
+/* ===================== EXECUÇÃO ====================== */
+
+static int write_events(const char *path, const replay_series_t *series, size_t nseries) {
+    char out[512];
+    snprintf(out, sizeof(out), "%s.replay.anomalies.jsonl", path);
+    FILE *f = fopen(out, "w");
+    if (!f) {
+        perror("Erro ao criar arquivo de anomalias");
+        return -1;
+    }
+    fprintf(f, "# JSON Lines: timestamp,pid,metric,value,z,detectors\n");
+    for (size_t i = 0; i < nseries; i++)
+        for (size_t k = 0; k < series[i].nevents; k++) {
+            const replay_event_t *e = &series[i].events[k];
+            fprintf(f, "{\"timestamp\": %.0f, \"pid\": %d, \"metric\": \"%s\", "
+                    "\"value\": %.6f, \"z\": %.6f, \"detectors\": \"%s\"}\n",
+                    e->timestamp, series[i].pid, e->metric, e->value, e->z, e->detectors);
+        }
+    fclose(f);
+    printf("Anomalias gravadas em %s\n", out);
+    return 0;
+}
+
+int replay_run(const char *path, const replay_options_t *opt) {
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    replay_data_t d;
+    if (replay_load(path, &d) != 0) return -1;
+
+    /* agrupa por PID, em ordem de tempo */
+    series_key_t *keys = malloc((d.count ? d.count : 1) * sizeof(*keys));
+    size_t *order = malloc((d.count ? d.count : 1) * sizeof(*order));
+    if (!keys || !order) {
+        free(keys);
+        free(order);
+        replay_free(&d);
+        return -1;
+    }
+    for (size_t i = 0; i < d.count; i++) {
+        keys[i].pid = d.samples[i].pid;
+        keys[i].ts = d.samples[i].timestamp;
+        keys[i].idx = i;
+    }
+    qsort(keys, d.count, sizeof(*keys), cmp_key);
+
+    size_t nseries = 0;
+    for (size_t i = 0; i < d.count; i++) {
+        order[i] = keys[i].idx;
+        if (i == 0 || keys[i].pid != keys[i - 1].pid) nseries++;
+    }
+    replay_series_t *series = calloc(nseries ? nseries : 1, sizeof(*series));
+    if (!series) {
+        free(keys);
+        free(order);
+        replay_free(&d);
+        return -1;
+    }
+    for (size_t i = 0, s = 0; i < d.count; i++) {
+        if (i > 0 && keys[i].pid != keys[i - 1].pid) s++;
+        if (series[s].n == 0) {
+            series[s].pid = keys[i].pid;
+            series[s].idx = &order[i];
+        }
+        series[s].n++;
+    }
+    free(keys);
+
+    int nthreads = opt->threads > 0 ? opt->threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (nthreads < 1) nthreads = 1;
+    if ((size_t)nthreads > nseries) nthreads = nseries ? (int)nseries : 1;
+
+    replay_job_t job = { &d, opt, series, nseries, 0 };
+    pthread_t *tids = malloc((size_t)nthreads * sizeof(pthread_t));
+    int started = 0;
+    for (int t = 0; tids && t < nthreads; t++) {
+        if (pthread_create(&tids[t], NULL, replay_worker, &job) != 0) break;
+        started++;
+    }
+    if (started == 0) replay_worker(&job);   // sem threads: processa aqui mesmo
+    for (int t = 0; t < started; t++) pthread_join(tids[t], NULL);
+    free(tids);
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double ms = (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
+
+    int rc = 0;
+    size_t total_events = 0;
+    for (size_t i = 0; i < nseries; i++) {
+        total_events += series[i].nevents;
+        if (series[i].failed) rc = -1;
+    }
+    printf("Replay: %zu amostras, %zu séries, %d threads, %.1f ms%s\n",
+           d.count, nseries, started ? started : 1, ms,
+           d.interval_s > 0.0 ? " (supressão reexpandida)" : "");
+
+    if (opt->anomaly) {
+        printf("Anomalias: %zu\n", total_events);
+        if (write_events(path, series, nseries) != 0) rc = -1;
+    }
+
+    if (opt->summary && nseries > 0) {
+        metric_summary_t *sums = malloc(nseries * sizeof(*sums));
+        if (sums) {
+            for (size_t i = 0; i < nseries; i++) {
+                sums[i] = series[i].summary;
+                metric_summary_print(&sums[i]);
+            }
+            char out[512];
+            snprintf(out, sizeof(out), "%s.replay.summary.csv", path);
+            if (export_summary(out, sums, nseries) != 0) rc = -1;
+            free(sums);
+        } else {
+            rc = -1;
+        }
+    }
+
+    for (size_t i = 0; i < nseries; i++) free(series[i].events);
+    free(series);
+    free(order);
+    replay_free(&d);
+    return rc;
+}
@@ -0,0 +1,385 @@
+/*
+ * src/rollup.c
+ *
+ * Armazenamento em camadas (bruto, 10 s, 1 min) com buffers circulares
+ * pré-alocados. Os agregados guardam min/max/média/último em float, e em
+ * double só os contadores de 64 bits, para que os tiers padrão caibam em
+ * poucos MB sem perder unidades dos contadores acumulados.
+ */
+
+#include "rollup.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <json-c/json.h>
+
+static const double k_tier_resolution[ROLLUP_TIER_COUNT] = { 0.0, 10.0, 60.0 };
+static const char *k_tier_names[ROLLUP_TIER_COUNT] = { "raw", "10s", "1m" };
+
+/* ===================== TIERS AGREGADOS ====================== */
+
+static int tier_init(rollup_tier_t *t, double resolution, size_t cap, const rollup_store_t *st) {
+    memset(t, 0, sizeof(*t));
+    t->resolution_s = resolution;
+    t->cap = cap;
+    if (cap == 0) return 0;
+
+    size_t cells = cap * (size_t)st->nnarrow, wcells = cap * (size_t)st->nwide;
+    size_t nm = (size_t)st->nmetrics;
+    t->start_ts = calloc(cap, sizeof(double));
+    t->samples  = calloc(cap, sizeof(unsigned));
+    t->min      = calloc(cells ? cells : 1, sizeof(float));
+    t->max      = calloc(cells ? cells : 1, sizeof(float));
+    t->mean     = calloc(cells ? cells : 1, sizeof(float));
+    t->last     = calloc(cells ? cells : 1, sizeof(float));
+    t->wmin     = calloc(wcells ? wcells : 1, sizeof(double));
+    t->wmax     = calloc(wcells ? wcells : 1, sizeof(double));
+    t->wmean    = calloc(wcells ? wcells : 1, sizeof(double));
+    t->wlast    = calloc(wcells ? wcells : 1, sizeof(double));
+    t->acc_sum  = calloc(nm, sizeof(double));
+    t->acc_min  = calloc(nm, sizeof(double));
+    t->acc_max  = calloc(nm, sizeof(double));
+    t->acc_last = calloc(nm, sizeof(double));
+    if (!t->start_ts || !t->samples || !t->min || !t->max || !t->mean || !t->last ||
+        !t->wmin || !t->wmax || !t->wmean || !t->wlast ||
+        !t->acc_sum || !t->acc_min || !t->acc_max || !t->acc_last)
+        return -1;
+    return 0;
+}
+
+static void tier_free(rollup_tier_t *t) {
+    free(t->start_ts); free(t->samples);
+    free(t->min); free(t->max); free(t->mean); free(t->last);
+    free(t->wmin); free(t->wmax); free(t->wmean); free(t->wlast);
+    free(t->acc_sum); free(t->acc_min); free(t->acc_max); free(t->acc_last);
+    memset(t, 0, sizeof(*t));
+}
+
+/* fecha a janela aberta e grava no buffer circular */
+static void tier_close_window(rollup_tier_t *t, const rollup_store_t *st) {
+    if (t->acc_n == 0) return;
+    size_t slot = t->head;
+    size_t base = slot * (size_t)st->nnarrow, wbase = slot * (size_t)st->nwide;
+    t->start_ts[slot] = t->acc_start;
+    t->samples[slot] = t->acc_n;
+    for (int k = 0; k < st->nmetrics; k++) {
+        double mean = t->acc_sum[k] / t->acc_n;
+        if (st->wide[k]) {
+            size_t i = wbase + (size_t)st->col[k];
+            t->wmin[i]  = t->acc_min[k];
+            t->wmax[i]  = t->acc_max[k];
+            t->wmean[i] = mean;
+            t->wlast[i] = t->acc_last[k];
+        } else {
+            size_t i = base + (size_t)st->col[k];
+            t->min[i]  = (float)t->acc_min[k];
+            t->max[i]  = (float)t->acc_max[k];
+            t->mean[i] = (float)mean;
+            t->last[i] = (float)t->acc_last[k];
+        }
+    }
+    t->head = (t->head + 1) % t->cap;
+    if (t->count < t->cap) t->count++;
+    t->acc_n = 0;
+}
+
+static void tier_add(rollup_tier_t *t, const rollup_store_t *st, double ts, const double *vals) {
+    if (t->cap == 0) return;
+    int nmetrics = st->nmetrics;
+    double start = floor(ts / t->resolution_s) * t->resolution_s;
+    if (t->acc_n > 0 && start != t->acc_start)
+        tier_close_window(t, st);
+
+    if (t->acc_n == 0) {
+        t->acc_start = start;
+        for (int k = 0; k < nmetrics; k++) {
+            t->acc_sum[k] = 0.0;
+            t->acc_min[k] = vals[k];
+            t->acc_max[k] = vals[k];
+        }
+    }
+    for (int k = 0; k < nmetrics; k++) {
+        double v = vals[k];
+        t->acc_sum[k] += v;
+        if (v < t->acc_min[k]) t->acc_min[k] = v;
+        if (v > t->acc_max[k]) t->acc_max[k] = v;
+        t->acc_last[k] = v;
+    }
+    t->acc_n++;
+}
+
+/* ===================== STORE ====================== */
+
+int rollup_store_init(rollup_store_t *st, pid_t pid, size_t raw_cap, size_t cap_10s, size_t cap_1m) {
+    memset(st, 0, sizeof(*st));
+    st->pid = pid;
+
+    /* só as métricas selecionadas em --fields (os grupos opcionais ficam de
+       fora por padrão), exceto as chaves Timestamp/PID: o tier bruto guarda
+       a amostra inteira, então o que não é exportado não precisa de agregado */
+    size_t nf;
+    const metric_field_t *fields = metric_fields(&nf);
+    const field_selection_t *sel = export_get_fields();
+    for (int c = 0; c < sel->count && st->nmetrics < METRIC_FIELD_MAX; c++) {
+        int i = sel->idx[c];
+        if (strcmp(fields[i].name, "timestamp") == 0 || strcmp(fields[i].name, "pid") == 0)
+            continue;
+        int k = st->nmetrics++;
+        st->metric_idx[k] = i;
+        st->wide[k] = fields[i].kind == FIELD_ULLONG;
+        st->col[k] = st->wide[k] ? st->nwide++ : st->nnarrow++;
+    }
+
+    if (raw_cap == 0) raw_cap = 1;
+    st->raw = calloc(raw_cap, sizeof(proc_metrics_t));
+    st->raw_cap = raw_cap;
+    if (!st->raw) return -1;
+
+    size_t caps[ROLLUP_TIER_COUNT] = { 0, cap_10s, cap_1m };
+    for (int t = ROLLUP_TIER_10S; t < ROLLUP_TIER_COUNT; t++) {
+        if (tier_init(&st->tiers[t], k_tier_resolution[t], caps[t], st) != 0) {
+            rollup_store_free(st);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void rollup_store_free(rollup_store_t *st) {
+    free(st->raw);
+    st->raw = NULL;
+    for (int t = ROLLUP_TIER_10S; t < ROLLUP_TIER_COUNT; t++)
+        tier_free(&st->tiers[t]);
+}
+
+void rollup_store_add(rollup_store_t *st, const proc_metrics_t *m) {
+    st->raw[st->raw_head] = *m;
+    st->raw_head = (st->raw_head + 1) % st->raw_cap;
+    if (st->raw_count < st->raw_cap) st->raw_count++;
+
+    if (st->tiers[ROLLUP_TIER_10S].cap == 0 && st->tiers[ROLLUP_TIER_1M].cap == 0)
+        return;
+
+    size_t nf;
+    const metric_field_t *fields = metric_fields(&nf);
+    double vals[METRIC_FIELD_MAX];
+    for (int k = 0; k < st->nmetrics; k++)
+        vals[k] = metric_field_value(m, &fields[st->metric_idx[k]]);
+
+    for (int t = ROLLUP_TIER_10S; t < ROLLUP_TIER_COUNT; t++)
+        tier_add(&st->tiers[t], st, m->timestamp, vals);
+}
+
+const proc_metrics_t *rollup_store_last(const rollup_store_t *st) {
+    if (st->raw_count == 0) return NULL;
+    return &st->raw[(st->raw_head + st->raw_cap - 1) % st->raw_cap];
+}
+
+size_t rollup_store_raw_copy(const rollup_store_t *st, proc_metrics_t *out, size_t max) {
+    size_t n = st->raw_count < max ? st->raw_count : max;
+    size_t first = (st->raw_head + st->raw_cap - st->raw_count) % st->raw_cap;
+    /* pula as mais antigas se out não couber tudo */
+    first = (first + (st->raw_count - n)) % st->raw_cap;
+    for (size_t i = 0; i < n; i++)
+        out[i] = st->raw[(first + i) % st->raw_cap];
+    return n;
+}
+
+size_t rollup_store_bytes(const rollup_store_t *st) {
+    size_t total = st->raw_cap * sizeof(proc_metrics_t);
+    for (int t = ROLLUP_TIER_10S; t < ROLLUP_TIER_COUNT; t++) {
+        const rollup_tier_t *tr = &st->tiers[t];
+        total += tr->cap * (sizeof(double) + sizeof(unsigned));
+        total += tr->cap * (size_t)st->nnarrow * 4 * sizeof(float);
+        total += tr->cap * (size_t)st->nwide * 4 * sizeof(double);
+        if (tr->cap) total += (size_t)st->nmetrics * 4 * sizeof(double);
+    }
+    return total;
+}
+
+void rollup_tier_window(const rollup_store_t *st, const rollup_tier_t *t, size_t slot,
+                        double *min, double *max, double *mean, double *last) {
+    size_t base = slot * (size_t)st->nnarrow, wbase = slot * (size_t)st->nwide;
+    for (int k = 0; k < st->nmetrics; k++) {
+        if (st->wide[k]) {
+            size_t i = wbase + (size_t)st->col[k];
+            min[k] = t->wmin[i]; max[k] = t->wmax[i]; mean[k] = t->wmean[i]; last[k] = t->wlast[i];
+        } else {
+            size_t i = base + (size_t)st->col[k];
+            min[k] = t->min[i]; max[k] = t->max[i]; mean[k] = t->mean[i]; last[k] = t->last[i];
+        }
+    }
+}
+
+int rollup_tier_parse(const char *name) {
+    for (int t = 0; t < ROLLUP_TIER_COUNT; t++)
+        if (strcmp(name, k_tier_names[t]) == 0) return t;
+    return -1;
+}
+
+/* ===================== EXPORTAÇÃO ====================== */
+
+/* posição (no vetor de métricas do store) de cada coluna selecionada */
+static int selected_metrics(const rollup_store_t *st, int *pos) {
+    const field_selection_t *sel = export_get_fields();
+    int n = 0;
+    for (int c = 0; c < sel->count; c++)
+        for (int k = 0; k < st->nmetrics; k++)
+            if (st->metric_idx[k] == sel->idx[c]) { pos[n++] = k; break; }
+    return n;
+}
+
+/* visita as janelas em ordem cronológica, incluindo a aberta */
+typedef void (*window_fn)(void *ctx, double start, unsigned n,
+                          const double *min, const double *max,
+                          const double *mean, const double *last);
+
+static void tier_visit(const rollup_store_t *st, const rollup_tier_t *t, window_fn fn, void *ctx) {
+    int nm = st->nmetrics;
+    double mn[METRIC_FIELD_MAX], mx[METRIC_FIELD_MAX], av[METRIC_FIELD_MAX], ls[METRIC_FIELD_MAX];
+    size_t first = (t->head + t->cap - t->count) % (t->cap ? t->cap : 1);
+    for (size_t i = 0; i < t->count; i++) {
+        size_t slot = (first + i) % t->cap;
+        rollup_tier_window(st, t, slot, mn, mx, av, ls);
+        fn(ctx, t->start_ts[slot], t->samples[slot], mn, mx, av, ls);
+    }
+    if (t->acc_n > 0) {
+        for (int k = 0; k < nm; k++) {
+            mn[k] = t->acc_min[k];
+            mx[k] = t->acc_max[k];
+            av[k] = t->acc_sum[k] / t->acc_n;
+            ls[k] = t->acc_last[k];
+        }
+        fn(ctx, t->acc_start, t->acc_n, mn, mx, av, ls);
+    }
+}
+
+typedef struct {
+    csv_writer_t *w;
+    pid_t pid;
+    const int *pos;
+    int npos;
+    const rollup_store_t *st;
+} csv_ctx_t;
+
+static void csv_window(void *vctx, double start, unsigned n,
+                       const double *min, const double *max,
+                       const double *mean, const double *last) {
+    csv_ctx_t *c = vctx;
+    size_t nf;
+    const metric_field_t *fields = metric_fields(&nf);
+    csv_put_fixed(c->w, start, 0);
+    csv_put_char(c->w, ',');
+    csv_put_i64(c->w, c->pid);
+    csv_put_char(c->w, ',');
+    csv_put_u64(c->w, n);
+    for (int i = 0; i < c->npos; i++) {
+        int k = c->pos[i];
+        int dec = fields[c->st->metric_idx[k]].decimals;
+        csv_put_char(c->w, ','); csv_put_fixed(c->w, min[k], dec);
+        csv_put_char(c->w, ','); csv_put_fixed(c->w, max[k], dec);
+        csv_put_char(c->w, ','); csv_put_fixed(c->w, mean[k], 2);
+        csv_put_char(c->w, ','); csv_put_fixed(c->w, last[k], dec);
+    }
+    csv_put_char(c->w, '\n');
+}
+
+static int export_tier_csv(const rollup_store_t *st, const rollup_tier_t *t, const char *filename) {
+    int pos[METRIC_FIELD_MAX];
+    int npos = selected_metrics(st, pos);
+    size_t nf;
+    const metric_field_t *fields = metric_fields(&nf);
+
+    csv_writer_t w;
+    if (csv_writer_open(&w, filename) != 0) return -1;
+
+    csv_put_str(&w, "Timestamp,PID,Samples");
+    static const char *suffix[4] = { "_min", "_max", "_mean", "_last" };
+    for (int i = 0; i < npos; i++) {
+        for (int s = 0; s < 4; s++) {
+            csv_put_char(&w, ',');
+            csv_put_str(&w, fields[st->metric_idx[pos[i]]].name);
+            csv_put_str(&w, suffix[s]);
+        }
+    }
+    csv_put_char(&w, '\n');
+
+    csv_ctx_t ctx = { &w, st->pid, pos, npos, st };
+    tier_visit(st, t, csv_window, &ctx);
+    return csv_writer_close(&w);
+}
+
+typedef struct {
+    struct json_object *arr;
+    pid_t pid;
+    const int *pos;
+    int npos;
+    const rollup_store_t *st;
+} json_ctx_t;
+
+static void json_window(void *vctx, double start, unsigned n,
+                        const double *min, const double *max,
+                        const double *mean, const double *last) {
+    json_ctx_t *c = vctx;
+    size_t nf;
+    const metric_field_t *fields = metric_fields(&nf);
+    struct json_object *o = json_object_new_object();
+    json_object_object_add(o, "timestamp", json_object_new_double(start));
+    json_object_object_add(o, "pid", json_object_new_int(c->pid));
+    json_object_object_add(o, "samples", json_object_new_int64(n));
+    for (int i = 0; i < c->npos; i++) {
+        int k = c->pos[i];
+        struct json_object *m = json_object_new_object();
+        json_object_object_add(m, "min", json_object_new_double(min[k]));
+        json_object_object_add(m, "max", json_object_new_double(max[k]));
+        json_object_object_add(m, "mean", json_object_new_double(mean[k]));
+        json_object_object_add(m, "last", json_object_new_double(last[k]));
+        json_object_object_add(o, fields[c->st->metric_idx[k]].name, m);
+    }
+    json_object_array_add(c->arr, o);
+}
+
+static int export_tier_json(const rollup_store_t *st, const rollup_tier_t *t, const char *filename) {
+    int pos[METRIC_FIELD_MAX];
+    int npos = selected_metrics(st, pos);
+    json_ctx_t ctx = { json_object_new_array(), st->pid, pos, npos, st };
+    tier_visit(st, t, json_window, &ctx);
+
+    FILE *f = fopen(filename, "w");
+    if (!f) {
+        json_object_put(ctx.arr);
+        return -1;
+    }
+    fprintf(f, "%s\n", json_object_to_json_string_ext(ctx.arr, JSON_C_TO_STRING_PRETTY));
+    fclose(f);
+    json_object_put(ctx.arr);
+    return 0;
+}
+
+int rollup_export(const rollup_store_t *st, rollup_tier_id_t tier, const char *filename) {
+    int is_json = strstr(filename, ".json") != NULL;
+    int is_rmb = strstr(filename, ".rmb") != NULL;
+
+    if (tier == ROLLUP_TIER_RAW) {
+        proc_metrics_t *tmp = malloc((st->raw_count ? st->raw_count : 1) * sizeof(proc_metrics_t));
+        if (!tmp) return -1;
+        size_t n = rollup_store_raw_copy(st, tmp, st->raw_count);
+        int rc = is_rmb ? export_metrics_rmb(filename, tmp, n)
+               : is_json ? export_metrics_json(filename, tmp, n)
+                         : export_metrics_csv(filename, tmp, n);
+        free(tmp);
+        return rc;
+    }
+
+    const rollup_tier_t *t = &st->tiers[tier];
+    if (t->cap == 0) {
+        fprintf(stderr, "Tier '%s' não está ativo (use --long-run)\n", k_tier_names[tier]);
+        return -1;
+    }
+    if (is_rmb) {
+        fprintf(stderr, "O formato .rmb guarda apenas amostras brutas (use --export-tier raw)\n");
+        return -1;
+    }
+    return is_json ? export_tier_json(st, t, filename) : export_tier_csv(st, t, filename);
+}
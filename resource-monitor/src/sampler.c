@@ -0,0 +1,605 @@
+/*
+ * src/sampler.c
+ *
+ * Thread de coleta com cadência fixa (ou adaptada ao orçamento de
+ * overhead) e entrega das amostras por um anel SPSC sem locks, mais a
+ * thread lenta de smaps_rollup com cadência ajustada ao próprio custo.
+ */
+
+#define _GNU_SOURCE
+#include "sampler.h"
+#include "selfstats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <sched.h>
+
+/* ===================== ANEL SPSC ====================== */
+
+int spsc_ring_init(spsc_ring_t *r, size_t capacity) {
+    memset(r, 0, sizeof(*r));
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        fprintf(stderr, "Capacidade do anel deve ser potência de 2: %zu\n", capacity);
+        return -1;
+    }
+    r->slots = calloc(capacity, sizeof(*r->slots));
+    if (!r->slots) return -1;
+    r->mask = capacity - 1;
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    return 0;
+}
+
+void spsc_ring_free(spsc_ring_t *r) {
+    free(r->slots);
+    r->slots = NULL;
+}
+
+sample_item_t *spsc_ring_reserve(spsc_ring_t *r) {
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (head - tail > r->mask) return NULL;
+    return &r->slots[head & r->mask];
+}
+
+void spsc_ring_commit(spsc_ring_t *r) {
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+}
+
+const sample_item_t *spsc_ring_peek(spsc_ring_t *r) {
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    if (tail == head) return NULL;
+    return &r->slots[tail & r->mask];
+}
+
+void spsc_ring_release(spsc_ring_t *r) {
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+}
+
+/* ===================== COLETA ====================== */
+
+static double ts_diff_ms(const struct timespec *a, const struct timespec *b) {
+    return (double)(a->tv_sec - b->tv_sec) * 1e3 + (double)(a->tv_nsec - b->tv_nsec) / 1e6;
+}
+
+static void ts_add_ms(struct timespec *t, long ms) {
+    t->tv_sec += ms / 1000;
+    t->tv_nsec += (ms % 1000) * 1000000L;
+    if (t->tv_nsec >= 1000000000L) {
+        t->tv_sec++;
+        t->tv_nsec -= 1000000000L;
+    }
+}
+
+/* ===================== ORÇAMENTO DE OVERHEAD ====================== */
+
+#define BUDGET_EWMA_ALPHA 0.3
+
+const char *sampler_shed_name(sampler_shed_t c) {
+    static const char *names[SAMPLER_SHED_COUNT] = {
+        "schedstat", "fd", "net", "perf", "cgroup", "smaps",
+    };
+    return c < SAMPLER_SHED_COUNT ? names[c] : "?";
+}
+
+void sampler_budget_init(sampler_budget_t *b, double budget_pct, long base_ms,
+                         long min_ms, long max_ms, unsigned optional) {
+    memset(b, 0, sizeof(*b));
+    b->budget_pct = budget_pct;
+    b->base_ms = base_ms;
+    if (min_ms <= 0) {
+        min_ms = base_ms / 4;
+        if (min_ms < 250) min_ms = 250;
+    }
+    if (min_ms > base_ms) min_ms = base_ms;
+    if (max_ms <= 0) max_ms = base_ms * 8;
+    if (max_ms < base_ms) max_ms = base_ms;
+    b->min_ms = min_ms;
+    b->max_ms = max_ms;
+    b->floor_ms = min_ms;
+    b->interval_ms = base_ms;
+    b->optional = optional;
+    b->overhead_pct = -1.0;
+}
+
+long sampler_budget_update(sampler_budget_t *b, double overhead_pct, int urgent, int target_idle) {
+    /* após um ajuste a média recomeça: a próxima medição já reflete o efeito */
+    if (b->overhead_pct < 0.0)
+        b->overhead_pct = overhead_pct;
+    else
+        b->overhead_pct += BUDGET_EWMA_ALPHA * (overhead_pct - b->overhead_pct);
+    b->idle = target_idle ? b->idle + 1 : 0;
+
+    if (b->overhead_pct > b->budget_pct) {
+        b->calm = 0;
+        unsigned left = b->optional & ~b->shed;
+        if (left) {
+            b->shed |= left & -left;        // o primeiro da ordem ainda ligado
+            b->overhead_pct = -1.0;
+        } else if (b->floor_ms < b->max_ms) {
+            long cur = b->floor_ms > b->interval_ms ? b->floor_ms : b->interval_ms;
+            b->floor_ms = cur * 3 / 2 < b->max_ms ? cur * 3 / 2 : b->max_ms;
+            b->widened++;
+            b->overhead_pct = -1.0;
+        }
+    } else if (b->overhead_pct < b->budget_pct / 2.0) {
+        if (++b->calm >= SAMPLER_CALM_TICKS) {
+            b->calm = 0;
+            if (b->floor_ms > b->min_ms) {
+                b->floor_ms = b->floor_ms * 4 / 5 > b->min_ms ? b->floor_ms * 4 / 5 : b->min_ms;
+                b->tightened++;
+            } else if (b->shed) {
+                int c = SAMPLER_SHED_COUNT - 1;
+                while (!(b->shed & SAMPLER_SHED_BIT(c))) c--;
+                b->shed &= ~SAMPLER_SHED_BIT(c);   // o último cortado volta primeiro
+                b->tightened++;
+            }
+        }
+    } else {
+        b->calm = 0;
+    }
+
+    long target = urgent ? b->min_ms : b->idle >= SAMPLER_IDLE_TICKS ? b->base_ms * 4 : b->base_ms;
+    if (target < b->floor_ms) target = b->floor_ms;
+    if (target > b->max_ms) target = b->max_ms;
+    b->interval_ms = target;
+    return target;
+}
+
+/* ===================== COLETA ====================== */
+
+static double process_cpu_ms(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return (double)t.tv_sec * 1e3 + (double)t.tv_nsec / 1e6;
+}
+
+static double thread_cpu_ms(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+    return (double)t.tv_sec * 1e3 + (double)t.tv_nsec / 1e6;
+}
+
+#define RUNS(c) (!(shed & SAMPLER_SHED_BIT(c)))
+
+/* prev_shed: cortados na amostra anterior; um coletor religado só volta a dar taxas no tick seguinte */
+static void collect(const sampler_config_t *cfg, sample_item_t *it, const proc_metrics_t *prev,
+                    double dt, unsigned shed, unsigned prev_shed, perfcount_t *perf,
+                    schedstat_state_t *sched, netns_cache_t *net, fd_state_t *fds) {
+    proc_metrics_t *m = &it->m;
+    memset(it, 0, sizeof(*it));
+    it->shed = shed;
+    m->pid = cfg->pid;
+    if (cfg->max_overhead_pct > 0.0) {
+        /* o intervalo adaptativo desce abaixo de 1 s: timestamp com fração */
+        struct timespec rt;
+        clock_gettime(CLOCK_REALTIME, &rt);
+        m->timestamp = (double)rt.tv_sec + (double)rt.tv_nsec / 1e9;
+    } else {
+        m->timestamp = time(NULL);
+    }
+
+    self_probe_t tick, probe;
+    selfstats_begin(&tick);
+    selfstats_begin(&probe);
+    monitor_cpu_usage(cfg->pid, &m->cpu_percent);
+    selfstats_end(&probe, SELF_CPU);
+    selfstats_begin(&probe);
+    monitor_memory_usage(cfg->pid, &m->rss_kb, &m->vmsize_kb, &m->minflt, &m->majflt, &m->swap_kb);
+    selfstats_end(&probe, SELF_MEM);
+    selfstats_begin(&probe);
+    monitor_io_usage(cfg->pid, &m->rchar, &m->wchar, &m->read_bytes, &m->write_bytes, &m->syscalls);
+    selfstats_end(&probe, SELF_IO);
+    double run_ms, wait_ms;
+    unsigned long long slices;
+    int sched_ok = 0;
+    if (cfg->schedstat && RUNS(SAMPLER_SHED_SCHED)) {
+        selfstats_begin(&probe);
+        sched_ok = monitor_schedstat(cfg->pid, sched, &run_ms, &wait_ms, &slices) == 0 &&
+                   !(prev_shed & SAMPLER_SHED_BIT(SAMPLER_SHED_SCHED));
+        selfstats_end(&probe, SELF_SCHED);
+    }
+    net_rates_t nr;
+    int net_ok = 0;
+    if (cfg->net && RUNS(SAMPLER_SHED_NET)) {
+        selfstats_begin(&probe);
+        netns_cache_begin(net);
+        net_ok = netns_cache_read(net, cfg->pid, monitor_netns(cfg->pid), NULL, &nr) == 0;
+        selfstats_end(&probe, SELF_NET);
+    }
+    fd_counts_t fc;
+    int fd_ok = 0;
+    if (cfg->fds && RUNS(SAMPLER_SHED_FD)) {
+        selfstats_begin(&probe);
+        fd_ok = monitor_fd_usage(cfg->pid, fds, &fc) == 0;
+        if (fd_ok) {
+            m->fd_count = fc.count;
+            m->fd_files = fc.by_type[FD_FILE];
+            m->fd_sockets = fc.by_type[FD_SOCKET];
+            m->fd_pipes = fc.by_type[FD_PIPE];
+            m->fd_eventfds = fc.by_type[FD_EVENTFD];
+            m->fd_anon = fc.by_type[FD_ANON];
+            m->fd_limit = fc.limit;
+            tcp_states_t ts;
+            if (cfg->fd_sockets && monitor_tcp_states(cfg->pid, fds->sockets, fds->nsockets, &ts) == 0) {
+                m->tcp_established = ts.established;
+                m->tcp_listen = ts.listen;
+                m->tcp_close_wait = ts.close_wait;
+                m->tcp_other = ts.other;
+            }
+        }
+        selfstats_end(&probe, SELF_FD);
+    }
+    if (perf && RUNS(SAMPLER_SHED_PERF)) {
+        selfstats_begin(&probe);
+        perfcount_read(perf, m);
+        selfstats_end(&probe, SELF_PERF);
+    }
+
+    /* taxas por segundo a partir da amostra anterior, se existir */
+    if (prev) {
+        if (dt <= 0.0) dt = 1.0; /* fallback seguro */
+
+        m->rchar_per_s = (double)(m->rchar - prev->rchar) / dt;
+        m->wchar_per_s = (double)(m->wchar - prev->wchar) / dt;
+        m->read_bytes_per_s = (double)(m->read_bytes - prev->read_bytes) / dt;
+        m->write_bytes_per_s = (double)(m->write_bytes - prev->write_bytes) / dt;
+        m->syscalls_per_s = (double)(m->syscalls - prev->syscalls) / dt;
+        if (sched_ok) {
+            m->cpu_run_ms_per_s = run_ms / dt;
+            m->cpu_wait_ms_per_s = wait_ms / dt;
+            m->wait_per_slice_us = slices ? wait_ms * 1e3 / (double)slices : 0.0;
+        }
+        if (net_ok) {
+            m->net_rx_bytes_per_s = nr.rx_bytes_per_s;
+            m->net_tx_bytes_per_s = nr.tx_bytes_per_s;
+            m->net_rx_packets_per_s = nr.rx_packets_per_s;
+            m->net_tx_packets_per_s = nr.tx_packets_per_s;
+            m->net_drops_per_s = nr.drops_per_s;
+            m->tcp_retrans_per_s = nr.tcp_retrans_per_s;
+        }
+        if (fd_ok && prev->fd_count)
+            m->fd_growth_per_s = ((double)m->fd_count - (double)prev->fd_count) / dt;
+    }
+
+    if (cfg->collect_cgroup && RUNS(SAMPLER_SHED_CGROUP)) {
+        it->cg_valid = 1;
+        selfstats_begin(&probe);
+        if (cfg->cgroup_name) {
+            cgroup_read_metrics(cfg->cgroup_name, &it->cg);
+            cgroup_read_memory_max(cfg->cgroup_name, &it->cg_mem_max);
+        } else {
+            cgroup_read_system_pressure(&it->cg.psi);
+        }
+        monitor_mem_available(&it->mem_avail_kb, &it->mem_total_kb);
+        selfstats_end(&probe, SELF_CGROUP);
+    }
+    selfstats_end(&tick, SELF_TICK);
+    selfstats_tick();
+}
+
+#undef RUNS
+
+static void *sampler_thread(void *arg) {
+    sampler_t *s = arg;
+    const sampler_config_t *cfg = &s->cfg;
+
+    if (cfg->pin_cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cfg->pin_cpu, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+            fprintf(stderr, "Aviso: não foi possível fixar a coleta no núcleo %d\n", cfg->pin_cpu);
+    }
+
+    if (cfg->perf) s->perf_ok = perfcount_open(&s->perf, cfg->pid, 1) == 0;
+    if (!s->perf_ok) s->budget.optional &= ~SAMPLER_SHED_BIT(SAMPLER_SHED_PERF);
+
+    proc_metrics_t prev;
+    int has_prev = 0;
+    unsigned prev_shed = 0;
+    sample_item_t overflow;     // coleta mesmo com o anel cheio, para manter as taxas
+    struct timespec next, now, prev_t = {0, 0};
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    int adaptive = cfg->max_overhead_pct > 0.0;
+    long interval = cfg->interval_ms;
+    double cpu0 = process_cpu_ms();
+    struct timespec wall0 = next;
+
+    while (!atomic_load(&s->stop) &&
+           (cfg->max_samples == 0 || atomic_load(&s->produced) + atomic_load(&s->dropped) < cfg->max_samples)) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double lag = ts_diff_ms(&now, &next);
+        if (lag < 0.0) lag = 0.0;
+        if (lag > s->max_lag_ms) s->max_lag_ms = lag;
+
+        sample_item_t *it = spsc_ring_reserve(&s->ring);
+        int full = it == NULL;
+        if (full) it = &overflow;
+        /* taxas pelo relógio monotônico: intervalos abaixo de 1 s continuam corretos */
+        collect(cfg, it, has_prev ? &prev : NULL, ts_diff_ms(&now, &prev_t) / 1e3, s->budget.shed,
+                prev_shed, s->perf_ok ? &s->perf : NULL, &s->sched, &s->net, &s->fd);
+        it->lag_ms = lag;
+        it->interval_ms = interval;
+        if (s->smaps_running) {
+            pthread_mutex_lock(&s->smaps_lock);
+            it->smaps = s->smaps_last;
+            it->smaps_procs = s->smaps_procs;
+            pthread_mutex_unlock(&s->smaps_lock);
+        }
+        prev = it->m;
+        prev_shed = it->shed;
+        prev_t = now;
+        has_prev = 1;
+
+        if (full) {
+            atomic_fetch_add(&s->dropped, 1);
+        } else {
+            spsc_ring_commit(&s->ring);
+            atomic_fetch_add(&s->produced, 1);
+            sem_post(&s->ready);
+        }
+
+        /* CPU do processo inteiro (coleta + consumidor) desde o tick anterior */
+        if (adaptive) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            double wall = ts_diff_ms(&now, &wall0), cpu1 = process_cpu_ms();
+            if (wall > 0.0 && has_prev) {
+                int idle = it->m.cpu_percent < 0.5 && it->m.rchar_per_s + it->m.wchar_per_s < 1024.0;
+                interval = sampler_budget_update(&s->budget, 100.0 * (cpu1 - cpu0) / wall,
+                                                 atomic_load(&s->urgent), idle);
+                atomic_store(&s->shed, s->budget.shed);
+            }
+            cpu0 = cpu1;
+            wall0 = now;
+        }
+
+        /* próximo horário absoluto; ciclos perdidos são pulados, não acumulados */
+        ts_add_ms(&next, interval);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        while (ts_diff_ms(&now, &next) >= 0.0) ts_add_ms(&next, interval);
+
+        pthread_mutex_lock(&s->lock);
+        while (!atomic_load(&s->stop)) {
+            if (pthread_cond_timedwait(&s->wake, &s->lock, &next) == ETIMEDOUT) break;
+        }
+        pthread_mutex_unlock(&s->lock);
+    }
+
+    if (s->perf_ok) perfcount_close(&s->perf);
+    monitor_schedstat_free(&s->sched);
+    netns_cache_free(&s->net);
+    monitor_fd_free(&s->fd);
+    selfstats_thread_done();
+    atomic_store(&s->done, 1);
+    sem_post(&s->ready);
+    return NULL;
+}
+
+/* ===================== SMAPS_ROLLUP (CADÊNCIA LENTA) ====================== */
+
+long sampler_smaps_interval(long base_ms, double cost_ms, double share_pct) {
+    if (share_pct <= 0.0) return base_ms;
+    double need = cost_ms * 100.0 / share_pct;
+    return need > (double)base_ms ? (long)(need + 0.5) : base_ms;
+}
+
+static void smaps_add(smaps_rollup_t *t, const smaps_rollup_t *r) {
+    t->rss_kb += r->rss_kb;
+    t->pss_kb += r->pss_kb;
+    t->pss_anon_kb += r->pss_anon_kb;
+    t->pss_file_kb += r->pss_file_kb;
+    t->pss_shmem_kb += r->pss_shmem_kb;
+    t->shared_clean_kb += r->shared_clean_kb;
+    t->shared_dirty_kb += r->shared_dirty_kb;
+    t->private_clean_kb += r->private_clean_kb;
+    t->private_dirty_kb += r->private_dirty_kb;
+    t->swap_kb += r->swap_kb;
+    t->swap_pss_kb += r->swap_pss_kb;
+    t->referenced_kb += r->referenced_kb;
+}
+
+/* Espera até o horário absoluto ou até pedirem o fim. @return 1 se deve parar. */
+static int wait_until(sampler_t *s, const struct timespec *deadline) {
+    pthread_mutex_lock(&s->lock);
+    while (!atomic_load(&s->stop)) {
+        if (pthread_cond_timedwait(&s->wake, &s->lock, deadline) == ETIMEDOUT) break;
+    }
+    pthread_mutex_unlock(&s->lock);
+    return atomic_load(&s->stop);
+}
+
+static void *smaps_thread(void *arg) {
+    sampler_t *s = arg;
+    const sampler_config_t *cfg = &s->cfg;
+    sampler_smaps_stats_t *st = &s->smaps;
+    pid_t pids[1 + SAMPLER_SMAPS_MAX_PROCS];
+    double cost_avg = -1.0;
+
+    FILE *csv = NULL;
+    if (cfg->smaps_csv) {
+        csv = fopen(cfg->smaps_csv, "w");
+        if (!csv)
+            fprintf(stderr, "Aviso: não foi possível abrir %s: %s\n", cfg->smaps_csv, strerror(errno));
+        else
+            fprintf(csv, "timestamp,pid,rss_kb,pss_kb,pss_anon_kb,pss_file_kb,pss_shmem_kb,"
+                         "shared_clean_kb,shared_dirty_kb,private_clean_kb,private_dirty_kb,"
+                         "uss_kb,swap_kb,swap_pss_kb,read_ms,interval_ms\n");
+    }
+
+    st->interval_ms = cfg->smaps_interval_ms;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (!atomic_load(&s->stop)) {
+        if (atomic_load(&s->shed) & SAMPLER_SHED_BIT(SAMPLER_SHED_SMAPS)) {
+            st->skipped++;
+        } else {
+            size_t n = 0;
+            pids[n++] = cfg->pid;
+            if (cfg->smaps_children) {
+                int nc = monitor_children(cfg->pid, pids + 1, SAMPLER_SMAPS_MAX_PROCS);
+                if (nc > 0) n += (size_t)nc;
+            }
+
+            struct timespec rt;
+            clock_gettime(CLOCK_REALTIME, &rt);
+            double ts = (double)rt.tv_sec + (double)rt.tv_nsec / 1e9;
+            smaps_rollup_t total;
+            memset(&total, 0, sizeof(total));
+            int ok = 0;
+            double cpu0 = thread_cpu_ms();
+            for (size_t i = 0; i < n && !atomic_load(&s->stop); i++) {
+                smaps_rollup_t r;
+                struct timespec t0, t1;
+                self_probe_t probe;
+                selfstats_begin(&probe);
+                clock_gettime(CLOCK_MONOTONIC, &t0);
+                int rc = monitor_smaps_rollup(pids[i], &r);
+                clock_gettime(CLOCK_MONOTONIC, &t1);
+                selfstats_end(&probe, SELF_SMAPS);
+                if (rc != 0) {
+                    st->failed++;   // filho que já saiu, ou sem permissão
+                    continue;
+                }
+                smaps_add(&total, &r);
+                ok++;
+                if (csv)
+                    fprintf(csv, "%.3f,%d,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%.3f,%ld\n",
+                            ts, pids[i], r.rss_kb, r.pss_kb, r.pss_anon_kb, r.pss_file_kb,
+                            r.pss_shmem_kb, r.shared_clean_kb, r.shared_dirty_kb,
+                            r.private_clean_kb, r.private_dirty_kb,
+                            r.private_clean_kb + r.private_dirty_kb, r.swap_kb, r.swap_pss_kb,
+                            ts_diff_ms(&t1, &t0), st->interval_ms);
+            }
+            /* CPU da thread, não tempo de parede: esperar pelo mmap_lock do alvo não custa CPU */
+            double cost = thread_cpu_ms() - cpu0;
+            if (csv) fflush(csv);
+
+            if (ok > 0) {
+                pthread_mutex_lock(&s->smaps_lock);
+                s->smaps_last = total;
+                s->smaps_procs = ok;
+                pthread_mutex_unlock(&s->smaps_lock);
+            }
+            st->passes++;
+            st->cost_ms_sum += cost;
+            if (cost > st->cost_ms_max) st->cost_ms_max = cost;
+            cost_avg = cost_avg < 0.0 ? cost : cost_avg + BUDGET_EWMA_ALPHA * (cost - cost_avg);
+            st->interval_ms = sampler_smaps_interval(cfg->smaps_interval_ms, cost_avg,
+                                                     SAMPLER_SMAPS_SHARE_PCT);
+        }
+
+        ts_add_ms(&next, st->interval_ms);
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        while (ts_diff_ms(&now, &next) >= 0.0) ts_add_ms(&next, st->interval_ms);
+        if (wait_until(s, &next)) break;
+    }
+
+    if (csv) fclose(csv);
+    selfstats_thread_done();
+    return NULL;
+}
+
+int sampler_start(sampler_t *s, const sampler_config_t *cfg) {
+    memset(s, 0, sizeof(*s));
+    s->cfg = *cfg;
+    if (s->cfg.interval_ms <= 0) s->cfg.interval_ms = 1000;
+    unsigned optional = 0;
+    if (cfg->schedstat) optional |= SAMPLER_SHED_BIT(SAMPLER_SHED_SCHED);
+    if (cfg->fds) optional |= SAMPLER_SHED_BIT(SAMPLER_SHED_FD);
+    if (cfg->net) optional |= SAMPLER_SHED_BIT(SAMPLER_SHED_NET);
+    if (cfg->perf) optional |= SAMPLER_SHED_BIT(SAMPLER_SHED_PERF);
+    if (cfg->collect_cgroup) optional |= SAMPLER_SHED_BIT(SAMPLER_SHED_CGROUP);
+    if (cfg->smaps_interval_ms > 0) optional |= SAMPLER_SHED_BIT(SAMPLER_SHED_SMAPS);
+    sampler_budget_init(&s->budget, cfg->max_overhead_pct, s->cfg.interval_ms,
+                        cfg->min_interval_ms, cfg->max_interval_ms, optional);
+    if (spsc_ring_init(&s->ring, cfg->ring_capacity ? cfg->ring_capacity : SAMPLER_RING_DEFAULT) != 0)
+        return -1;
+
+    sem_init(&s->ready, 0, 0);
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_condattr_t ca;
+    pthread_condattr_init(&ca);
+    pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+    pthread_cond_init(&s->wake, &ca);
+    pthread_condattr_destroy(&ca);
+    pthread_mutex_init(&s->smaps_lock, NULL);
+
+    /* SIGINT fica com a thread principal (o consumidor) */
+    sigset_t block, old;
+    sigemptyset(&block);
+    sigaddset(&block, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+    int rc = pthread_create(&s->thread, NULL, sampler_thread, s);
+    if (rc == 0 && s->cfg.smaps_interval_ms > 0) {
+        int rs = pthread_create(&s->smaps_thread, NULL, smaps_thread, s);
+        if (rs == 0)
+            s->smaps_running = 1;
+        else
+            fprintf(stderr, "Aviso: smaps_rollup desligado (thread: %s)\n", strerror(rs));
+    }
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (rc != 0) {
+        fprintf(stderr, "Erro ao criar thread de coleta: %s\n", strerror(rc));
+        pthread_mutex_destroy(&s->smaps_lock);
+        pthread_cond_destroy(&s->wake);
+        pthread_mutex_destroy(&s->lock);
+        sem_destroy(&s->ready);
+        spsc_ring_free(&s->ring);
+        return -1;
+    }
+    return 0;
+}
+
+int sampler_next(sampler_t *s, sample_item_t *out, long timeout_ms) {
+    for (;;) {
+        const sample_item_t *it = spsc_ring_peek(&s->ring);
+        if (it) {
+            *out = *it;
+            spsc_ring_release(&s->ring);
+            return 1;
+        }
+        if (atomic_load(&s->done)) {
+            /* a coleta pode ter publicado entre o peek e a leitura de done */
+            if (spsc_ring_peek(&s->ring)) continue;
+            return -1;
+        }
+
+        struct timespec dl;
+        clock_gettime(CLOCK_REALTIME, &dl);
+        ts_add_ms(&dl, timeout_ms);
+        if (sem_timedwait(&s->ready, &dl) != 0) {
+            if (errno == ETIMEDOUT) return 0;
+            if (errno == EINTR) return 0;   // sinal (Ctrl+C): o chamador decide
+        }
+    }
+}
+
+void sampler_hint(sampler_t *s, int urgent) {
+    atomic_store(&s->urgent, urgent);
+}
+
+void sampler_stop(sampler_t *s) {
+    if (atomic_exchange(&s->stop, 1)) return;
+    pthread_mutex_lock(&s->lock);
+    pthread_cond_broadcast(&s->wake);     // coleta e thread lenta esperam na mesma condição
+    pthread_mutex_unlock(&s->lock);
+}
+
+void sampler_finish(sampler_t *s) {
+    sampler_stop(s);
+    pthread_join(s->thread, NULL);
+    if (s->smaps_running) pthread_join(s->smaps_thread, NULL);
+    pthread_mutex_destroy(&s->smaps_lock);
+    pthread_cond_destroy(&s->wake);
+    pthread_mutex_destroy(&s->lock);
+    sem_destroy(&s->ready);
+    spsc_ring_free(&s->ring);
+}
@@ -0,0 +1,220 @@
+/*
+ * src/selfstats.c
+ *
+ * Histogramas log-lineares do custo de cada coletor e do próprio monitor.
+ */
+
+#define _GNU_SOURCE
+#include "selfstats.h"
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* ===================== HISTOGRAMA ====================== */
+
+/* 0..2*SUB-1 são exatos; acima, SUB buckets lineares por potência de 2 */
+static int bucket_of(uint64_t v) {
+    if (v < 2 * SELF_HIST_SUB) return (int)v;
+    int e = 63 - __builtin_clzll(v);                // e >= 4
+    int sub = (int)((v >> (e - 3)) & (SELF_HIST_SUB - 1));
+    return 2 * SELF_HIST_SUB + (e - 4) * SELF_HIST_SUB + sub;
+}
+
+static uint64_t bucket_upper(int b) {
+    if (b < 2 * SELF_HIST_SUB) return (uint64_t)b;
+    int e = (b - 2 * SELF_HIST_SUB) / SELF_HIST_SUB + 4;
+    int sub = (b - 2 * SELF_HIST_SUB) % SELF_HIST_SUB;
+    uint64_t lo = ((uint64_t)(SELF_HIST_SUB + sub)) << (e - 3);
+    return lo + (1ULL << (e - 3)) - 1;
+}
+
+void self_hist_record(self_hist_t *h, uint64_t v) {
+    h->counts[bucket_of(v)]++;
+    h->n++;
+    h->sum += v;
+    if (v > h->max) h->max = v;
+}
+
+uint64_t self_hist_quantile(const self_hist_t *h, double q) {
+    if (h->n == 0) return 0;
+    uint64_t rank = (uint64_t)(q * (double)(h->n - 1)) + 1, seen = 0;
+    for (int b = 0; b < SELF_HIST_BUCKETS; b++) {
+        seen += h->counts[b];
+        if (seen >= rank) {
+            uint64_t up = bucket_upper(b);
+            return up < h->max ? up : h->max;
+        }
+    }
+    return h->max;
+}
+
+double self_hist_mean(const self_hist_t *h) {
+    return h->n ? (double)h->sum / (double)h->n : 0.0;
+}
+
+/* ===================== SONDAS ====================== */
+
+static int g_enabled = 0;
+static self_collector_stats_t g_stats[SELF_NCOLLECTORS];
+static self_hist_t g_self_cpu;      // centésimos de ponto percentual
+static self_hist_t g_self_rss;      // kB
+static __thread int t_io_fd = -1;
+
+static const char *k_names[SELF_NCOLLECTORS] = {
+    "monitor_cpu_usage", "monitor_memory_usage", "monitor_io_usage",
+    "monitor_schedstat", "monitor_net_usage", "monitor_fd_usage", "perf_counters", "cgroup", "smaps_rollup", "export", "tick"
+};
+
+void selfstats_enable(int on) { g_enabled = on; }
+int selfstats_enabled(void) { return g_enabled; }
+
+/* rchar/syscr/syscw da thread atual; retorna bytes lidos da sonda ou -1 */
+static ssize_t read_thread_io(unsigned long long *rchar, unsigned long long *sys) {
+    if (t_io_fd < 0) {
+        t_io_fd = open("/proc/thread-self/io", O_RDONLY | O_CLOEXEC);
+        if (t_io_fd < 0) return -1;
+    }
+    char buf[512];
+    ssize_t n = pread(t_io_fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) return -1;
+    buf[n] = '\0';
+    unsigned long long r = 0, sr = 0, sw = 0;
+    char *p;
+    if ((p = strstr(buf, "rchar:"))) r = strtoull(p + 6, NULL, 10);
+    if ((p = strstr(buf, "syscr:"))) sr = strtoull(p + 6, NULL, 10);
+    if ((p = strstr(buf, "syscw:"))) sw = strtoull(p + 6, NULL, 10);
+    *rchar = r;
+    *sys = sr + sw;
+    return n;
+}
+
+void selfstats_begin(self_probe_t *p) {
+    p->active = g_enabled;
+    if (!p->active) return;
+    ssize_t n = read_thread_io(&p->rchar, &p->syscalls);
+    p->ok = n > 0;
+    p->probe_bytes = p->ok ? (unsigned long long)n : 0;
+    clock_gettime(CLOCK_MONOTONIC, &p->t0);
+}
+
+void selfstats_end(self_probe_t *p, self_collector_t which) {
+    if (!p->active) return;
+    struct timespec t1;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    int64_t ns = (int64_t)(t1.tv_sec - p->t0.tv_sec) * 1000000000LL + (t1.tv_nsec - p->t0.tv_nsec);
+    self_collector_stats_t *s = &g_stats[which];
+    self_hist_record(&s->time_ns, ns > 0 ? (uint64_t)ns : 0);
+
+    unsigned long long rchar, sys;
+    if (p->ok && read_thread_io(&rchar, &sys) > 0) {
+        /* a leitura de begin já está nos contadores: 1 syscall e probe_bytes */
+        unsigned long long ds = sys - p->syscalls, db = rchar - p->rchar;
+        self_hist_record(&s->syscalls, ds > 0 ? ds - 1 : 0);
+        self_hist_record(&s->bytes, db > p->probe_bytes ? db - p->probe_bytes : 0);
+    }
+}
+
+void selfstats_thread_done(void) {
+    if (t_io_fd >= 0) close(t_io_fd);
+    t_io_fd = -1;
+}
+
+void selfstats_tick(void) {
+    static int fd = -1;
+    static unsigned long long last_jiffies = 0;
+    static struct timespec last_t;
+    static long hz = 0, page_kb = 0;
+    if (!g_enabled) return;
+    if (fd < 0) {
+        fd = open("/proc/self/stat", O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return;
+        hz = sysconf(_SC_CLK_TCK);
+        page_kb = sysconf(_SC_PAGESIZE) / 1024;
+    }
+    char buf[1024];
+    ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) return;
+    buf[n] = '\0';
+    const char *p = strrchr(buf, ')');
+    if (!p) return;
+
+    /* após ')': estado e campos 4..24; utime=14, stime=15, rss=24 */
+    unsigned long long f[22];
+    p += 3;
+    for (int i = 0; i < 21; i++) {
+        char *end;
+        f[i] = strtoull(p, &end, 10);
+        p = end;
+    }
+    unsigned long long jiffies = f[10] + f[11];
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (last_t.tv_sec != 0) {
+        double dt = (double)(now.tv_sec - last_t.tv_sec) + (double)(now.tv_nsec - last_t.tv_nsec) / 1e9;
+        if (dt > 0.0) {
+            double cpu = 100.0 * (double)(jiffies - last_jiffies) / ((double)hz * dt);
+            self_hist_record(&g_self_cpu, (uint64_t)(cpu * 100.0 + 0.5));
+        }
+    }
+    last_jiffies = jiffies;
+    last_t = now;
+    self_hist_record(&g_self_rss, f[20] * (unsigned long long)page_kb);
+}
+
+const self_collector_stats_t *selfstats_collector(self_collector_t which) {
+    return &g_stats[which];
+}
+
+const char *selfstats_collector_name(self_collector_t which) {
+    return k_names[which];
+}
+
+/* ===================== SAÍDA ====================== */
+
+void selfstats_print(FILE *out) {
+    fprintf(out, "\nCusto do monitor (--self-stats):\n");
+    fprintf(out, "  %-22s %8s %10s %10s %10s %9s %10s\n",
+            "coletor", "chamadas", "p50 µs", "p99 µs", "max µs", "syscalls", "bytes");
+    for (int c = 0; c < SELF_NCOLLECTORS; c++) {
+        const self_collector_stats_t *s = &g_stats[c];
+        if (s->time_ns.n == 0) continue;
+        fprintf(out, "  %-22s %8llu %10.1f %10.1f %10.1f %9.1f %10.0f\n", k_names[c],
+                (unsigned long long)s->time_ns.n,
+                self_hist_quantile(&s->time_ns, 0.5) / 1e3,
+                self_hist_quantile(&s->time_ns, 0.99) / 1e3,
+                s->time_ns.max / 1e3, self_hist_mean(&s->syscalls), self_hist_mean(&s->bytes));
+    }
+    if (g_self_rss.n)
+        fprintf(out, "  monitor: CPU média %.2f%% (máx %.2f%%), RSS máx %llu kB\n",
+                self_hist_mean(&g_self_cpu) / 100.0, g_self_cpu.max / 100.0,
+                (unsigned long long)g_self_rss.max);
+}
+
+static void write_row(FILE *f, const char *who, const char *metric, const self_hist_t *h, double scale) {
+    fprintf(f, "%s,%s,%llu,%.3f,%.3f,%.3f,%.3f,%.3f\n", who, metric, (unsigned long long)h->n,
+            self_hist_mean(h) / scale, self_hist_quantile(h, 0.5) / scale,
+            self_hist_quantile(h, 0.9) / scale, self_hist_quantile(h, 0.99) / scale, h->max / scale);
+}
+
+int selfstats_write(const char *base) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s.selfstats.csv", base);
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror("Erro ao criar arquivo de self-stats");
+        return -1;
+    }
+    fprintf(f, "collector,metric,count,mean,p50,p90,p99,max\n");
+    for (int c = 0; c < SELF_NCOLLECTORS; c++) {
+        const self_collector_stats_t *s = &g_stats[c];
+        if (s->time_ns.n == 0) continue;
+        write_row(f, k_names[c], "time_us", &s->time_ns, 1e3);
+        write_row(f, k_names[c], "syscalls", &s->syscalls, 1.0);
+        write_row(f, k_names[c], "bytes_read", &s->bytes, 1.0);
+    }
+    write_row(f, "monitor", "cpu_percent", &g_self_cpu, 100.0);
+    write_row(f, "monitor", "rss_kb", &g_self_rss, 1.0);
+    fclose(f);
+    return 0;
+}
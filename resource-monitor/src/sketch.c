@@ -0,0 +1,209 @@
+/*
+ * src/sketch.c
+ *
+ * DDSketch com buckets densos de tamanho fixo e resumo por alvo
+ * (p50/p90/p99/max de CPU%, RSS, taxas de I/O e espera na fila de CPU) em memória constante.
+ */
+
+#include "sketch.h"
+#include "export.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+/* menor valor indexável; abaixo disso conta como zero */
+#define DDS_MIN_INDEXABLE 1e-9
+
+/* ===================== DDSKETCH ====================== */
+
+void ddsketch_init(ddsketch_t *s, double alpha) {
+    memset(s, 0, sizeof(*s));
+    if (alpha <= 0.0 || alpha >= 1.0) alpha = DDS_DEFAULT_ALPHA;
+    s->gamma = (1.0 + alpha) / (1.0 - alpha);
+    s->log_gamma = log(s->gamma);
+}
+
+static inline int dds_key(const ddsketch_t *s, double v) {
+    return (int)ceil(log(v) / s->log_gamma);
+}
+
+static inline double dds_value(const ddsketch_t *s, int key) {
+    /* ponto que minimiza o erro relativo dentro de (gamma^(k-1), gamma^k] */
+    return 2.0 * pow(s->gamma, key) / (s->gamma + 1.0);
+}
+
+/* Garante que key caiba em bins[]; pode deslocar a janela ou colapsar
+   os buckets mais baixos. Retorna a chave efetiva a usar. */
+static int dds_make_room(ddsketch_t *s, int key) {
+    if (!s->has_bins) {
+        s->offset = key - DDS_MAX_BINS / 2;
+        s->min_key = s->max_key = key;
+        s->has_bins = 1;
+        return key;
+    }
+    if (key >= s->offset && key < s->offset + DDS_MAX_BINS) {
+        if (key < s->min_key) s->min_key = key;
+        if (key > s->max_key) s->max_key = key;
+        return key;
+    }
+
+    int new_min = key < s->min_key ? key : s->min_key;
+    int new_max = key > s->max_key ? key : s->max_key;
+
+    if (new_max - new_min < DDS_MAX_BINS) {
+        /* cabe: recentraliza a janela sobre [new_min, new_max] */
+        int new_offset = new_min - (DDS_MAX_BINS - (new_max - new_min + 1)) / 2;
+        uint32_t tmp[DDS_MAX_BINS];
+        memset(tmp, 0, sizeof(tmp));
+        for (int k = s->min_key; k <= s->max_key; k++)
+            tmp[k - new_offset] = s->bins[k - s->offset];
+        memcpy(s->bins, tmp, sizeof(tmp));
+        s->offset = new_offset;
+        s->min_key = new_min;
+        s->max_key = new_max;
+        return key;
+    }
+
+    /* não cabe: mantém as chaves mais altas e colapsa as baixas */
+    int new_offset = new_max - DDS_MAX_BINS + 1;
+    uint32_t tmp[DDS_MAX_BINS];
+    memset(tmp, 0, sizeof(tmp));
+    for (int k = s->min_key; k <= s->max_key; k++) {
+        uint32_t c = s->bins[k - s->offset];
+        if (!c) continue;
+        int dst = k < new_offset ? new_offset : k;
+        tmp[dst - new_offset] += c;
+    }
+    memcpy(s->bins, tmp, sizeof(tmp));
+    s->offset = new_offset;
+    s->min_key = new_min < new_offset ? new_offset : new_min;
+    s->max_key = new_max;
+    return key < new_offset ? new_offset : key;
+}
+
+static void dds_add_key(ddsketch_t *s, int key, uint32_t n) {
+    key = dds_make_room(s, key);
+    s->bins[key - s->offset] += n;
+}
+
+void ddsketch_add(ddsketch_t *s, double v) {
+    if (isnan(v)) return;
+    if (s->count == 0 || v < s->min) s->min = v;
+    if (s->count == 0 || v > s->max) s->max = v;
+    s->count++;
+    s->sum += v;
+
+    if (v <= DDS_MIN_INDEXABLE) {
+        s->zero_count++;
+        return;
+    }
+    dds_add_key(s, dds_key(s, v), 1);
+}
+
+int ddsketch_merge(ddsketch_t *dst, const ddsketch_t *src) {
+    if (fabs(dst->gamma - src->gamma) > 1e-12) return -1;
+    if (src->count == 0) return 0;
+
+    if (dst->count == 0 || src->min < dst->min) dst->min = src->min;
+    if (dst->count == 0 || src->max > dst->max) dst->max = src->max;
+    dst->count += src->count;
+    dst->sum += src->sum;
+    dst->zero_count += src->zero_count;
+
+    if (src->has_bins) {
+        /* insere da chave mais alta para a mais baixa: colapsos afetam só o fundo */
+        for (int k = src->max_key; k >= src->min_key; k--) {
+            uint32_t c = src->bins[k - src->offset];
+            if (c) dds_add_key(dst, k, c);
+        }
+    }
+    return 0;
+}
+
+double ddsketch_quantile(const ddsketch_t *s, double q) {
+    if (s->count == 0) return 0.0;
+    if (q <= 0.0) return s->min;
+    if (q >= 1.0) return s->max;
+
+    double rank = q * (double)(s->count - 1);
+    double cum = (double)s->zero_count;
+    double v;
+    if (cum > rank) {
+        v = 0.0;
+    } else {
+        v = s->max;
+        if (s->has_bins) {
+            for (int k = s->min_key; k <= s->max_key; k++) {
+                cum += s->bins[k - s->offset];
+                if (cum > rank) {
+                    v = dds_value(s, k);
+                    break;
+                }
+            }
+        }
+    }
+    if (v < s->min) v = s->min;
+    if (v > s->max) v = s->max;
+    return v;
+}
+
+double ddsketch_mean(const ddsketch_t *s) {
+    return s->count ? s->sum / (double)s->count : 0.0;
+}
+
+/* ===================== RESUMO POR ALVO ====================== */
+
+static const char *k_summary_fields[] = {
+    "cpu_percent", "rss_kb",
+    "read_bytes_per_s", "write_bytes_per_s",
+    "rchar_per_s", "wchar_per_s",
+    "cpu_wait_ms_per_s",
+    "net_rx_bytes_per_s",
+};
+
+void metric_summary_init(metric_summary_t *ms, pid_t pid) {
+    memset(ms, 0, sizeof(*ms));
+    ms->pid = pid;
+    size_t n = sizeof(k_summary_fields) / sizeof(k_summary_fields[0]);
+    for (size_t i = 0; i < n && ms->nmetrics < SUMMARY_MAX_METRICS; i++) {
+        int idx = metric_field_find(k_summary_fields[i]);
+        if (idx < 0) continue;
+        ms->field_idx[ms->nmetrics] = idx;
+        ddsketch_init(&ms->sk[ms->nmetrics], DDS_DEFAULT_ALPHA);
+        ms->nmetrics++;
+    }
+}
+
+void metric_summary_add(metric_summary_t *ms, const proc_metrics_t *m) {
+    size_t nf;
+    const metric_field_t *fields = metric_fields(&nf);
+    for (int k = 0; k < ms->nmetrics; k++)
+        ddsketch_add(&ms->sk[k], metric_field_value(m, &fields[ms->field_idx[k]]));
+}
+
+int metric_summary_merge(metric_summary_t *dst, const metric_summary_t *src) {
+    if (dst->nmetrics != src->nmetrics) return -1;
+    for (int k = 0; k < dst->nmetrics; k++) {
+        if (dst->field_idx[k] != src->field_idx[k]) return -1;
+        if (ddsketch_merge(&dst->sk[k], &src->sk[k]) != 0) return -1;
+    }
+    return 0;
+}
+
+const char *metric_summary_name(const metric_summary_t *ms, int k) {
+    size_t nf;
+    const metric_field_t *fields = metric_fields(&nf);
+    return fields[ms->field_idx[k]].name;
+}
+
+void metric_summary_print(const metric_summary_t *ms) {
+    printf("\n==== Resumo PID %d ====\n", ms->pid);
+    printf("%-20s %10s %14s %14s %14s %14s\n", "métrica", "amostras", "p50", "p90", "p99", "max");
+    for (int k = 0; k < ms->nmetrics; k++) {
+        const ddsketch_t *s = &ms->sk[k];
+        printf("%-20s %10llu %14.2f %14.2f %14.2f %14.2f\n",
+               metric_summary_name(ms, k), (unsigned long long)s->count,
+               ddsketch_quantile(s, 0.50), ddsketch_quantile(s, 0.90),
+               ddsketch_quantile(s, 0.99), s->max);
+    }
+}
@@ -0,0 +1,731 @@
+/*
+ * src/summarize.c
+ *
+ * --summarize: agrega os resultados dos experimentos (exp1..exp5) num CSV
+ * compacto para scripts/visualize.py, lendo cada arquivo em fluxo.
+ */
+
+#include "summarize.h"
+#include "replay.h"
+#include "sketch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <math.h>
+#include <glob.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#define SUM_MAX_ACC 8
+#define SUM_MAX_SKETCH 2
+
+/* ===================== ACUMULADORES ====================== */
+
+/* média/variância em uma passada (Welford) */
+typedef struct {
+    size_t n;
+    double mean;
+    double m2;
+    double sum;
+} sum_acc_t;
+
+static void acc_add(sum_acc_t *a, double v) {
+    if (isnan(v)) return;
+    a->n++;
+    a->sum += v;
+    double d = v - a->mean;
+    a->mean += d / (double)a->n;
+    a->m2 += d * (v - a->mean);
+}
+
+static double acc_mean(const sum_acc_t *a) { return a->n ? a->mean : NAN; }
+
+/* desvio amostral (ddof=1), como o groupby do pandas */
+static double acc_std(const sum_acc_t *a) {
+    return a->n > 1 ? sqrt(a->m2 / (double)(a->n - 1)) : NAN;
+}
+
+typedef struct {
+    char key[128];
+    sum_acc_t acc[SUM_MAX_ACC];
+    ddsketch_t *sk;                 // [nsketch] ou NULL
+    double *vals;                   // valores guardados para a mediana exata
+    size_t nvals;
+    size_t cap_vals;
+} sum_group_t;
+
+typedef struct {
+    sum_group_t *g;
+    size_t n;
+    size_t cap;
+    int nsketch;
+} sum_table_t;
+
+static sum_group_t *table_get(sum_table_t *t, const char *key) {
+    for (size_t i = 0; i < t->n; i++)
+        if (strcmp(t->g[i].key, key) == 0) return &t->g[i];
+
+    if (t->n == t->cap) {
+        size_t cap = t->cap ? t->cap * 2 : 16;
+        sum_group_t *ng = realloc(t->g, cap * sizeof(*ng));
+        if (!ng) return NULL;
+        t->g = ng;
+        t->cap = cap;
+    }
+    sum_group_t *g = &t->g[t->n];
+    memset(g, 0, sizeof(*g));
+    snprintf(g->key, sizeof(g->key), "%s", key);
+    if (t->nsketch > 0) {
+        g->sk = malloc((size_t)t->nsketch * sizeof(ddsketch_t));
+        if (!g->sk) return NULL;
+        for (int k = 0; k < t->nsketch; k++) ddsketch_init(&g->sk[k], DDS_DEFAULT_ALPHA);
+    }
+    t->n++;
+    return g;
+}
+
+/* grupo cuja chave tem o mesmo valor numérico ("1" == "1.0") */
+static sum_group_t *table_find_num(sum_table_t *t, const char *key) {
+    char *end;
+    double v = strtod(key, &end);
+    if (end == key) return NULL;
+    for (size_t i = 0; i < t->n; i++) {
+        char *e2;
+        double k = strtod(t->g[i].key, &e2);
+        if (e2 != t->g[i].key && k == v) return &t->g[i];
+    }
+    return NULL;
+}
+
+static int group_push(sum_group_t *g, double v) {
+    if (isnan(v)) return 0;
+    if (g->nvals == g->cap_vals) {
+        size_t cap = g->cap_vals ? g->cap_vals * 2 : 16;
+        double *nv = realloc(g->vals, cap * sizeof(*nv));
+        if (!nv) return -1;
+        g->vals = nv;
+        g->cap_vals = cap;
+    }
+    g->vals[g->nvals++] = v;
+    return 0;
+}
+
+static int double_cmp(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* mediana com interpolação entre os dois centrais, como pandas */
+static double group_median(sum_group_t *g) {
+    if (g->nvals == 0) return NAN;
+    qsort(g->vals, g->nvals, sizeof(double), double_cmp);
+    size_t h = g->nvals / 2;
+    return g->nvals % 2 ? g->vals[h] : 0.5 * (g->vals[h - 1] + g->vals[h]);
+}
+
+static int group_cmp(const void *a, const void *b) {
+    const sum_group_t *x = a, *y = b;
+    char *ex, *ey;
+    double dx = strtod(x->key, &ex), dy = strtod(y->key, &ey);
+    if (ex != x->key && ey != y->key && *ex == '\0' && *ey == '\0')
+        return (dx > dy) - (dx < dy);
+    return strcmp(x->key, y->key);
+}
+
+static void table_sort(sum_table_t *t) {
+    if (t->n > 1) qsort(t->g, t->n, sizeof(*t->g), group_cmp);
+}
+
+static void table_free(sum_table_t *t) {
+    for (size_t i = 0; i < t->n; i++) {
+        free(t->g[i].sk);
+        free(t->g[i].vals);
+    }
+    free(t->g);
+    memset(t, 0, sizeof(*t));
+}
+
+/* ===================== LEITURA CSV ====================== */
+
+typedef struct {
+    FILE *fp;
+    char *line;
+    size_t cap;
+    char *hdr_line;
+    char **hdr;         // [maxcols], dimensionado pelo cabeçalho
+    int nhdr;
+    char **f;           // [maxcols]
+    int nf;
+    int maxcols;
+} sum_csv_t;
+
+static char *trim(char *s) {
+    while (isspace((unsigned char)*s)) s++;
+    size_t n = strlen(s);
+    while (n > 0 && isspace((unsigned char)s[n - 1])) s[--n] = '\0';
+    return s;
+}
+
+/* separa a linha em campos (no próprio buffer), respeitando aspas */
+static int split_csv(char *line, char **f, int max) {
+    line[strcspn(line, "\r\n")] = '\0';
+    int n = 0;
+    char *p = line;
+    while (n < max) {
+        char *start = p, *w = p;
+        int quoted = 0;
+        while (*p) {
+            if (*p == '"') {
+                if (quoted && p[1] == '"') {
+                    *w++ = '"';
+                    p += 2;
+                    continue;
+                }
+                quoted = !quoted;
+                p++;
+                continue;
+            }
+            if (*p == ',' && !quoted) break;
+            *w++ = *p++;
+        }
+        char next = *p;
+        *w = '\0';
+        f[n++] = trim(start);
+        if (next != ',') break;
+        p++;
+    }
+    return n;
+}
+
+static void csv_close(sum_csv_t *c) {
+    if (c->fp) fclose(c->fp);
+    free(c->line);
+    free(c->hdr_line);
+    free(c->hdr);
+    free(c->f);
+    memset(c, 0, sizeof(*c));
+}
+
+static int csv_open(sum_csv_t *c, const char *path) {
+    memset(c, 0, sizeof(*c));
+    c->fp = fopen(path, "r");
+    if (!c->fp) {
+        fprintf(stderr, "Erro ao abrir %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    ssize_t len = getline(&c->hdr_line, &c->cap, c->fp);
+    if (len <= 0) {
+        fprintf(stderr, "Arquivo sem cabeçalho: %s\n", path);
+        fclose(c->fp);
+        free(c->hdr_line);
+        return -1;
+    }
+    /* cada vírgula pode abrir uma coluna: o cabeçalho limita quantas existem */
+    c->maxcols = 1;
+    for (const char *s = c->hdr_line; *s; s++)
+        if (*s == ',') c->maxcols++;
+    c->hdr = malloc((size_t)c->maxcols * sizeof(char *));
+    c->f = malloc((size_t)c->maxcols * sizeof(char *));
+    if (!c->hdr || !c->f) {
+        fprintf(stderr, "Erro de alocação ao ler %s\n", path);
+        csv_close(c);
+        return -1;
+    }
+    c->nhdr = split_csv(c->hdr_line, c->hdr, c->maxcols);
+    for (int i = 0; i < c->nhdr; i++)
+        for (char *s = c->hdr[i]; *s; s++) *s = (char)tolower((unsigned char)*s);
+    c->cap = 0;
+    return 0;
+}
+
+/* próxima linha não vazia; 0 no fim do arquivo */
+static int csv_next(sum_csv_t *c) {
+    while (getline(&c->line, &c->cap, c->fp) > 0) {
+        c->nf = split_csv(c->line, c->f, c->maxcols);
+        if (c->nf > 1 || (c->nf == 1 && c->f[0][0])) return 1;
+    }
+    return 0;
+}
+
+static int csv_col(const sum_csv_t *c, const char *name) {
+    for (int i = 0; i < c->nhdr; i++)
+        if (strcmp(c->hdr[i], name) == 0) return i;
+    return -1;
+}
+
+static const char *csv_str(const sum_csv_t *c, int col) {
+    return (col >= 0 && col < c->nf) ? c->f[col] : "";
+}
+
+/* valor numérico da coluna; NaN se vazia ou inválida (como to_numeric coerce) */
+static double csv_num(const sum_csv_t *c, int col) {
+    const char *s = csv_str(c, col);
+    char *end;
+    double v = strtod(s, &end);
+    if (end == s || *end != '\0') return NAN;
+    return v;
+}
+
+
+static int truthy(const char *s) {
+    return strcasecmp(s, "yes") == 0 || strcasecmp(s, "true") == 0 || strcmp(s, "1") == 0 ||
+           strcasecmp(s, "y") == 0 || strcasecmp(s, "t") == 0;
+}
+
+/* ===================== ESCRITA ====================== */
+
+static int mkdir_p(const char *dir) {
+    char buf[1024];
+    snprintf(buf, sizeof(buf), "%s", dir);
+    for (char *p = buf + 1; *p; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        if (mkdir(buf, 0755) != 0 && errno != EEXIST) return -1;
+        *p = '/';
+    }
+    if (mkdir(buf, 0755) != 0 && errno != EEXIST) return -1;
+    return 0;
+}
+
+static FILE *open_out(const char *out_dir, const char *name, const char *header) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", out_dir, name);
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "Erro ao criar %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    fprintf(f, "%s\n", header);
+    printf("Resumo gravado em %s\n", path);
+    return f;
+}
+
+static void put_key(FILE *f, const char *key) {
+    if (strpbrk(key, ",\"")) {
+        fputc('"', f);
+        for (const char *p = key; *p; p++) {
+            if (*p == '"') fputc('"', f);
+            fputc(*p, f);
+        }
+        fputc('"', f);
+    } else {
+        fputs(key, f);
+    }
+}
+
+/* NaN/inf saem como campo vazio (lido como NaN pelo pandas) */
+static void put_row(FILE *f, const char *key, const double *v, int n) {
+    put_key(f, key);
+    for (int i = 0; i < n; i++) {
+        fputc(',', f);
+        if (isfinite(v[i])) fprintf(f, "%.10g", v[i]);
+    }
+    fputc('\n', f);
+}
+
+static double pct_over(double monitored, double baseline) {
+    return baseline > 0 ? 100.0 * (monitored - baseline) / baseline : NAN;
+}
+
+static int close_out(FILE *f) {
+    int rc = ferror(f) ? -1 : 0;
+    if (fclose(f) != 0) rc = -1;
+    return rc;
+}
+
+/* ===================== EXPERIMENTO 2 ====================== */
+
+/* combo,trial,time_us,pid_count,net_links,mounts,isol_pid,isol_net,isol_mnt */
+static int summarize_exp2(const char *path, const char *out_dir) {
+    sum_csv_t c;
+    if (csv_open(&c, path) != 0) return -1;
+    sum_table_t t = { 0 };
+
+    while (csv_next(&c)) {
+        /* combos antigos não eram citados: as 8 últimas colunas são fixas */
+        if (c.nf < 9) continue;
+        int base = c.nf - 8;
+        char combo[128] = "";
+        size_t len = 0;
+        for (int i = 0; i < base && len < sizeof(combo); i++)
+            len += (size_t)snprintf(combo + len, sizeof(combo) - len, "%s%s", i ? "," : "", c.f[i]);
+
+        sum_group_t *g = table_get(&t, combo);
+        if (!g) break;
+        double us = csv_num(&c, base + 1);
+        acc_add(&g->acc[0], us);
+        if (group_push(g, us) != 0) break;
+        for (int k = 0; k < 3; k++) acc_add(&g->acc[1 + k], truthy(c.f[base + 5 + k]) ? 1.0 : 0.0);
+    }
+    csv_close(&c);
+    table_sort(&t);
+
+    int rc = -1;
+    FILE *ft = open_out(out_dir, "exp2_time_agg.csv", "combo,mean,median,std,count");
+    FILE *fh = ft ? open_out(out_dir, "exp2_isolation_heat.csv", "combo,isol_pid,isol_net,isol_mnt") : NULL;
+    if (ft && fh) {
+        for (size_t i = 0; i < t.n; i++) {
+            sum_group_t *g = &t.g[i];
+            double tv[4] = { acc_mean(&g->acc[0]), group_median(g),
+                             acc_std(&g->acc[0]), (double)g->acc[0].n };
+            double hv[3] = { g->acc[1].sum, g->acc[2].sum, g->acc[3].sum };
+            put_row(ft, g->key, tv, 4);
+            put_row(fh, g->key, hv, 3);
+        }
+        rc = 0;
+    }
+    if (ft && close_out(ft) != 0) rc = -1;
+    if (fh && close_out(fh) != 0) rc = -1;
+    table_free(&t);
+    return rc;
+}
+
+/* ===================== EXPERIMENTO 3 ====================== */
+
+/* limit,trial,limit_cores,applied,max_cpu_pct,measured_cpu_pct,throughput_iters */
+static int summarize_exp3(const char *path, const char *out_dir) {
+    sum_csv_t c;
+    if (csv_open(&c, path) != 0) return -1;
+    int c_key = csv_col(&c, "limit_cores"), c_trial = csv_col(&c, "trial");
+    int c_applied = csv_col(&c, "applied"), c_meas = csv_col(&c, "measured_cpu_pct");
+    int c_thr = csv_col(&c, "throughput_iters");
+    if (c_key < 0 || c_meas < 0) {
+        fprintf(stderr, "%s sem colunas limit_cores/measured_cpu_pct\n", path);
+        csv_close(&c);
+        return -1;
+    }
+    sum_table_t t = { 0 };
+
+    while (csv_next(&c)) {
+        sum_group_t *g = table_get(&t, csv_str(&c, c_key));
+        if (!g) break;
+        double cores = csv_num(&c, c_key), meas = csv_num(&c, c_meas);
+        if (csv_str(&c, c_trial)[0]) acc_add(&g->acc[0], 1.0);
+        acc_add(&g->acc[1], meas);
+        acc_add(&g->acc[2], csv_num(&c, c_thr));
+        acc_add(&g->acc[3], truthy(csv_str(&c, c_applied)) ? 1.0 : 0.0);
+        /* fração da cota (limit_cores × 100%) efetivamente usada */
+        if (cores > 0) acc_add(&g->acc[4], 100.0 * meas / (cores * 100.0));
+    }
+    csv_close(&c);
+    table_sort(&t);
+
+    FILE *f = open_out(out_dir, "exp3_agg.csv",
+                       "limit_cores,trials,mean_measured_pct,std_measured_pct,mean_throughput,"
+                       "applied_trials,quota_pct,mean_quota_utilization_pct");
+    if (!f) {
+        table_free(&t);
+        return -1;
+    }
+    for (size_t i = 0; i < t.n; i++) {
+        const sum_group_t *g = &t.g[i];
+        double v[7] = { g->acc[0].sum, acc_mean(&g->acc[1]), acc_std(&g->acc[1]), acc_mean(&g->acc[2]),
+                        g->acc[3].sum, strtod(g->key, NULL) * 100.0, acc_mean(&g->acc[4]) };
+        put_row(f, g->key, v, 7);
+    }
+    table_free(&t);
+    return close_out(f);
+}
+
+/* ===================== EXPERIMENTO 4 ====================== */
+
+/* último "MAX_ALLOC:<n>"/"ALLOC:<n>" do log do workload, ou NaN */
+static double max_alloc_from_log(const char *logpath) {
+    FILE *f = fopen(logpath, "r");
+    if (!f) return NAN;
+    char line[256];
+    double v = NAN;
+    while (fgets(line, sizeof(line), f)) {
+        if (!strstr(line, "ALLOC:")) continue;
+        char digits[32];
+        size_t n = 0;
+        for (const char *p = line; *p && n < sizeof(digits) - 1; p++)
+            if (isdigit((unsigned char)*p)) digits[n++] = *p;
+        digits[n] = '\0';
+        if (n > 0) v = strtod(digits, NULL);
+    }
+    fclose(f);
+    return v;
+}
+
+/* limit_bytes,trial,max_alloc_bytes,failcnt,oom_kills,exit_status,logfile */
+static int summarize_exp4(const char *path, const char *out_dir) {
+    sum_csv_t c;
+    if (csv_open(&c, path) != 0) return -1;
+    int c_key = csv_col(&c, "limit_bytes"), c_trial = csv_col(&c, "trial");
+    int c_alloc = csv_col(&c, "max_alloc_bytes"), c_fail = csv_col(&c, "failcnt");
+    int c_oom = csv_col(&c, "oom_kills"), c_log = csv_col(&c, "logfile");
+    if (c_key < 0 || c_alloc < 0) {
+        fprintf(stderr, "%s sem colunas limit_bytes/max_alloc_bytes\n", path);
+        csv_close(&c);
+        return -1;
+    }
+    sum_table_t t = { 0 };
+
+    while (csv_next(&c)) {
+        sum_group_t *g = table_get(&t, csv_str(&c, c_key));
+        if (!g) break;
+        double limit = csv_num(&c, c_key), alloc = csv_num(&c, c_alloc);
+        if (isnan(alloc) && csv_str(&c, c_log)[0]) alloc = max_alloc_from_log(csv_str(&c, c_log));
+        if (csv_str(&c, c_trial)[0]) acc_add(&g->acc[0], 1.0);
+        acc_add(&g->acc[1], alloc);
+        acc_add(&g->acc[2], csv_num(&c, c_fail));
+        acc_add(&g->acc[3], csv_num(&c, c_oom));
+        if (limit > 0) acc_add(&g->acc[4], 100.0 * alloc / limit);
+    }
+    csv_close(&c);
+    table_sort(&t);
+
+    FILE *f = open_out(out_dir, "exp4_agg.csv",
+                       "limit_bytes,trials,mean_max_alloc,std_max_alloc,total_failcnt,total_oom,"
+                       "mean_alloc_limit_pct");
+    if (!f) {
+        table_free(&t);
+        return -1;
+    }
+    for (size_t i = 0; i < t.n; i++) {
+        const sum_group_t *g = &t.g[i];
+        double v[6] = { g->acc[0].sum, acc_mean(&g->acc[1]), acc_std(&g->acc[1]),
+                        g->acc[2].sum, g->acc[3].sum, acc_mean(&g->acc[4]) };
+        put_row(f, g->key, v, 6);
+    }
+    table_free(&t);
+    return close_out(f);
+}
+
+/* ===================== EXPERIMENTO 5 ====================== */
+
+/* limit_bps,trial,measured_bytes,measured_bps,avg_write_latency_us,run_time_s,applied,logfile */
+static int summarize_exp5(const char *path, const char *out_dir) {
+    sum_csv_t c;
+    if (csv_open(&c, path) != 0) return -1;
+    int c_key = csv_col(&c, "limit_bps"), c_trial = csv_col(&c, "trial");
+    int c_bps = csv_col(&c, "measured_bps"), c_lat = csv_col(&c, "avg_write_latency_us");
+    int c_applied = csv_col(&c, "applied");
+    if (c_key < 0 || c_bps < 0) {
+        fprintf(stderr, "%s sem colunas limit_bps/measured_bps\n", path);
+        csv_close(&c);
+        return -1;
+    }
+    sum_table_t t = { 0 };
+
+    while (csv_next(&c)) {
+        sum_group_t *g = table_get(&t, csv_str(&c, c_key));
+        if (!g) break;
+        if (csv_str(&c, c_trial)[0]) acc_add(&g->acc[0], 1.0);
+        acc_add(&g->acc[1], csv_num(&c, c_bps));
+        acc_add(&g->acc[2], csv_num(&c, c_lat));
+        acc_add(&g->acc[3], truthy(csv_str(&c, c_applied)) ? 1.0 : 0.0);
+    }
+    csv_close(&c);
+    table_sort(&t);
+
+    FILE *f = open_out(out_dir, "exp5_agg.csv",
+                       "limit_bps,trials,mean_measured_bps,std_measured_bps,mean_latency_us,ratio,"
+                       "applied_trials");
+    if (!f) {
+        table_free(&t);
+        return -1;
+    }
+    for (size_t i = 0; i < t.n; i++) {
+        const sum_group_t *g = &t.g[i];
+        double limit = strtod(g->key, NULL);
+        double mean_bps = acc_mean(&g->acc[1]);
+        double v[6] = { g->acc[0].sum, mean_bps, acc_std(&g->acc[1]), acc_mean(&g->acc[2]),
+                        limit > 0 ? mean_bps / limit : NAN, g->acc[3].sum };
+        put_row(f, g->key, v, 6);
+    }
+    table_free(&t);
+    return close_out(f);
+}
+
+/* ===================== EXPERIMENTO 1 ====================== */
+
+enum { E1_EL_BASE, E1_EL_MON, E1_CPU_BASE, E1_CPU_MON, E1_LAT, E1_THR_BASE, E1_THR_MON };
+enum { E1_SK_CPU, E1_SK_LAT };
+
+/*
+ * Uma gravação metrics_<intervalo>_<run>.csv: linha em latency_per_run.csv
+ * (intervalo entre amostras consecutivas) e CPU%/latências no sketch do
+ * intervalo. Gravações com --suppress não guardam todos os instantes de
+ * amostragem, então ficam fora das latências (como no visualize.py).
+ */
+static void summarize_metrics_file(const char *path, sum_table_t *t, FILE *lat_out) {
+    const char *name = strrchr(path, '/');
+    name = name ? name + 1 : path;
+
+    char interval[64];
+    snprintf(interval, sizeof(interval), "%s", name + strlen("metrics_"));
+    char *us = strrchr(interval, '_');
+    if (us) *us = '\0';
+    sum_group_t *g = table_find_num(t, interval);
+    if (!g) g = table_get(t, interval);
+    if (!g) return;
+
+    replay_data_t d;
+    memset(&d, 0, sizeof(d));
+    if (replay_map_file(path, &d) != 0) return;
+    const char *end = (const char *)d.map + d.map_len;
+    csv_layout_t lay;
+    const char *p = replay_csv_layout(d.map, end, &lay);
+    if (!p) {
+        replay_free(&d);
+        return;
+    }
+
+    ddsketch_t run_sk;
+    ddsketch_init(&run_sk, DDS_DEFAULT_ALPHA);
+    sum_acc_t run = { 0 };
+    size_t n_samples = 0;
+    double prev = NAN;
+    proc_metrics_t m;
+    int is_row;
+    while (p < end) {
+        p = replay_csv_row(p, end, &lay, &m, &is_row);
+        if (!is_row) continue;
+        n_samples++;
+        ddsketch_add(&g->sk[E1_SK_CPU], m.cpu_percent);
+        double dt = m.timestamp - prev;
+        prev = m.timestamp;
+        if (lay.interval_s > 0 || !(dt > 0)) continue;
+        acc_add(&run, dt);
+        ddsketch_add(&run_sk, dt);
+        ddsketch_add(&g->sk[E1_SK_LAT], dt);
+        acc_add(&g->acc[E1_LAT], dt);
+    }
+    replay_free(&d);
+
+    if (run.n == 0) return;
+    /* desvio populacional (ddof=0), como np.std */
+    double v[6] = { (double)n_samples, run.mean, ddsketch_quantile(&run_sk, 0.5),
+                    sqrt(run.m2 / (double)run.n), run_sk.min, run_sk.max };
+    put_row(lat_out, name, v, 6);
+}
+
+/* overhead_summary.csv: mode,interval,run,elapsed_sec,percent_cpu[,throughput] */
+static int summarize_exp1(const char *dir, const char *path, const char *out_dir) {
+    sum_csv_t c;
+    if (csv_open(&c, path) != 0) return -1;
+    int c_mode = csv_col(&c, "mode"), c_int = csv_col(&c, "interval");
+    int c_el = csv_col(&c, "elapsed_sec"), c_cpu = csv_col(&c, "percent_cpu");
+    int c_thr = csv_col(&c, "throughput");     // vazão do rm_workload (opcional)
+    if (c_mode < 0 || c_int < 0 || c_el < 0 || c_cpu < 0) {
+        fprintf(stderr, "%s sem colunas mode/interval/elapsed_sec/percent_cpu\n", path);
+        csv_close(&c);
+        return -1;
+    }
+    sum_table_t t = { .nsketch = SUM_MAX_SKETCH };
+
+    while (csv_next(&c)) {
+        double el = csv_num(&c, c_el), cpu = csv_num(&c, c_cpu);
+        double thr = c_thr >= 0 ? csv_num(&c, c_thr) : NAN;
+        if ((isnan(el) || isnan(cpu)) && isnan(thr)) continue;
+        int mon;
+        if (strcmp(csv_str(&c, c_mode), "baseline") == 0) mon = 0;
+        else if (strcmp(csv_str(&c, c_mode), "monitored") == 0) mon = 1;
+        else continue;
+        sum_group_t *g = table_find_num(&t, csv_str(&c, c_int));
+        if (!g) g = table_get(&t, csv_str(&c, c_int));
+        if (!g) break;
+        // a vazão vem do próprio rm_workload e vale mesmo sem tempo/CPU do /usr/bin/time
+        if (!isnan(thr)) acc_add(&g->acc[mon ? E1_THR_MON : E1_THR_BASE], thr);
+        if (isnan(el) || isnan(cpu)) continue;
+        acc_add(&g->acc[mon ? E1_EL_MON : E1_EL_BASE], el);
+        acc_add(&g->acc[mon ? E1_CPU_MON : E1_CPU_BASE], cpu);
+    }
+    csv_close(&c);
+
+    int rc = 0;
+    FILE *lat = open_out(out_dir, "latency_per_run.csv",
+                         "file,n_samples,mean_latency_s,median_latency_s,std_latency_s,"
+                         "min_latency_s,max_latency_s");
+    if (lat) {
+        char pattern[1024];
+        snprintf(pattern, sizeof(pattern), "%s/metrics_*.csv", dir);
+        glob_t gl;
+        if (glob(pattern, 0, NULL, &gl) == 0) {
+            for (size_t i = 0; i < gl.gl_pathc; i++) summarize_metrics_file(gl.gl_pathv[i], &t, lat);
+            globfree(&gl);
+        }
+        if (close_out(lat) != 0) rc = -1;
+    } else {
+        rc = -1;
+    }
+    table_sort(&t);
+
+    FILE *f = open_out(out_dir, "aggregated_summary.csv",
+                       "interval,elapsed_baseline,elapsed_monitored,elapsed_overhead_pct,"
+                       "cpu_baseline,cpu_monitored,cpu_overhead_pct,runs_baseline,runs_monitored,"
+                       "elapsed_monitored_std,cpu_monitored_std,sample_cpu_p50,sample_cpu_p90,"
+                       "sample_cpu_p99,latency_mean_s,latency_p99_s,throughput_baseline,"
+                       "throughput_monitored,throughput_loss_pct");
+    if (!f) {
+        table_free(&t);
+        return -1;
+    }
+    for (size_t i = 0; i < t.n; i++) {
+        const sum_group_t *g = &t.g[i];
+        const ddsketch_t *cpu = &g->sk[E1_SK_CPU], *lt = &g->sk[E1_SK_LAT];
+        double eb = acc_mean(&g->acc[E1_EL_BASE]), em = acc_mean(&g->acc[E1_EL_MON]);
+        double cb = acc_mean(&g->acc[E1_CPU_BASE]), cm = acc_mean(&g->acc[E1_CPU_MON]);
+        double tb = acc_mean(&g->acc[E1_THR_BASE]), tm = acc_mean(&g->acc[E1_THR_MON]);
+        double v[18] = {
+            eb, em, pct_over(em, eb),
+            cb, cm, pct_over(cm, cb),
+            (double)g->acc[E1_EL_BASE].n, (double)g->acc[E1_EL_MON].n,
+            acc_std(&g->acc[E1_EL_MON]), acc_std(&g->acc[E1_CPU_MON]),
+            cpu->count ? ddsketch_quantile(cpu, 0.5) : NAN,
+            cpu->count ? ddsketch_quantile(cpu, 0.9) : NAN,
+            cpu->count ? ddsketch_quantile(cpu, 0.99) : NAN,
+            acc_mean(&g->acc[E1_LAT]),
+            lt->count ? ddsketch_quantile(lt, 0.99) : NAN,
+            tb, tm, -pct_over(tm, tb),      // overhead como perda de vazão
+        };
+        put_row(f, g->key, v, 18);
+    }
+    table_free(&t);
+    if (close_out(f) != 0) rc = -1;
+    return rc;
+}
+
+/* ===================== DESPACHO ====================== */
+
+static int file_exists(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISREG(st.st_mode);
+}
+
+int summarize_experiment(const char *dir, const char *out_dir) {
+    char def_out[768];
+    if (!out_dir) {
+        snprintf(def_out, sizeof(def_out), "%.700s/plots", dir);
+        out_dir = def_out;
+    }
+    if (mkdir_p(out_dir) != 0) {
+        fprintf(stderr, "Erro ao criar %s: %s\n", out_dir, strerror(errno));
+        return -1;
+    }
+
+    /* mesma ordem de detecção de summarize_and_plot() no visualize.py */
+    static const struct {
+        const char *file;
+        int (*fn)(const char *path, const char *out_dir);
+    } k_kinds[] = {
+        { "experiment2_results.csv", summarize_exp2 },
+        { "exp3_results.csv", summarize_exp3 },
+        { "exp4_results.csv", summarize_exp4 },
+        { "exp5_results.csv", summarize_exp5 },
+    };
+    char path[1024];
+    for (size_t i = 0; i < sizeof(k_kinds) / sizeof(k_kinds[0]); i++) {
+        snprintf(path, sizeof(path), "%s/%s", dir, k_kinds[i].file);
+        if (file_exists(path)) return k_kinds[i].fn(path, out_dir);
+    }
+    snprintf(path, sizeof(path), "%s/overhead_summary.csv", dir);
+    if (file_exists(path)) return summarize_exp1(dir, path, out_dir);
+
+    fprintf(stderr, "Nenhum resultado de experimento reconhecido em %s\n", dir);
+    return -1;
+}
@@ -0,0 +1,950 @@
+/*
+ * src/top.c
+ *
+ * --top: coletor de todos os processos em thread própria, visão com
+ * filtro/ordenação/agrupamento e painel ncurses com redesenho incremental.
+ */
+
+#define _GNU_SOURCE
+#include "top.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/resource.h>
+
+#ifdef USE_NCURSES
+#include <ncurses.h>
+#include <locale.h>
+#endif
+
+static double mono_now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec / 1e9;
+}
+
+/* ===================== LEITURA DE /proc ====================== */
+
+/* lê um arquivo pequeno relativo a dirfd; retorna bytes lidos ou -1 */
+static ssize_t read_small(int dirfd, const char *path, char *buf, size_t size) {
+    int fd = openat(dirfd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    ssize_t n = read(fd, buf, size - 1);
+    close(fd);
+    if (n < 0) return -1;
+    buf[n] = '\0';
+    return n;
+}
+
+typedef struct {
+    char comm[32];
+    char state;
+    unsigned long long minflt, majflt, jiffies, starttime, rss_pages;
+    int threads;
+} stat_fields_t;
+
+/* campos de /proc/<pid>/stat (o comando pode conter espaços e parênteses) */
+static int parse_stat(const char *buf, stat_fields_t *s) {
+    const char *open = strchr(buf, '(');
+    const char *close = strrchr(buf, ')');
+    if (!open || !close || close < open) return -1;
+    size_t len = (size_t)(close - open - 1);
+    if (len >= sizeof(s->comm)) len = sizeof(s->comm) - 1;
+    memcpy(s->comm, open + 1, len);
+    s->comm[len] = '\0';
+
+    const char *p = close + 2;
+    s->state = *p;
+    p++;
+    /* após o estado: campos 4..24 de proc(5) */
+    unsigned long long f[22];
+    for (int i = 0; i < 21; i++) {
+        char *end;
+        f[i] = strtoull(p, &end, 10);
+        if (end == p) return -1;
+        p = end;
+    }
+    s->minflt = f[6];
+    s->majflt = f[8];
+    s->jiffies = f[10] + f[11];
+    s->threads = (int)f[16];
+    s->starttime = f[18];
+    s->rss_pages = f[20];
+    return 0;
+}
+
+static void read_cgroup(int dirfd, const char *pid, char *out, size_t size) {
+    char path[300], buf[1024];
+    snprintf(out, size, "/");
+    snprintf(path, sizeof(path), "%s/cgroup", pid);
+    if (read_small(dirfd, path, buf, sizeof(buf)) <= 0) return;
+
+    /* cgroup v2: "0::/caminho"; em v1, usa a primeira hierarquia */
+    char *line = strstr(buf, "0::");
+    if (!line || (line != buf && line[-1] != '\n')) line = buf;
+    char *colon = strchr(line, ':');
+    if (colon) colon = strchr(colon + 1, ':');
+    if (!colon) return;
+    colon++;
+    size_t n = strcspn(colon, "\n");
+    if (n == 0) return;
+    if (n >= size) n = size - 1;
+    memcpy(out, colon, n);
+    out[n] = '\0';
+}
+
+static unsigned long read_ns(int dirfd, const char *pid, const char *type) {
+    char path[300], link[64];
+    snprintf(path, sizeof(path), "%s/ns/%s", pid, type);
+    ssize_t n = readlinkat(dirfd, path, link, sizeof(link) - 1);
+    if (n <= 0) return 0;
+    link[n] = '\0';
+    const char *b = strchr(link, '[');
+    return b ? strtoul(b + 1, NULL, 10) : 0;
+}
+
+/* ===================== COLETOR ====================== */
+
+int top_collector_init(top_collector_t *c, long interval_ms) {
+    memset(c, 0, sizeof(*c));
+    c->interval_ms = interval_ms > 0 ? interval_ms : 1000;
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_condattr_t ca;
+    pthread_condattr_init(&ca);
+    pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+    pthread_cond_init(&c->wake, &ca);
+    pthread_condattr_destroy(&ca);
+    return 0;
+}
+
+static int proc_cmp(const void *a, const void *b) {
+    pid_t x = ((const top_proc_t *)a)->row.pid, y = ((const top_proc_t *)b)->row.pid;
+    return (x > y) - (x < y);
+}
+
+static top_proc_t *find_proc(top_collector_t *c, pid_t pid) {
+    top_proc_t key;
+    key.row.pid = pid;
+    return bsearch(&key, c->procs, c->nprocs, sizeof(*c->procs), proc_cmp);
+}
+
+/* dados de um tick compartilhados pelas tarefas (só leitura, exceto out[i]) */
+typedef struct {
+    top_collector_t *c;
+    int dfd;
+    top_proc_t *out;                // out[i].row.pid == 0: processo sumiu
+    const unsigned char *fresh;     // 1 = PID não estava no tick anterior
+    int batched;                    // stat já lido em lote (reqs[i].result)
+    double dt;
+    long hz;
+    long page_kb;
+} scan_job_t;
+
+static int open_stat(int dfd, pid_t pid) {
+    char path[32];
+    snprintf(path, sizeof(path), "%d/stat", (int)pid);
+    return openat(dfd, path, O_RDONLY | O_CLOEXEC);
+}
+
+/* tarefa de um alvo: interpreta /proc/<pid>/stat e deriva as taxas do tick */
+static void scan_one(void *ctx, size_t i) {
+    scan_job_t *job = ctx;
+    top_collector_t *c = job->c;
+    top_proc_t *p = &job->out[i];
+    char *buf = c->statbuf + i * TOP_STAT_BUF;
+    int fresh = job->fresh[i];
+
+    ssize_t n;
+    if (job->batched) n = c->reqs[i].result;
+    else if (p->stat_fd >= 0) n = pread(p->stat_fd, buf, TOP_STAT_BUF - 1, 0);
+    else n = -1;
+
+    if (n <= 0 && p->stat_fd >= 0) {
+        /* descritor de um processo que terminou (o PID pode ter sido reutilizado) */
+        close(p->stat_fd);
+        p->stat_fd = open_stat(job->dfd, p->row.pid);
+        n = p->stat_fd >= 0 ? pread(p->stat_fd, buf, TOP_STAT_BUF - 1, 0) : -1;
+        fresh = 1;
+    }
+    char name[16], path[32];
+    snprintf(name, sizeof(name), "%d", (int)p->row.pid);
+    if (n <= 0 && p->stat_fd < 0) {
+        /* sem descritor (limite de arquivos abertos): abre, lê e fecha */
+        snprintf(path, sizeof(path), "%s/stat", name);
+        n = read_small(job->dfd, path, buf, TOP_STAT_BUF);
+    } else if (n > 0) {
+        buf[n] = '\0';
+    }
+
+    stat_fields_t sf;
+    if (n <= 0 || parse_stat(buf, &sf) != 0) {
+        if (p->stat_fd >= 0) close(p->stat_fd);
+        p->stat_fd = -1;
+        p->row.pid = 0;     // o processo terminou entre o readdir e a leitura
+        return;
+    }
+
+    int known = !fresh && p->starttime == sf.starttime;
+    if (!known) {
+        pid_t pid = p->row.pid;
+        int fd = p->stat_fd;
+        memset(p, 0, sizeof(*p));
+        p->row.pid = pid;
+        p->stat_fd = fd;
+        p->starttime = sf.starttime;
+        read_cgroup(job->dfd, name, p->row.cgroup, sizeof(p->row.cgroup));
+        p->row.pidns = read_ns(job->dfd, name, "pid");
+        p->row.netns = read_ns(job->dfd, name, "net");
+    }
+
+    top_row_t *r = &p->row;
+    double dt = job->dt;
+    if (known && dt > 0.0) {
+        r->cpu_percent = 100.0 * (double)(sf.jiffies - p->jiffies) / ((double)job->hz * dt);
+        r->minflt_per_s = (double)(sf.minflt - p->minflt) / dt;
+        r->majflt_per_s = (double)(sf.majflt - p->majflt) / dt;
+    } else {
+        r->cpu_percent = r->minflt_per_s = r->majflt_per_s = 0.0;
+    }
+    memmove(r->spark, r->spark + 1, (TOP_SPARK_LEN - 1) * sizeof(r->spark[0]));
+    r->spark[TOP_SPARK_LEN - 1] = (float)r->cpu_percent;
+
+    snprintf(r->comm, sizeof(r->comm), "%s", sf.comm);
+    r->state = sf.state;
+    r->threads = sf.threads;
+    r->rss_kb = (unsigned long)(sf.rss_pages * (unsigned long long)job->page_kb);
+    p->jiffies = sf.jiffies;
+    p->minflt = sf.minflt;
+    p->majflt = sf.majflt;
+}
+
+static int pid_cmp(const void *a, const void *b) {
+    pid_t x = *(const pid_t *)a, y = *(const pid_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* primeiro uso: backend de leitura e limite de descritores (um por PID) */
+static void io_setup(top_collector_t *c) {
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+    if (batchread_init(&c->io, (batchread_backend_t)c->io_backend) != 0)
+        batchread_init(&c->io, BATCHREAD_PREAD);
+    c->io_ready = 1;
+}
+
+int top_collector_scan(top_collector_t *c) {
+    /* um único instante para o tick inteiro: taxas e quadro usam o mesmo t0 */
+    double t0 = mono_now();
+    double wall = (double)time(NULL);
+    scan_job_t job = { c, -1, NULL, NULL, 0, c->last_scan > 0.0 ? t0 - c->last_scan : 0.0,
+                       sysconf(_SC_CLK_TCK), sysconf(_SC_PAGESIZE) / 1024 };
+    if (!c->io_ready) io_setup(c);
+
+    DIR *d = opendir(c->proc_root ? c->proc_root : "/proc");
+    if (!d) {
+        perror("Erro ao abrir /proc");
+        return -1;
+    }
+    job.dfd = dirfd(d);
+
+    size_t cap = c->nprocs + 64, n = 0;
+    pid_t *pids = malloc(cap * sizeof(*pids));
+    struct dirent *de;
+    while (pids && (de = readdir(d))) {
+        if (!isdigit((unsigned char)de->d_name[0])) continue;
+        if (n == cap) {
+            cap *= 2;
+            pid_t *g = realloc(pids, cap * sizeof(*pids));
+            if (!g) break;
+            pids = g;
+        }
+        pids[n++] = (pid_t)atoi(de->d_name);
+    }
+    top_proc_t *np = pids ? malloc((n ? n : 1) * sizeof(*np)) : NULL;
+    unsigned char *fresh = np ? malloc(n ? n : 1) : NULL;
+    unsigned char *carried = fresh ? calloc(c->nprocs ? c->nprocs : 1, 1) : NULL;
+    if (c->buf_cap < n && carried) {
+        char *nb = realloc(c->statbuf, n * TOP_STAT_BUF);
+        batchread_req_t *nr = nb ? realloc(c->reqs, n * sizeof(*nr)) : NULL;
+        if (nb) c->statbuf = nb;
+        if (nr) {
+            c->reqs = nr;
+            c->buf_cap = n;
+        }
+    }
+    if (!carried || c->buf_cap < n) {
+        free(carried);
+        free(fresh);
+        free(np);
+        free(pids);
+        closedir(d);
+        return -1;
+    }
+    qsort(pids, n, sizeof(*pids), pid_cmp);
+
+    /* herda estado e descritor de quem já existia; abre stat só para PIDs novos */
+    for (size_t i = 0; i < n; i++) {
+        top_proc_t *old = find_proc(c, pids[i]);
+        if (old) {
+            np[i] = *old;
+            carried[old - c->procs] = 1;
+            fresh[i] = 0;
+        } else {
+            memset(&np[i], 0, sizeof(np[i]));
+            np[i].row.pid = pids[i];
+            np[i].stat_fd = open_stat(job.dfd, pids[i]);
+            fresh[i] = 1;
+        }
+    }
+    for (size_t i = 0; i < c->nprocs; i++)
+        if (!carried[i] && c->procs[i].stat_fd >= 0) close(c->procs[i].stat_fd);
+    free(carried);
+    free(pids);
+    job.out = np;
+    job.fresh = fresh;
+
+    /* io_uring: todas as leituras de stat do tick num lote só */
+    if (c->io.backend == BATCHREAD_URING) {
+        for (size_t i = 0; i < n; i++) {
+            batchread_req_t *rq = &c->reqs[i];
+            rq->fd = np[i].stat_fd;
+            rq->buf = c->statbuf + i * TOP_STAT_BUF;
+            rq->size = TOP_STAT_BUF;
+            rq->result = -1;
+        }
+        batchread_run(&c->io, c->reqs, n);
+        job.batched = 1;
+    }
+
+    /* pool só com muitos alvos (ou se pedido explicitamente) */
+    if (!c->pool_ready && c->workers != 1 && (c->workers > 1 || n >= TOP_POOL_MIN_TARGETS)) {
+        if (workpool_init(&c->pool, c->workers) == 0) c->pool_ready = 1;
+        else c->workers = 1;
+    }
+    size_t steals = 0;
+    int nworkers = 1;
+    if (c->pool_ready) {
+        workpool_run(&c->pool, n, scan_one, &job);     // retorna após a barreira do tick
+        steals = atomic_load(&c->pool.steals);
+        nworkers = c->pool.nworkers;
+    } else {
+        for (size_t i = 0; i < n; i++) scan_one(&job, i);
+    }
+    closedir(d);
+    free(fresh);
+
+    /* processos que sumiram ficam de fora do novo array */
+    size_t live = 0;
+    for (size_t i = 0; i < n; i++)
+        if (np[i].row.pid != 0) np[live++] = np[i];
+    n = live;
+    qsort(np, n, sizeof(*np), proc_cmp);
+    free(c->procs);
+    c->procs = np;
+    c->nprocs = n;
+    c->last_scan = t0;
+
+    /* rede: uma leitura por namespace; os demais membros reusam a do tick */
+    netns_cache_begin(&c->net);
+    for (size_t i = 0; i < n; i++) {
+        net_rates_t nr;
+        top_row_t *r = &np[i].row;
+        if (netns_cache_read(&c->net, r->pid, r->netns, NULL, &nr) == 0) {
+            r->net_rx_per_s = nr.rx_bytes_per_s;
+            r->net_tx_per_s = nr.tx_bytes_per_s;
+        } else {
+            r->net_rx_per_s = r->net_tx_per_s = 0.0;
+        }
+    }
+
+    pthread_mutex_lock(&c->lock);
+    top_frame_t *f = &c->published;
+    int rc = 0;
+    if (f->cap < n) {
+        top_row_t *rows = realloc(f->rows, n * sizeof(*rows));
+        if (rows) {
+            f->rows = rows;
+            f->cap = n;
+        } else {
+            rc = -1;
+        }
+    }
+    if (rc == 0) {
+        f->cpu_total = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            f->rows[i] = np[i].row;
+            f->cpu_total += np[i].row.cpu_percent;
+        }
+        f->count = n;
+        f->timestamp = wall;
+        f->scan_ms = (mono_now() - t0) * 1e3;
+        f->workers = nworkers;
+        f->steals = steals;
+        f->io_backend = batchread_backend_name(&c->io);
+        f->io_syscalls = job.batched ? c->io.syscalls : n;
+        f->net_reads = c->net.reads;
+        f->generation++;
+    }
+    pthread_mutex_unlock(&c->lock);
+    return rc;
+}
+
+static void *collector_thread(void *arg) {
+    top_collector_t *c = arg;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (!atomic_load(&c->stop)) {
+        top_collector_scan(c);
+
+        next.tv_sec += c->interval_ms / 1000;
+        next.tv_nsec += (c->interval_ms % 1000) * 1000000L;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        pthread_mutex_lock(&c->lock);
+        while (!atomic_load(&c->stop)) {
+            if (pthread_cond_timedwait(&c->wake, &c->lock, &next) == ETIMEDOUT) break;
+        }
+        pthread_mutex_unlock(&c->lock);
+    }
+    return NULL;
+}
+
+int top_collector_start(top_collector_t *c) {
+    /* SIGINT fica com a thread da interface */
+    sigset_t block, old;
+    sigemptyset(&block);
+    sigaddset(&block, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+    int rc = pthread_create(&c->thread, NULL, collector_thread, c);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (rc != 0) {
+        fprintf(stderr, "Erro ao criar thread coletora: %s\n", strerror(rc));
+        return -1;
+    }
+    c->started = 1;
+    return 0;
+}
+
+int top_snapshot(top_collector_t *c, top_frame_t *out) {
+    int rc = 0;
+    pthread_mutex_lock(&c->lock);
+    const top_frame_t *f = &c->published;
+    if (f->generation != out->generation) {
+        if (out->cap < f->count) {
+            top_row_t *rows = realloc(out->rows, f->count * sizeof(*rows));
+            if (!rows) {
+                pthread_mutex_unlock(&c->lock);
+                return -1;
+            }
+            out->rows = rows;
+            out->cap = f->count;
+        }
+        if (f->count) memcpy(out->rows, f->rows, f->count * sizeof(*f->rows));
+        out->count = f->count;
+        out->timestamp = f->timestamp;
+        out->generation = f->generation;
+        out->cpu_total = f->cpu_total;
+        out->scan_ms = f->scan_ms;
+        out->workers = f->workers;
+        out->steals = f->steals;
+        out->io_backend = f->io_backend;
+        out->io_syscalls = f->io_syscalls;
+        out->net_reads = f->net_reads;
+        rc = 1;
+    }
+    pthread_mutex_unlock(&c->lock);
+    return rc;
+}
+
+void top_frame_free(top_frame_t *f) {
+    free(f->rows);
+    memset(f, 0, sizeof(*f));
+}
+
+void top_collector_free(top_collector_t *c) {
+    if (c->started) {
+        pthread_mutex_lock(&c->lock);
+        atomic_store(&c->stop, 1);
+        pthread_cond_signal(&c->wake);
+        pthread_mutex_unlock(&c->lock);
+        pthread_join(c->thread, NULL);
+    }
+    if (c->pool_ready) workpool_free(&c->pool);
+    if (c->io_ready) batchread_free(&c->io);
+    for (size_t i = 0; i < c->nprocs; i++)
+        if (c->procs[i].stat_fd >= 0) close(c->procs[i].stat_fd);
+    free(c->statbuf);
+    free(c->reqs);
+    netns_cache_free(&c->net);
+    pthread_cond_destroy(&c->wake);
+    pthread_mutex_destroy(&c->lock);
+    top_frame_free(&c->published);
+    free(c->procs);
+    memset(c, 0, sizeof(*c));
+}
+
+/* ===================== VISÃO ====================== */
+
+void top_view_default(top_view_t *v) {
+    memset(v, 0, sizeof(*v));
+    v->sort = TOP_SORT_CPU;
+}
+
+static int cmp_num(double a, double b) { return (a > b) - (a < b); }
+
+/* ordem da coluna: maiores primeiro para CPU/memória/threads, menores para PID/nome */
+static int row_order(const top_view_t *v, const top_row_t *a, const top_row_t *b) {
+    int c;
+    switch (v->sort) {
+        case TOP_SORT_MEM:     c = -cmp_num((double)a->rss_kb, (double)b->rss_kb); break;
+        case TOP_SORT_THREADS: c = -cmp_num(a->threads, b->threads); break;
+        case TOP_SORT_NAME:    c = strcasecmp(a->comm, b->comm); break;
+        case TOP_SORT_PID:     c = 0; break;
+        case TOP_SORT_CPU:
+        default:               c = -cmp_num(a->cpu_percent, b->cpu_percent); break;
+    }
+    if (c == 0) c = cmp_num(a->pid, b->pid);
+    return v->reverse ? -c : c;
+}
+
+static int group_order(const top_view_t *v, const top_row_t *a, const top_row_t *b) {
+    if (v->group == TOP_GROUP_CGROUP) return strcmp(a->cgroup, b->cgroup);
+    if (v->group == TOP_GROUP_PIDNS) return cmp_num((double)a->pidns, (double)b->pidns);
+    if (v->group == TOP_GROUP_NETNS) return cmp_num((double)a->netns, (double)b->netns);
+    return 0;
+}
+
+static int cand_cmp(const void *a, const void *b, void *ctx) {
+    const top_view_t *v = ctx;
+    const top_row_t *x = *(const top_row_t *const *)a, *y = *(const top_row_t *const *)b;
+    int g = group_order(v, x, y);
+    return g ? g : row_order(v, x, y);
+}
+
+typedef struct {
+    size_t start, len;
+    double cpu;
+    unsigned long rss_kb;
+    int threads;
+    pid_t min_pid;
+} view_group_t;
+
+static int group_cmp(const void *a, const void *b, void *ctx) {
+    const top_view_t *v = ctx;
+    const view_group_t *x = a, *y = b;
+    int c;
+    switch (v->sort) {
+        case TOP_SORT_MEM:     c = -cmp_num((double)x->rss_kb, (double)y->rss_kb); break;
+        case TOP_SORT_THREADS: c = -cmp_num(x->threads, y->threads); break;
+        case TOP_SORT_PID:
+        case TOP_SORT_NAME:    c = cmp_num(x->min_pid, y->min_pid); break;
+        case TOP_SORT_CPU:
+        default:               c = -cmp_num(x->cpu, y->cpu); break;
+    }
+    return v->reverse ? -c : c;
+}
+
+static int row_visible(const top_view_t *v, const top_row_t *r) {
+    if (v->hide_idle && r->cpu_percent < 0.05) return 0;
+    if (v->filter[0] && !strcasestr(r->comm, v->filter) && !strcasestr(r->cgroup, v->filter))
+        return 0;
+    return 1;
+}
+
+static void group_key(const top_view_t *v, const top_row_t *r, char *out, size_t size) {
+    if (v->group == TOP_GROUP_PIDNS)
+        snprintf(out, size, "pidns:%lu", r->pidns);
+    else if (v->group == TOP_GROUP_NETNS)
+        snprintf(out, size, "netns:%lu", r->netns);
+    else
+        snprintf(out, size, "%s", r->cgroup);
+}
+
+size_t top_view_build(const top_view_t *v, const top_frame_t *f, top_line_t *out, size_t max) {
+    if (max == 0 || f->count == 0) return 0;
+    const top_row_t **cand = malloc(f->count * sizeof(*cand));
+    if (!cand) return 0;
+    size_t nc = 0;
+    for (size_t i = 0; i < f->count; i++)
+        if (row_visible(v, &f->rows[i])) cand[nc++] = &f->rows[i];
+    qsort_r(cand, nc, sizeof(*cand), cand_cmp, (void *)v);
+
+    size_t n = 0;
+    if (v->group == TOP_GROUP_NONE) {
+        for (size_t i = 0; i < nc && n < max; i++, n++) {
+            memset(&out[n], 0, sizeof(out[n]));
+            out[n].row = cand[i];
+            out[n].cpu_percent = cand[i]->cpu_percent;
+            out[n].rss_kb = cand[i]->rss_kb;
+            out[n].nprocs = 1;
+        }
+        free(cand);
+        return n;
+    }
+
+    /* candidatos já estão contíguos por grupo: agrega cada sequência */
+    view_group_t *groups = malloc((nc ? nc : 1) * sizeof(*groups));
+    if (!groups) {
+        free(cand);
+        return 0;
+    }
+    size_t ng = 0;
+    for (size_t i = 0; i < nc; i++) {
+        if (i == 0 || group_order(v, cand[i - 1], cand[i]) != 0) {
+            memset(&groups[ng], 0, sizeof(groups[ng]));
+            groups[ng].start = i;
+            groups[ng].min_pid = cand[i]->pid;
+            ng++;
+        }
+        view_group_t *g = &groups[ng - 1];
+        g->len++;
+        g->cpu += cand[i]->cpu_percent;
+        g->rss_kb += cand[i]->rss_kb;
+        g->threads += cand[i]->threads;
+        if (cand[i]->pid < g->min_pid) g->min_pid = cand[i]->pid;
+    }
+    qsort_r(groups, ng, sizeof(*groups), group_cmp, (void *)v);
+
+    for (size_t gi = 0; gi < ng && n < max; gi++) {
+        const view_group_t *g = &groups[gi];
+        top_line_t *h = &out[n++];
+        memset(h, 0, sizeof(*h));
+        h->is_group = 1;
+        group_key(v, cand[g->start], h->key, sizeof(h->key));
+        h->cpu_percent = g->cpu;
+        h->rss_kb = g->rss_kb;
+        h->nprocs = (int)g->len;
+        if (v->group == TOP_GROUP_NETNS) {
+            /* tráfego do namespace: o mesmo em todas as linhas, não se soma */
+            h->has_net = 1;
+            h->net_rx_per_s = cand[g->start]->net_rx_per_s;
+            h->net_tx_per_s = cand[g->start]->net_tx_per_s;
+        }
+        for (size_t i = g->start; i < g->start + g->len && n < max; i++, n++) {
+            memset(&out[n], 0, sizeof(out[n]));
+            out[n].row = cand[i];
+            out[n].cpu_percent = cand[i]->cpu_percent;
+            out[n].rss_kb = cand[i]->rss_kb;
+            out[n].nprocs = 1;
+        }
+    }
+    free(groups);
+    free(cand);
+    return n;
+}
+
+/* ===================== FORMATAÇÃO ====================== */
+
+#define TOP_PREFIX_COLS 41      // colunas fixas antes do histórico
+
+static const char *k_spark[8] = { "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█" };
+
+/* acrescenta texto sem passar de width colunas (bytes de continuação UTF-8 não contam) */
+static void put_cols(char *buf, size_t size, size_t *len, int *cols, int width, const char *s) {
+    while (*s && *len + 1 < size) {
+        int cont = ((unsigned char)*s & 0xC0) == 0x80;
+        if (!cont && *cols >= width) break;
+        buf[(*len)++] = *s++;
+        if (!cont) (*cols)++;
+    }
+    buf[*len] = '\0';
+}
+
+void top_format_header(char *buf, size_t size, int width) {
+    size_t len = 0;
+    int cols = 0;
+    buf[0] = '\0';
+    put_cols(buf, size, &len, &cols, width, "    PID S    CPU%   RSS(MB)  THR  FLT/s  ");
+    if (width >= TOP_PREFIX_COLS + TOP_SPARK_LEN + 2)
+        put_cols(buf, size, &len, &cols, width, "CPU (histórico)   ");
+    put_cols(buf, size, &len, &cols, width, "COMANDO");
+}
+
+void top_format_line(const top_line_t *l, char *buf, size_t size, int width) {
+    char tmp[256];
+    size_t len = 0;
+    int cols = 0;
+    buf[0] = '\0';
+
+    if (l->is_group) {
+        snprintf(tmp, sizeof(tmp), "%6dp + %7.1f %9.1f              ",
+                 l->nprocs, l->cpu_percent, l->rss_kb / 1024.0);
+        put_cols(buf, size, &len, &cols, width, tmp);
+        put_cols(buf, size, &len, &cols, width, "[");
+        put_cols(buf, size, &len, &cols, width, l->key);
+        put_cols(buf, size, &len, &cols, width, "]");
+        if (l->has_net) {
+            snprintf(tmp, sizeof(tmp), "  rx %.1f KB/s  tx %.1f KB/s",
+                     l->net_rx_per_s / 1024.0, l->net_tx_per_s / 1024.0);
+            put_cols(buf, size, &len, &cols, width, tmp);
+        }
+        return;
+    }
+
+    const top_row_t *r = l->row;
+    snprintf(tmp, sizeof(tmp), "%7d %c %7.1f %9.1f %4d %6.0f  ",
+             (int)r->pid, r->state ? r->state : '?', r->cpu_percent, r->rss_kb / 1024.0,
+             r->threads, r->minflt_per_s + r->majflt_per_s);
+    put_cols(buf, size, &len, &cols, width, tmp);
+
+    /* histórico: escala do próprio processo, no mínimo um núcleo */
+    if (width >= TOP_PREFIX_COLS + TOP_SPARK_LEN + 2) {
+        float peak = 100.0f;
+        for (int i = 0; i < TOP_SPARK_LEN; i++)
+            if (r->spark[i] > peak) peak = r->spark[i];
+        for (int i = 0; i < TOP_SPARK_LEN && len + 4 < size; i++) {
+            const char *g = " ";
+            if (r->spark[i] >= 0.05f) {
+                int lvl = (int)(r->spark[i] / peak * 7.999f);
+                g = k_spark[lvl < 0 ? 0 : lvl > 7 ? 7 : lvl];
+            }
+            size_t gl = strlen(g);
+            memcpy(buf + len, g, gl);
+            len += gl;
+            cols++;
+        }
+        buf[len] = '\0';
+        put_cols(buf, size, &len, &cols, width, "  ");
+    }
+    put_cols(buf, size, &len, &cols, width, r->comm);
+}
+
+/* ===================== EXECUÇÃO ====================== */
+
+static volatile sig_atomic_t g_top_quit = 0;
+static void top_sigint(int sig __attribute__((unused))) { g_top_quit = 1; }
+
+#ifdef USE_NCURSES
+
+static const char *sort_name(top_sort_t s) {
+    static const char *names[] = { "cpu", "mem", "pid", "threads", "nome" };
+    return names[s];
+}
+
+static const char *group_name(top_group_t g) {
+    static const char *names[] = { "nenhum", "cgroup", "pidns", "netns" };
+    return names[g];
+}
+
+/* aplica uma tecla à visão; retorna 1 se algo mudou, -1 para sair */
+static int handle_key(int ch, top_view_t *v, int *scroll, int page, int *editing) {
+    if (*editing) {
+        size_t n = strlen(v->filter);
+        if (ch == '\n' || ch == KEY_ENTER || ch == 27) *editing = 0;
+        else if ((ch == KEY_BACKSPACE || ch == 127 || ch == 8) && n > 0) v->filter[n - 1] = '\0';
+        else if (isprint(ch) && n + 1 < sizeof(v->filter)) {
+            v->filter[n] = (char)ch;
+            v->filter[n + 1] = '\0';
+        }
+        *scroll = 0;
+        return 1;
+    }
+    switch (ch) {
+        case 'q': case 'Q': return -1;
+        case 'c': v->sort = TOP_SORT_CPU; break;
+        case 'm': v->sort = TOP_SORT_MEM; break;
+        case 'p': v->sort = TOP_SORT_PID; break;
+        case 't': v->sort = TOP_SORT_THREADS; break;
+        case 'n': v->sort = TOP_SORT_NAME; break;
+        case 'r': v->reverse = !v->reverse; break;
+        case 'g': v->group = (top_group_t)((v->group + 1) % 4); break;
+        case 'i': v->hide_idle = !v->hide_idle; break;
+        case '/': *editing = 1; break;
+        case KEY_UP: if (*scroll > 0) (*scroll)--; break;
+        case KEY_DOWN: (*scroll)++; break;
+        case KEY_PPAGE: *scroll = *scroll > page ? *scroll - page : 0; break;
+        case KEY_NPAGE: *scroll += page; break;
+        case KEY_HOME: *scroll = 0; break;
+        case KEY_RESIZE: break;
+        default: return 0;
+    }
+    return 1;
+}
+
+/*
+ * Redesenho incremental: guarda o texto de cada linha da tela e só
+ * reescreve as que mudaram (nunca clear()); o ncurses ainda compara
+ * célula a célula antes de enviar ao terminal.
+ */
+static int run_curses(top_collector_t *c) {
+    setlocale(LC_ALL, "");
+    initscr();
+    cbreak();
+    noecho();
+    keypad(stdscr, TRUE);
+    curs_set(0);
+    timeout(100);
+
+    top_view_t view;
+    top_view_default(&view);
+    top_frame_t frame = {0};
+    top_line_t *lines = NULL;
+    size_t lines_cap = 0;
+    char **shadow = NULL;
+    int shadow_rows = 0, shadow_cols = 0;
+    int scroll = 0, editing = 0, dirty = 1;
+    const size_t line_bytes = 1024;
+
+    while (!g_top_quit) {
+        int ch = getch();
+        if (ch != ERR) {
+            int k = handle_key(ch, &view, &scroll, LINES - 3, &editing);
+            if (k < 0) break;
+            if (k > 0) dirty = 1;
+        }
+        int snap = top_snapshot(c, &frame);
+        if (snap < 0) break;
+        if (snap > 0) dirty = 1;
+        if (!dirty) continue;
+        dirty = 0;
+
+        if (LINES != shadow_rows || COLS != shadow_cols) {
+            for (int i = 0; i < shadow_rows; i++) free(shadow[i]);
+            free(shadow);
+            shadow_rows = LINES;
+            shadow_cols = COLS;
+            shadow = calloc((size_t)shadow_rows, sizeof(*shadow));
+            for (int i = 0; shadow && i < shadow_rows; i++) shadow[i] = calloc(1, line_bytes);
+            erase();
+        }
+        if (!shadow) break;
+
+        size_t want = frame.count * 2 + 1;
+        if (lines_cap < want) {
+            top_line_t *nl = realloc(lines, want * sizeof(*lines));
+            if (!nl) break;
+            lines = nl;
+            lines_cap = want;
+        }
+        size_t nl = top_view_build(&view, &frame, lines, lines_cap);
+        int body = LINES - 3;
+        if (body < 1) body = 1;
+        if (scroll > (int)nl - body) scroll = (int)nl - body > 0 ? (int)nl - body : 0;
+
+        char text[1024];
+        for (int row = 0; row < LINES; row++) {
+            int attr = 0;
+            if (row == 0) {
+                char when[16];
+                time_t t = (time_t)frame.timestamp;
+                strftime(when, sizeof(when), "%H:%M:%S", localtime(&t));
+                snprintf(text, sizeof(text),
+                         "resource_monitor --top  %s  procs %zu  CPU %.1f%%  varredura %.1f ms/%d thr/%s %zu sc  "
+                         "netns %zu  ordem %s%s  grupo %s%s%s%s",
+                         when, frame.count, frame.cpu_total, frame.scan_ms, frame.workers,
+                         frame.io_backend, frame.io_syscalls, frame.net_reads,
+                         sort_name(view.sort), view.reverse ? " (inv)" : "", group_name(view.group),
+                         view.hide_idle ? "  ocultando ociosos" : "",
+                         view.filter[0] || editing ? "  filtro: " : "", view.filter);
+                if (editing) strncat(text, "_", sizeof(text) - strlen(text) - 1);
+            } else if (row == 1) {
+                top_format_header(text, sizeof(text), COLS);
+                attr = A_REVERSE;
+            } else if (row == LINES - 1) {
+                snprintf(text, sizeof(text),
+                         "q sair  c/m/p/t/n ordenar  r inverter  g agrupar  / filtrar  i ociosos  setas rolar");
+            } else {
+                size_t li = (size_t)(scroll + row - 2);
+                if (li < nl) {
+                    top_format_line(&lines[li], text, sizeof(text), COLS);
+                    if (lines[li].is_group) attr = A_BOLD;
+                } else {
+                    text[0] = '\0';
+                }
+            }
+            /* o atributo entra na comparação para a linha mudar de estilo junto */
+            char key[1024];
+            snprintf(key, sizeof(key), "%c%s", attr == A_BOLD ? 'b' : attr ? 'r' : ' ', text);
+            if (strcmp(shadow[row], key) == 0) continue;
+            snprintf(shadow[row], line_bytes, "%s", key);
+            if (attr) attron(attr);
+            mvaddnstr(row, 0, text, (int)sizeof(text));
+            clrtoeol();
+            if (attr) attroff(attr);
+        }
+        wnoutrefresh(stdscr);
+        doupdate();
+    }
+
+    endwin();
+    for (int i = 0; i < shadow_rows; i++) free(shadow[i]);
+    free(shadow);
+    free(lines);
+    top_frame_free(&frame);
+    return 0;
+}
+
+#else
+
+/* sem ncurses: a cada quadro, as linhas mais ativas (como top -b) */
+#define TOP_BATCH_ROWS 25
+
+static int run_batch(top_collector_t *c) {
+    top_view_t view;
+    top_view_default(&view);
+    top_frame_t frame = {0};
+    top_line_t lines[TOP_BATCH_ROWS];
+    char text[1024];
+    const struct timespec nap = { 0, 100 * 1000000L };
+
+    while (!g_top_quit) {
+        int snap = top_snapshot(c, &frame);
+        if (snap < 0) break;
+        if (snap == 0) {
+            nanosleep(&nap, NULL);
+            continue;
+        }
+        size_t nl = top_view_build(&view, &frame, lines, TOP_BATCH_ROWS);
+        printf("\n[%.0f] procs %zu  CPU %.1f%%  varredura %.1f ms (%d threads, %zu roubos, %s: %zu syscalls de leitura, "
+               "%zu netns lidos)\n",
+               frame.timestamp, frame.count, frame.cpu_total, frame.scan_ms, frame.workers, frame.steals,
+               frame.io_backend, frame.io_syscalls, frame.net_reads);
+        top_format_header(text, sizeof(text), 120);
+        printf("%s\n", text);
+        for (size_t i = 0; i < nl; i++) {
+            top_format_line(&lines[i], text, sizeof(text), 120);
+            printf("%s\n", text);
+        }
+        fflush(stdout);
+    }
+    top_frame_free(&frame);
+    return 0;
+}
+
+#endif
+
+int top_run(double interval_s, int workers, int io_backend, const char *proc_root) {
+    top_collector_t c;
+    long ms = (long)(interval_s * 1000.0);
+    if (top_collector_init(&c, ms) != 0) return -1;
+    c.workers = workers;
+    c.io_backend = io_backend;
+    c.proc_root = proc_root;
+
+    g_top_quit = 0;
+    signal(SIGINT, top_sigint);
+    if (top_collector_start(&c) != 0) {
+        top_collector_free(&c);
+        return -1;
+    }
+#ifdef USE_NCURSES
+    int rc = run_curses(&c);
+#else
+    int rc = run_batch(&c);
+#endif
+    top_collector_free(&c);
+    return rc;
+}
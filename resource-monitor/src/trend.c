@@ -0,0 +1,108 @@
+/*
+ * src/trend.c
+ *
+ * Regressão online (mínimos quadrados exponenciais + Theil–Sen) para prever
+ * quando a memória de um alvo atinge o limite.
+ */
+
+#include "trend.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define TREND_MIN_POINTS 3
+#define TREND_MIN_ROBUST 8
+
+void trend_init(trend_t *tr, double half_life_s) {
+    memset(tr, 0, sizeof(*tr));
+    tr->half_life_s = half_life_s > 0.0 ? half_life_s : 120.0;
+    tr->step_s = 2.0 * tr->half_life_s / TREND_WINDOW;
+}
+
+void trend_add(trend_t *tr, double t, double y) {
+    if (isnan(y)) return;
+    if (tr->n == 0) {
+        tr->t0 = t;
+    } else {
+        if (t <= tr->last_t) return;
+        double decay = exp(-M_LN2 * (t - tr->last_t) / tr->half_life_s);
+        tr->sw *= decay;
+        tr->swt *= decay;
+        tr->swy *= decay;
+        tr->swtt *= decay;
+        tr->swty *= decay;
+    }
+
+    double x = t - tr->t0;
+    tr->sw += 1.0;
+    tr->swt += x;
+    tr->swy += y;
+    tr->swtt += x * x;
+    tr->swty += x * y;
+
+    /* janela robusta: um ponto a cada step_s */
+    int prev = (tr->whead + TREND_WINDOW - 1) % TREND_WINDOW;
+    if (tr->wn == 0 || x - tr->wt[prev] >= tr->step_s) {
+        tr->wt[tr->whead] = x;
+        tr->wy[tr->whead] = y;
+        tr->whead = (tr->whead + 1) % TREND_WINDOW;
+        if (tr->wn < TREND_WINDOW) tr->wn++;
+    }
+
+    tr->last_t = t;
+    tr->last_y = y;
+    tr->n++;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double median(double *v, int n) {
+    qsort(v, (size_t)n, sizeof(double), cmp_double);
+    return (n % 2) ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+}
+
+int trend_estimate(const trend_t *tr, trend_estimate_t *est) {
+    if (tr->n < TREND_MIN_POINTS) return -1;
+
+    double den = tr->sw * tr->swtt - tr->swt * tr->swt;
+    if (den <= 0.0) return -1;
+    double x_last = tr->last_t - tr->t0;
+    est->slope_ls = (tr->sw * tr->swty - tr->swt * tr->swy) / den;
+    double tbar = tr->swt / tr->sw, ybar = tr->swy / tr->sw;
+    double level_ls = ybar + est->slope_ls * (x_last - tbar);
+
+    est->slope_robust = NAN;
+    est->slope = est->slope_ls;
+    est->level = level_ls;
+    est->t = tr->last_t;
+
+    if (tr->wn >= TREND_MIN_ROBUST) {
+        double slopes[TREND_WINDOW * (TREND_WINDOW - 1) / 2];
+        double resid[TREND_WINDOW + 1];
+        int ns = 0;
+        for (int i = 0; i < tr->wn; i++)
+            for (int j = i + 1; j < tr->wn; j++) {
+                double dt = tr->wt[j] - tr->wt[i];
+                if (dt != 0.0) slopes[ns++] = (tr->wy[j] - tr->wy[i]) / dt;
+            }
+        if (ns > 0) {
+            double s = median(slopes, ns);
+            /* nível: mediana dos resíduos (inclui o ponto mais recente) */
+            for (int i = 0; i < tr->wn; i++) resid[i] = tr->wy[i] - s * tr->wt[i];
+            resid[tr->wn] = tr->last_y - s * x_last;
+            est->slope_robust = s;
+            est->slope = s;
+            est->level = median(resid, tr->wn + 1) + s * x_last;
+        }
+    }
+    return 0;
+}
+
+double trend_time_to(const trend_estimate_t *est, double limit) {
+    if (est->level >= limit) return 0.0;
+    if (!(est->slope > 0.0)) return INFINITY;
+    return (limit - est->level) / est->slope;
+}
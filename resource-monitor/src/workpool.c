@@ -0,0 +1,191 @@
+/*
+ * src/workpool.c
+ *
+ * Pool de coleta com uma deque por worker e roubo de trabalho.
+ */
+
+#define _GNU_SOURCE
+#include "workpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+
+static int pop_own(workpool_deque_t *d, size_t *idx) {
+    int ok = 0;
+    pthread_mutex_lock(&d->lock);
+    if (d->lo < d->hi) {
+        *idx = d->lo++;
+        ok = 1;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return ok;
+}
+
+/* rouba a metade de trás de outra deque para a própria; 0 se todas vazias */
+static int steal(workpool_t *p, int self, unsigned *seed) {
+    int n = p->nworkers;
+    int first = (int)(rand_r(seed) % (unsigned)n);
+    for (int k = 0; k < n; k++) {
+        int v = (first + k) % n;
+        if (v == self) continue;
+        workpool_deque_t *d = &p->deques[v];
+        size_t lo = 0, hi = 0;
+        pthread_mutex_lock(&d->lock);
+        if (d->lo < d->hi) {
+            hi = d->hi;
+            lo = d->hi - (d->hi - d->lo + 1) / 2;
+            d->hi = lo;
+        }
+        pthread_mutex_unlock(&d->lock);
+        if (lo < hi) {
+            workpool_deque_t *own = &p->deques[self];
+            pthread_mutex_lock(&own->lock);
+            own->lo = lo;
+            own->hi = hi;
+            pthread_mutex_unlock(&own->lock);
+            atomic_fetch_add(&p->steals, 1);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+typedef struct {
+    workpool_t *pool;
+    int id;
+} worker_arg_t;
+
+static void *worker(void *arg) {
+    worker_arg_t *wa = arg;
+    workpool_t *p = wa->pool;
+    int id = wa->id;
+    free(wa);
+    unsigned seed = (unsigned)id * 2654435761u + 1;
+    unsigned long seen = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&p->lock);
+        while (!p->quit && p->tick == seen) pthread_cond_wait(&p->start, &p->lock);
+        if (p->quit) {
+            pthread_mutex_unlock(&p->lock);
+            break;
+        }
+        seen = p->tick;
+        workpool_fn fn = p->fn;
+        void *ctx = p->ctx;
+        pthread_mutex_unlock(&p->lock);
+
+        /* tarefas em andamento noutros workers não voltam para as deques:
+           com todas vazias, não há mais nada a pegar neste tick */
+        size_t idx;
+        for (;;) {
+            if (pop_own(&p->deques[id], &idx)) fn(ctx, idx);
+            else if (!steal(p, id, &seed)) break;
+        }
+
+        pthread_mutex_lock(&p->lock);
+        if (--p->active == 0) pthread_cond_signal(&p->done);
+        pthread_mutex_unlock(&p->lock);
+    }
+    return NULL;
+}
+
+int workpool_init(workpool_t *p, int nworkers) {
+    memset(p, 0, sizeof(*p));
+    if (nworkers <= 0) nworkers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (nworkers < 1) nworkers = 1;
+
+    p->threads = calloc((size_t)nworkers, sizeof(*p->threads));
+    p->deques = calloc((size_t)nworkers, sizeof(*p->deques));
+    if (!p->threads || !p->deques) {
+        free(p->threads);
+        free(p->deques);
+        return -1;
+    }
+    for (int i = 0; i < nworkers; i++) pthread_mutex_init(&p->deques[i].lock, NULL);
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->start, NULL);
+    pthread_cond_init(&p->done, NULL);
+    atomic_init(&p->steals, 0);
+
+    /* SIGINT fica com a thread principal */
+    sigset_t block, old;
+    sigemptyset(&block);
+    sigaddset(&block, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+    for (int i = 0; i < nworkers; i++) {
+        worker_arg_t *wa = malloc(sizeof(*wa));
+        int rc = wa ? 0 : -1;
+        if (wa) {
+            wa->pool = p;
+            wa->id = i;
+            rc = pthread_create(&p->threads[i], NULL, worker, wa);
+            if (rc != 0) free(wa);
+        }
+        if (rc != 0) {
+            fprintf(stderr, "Aviso: pool de coleta com %d de %d threads\n", i, nworkers);
+            break;
+        }
+        p->nworkers = i + 1;
+    }
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (p->nworkers == 0) {
+        workpool_free(p);
+        return -1;
+    }
+    return 0;
+}
+
+int workpool_run(workpool_t *p, size_t ntasks, workpool_fn fn, void *ctx) {
+    if (p->nworkers == 0) return -1;
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    atomic_store(&p->steals, 0);
+
+    /* faixas contíguas iniciais: alvos vizinhos tendem a ficar no mesmo worker */
+    size_t per = ntasks / (size_t)p->nworkers, extra = ntasks % (size_t)p->nworkers, at = 0;
+    for (int i = 0; i < p->nworkers; i++) {
+        size_t len = per + ((size_t)i < extra ? 1 : 0);
+        pthread_mutex_lock(&p->deques[i].lock);
+        p->deques[i].lo = at;
+        p->deques[i].hi = at + len;
+        pthread_mutex_unlock(&p->deques[i].lock);
+        at += len;
+    }
+
+    pthread_mutex_lock(&p->lock);
+    p->fn = fn;
+    p->ctx = ctx;
+    p->active = p->nworkers;
+    p->tick++;
+    pthread_cond_broadcast(&p->start);
+    while (p->active > 0) pthread_cond_wait(&p->done, &p->lock);
+    pthread_mutex_unlock(&p->lock);
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    p->last_run_ms = (double)(t1.tv_sec - t0.tv_sec) * 1e3 + (double)(t1.tv_nsec - t0.tv_nsec) / 1e6;
+    return 0;
+}
+
+void workpool_free(workpool_t *p) {
+    if (p->threads) {
+        pthread_mutex_lock(&p->lock);
+        p->quit = 1;
+        pthread_cond_broadcast(&p->start);
+        pthread_mutex_unlock(&p->lock);
+        for (int i = 0; i < p->nworkers; i++) pthread_join(p->threads[i], NULL);
+        pthread_cond_destroy(&p->start);
+        pthread_cond_destroy(&p->done);
+        pthread_mutex_destroy(&p->lock);
+    }
+    if (p->deques) {
+        for (int i = 0; i < p->nworkers; i++) pthread_mutex_destroy(&p->deques[i].lock);
+    }
+    free(p->threads);
+    free(p->deques);
+    memset(p, 0, sizeof(*p));
+}
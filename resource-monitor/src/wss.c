@@ -0,0 +1,261 @@
+/*
+ * src/wss.c
+ *
+ * Working set por idle page tracking (pagemap + page_idle/bitmap) ou, sem
+ * permissão para isso, por clear_refs + Referenced de smaps_rollup.
+ */
+
+#include "wss.h"
+#include "monitor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+#define PAGEMAP_PRESENT (1ULL << 63)
+#define PAGEMAP_PFN_MASK ((1ULL << 55) - 1)
+#define PAGE_IDLE_BITMAP "/sys/kernel/mm/page_idle/bitmap"
+
+int wss_method_parse(const char *name) {
+    if (strcmp(name, "auto") == 0) return WSS_AUTO;
+    if (strcmp(name, "idle") == 0) return WSS_IDLE;
+    if (strcmp(name, "refs") == 0) return WSS_REFS;
+    return -1;
+}
+
+const char *wss_method_name(wss_method_t m) {
+    switch (m) {
+    case WSS_IDLE: return "idle";
+    case WSS_REFS: return "refs";
+    default: return "auto";
+    }
+}
+
+static double now_ms(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec * 1e3 + (double)t.tv_nsec / 1e6;
+}
+
+static void sleep_s(double s) {
+    struct timespec ts = { (time_t)s, (long)((s - (double)(time_t)s) * 1e9) };
+    nanosleep(&ts, NULL);   // Ctrl+C encerra a janela mais cedo; o chamador mede a duração real
+}
+
+size_t wss_plan_runs(const uint64_t *pfns, size_t n, size_t max_words, size_t max_gap,
+                     wss_run_t *runs, size_t max_runs) {
+    size_t nr = 0;
+    for (size_t i = 0; i < n && nr < max_runs; ) {
+        uint64_t first = pfns[i] / 64, last = first;
+        for (i++; i < n; i++) {
+            uint64_t w = pfns[i] / 64;
+            if (w - last > max_gap + 1 || w - first + 1 > max_words) break;
+            last = w;
+        }
+        runs[nr].word = first;
+        runs[nr].nwords = (size_t)(last - first + 1);
+        nr++;
+    }
+    return nr;
+}
+
+/* ===================== IDLE PAGE TRACKING ====================== */
+
+typedef struct {
+    uint64_t *v;
+    size_t n, cap;
+} pfn_vec_t;
+
+static int pfn_push(pfn_vec_t *p, uint64_t pfn) {
+    if (p->n == p->cap) {
+        size_t cap = p->cap ? p->cap * 2 : 65536;
+        uint64_t *v = realloc(p->v, cap * sizeof(*v));
+        if (!v) return -1;
+        p->v = v;
+        p->cap = cap;
+    }
+    p->v[p->n++] = pfn;
+    return 0;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/*
+ * PFNs das páginas presentes do alvo, ordenados e sem repetição (a mesma
+ * página pode estar mapeada em duas VMAs). @return 0, -1 em erro (errno).
+ */
+static int collect_pfns(pid_t pid, pfn_vec_t *out, size_t *syscalls) {
+    char path[320];
+    out->n = 0;
+    snprintf(path, sizeof(path), "%s/%d/maps", monitor_proc_root(), pid);
+    FILE *maps = fopen(path, "r");
+    if (!maps) return -1;
+    snprintf(path, sizeof(path), "%s/%d/pagemap", monitor_proc_root(), pid);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fclose(maps);
+        return -1;
+    }
+
+    static uint64_t buf[WSS_PAGEMAP_BATCH];
+    unsigned long page = (unsigned long)sysconf(_SC_PAGESIZE);
+    char line[512];
+    int rc = 0, any_present = 0;
+    while (rc == 0 && fgets(line, sizeof(line), maps)) {
+        unsigned long start, end;
+        if (sscanf(line, "%lx-%lx", &start, &end) != 2) continue;
+        if (strstr(line, "[vsyscall]")) continue;   // fora do pagemap em x86-64
+        for (unsigned long vpn = start / page; vpn < end / page && rc == 0; ) {
+            size_t want = end / page - vpn;
+            if (want > WSS_PAGEMAP_BATCH) want = WSS_PAGEMAP_BATCH;
+            ssize_t got = pread(fd, buf, want * sizeof(uint64_t), (off_t)(vpn * sizeof(uint64_t)));
+            (*syscalls)++;
+            if (got <= 0) break;    // VMA desfeita durante a leitura
+            size_t ne = (size_t)got / sizeof(uint64_t);
+            for (size_t i = 0; i < ne; i++) {
+                if (!(buf[i] & PAGEMAP_PRESENT)) continue;
+                any_present = 1;
+                uint64_t pfn = buf[i] & PAGEMAP_PFN_MASK;
+                if (pfn && pfn_push(out, pfn) != 0) rc = -1;
+            }
+            vpn += ne;
+        }
+    }
+    close(fd);
+    fclose(maps);
+    if (rc != 0) return -1;
+    /* páginas presentes sem PFN: o kernel escondeu os PFNs (falta CAP_SYS_ADMIN) */
+    if (any_present && out->n == 0) {
+        errno = EPERM;
+        return -1;
+    }
+
+    qsort(out->v, out->n, sizeof(uint64_t), cmp_u64);
+    size_t u = 0;
+    for (size_t i = 0; i < out->n; i++)
+        if (u == 0 || out->v[i] != out->v[u - 1]) out->v[u++] = out->v[i];
+    out->n = u;
+    return 0;
+}
+
+/*
+ * Percorre os trechos do bitmap: com mark, grava 1 nos bits dos PFNs
+ * (escrever 0 não tem efeito); sem mark, lê e conta os PFNs cujo bit
+ * foi limpo (acessados). @return Páginas acessadas, ou -1 em erro.
+ */
+static long walk_bitmap(int fd, const pfn_vec_t *p, int mark, size_t *syscalls) {
+    static uint64_t words[WSS_BITMAP_BATCH_WORDS];
+    static wss_run_t runs[4096];
+    long active = 0;
+    size_t i = 0;
+    while (i < p->n) {
+        size_t nr = wss_plan_runs(p->v + i, p->n - i, WSS_BITMAP_BATCH_WORDS, WSS_BITMAP_MAX_GAP,
+                                  runs, sizeof(runs) / sizeof(runs[0]));
+        for (size_t r = 0; r < nr; r++) {
+            uint64_t w0 = runs[r].word;
+            size_t len = runs[r].nwords * sizeof(uint64_t);
+            off_t off = (off_t)(w0 * sizeof(uint64_t));
+            if (mark) {
+                memset(words, 0, len);
+                for (; i < p->n && p->v[i] / 64 < w0 + runs[r].nwords; i++)
+                    words[p->v[i] / 64 - w0] |= 1ULL << (p->v[i] % 64);
+                if (pwrite(fd, words, len, off) != (ssize_t)len) return -1;
+            } else {
+                if (pread(fd, words, len, off) != (ssize_t)len) return -1;
+                for (; i < p->n && p->v[i] / 64 < w0 + runs[r].nwords; i++)
+                    if (!(words[p->v[i] / 64 - w0] & (1ULL << (p->v[i] % 64)))) active++;
+            }
+            (*syscalls)++;
+        }
+    }
+    return active;
+}
+
+static int measure_idle(pid_t pid, double window_s, wss_result_t *out) {
+    int fd = open(PAGE_IDLE_BITMAP, O_RDWR | O_CLOEXEC);
+    if (fd < 0) return -1;
+    pfn_vec_t pfns = { NULL, 0, 0 };
+    int rc = -1;
+
+    double t0 = now_ms();
+    if (collect_pfns(pid, &pfns, &out->syscalls) != 0) goto done;
+    if (walk_bitmap(fd, &pfns, 1, &out->syscalls) < 0) goto done;
+    out->scan_ms = now_ms() - t0;
+
+    double w0 = now_ms();
+    sleep_s(window_s);
+    out->window_s = (now_ms() - w0) / 1e3;
+
+    /* páginas que apareceram na janela nunca foram marcadas: contam como acessadas */
+    t0 = now_ms();
+    if (collect_pfns(pid, &pfns, &out->syscalls) != 0) goto done;
+    long active = walk_bitmap(fd, &pfns, 0, &out->syscalls);
+    if (active < 0) goto done;
+    out->scan_ms += now_ms() - t0;
+
+    unsigned long page_kb = (unsigned long)sysconf(_SC_PAGESIZE) / 1024;
+    out->pages = pfns.n;
+    out->rss_kb = (unsigned long)pfns.n * page_kb;
+    out->wss_kb = (unsigned long)active * page_kb;
+    out->method = WSS_IDLE;
+    rc = 0;
+done:
+    free(pfns.v);
+    close(fd);
+    return rc;
+}
+
+/* ===================== CLEAR_REFS ====================== */
+
+static int measure_refs(pid_t pid, double window_s, wss_result_t *out) {
+    char path[320];
+    snprintf(path, sizeof(path), "%s/%d/clear_refs", monitor_proc_root(), pid);
+    double t0 = now_ms();
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "Erro ao abrir %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    if (write(fd, "1", 1) != 1) {
+        fprintf(stderr, "Erro ao limpar referências de %d: %s\n", pid, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    close(fd);
+    out->scan_ms = now_ms() - t0;
+
+    double w0 = now_ms();
+    sleep_s(window_s);
+    out->window_s = (now_ms() - w0) / 1e3;
+
+    smaps_rollup_t r;
+    t0 = now_ms();
+    if (monitor_smaps_rollup(pid, &r) != 0) {
+        fprintf(stderr, "Erro ao ler smaps_rollup de %d\n", pid);
+        return -1;
+    }
+    out->scan_ms += now_ms() - t0;
+    out->rss_kb = r.rss_kb;
+    out->wss_kb = r.referenced_kb;
+    out->method = WSS_REFS;
+    return 0;
+}
+
+int wss_measure(pid_t pid, double window_s, wss_method_t method, wss_result_t *out) {
+    memset(out, 0, sizeof(*out));
+    if (method != WSS_REFS) {
+        if (measure_idle(pid, window_s, out) == 0) return 0;
+        if (method == WSS_IDLE) {
+            fprintf(stderr, "Erro: idle page tracking indisponível para %d: %s\n", pid, strerror(errno));
+            return -1;
+        }
+        memset(out, 0, sizeof(*out));
+    }
+    return measure_refs(pid, window_s, out);
+}
@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "../include/anomaly.h"
+
+#define TICK_BUDGET_US 60000.0      // ~4x o medido (15-19 ms por tick com 43k séries, -O2)
+#define SCALE_MAX      6.0          // 4x as séries pode custar no máximo 6x (linear = 4x)
+
+typedef struct {
+    int count;
+    char last_metric[ANOMALY_METRIC_NAME_MAX];
+    double last_ts;
+} counter_t;
+
+static void on_event(const anomaly_event_t *ev, void *ctx) {
+    counter_t *c = ctx;
+    c->count++;
+    snprintf(c->last_metric, sizeof(c->last_metric), "%s", ev->metric);
+    c->last_ts = ev->timestamp;
+}
+
+/* ruído determinístico em [-1, 1] */
+static double noise(unsigned *seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    return ((*seed >> 16) & 0x7fff) / 16383.5 - 1.0;
+}
+
+/* custo médio por tick (us) de 50 ticks com 'targets' alvos; -1 em erro */
+static double tick_cost_us(size_t targets, const anomaly_metric_t *metrics, size_t nm,
+                           const anomaly_config_t *cfg, size_t *nseries) {
+    anomaly_engine_t e;
+    unsigned seed = 7;
+    if (anomaly_engine_init(&e, targets, metrics, nm, cfg) != 0) return -1.0;
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int tick = 0; tick < 50; tick++) {
+        for (size_t t = 0; t < targets; t++) {
+            double *row = anomaly_engine_row(&e, t);
+            for (size_t k = 0; k < nm; k++) row[k] = 100.0 * tick + noise(&seed);
+        }
+        anomaly_engine_tick(&e, tick, NULL, NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    *nseries = e.nseries;
+    anomaly_engine_free(&e);
+    return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / 1e3 / 50;
+}
+
+int main() {
+    int failures = 0;
+    unsigned seed = 42;
+    anomaly_config_t cfg;
+    anomaly_engine_t e;
+    printf("=== Teste: Anomalias ===\n");
+
+    // 1) série estável não alarma
+    anomaly_metric_t gauge = { "cpu_percent", ANOMALY_GAUGE };
+    anomaly_config_default(&cfg);
+    if (anomaly_engine_init(&e, 1, &gauge, 1, &cfg) != 0) {
+        printf("❌ init falhou\n");
+        return 1;
+    }
+    counter_t c = {0};
+    double ts = 0;
+    for (int i = 0; i < 60; i++, ts++) {
+        anomaly_engine_row(&e, 0)[0] = 20.0 + noise(&seed);
+        anomaly_engine_tick(&e, ts, on_event, &c);
+    }
+    if (c.count != 0) { printf("❌ falso positivo em série estável (%d)\n", c.count); failures++; }
+
+    // mudança de patamar: alarma no início e para depois que os baselines se adaptam
+    for (int i = 0; i < 200; i++, ts++) {
+        anomaly_engine_row(&e, 0)[0] = 60.0 + noise(&seed);
+        anomaly_engine_tick(&e, ts, on_event, &c);
+    }
+    if (c.count == 0 || c.last_ts > ts - 150) {
+        printf("❌ novo patamar: %d eventos, último em %.0f\n", c.count, c.last_ts);
+        failures++;
+    }
+
+    // pico isolado no novo patamar
+    c.count = 0;
+    anomaly_engine_row(&e, 0)[0] = 95.0;
+    anomaly_engine_tick(&e, ts++, on_event, &c);
+    if (c.count != 1) { printf("❌ pico não detectado (%d)\n", c.count); failures++; }
+    anomaly_engine_free(&e);
+
+    // 2) contador: tempestade de page faults aparece como taxa
+    anomaly_metric_t metrics[ANOMALY_MAX_METRICS];
+    size_t nm = anomaly_proc_metrics(metrics, ANOMALY_MAX_METRICS);
+    int idx = -1;
+    for (size_t i = 0; i < nm; i++)
+        if (strcmp(metrics[i].name, "minflt_per_s") == 0) idx = (int)i;
+    if (idx < 0) { printf("❌ minflt_per_s ausente\n"); failures++; idx = 0; }
+
+    if (anomaly_engine_init(&e, 1, metrics, nm, &cfg) != 0) { printf("❌ init proc\n"); return 1; }
+    proc_metrics_t m;
+    memset(&m, 0, sizeof(m));
+    c.count = 0;
+    for (int i = 0; i < 40; i++) {
+        m.timestamp = i;
+        m.minflt += 100 + (unsigned long)(5 * (noise(&seed) + 1.0));
+        m.rss_kb = 50000;
+        m.cpu_percent = 10.0;
+        anomaly_fill_proc(anomaly_engine_row(&e, 0), &m);
+        anomaly_engine_tick(&e, m.timestamp, on_event, &c);
+    }
+    m.timestamp = 40;
+    m.minflt += 50000;
+    anomaly_fill_proc(anomaly_engine_row(&e, 0), &m);
+    anomaly_engine_tick(&e, m.timestamp, on_event, &c);
+    if (c.count != 1 || strcmp(c.last_metric, "minflt_per_s") != 0) {
+        printf("❌ tempestade de page faults: %d eventos (%s)\n", c.count, c.last_metric);
+        failures++;
+    }
+    anomaly_engine_free(&e);
+
+    // 3) detector desconhecido é rejeitado
+    cfg.detectors = "ewma,nada";
+    if (anomaly_engine_init(&e, 1, &gauge, 1, &cfg) == 0) {
+        printf("❌ detector inválido aceito\n");
+        failures++;
+        anomaly_engine_free(&e);
+    }
+
+    // 4) custo por tick com muitas séries: cabe com folga no intervalo de 1 s
+    //    e cresce linearmente (N e 4N alvos; melhor de 3 rodadas contra ruído)
+    cfg.detectors = "ewma,mad,seasonal";
+    double small = -1.0, large = -1.0;
+    size_t ns_small = 0, ns_large = 0;
+    for (int rep = 0; rep < 3; rep++) {
+        double a = tick_cost_us(250, metrics, nm, &cfg, &ns_small);
+        double b = tick_cost_us(1000, metrics, nm, &cfg, &ns_large);
+        if (a < 0 || b < 0) { printf("❌ init grande\n"); return 1; }
+        if (small < 0 || a < small) small = a;
+        if (large < 0 || b < large) large = b;
+    }
+    printf("   %zu séries: %.1f us por tick; %zu séries: %.1f us por tick (%.1fx)\n",
+           ns_small, small, ns_large, large, large / small);
+    if (large > TICK_BUDGET_US) {
+        printf("❌ %zu séries: %.0f us por tick (limite %.0f us)\n", ns_large, large, TICK_BUDGET_US);
+        failures++;
+    }
+    if (large > SCALE_MAX * small) {
+        printf("❌ 4x as séries custou %.1fx (limite %.1fx)\n", large / small, SCALE_MAX);
+        failures++;
+    }
+
+    if (failures == 0)
+        printf("✅ Teste de anomalias concluído.\n");
+    else
+        printf("❌ Teste de anomalias falhou (%d).\n", failures);
+    return failures ? 1 : 0;
+}
@@ -1,18 +1,68 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <unistd.h>
 #include <time.h>
 #include <stdlib.h>
+#include <sched.h>
+#include <pthread.h>
 #include "../include/monitor.h"
 
 static void burn_cpu(int ms) {
-    // Gera carga para o processo atual por "ms" milissegundos
+    // Gera carga para o processo atual por "ms" milissegundos de CPU.
+    // clock() é consultado a cada bloco de iterações: chamado a cada volta,
+    // a própria syscall dominava a carga medida.
     clock_t start = clock();
-    while (1) {
-        volatile double x = 1.2345;
-        x *= 2.3456; // impede otimização
-        if (((clock() - start) * 1000 / CLOCKS_PER_SEC) >= ms)
-            break;
+    volatile double x = 1.2345;
+    do {
+        for (int i = 0; i < 100000; i++)
+            x *= 1.0000001; // impede otimização
+    } while (((clock() - start) * 1000 / CLOCKS_PER_SEC) < ms);
+}
+
+/* duas threads presas no mesmo núcleo: cada uma espera na fila enquanto a outra roda */
+static volatile int g_spin_release = 0;
+static int g_spin_done = 0;
+
+static void *spin_thread(void *arg) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(0, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    /* CPU da própria thread: clock() somaria as duas */
+    struct timespec t;
+    volatile double x = 1.2345;
+    do {
+        for (int i = 0; i < 100000; i++) x *= 1.0000001;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+    } while (t.tv_sec * 1000 + t.tv_nsec / 1000000 < *(int *)arg);
+    __atomic_add_fetch(&g_spin_done, 1, __ATOMIC_SEQ_CST);
+    /* viva até a segunda leitura: o schedstat de uma thread some quando ela termina */
+    while (!g_spin_release) usleep(1000);
+    return NULL;
+}
+
+static int test_schedstat(pid_t pid) {
+    schedstat_state_t st = {0};
+    double run_ms, wait_ms;
+    unsigned long long slices;
+    if (monitor_schedstat(pid, &st, &run_ms, &wait_ms, &slices) != 0) {
+        printf(" - schedstat indisponível, ignorado\n");
+        return 0;
     }
+    int ms = 150;
+    pthread_t th[2];
+    for (int i = 0; i < 2; i++) pthread_create(&th[i], NULL, spin_thread, &ms);
+    while (__atomic_load_n(&g_spin_done, __ATOMIC_SEQ_CST) < 2) usleep(1000);
+    int rc = monitor_schedstat(pid, &st, &run_ms, &wait_ms, &slices);
+    g_spin_release = 1;
+    for (int i = 0; i < 2; i++) pthread_join(th[i], NULL);
+    monitor_schedstat_free(&st);
+    printf(" - schedstat: %.1f ms na CPU, %.1f ms na fila, %llu fatias\n", run_ms, wait_ms, slices);
+    if (rc != 0 || run_ms < 2 * ms * 0.9 || wait_ms < ms * 0.5) {
+        printf("❌ Espera na fila de duas threads no mesmo núcleo não apareceu.\n");
+        return 1;
+    }
+    return 0;
 }
 
 int main() {
@@ -42,6 +92,12 @@ int main() {
         printf(" - CPU após carga: %.2f%%\n", cpu_percent);
     else
         printf("❌ Erro na segunda leitura.\n");
+    if (cpu_percent <= 0.0) {
+        printf("❌ Carga de 200ms não apareceu no CPU%%.\n");
+        return 1;
+    }
+
+    if (test_schedstat(pid) != 0) return 1;
 
     printf("✅ Teste de CPU concluído.\n");
     return 0;
@@ -0,0 +1,204 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../include/monitor.h"
+#include "../include/export.h"
+
+static int read_file(const char *path, char *buf, size_t size) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) return -1;
+    size_t n = fread(buf, 1, size - 1, fp);
+    buf[n] = '\0';
+    fclose(fp);
+    return 0;
+}
+
+/* csv_put_fixed contra snprintf("%.*f"): empates exatos em binário vão para o par,
+   quase-empates (1.005 é 1.00499...) seguem o valor exato, e -0.001 vira "-0.00" */
+static int test_fixed_rounding(void) {
+    static const double cases[] = {
+        0.125, 0.375, 2.5, 3.5, -2.5, 0.5, 1.5, 1.005, 2.675, 1.115, 0.285, 1234.5675,
+        -0.001, -0.0, 0.0, 99.995, 1048576.125, 4503599627370.5, 0.045, 8.345,
+    };
+    char *mem = NULL;
+    size_t memlen = 0;
+    FILE *fp = open_memstream(&mem, &memlen);
+    csv_writer_t w;
+    if (!fp || csv_writer_attach(&w, fp) != 0) return 1;
+    char want[64 * 1024] = "";
+    size_t wl = 0;
+    unsigned long long seed = 88172645463325252ULL;
+    for (int i = 0; i < 4000; i++) {
+        double v;
+        if (i < (int)(sizeof(cases) / sizeof(cases[0]))) {
+            v = cases[i];
+        } else {
+            seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+            // metades e milésimos exatos e valores quaisquer, em várias escalas
+            double base = (double)(seed % 2000000) / ((i % 3) ? 8.0 : 1000.0);
+            v = (i & 1) ? -base : base;
+        }
+        for (int d = 0; d <= 3; d++) {
+            csv_put_fixed(&w, v, d);
+            csv_put_char(&w, '\n');
+            wl += (size_t)snprintf(want + wl, sizeof(want) - wl, "%.*f\n", d, v);
+            if (wl >= sizeof(want) - 64) break;
+        }
+        if (wl >= sizeof(want) - 64) break;
+    }
+    csv_writer_close(&w);
+    fclose(fp);
+    int fail = memlen != wl || memcmp(mem, want, wl) != 0;
+    if (fail) {
+        size_t i = 0;
+        while (i < wl && i < memlen && mem[i] == want[i]) i++;
+        while (i > 0 && want[i - 1] != '\n') i--;
+        printf("❌ csv_put_fixed difere do printf: got %.20s exp %.20s\n", mem + i, want + i);
+    }
+    free(mem);
+    return fail;
+}
+
+int main() {
+    const char *path = "/tmp/rm_test_export.csv";
+    char buf[4096];
+    char expected[4096];
+    int failures = 0;
+
+    printf("=== Teste: Export CSV ===\n");
+
+    proc_metrics_t m[2];
+    memset(m, 0, sizeof(m));
+    m[0].timestamp = 1763251292.0; m[0].pid = 739; m[0].cpu_percent = 12.345;
+    m[0].rss_kb = 5120; m[0].write_bytes = 1123055344678ULL; m[0].write_bytes_per_s = 0.004;
+    m[0].task_clock_ms_per_s = 812.5; m[0].page_faults_per_s = 4096.25; m[0].ipc = 1.25;
+    m[0].cpu_run_ms_per_s = 400.0; m[0].cpu_wait_ms_per_s = 37.5; m[0].wait_per_slice_us = 250.25;
+    m[0].net_rx_bytes_per_s = 1250000.0; m[0].net_tx_bytes_per_s = 640.5; m[0].tcp_retrans_per_s = 0.25;
+    m[0].fd_count = 812; m[0].fd_sockets = 640; m[0].fd_limit = 1024; m[0].fd_growth_per_s = 2.5;
+    m[0].tcp_close_wait = 600;
+    m[1].timestamp = 1763251293.0; m[1].pid = 739; m[1].cpu_percent = 99.999;
+    m[1].rss_kb = 0;    m[1].write_bytes = 0;              m[1].write_bytes_per_s = 1048576.5;
+
+    // 1) Formatação manual deve coincidir com printf
+    if (export_set_fields("all") != 0 || export_metrics_csv(path, m, 2) != 0 || read_file(path, buf, sizeof(buf)) != 0) {
+        printf("❌ Falha ao exportar CSV completo.\n");
+        return 1;
+    }
+    char *row = strchr(buf, '\n') + 1;
+    snprintf(expected, sizeof(expected),
+        "%.0f,%d,%.2f,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,"
+        "%llu,%llu,%llu,%llu,%llu,"
+        "%.2f,%.2f,%.2f,%.2f,%.2f,"
+        "%.3f,%.2f,%.2f,%.2f,%.0f,%.0f,%.2f,%.3f,"
+        "%.2f,%.2f,%.2f,"
+        "%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,"
+        "%lu,%lu,%lu,%lu,%lu,%lu,%lu,%.2f,%lu,%lu,%lu,%lu\n",
+        m[0].timestamp, m[0].pid, m[0].cpu_percent,
+        m[0].threads, m[0].voluntary_ctxt, m[0].involuntary_ctxt,
+        m[0].rss_kb, m[0].vmsize_kb, m[0].minflt, m[0].majflt, m[0].swap_kb,
+        m[0].rchar, m[0].wchar, m[0].read_bytes, m[0].write_bytes, m[0].syscalls,
+        m[0].rchar_per_s, m[0].wchar_per_s, m[0].read_bytes_per_s,
+        m[0].write_bytes_per_s, m[0].syscalls_per_s,
+        m[0].task_clock_ms_per_s, m[0].ctx_switches_per_s, m[0].cpu_migrations_per_s,
+        m[0].page_faults_per_s, m[0].cycles_per_s, m[0].instructions_per_s, m[0].cache_misses_per_s,
+        m[0].ipc,
+        m[0].cpu_run_ms_per_s, m[0].cpu_wait_ms_per_s, m[0].wait_per_slice_us,
+        m[0].net_rx_bytes_per_s, m[0].net_tx_bytes_per_s, m[0].net_rx_packets_per_s,
+        m[0].net_tx_packets_per_s, m[0].net_drops_per_s, m[0].tcp_retrans_per_s,
+        m[0].fd_count, m[0].fd_files, m[0].fd_sockets, m[0].fd_pipes, m[0].fd_eventfds, m[0].fd_anon,
+        m[0].fd_limit, m[0].fd_growth_per_s, m[0].tcp_established, m[0].tcp_listen,
+        m[0].tcp_close_wait, m[0].tcp_other);
+    if (strncmp(row, expected, strlen(expected)) != 0) {
+        printf("❌ Linha CSV difere:\n   got: %.*s   exp: %s", (int)strlen(expected), row, expected);
+        failures++;
+    }
+
+    // 2) Projeção de colunas (--fields)
+    if (export_set_fields("cpu_percent,rss_kb,write_bytes_per_s") != 0 ||
+        export_metrics_csv(path, m, 2) != 0 || read_file(path, buf, sizeof(buf)) != 0) {
+        printf("❌ Falha ao exportar CSV projetado.\n");
+        return 1;
+    }
+    const char *want =
+        "Timestamp,PID,CPU%,RSS(kB),WriteBytes/s\n"
+        "1763251292,739,12.35,5120,0.00\n"
+        "1763251293,739,100.00,0,1048576.50\n";
+    if (strcmp(buf, want) != 0) {
+        printf("❌ CSV projetado difere:\n%s", buf);
+        failures++;
+    }
+
+    // 3) Campo inválido deve ser rejeitado
+    if (export_set_fields("cpu_percent,nao_existe") == 0) {
+        printf("❌ Campo desconhecido aceito.\n");
+        failures++;
+    }
+
+    // 3b) Padrão = colunas originais; grupos opcionais só quando pedidos
+    field_selection_t def, grp;
+    if (field_selection_parse(NULL, &def) != 0 || def.count != 21 ||
+        field_selection_parse("default,perf,tcp", &grp) != 0 || grp.count != 21 + 8 + 4 ||
+        field_selection_parse("rss_kb,fd", &grp) != 0 || grp.count != 3 + 8) {
+        printf("❌ Seleção padrão/grupos com contagem inesperada (%d, %d).\n", def.count, grp.count);
+        failures++;
+    }
+    const char *default_hdr =
+        "Timestamp,PID,CPU%,Threads,VolCtx,InvCtx,RSS(kB),VSZ(kB),MinFlt,MajFlt,Swap(kB),"
+        "RChar,WChar,ReadBytes,WriteBytes,Syscalls,RChar/s,WChar/s,ReadBytes/s,"
+        "WriteBytes/s,Syscalls/s\n";
+    if (export_set_fields(NULL) != 0 || export_metrics_csv(path, m, 2) != 0 ||
+        read_file(path, buf, sizeof(buf)) != 0 ||
+        strncmp(buf, default_hdr, strlen(default_hdr)) != 0) {
+        printf("❌ Cabeçalho padrão difere:\n%.*s\n", (int)(strchr(buf, '\n') - buf), buf);
+        failures++;
+    }
+
+    // 4) Supressão: repetições somem, heartbeat e última amostra ficam
+    proc_metrics_t idle[6];
+    memset(idle, 0, sizeof(idle));
+    for (int i = 0; i < 6; i++) {
+        idle[i].timestamp = 100.0 + i;
+        idle[i].pid = 42;
+        idle[i].rss_kb = (i == 2) ? 6000 : 5120;
+    }
+    unsigned char keep[6];
+    export_suppression_t sup = {1, 0.0, 0.0, 1.0};
+    field_selection_t sel;
+    field_selection_parse("rss_kb", &sel);
+    long kept = export_mark_kept(idle, 6, &sel, &sup, keep);
+    // mantidas: 0 (primeira), 2 (mudou), 3 (voltou), 5 (última)
+    if (kept != 4 || !keep[0] || keep[1] || !keep[2] || !keep[3] || keep[4] || !keep[5]) {
+        printf("❌ Supressão marcou %ld linhas inesperadas.\n", kept);
+        failures++;
+    }
+
+    // 4b) epsilon relativo por campo: 5% de 5120 kB não é 5% de 2% de CPU
+    proc_metrics_t var[5];
+    memset(var, 0, sizeof(var));
+    const unsigned long rss[5] = { 5120, 5300, 5400, 5400, 5400 };   // +3.5%, +5.5%
+    const double cpu[5] = { 2.0, 2.0, 2.0, 2.09, 2.09 };            // +4.5%
+    for (int i = 0; i < 5; i++) {
+        var[i].timestamp = 100.0 + i;
+        var[i].pid = 42;
+        var[i].rss_kb = rss[i];
+        var[i].cpu_percent = cpu[i];
+    }
+    export_suppression_t rel = {1, 0.05, 0.0, 1.0};
+    field_selection_parse("cpu_percent,rss_kb", &sel);
+    kept = export_mark_kept(var, 5, &sel, &rel, keep);
+    // mantidas: 0 (primeira), 2 (rss +5.5% sobre a gravada), 4 (última);
+    // com 0.05 absoluto, 1 (+180 kB) e 3 (+0.09%) também seriam gravadas
+    if (kept != 3 || !keep[0] || keep[1] || !keep[2] || keep[3] || !keep[4]) {
+        printf("❌ Supressão com epsilon relativo marcou %ld linhas inesperadas.\n", kept);
+        failures++;
+    }
+
+    // 5) Arredondamento idêntico ao printf
+    failures += test_fixed_rounding();
+
+    remove(path);
+    if (failures) return 1;
+    printf("✅ Teste de export concluído.\n");
+    return 0;
+}
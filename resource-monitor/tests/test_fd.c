@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "../include/monitor.h"
+#include "../include/procfixture.h"
+
+#define NPROCS 20
+#define LEAKER 1        // classe 1 da árvore sintética: um socket em CLOSE_WAIT a cada 2 ticks
+
+static int test_classify(void) {
+    struct { const char *link; fd_type_t want; unsigned long ino; } cases[] = {
+        { "/dev/null", FD_FILE, 0 },
+        { "/var/lib/db/data.0001 (deleted)", FD_FILE, 0 },
+        { "socket:[4242]", FD_SOCKET, 4242 },
+        { "pipe:[99]", FD_PIPE, 0 },
+        { "anon_inode:[eventfd]", FD_EVENTFD, 0 },
+        { "anon_inode:[eventpoll]", FD_ANON, 0 },
+        { "anon_inode:[io_uring]", FD_ANON, 0 },
+        { "net:[4026531833]", FD_OTHER, 0 },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        unsigned long ino;
+        fd_type_t got = monitor_fd_classify(cases[i].link, &ino);
+        if (got != cases[i].want || ino != cases[i].ino) {
+            printf("❌ classificação de %s: tipo %d, inode %lu\n", cases[i].link, (int)got, ino);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int check_counts(const char *when, const fd_counts_t *c, const tcp_states_t *ts,
+                        const procfixture_proc_t *v) {
+    if (c->count != v->fd_count || c->by_type[FD_FILE] != v->fd_files ||
+        c->by_type[FD_SOCKET] != v->fd_sockets || c->by_type[FD_PIPE] != v->fd_pipes ||
+        c->by_type[FD_EVENTFD] != v->fd_eventfds || c->by_type[FD_ANON] != v->fd_anon ||
+        c->limit != v->fd_limit) {
+        printf("❌ %s: %lu descritores, %lu sockets, limite %lu (esperado %lu, %lu, %lu)\n", when,
+               c->count, c->by_type[FD_SOCKET], c->limit, v->fd_count, v->fd_sockets, v->fd_limit);
+        return 1;
+    }
+    /* TIME_WAIT (inode 0) e o socket de outro processo ficam de fora */
+    if (ts->listen != v->tcp_listen || ts->established != v->tcp_established ||
+        ts->close_wait != v->tcp_close_wait || ts->other != 0) {
+        printf("❌ %s: TCP %lu listen, %lu estab, %lu close_wait, %lu outros\n", when,
+               ts->listen, ts->established, ts->close_wait, ts->other);
+        return 1;
+    }
+    return 0;
+}
+
+/* o processo que vaza: contagem exata e só os descritores novos relidos */
+static int test_fixture(const char *root, procfixture_config_t *cfg) {
+    procfixture_proc_t v;
+    procfixture_proc_values(cfg, LEAKER, &v);
+    fd_state_t st = {0};
+    fd_counts_t c;
+    tcp_states_t ts;
+    int fail = 0;
+    if (monitor_fd_usage(v.pid, &st, &c) != 0 ||
+        monitor_tcp_states(v.pid, st.sockets, st.nsockets, &ts) != 0) {
+        printf("❌ leitura dos descritores do PID %d\n", v.pid);
+        monitor_fd_free(&st);
+        return 1;
+    }
+    fail |= check_counts("primeiro tick", &c, &ts, &v);
+    if (st.readlinks != v.fd_count) {
+        printf("❌ primeira leitura: %zu readlinks para %lu descritores\n", st.readlinks, v.fd_count);
+        fail = 1;
+    }
+
+    unsigned long before = v.fd_count;
+    cfg->tick += 4;
+    if (procfixture_write(root, cfg) != 0) fail = 1;
+    procfixture_proc_values(cfg, LEAKER, &v);
+    if (monitor_fd_usage(v.pid, &st, &c) != 0 ||
+        monitor_tcp_states(v.pid, st.sockets, st.nsockets, &ts) != 0) {
+        printf("❌ segunda leitura\n");
+        fail = 1;
+    } else {
+        fail |= check_counts("segundo tick", &c, &ts, &v);
+        if (v.fd_count != before + 2 || st.readlinks != 2) {
+            printf("❌ segundo tick: %lu -> %lu descritores, %zu readlinks (esperado 2)\n", before,
+                   v.fd_count, st.readlinks);
+            fail = 1;
+        }
+    }
+    monitor_fd_free(&st);
+    return fail;
+}
+
+/* o próprio processo: pipe, eventfd e sockets por loopback, um deles em CLOSE_WAIT */
+static int test_live(void) {
+    fd_state_t st = {0};
+    fd_counts_t a, b;
+    tcp_states_t ts;
+    struct rlimit rl;
+    if (monitor_fd_usage(getpid(), &st, &a) != 0) {
+        printf("❌ /proc/self/fd\n");
+        return 1;
+    }
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY && a.limit != rl.rlim_cur) {
+        printf("❌ limite %lu, getrlimit %lu\n", a.limit, (unsigned long)rl.rlim_cur);
+        monitor_fd_free(&st);
+        return 1;
+    }
+
+    int p[2] = { -1, -1 };
+    int efd = eventfd(0, 0);
+    int srv = socket(AF_INET, SOCK_STREAM, 0);
+    int c1 = socket(AF_INET, SOCK_STREAM, 0), c2 = socket(AF_INET, SOCK_STREAM, 0);
+    int s1 = -1, s2 = -1;
+    struct sockaddr_in addr;
+    socklen_t alen = sizeof(addr);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int ok = pipe(p) == 0 && efd >= 0 && srv >= 0 && c1 >= 0 && c2 >= 0 &&
+             bind(srv, (struct sockaddr *)&addr, sizeof(addr)) == 0 && listen(srv, 4) == 0 &&
+             getsockname(srv, (struct sockaddr *)&addr, &alen) == 0 &&
+             connect(c1, (struct sockaddr *)&addr, sizeof(addr)) == 0 &&
+             connect(c2, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+    if (ok) {
+        s1 = accept(srv, NULL, NULL);
+        s2 = accept(srv, NULL, NULL);
+        ok = s1 >= 0 && s2 >= 0;
+    }
+    if (ok) {
+        close(c2);          // o par fechou: s2 fica em CLOSE_WAIT
+        c2 = -1;
+        usleep(20000);
+    }
+
+    int fail = 0;
+    if (!ok) {
+        printf("⚠️  sem TCP por loopback: estados não conferidos\n");
+    } else if (monitor_fd_usage(getpid(), &st, &b) != 0 ||
+               monitor_tcp_states(getpid(), st.sockets, st.nsockets, &ts) != 0) {
+        printf("❌ segunda leitura do próprio processo\n");
+        fail = 1;
+    } else {
+        /* +2 do pipe, +1 eventfd, +4 sockets (srv, c1, s1, s2) */
+        if (b.count != a.count + 7 || b.by_type[FD_PIPE] != a.by_type[FD_PIPE] + 2 ||
+            b.by_type[FD_EVENTFD] != a.by_type[FD_EVENTFD] + 1 ||
+            b.by_type[FD_SOCKET] != a.by_type[FD_SOCKET] + 4 || st.readlinks != 7) {
+            printf("❌ %lu -> %lu descritores, %lu sockets, %zu readlinks\n", a.count, b.count,
+                   b.by_type[FD_SOCKET], st.readlinks);
+            fail = 1;
+        }
+        if (ts.listen < 1 || ts.established < 2 || ts.close_wait < 1) {
+            printf("❌ TCP: %lu listen, %lu estab, %lu close_wait\n", ts.listen, ts.established,
+                   ts.close_wait);
+            fail = 1;
+        }
+    }
+    int fds[] = { p[0], p[1], efd, srv, c1, c2, s1, s2 };
+    for (size_t i = 0; i < sizeof(fds) / sizeof(fds[0]); i++)
+        if (fds[i] >= 0) close(fds[i]);
+    monitor_fd_free(&st);
+    return fail;
+}
+
+int main() {
+    int failures = 0;
+    printf("=== Teste: Descritores e Sockets ===\n");
+    failures += test_classify();
+
+    char root[] = "/tmp/test_fd_XXXXXX";
+    if (!mkdtemp(root)) {
+        printf("❌ diretório temporário\n");
+        return 1;
+    }
+    procfixture_config_t cfg = { NPROCS, 1, 4, 0, 8 };
+    if (procfixture_write(root, &cfg) != 0) {
+        printf("❌ procfixture_write\n");
+        procfixture_remove(root);
+        return 1;
+    }
+    char proc[64];
+    snprintf(proc, sizeof(proc), "%s/proc", root);
+    monitor_set_proc_root(proc);
+    failures += test_fixture(root, &cfg);
+    monitor_set_proc_root(NULL);
+    procfixture_remove(root);
+
+    failures += test_live();
+
+    if (failures == 0)
+        printf("✅ Teste de descritores e sockets concluído.\n");
+    else
+        printf("❌ Teste de descritores e sockets falhou (%d).\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../include/procfixture.h"
+#include "../include/monitor.h"
+#include "../include/cgroup.h"
+#include "../include/top.h"
+
+#define NPROCS 300
+
+/* coletores de processo leem exatamente os valores gerados */
+static int test_proc_collectors(const procfixture_config_t *cfg) {
+    procfixture_proc_t v;
+    procfixture_proc_values(cfg, 10, &v);      // índice 10: classe ocupada
+
+    unsigned long rss, vsz, minflt, majflt, swap;
+    unsigned long long rchar, wchar, rb, wb, sc;
+    if (monitor_memory_usage(v.pid, &rss, &vsz, &minflt, &majflt, &swap) != 0 ||
+        rss != v.rss_kb || vsz != v.vmsize_kb || minflt != v.minflt || majflt != v.majflt) {
+        printf("❌ memória do PID %d: rss=%lu vsz=%lu minflt=%lu (esperado %lu %lu %lu)\n",
+               v.pid, rss, vsz, minflt, v.rss_kb, v.vmsize_kb, v.minflt);
+        return 1;
+    }
+    if (monitor_io_usage(v.pid, &rchar, &wchar, &rb, &wb, &sc) != 0 ||
+        rchar != v.rchar || wchar != v.wchar || wb != v.write_bytes || sc != v.syscr) {
+        printf("❌ I/O do PID %d: rchar=%llu wchar=%llu\n", v.pid, rchar, wchar);
+        return 1;
+    }
+    unsigned long avail, total;
+    if (monitor_mem_available(&avail, &total) != 0 || total != 16777216UL || avail == 0) {
+        printf("❌ meminfo sintético: total=%lu disponível=%lu\n", total, avail);
+        return 1;
+    }
+    return 0;
+}
+
+/* contadores andam com o tick: CPU% sai da diferença entre duas gravações */
+static int test_evolving(const char *root, procfixture_config_t *cfg) {
+    procfixture_proc_t a, b;
+    procfixture_proc_values(cfg, 10, &a);
+    double cpu, run_ms, wait_ms;
+    unsigned long long slices;
+    schedstat_state_t sched = {0};
+    monitor_cpu_usage(a.pid, &cpu);
+    monitor_schedstat(a.pid, &sched, &run_ms, &wait_ms, &slices);
+
+    cfg->tick += 5;
+    if (procfixture_write(root, cfg) != 0) return 1;
+    procfixture_proc_values(cfg, 10, &b);
+    monitor_cpu_usage(a.pid, &cpu);
+    int sched_rc = monitor_schedstat(a.pid, &sched, &run_ms, &wait_ms, &slices);
+    monitor_schedstat_free(&sched);
+
+    double expect = 100.0 * (double)((b.utime + b.stime) - (a.utime + a.stime)) /
+                    (5.0 * PROCFIXTURE_JIFFIES_PER_TICK);
+    if (cpu < expect - 0.01 || cpu > expect + 0.01 || b.rss_kb != a.rss_kb) {
+        printf("❌ CPU%% após 5 ticks: %.3f (esperado %.3f)\n", cpu, expect);
+        return 1;
+    }
+    /* schedstat somado nas 3 threads: CPU em ms e espera na fila do intervalo */
+    double run_expect = (double)((b.utime + b.stime) - (a.utime + a.stime)) * 10.0;
+    double wait_expect = (double)(b.run_delay_ms - a.run_delay_ms);
+    if (sched_rc != 0 || run_ms != run_expect || wait_ms != wait_expect || wait_ms < 500.0 ||
+        slices != (b.voluntary_ctxt + b.nonvoluntary_ctxt) - (a.voluntary_ctxt + a.nonvoluntary_ctxt)) {
+        printf("❌ schedstat após 5 ticks: run=%.1f wait=%.1f ms (esperado %.1f %.1f)\n",
+               run_ms, wait_ms, run_expect, wait_expect);
+        return 1;
+    }
+    procfixture_proc_values(cfg, 11, &b);
+    procfixture_proc_values(&(procfixture_config_t){ NPROCS, 3, 4, 0, cfg->tick - 5 }, 11, &a);
+    if (b.rss_kb != a.rss_kb + 5 * 64) {
+        printf("❌ processo com vazamento não cresceu: %lu -> %lu kB\n", a.rss_kb, b.rss_kb);
+        return 1;
+    }
+    return 0;
+}
+
+/* cgroups: somas dos membros, limite e PSI do sistema */
+static int test_cgroups(const procfixture_config_t *cfg) {
+    cgroup_metrics_t m;
+    if (cgroup_read_metrics("g001", &m) != 0) {
+        printf("❌ cgroup_read_metrics(g001) falhou\n");
+        return 1;
+    }
+    unsigned long long usage = 0, anon = 0;
+    for (size_t i = 1; i < cfg->nprocs; i += 4) {
+        procfixture_proc_t v;
+        procfixture_proc_values(cfg, i, &v);
+        usage += (unsigned long long)(v.utime + v.stime) * 10000;
+        anon += (unsigned long long)v.rss_kb * 3 / 4 * 1024;
+    }
+    unsigned long long max = 0;
+    if (m.cpu.usage_usec != usage || m.mem.anon != anon || m.mem.current == 0 || m.io.wbytes == 0 ||
+        cgroup_read_memory_max("g001", &max) != 0 || max == 0) {
+        printf("❌ g001: usage=%llu (esperado %llu) anon=%llu (esperado %llu) max=%llu\n",
+               m.cpu.usage_usec, usage, m.mem.anon, anon, max);
+        return 1;
+    }
+    cgroup_psi_metrics_t psi;
+    if (cgroup_read_system_pressure(&psi) != 0 || psi.io.some_total == 0) {
+        printf("❌ PSI sintético do sistema não lido\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* varredura do top sobre a árvore: todos os processos, threads e cgroup de cada um */
+static int test_top_scan(const char *proc) {
+    top_collector_t c;
+    top_frame_t snap = {0};
+    top_collector_init(&c, 50);
+    c.proc_root = proc;
+    c.workers = 1;
+    top_collector_scan(&c);
+    top_snapshot(&c, &snap);
+
+    int fail = snap.count != NPROCS;
+    size_t containers = 0;
+    for (size_t i = 0; i < snap.count && !fail; i++) {
+        if (snap.rows[i].threads != 3 || strncmp(snap.rows[i].cgroup, "/resource_monitor/g", 19) != 0) fail = 1;
+        if (snap.rows[i].pidns != 4026531836UL) containers++;
+    }
+    if (fail || containers != NPROCS / 4)
+        printf("❌ top na árvore sintética: %zu processos, %zu em outro pidns\n", snap.count, containers);
+    /* um netns por cgroup: quatro leituras de net/ para os 300 processos */
+    if (snap.net_reads != 4 || snap.rows[0].netns != 4026532500UL) {
+        printf("❌ top leu %zu netns (esperado 4)\n", snap.net_reads);
+        fail = 1;
+    }
+    top_collector_free(&c);
+    top_frame_free(&snap);
+    return fail || containers != NPROCS / 4;
+}
+
+int main() {
+    int failures = 0;
+    printf("=== Teste: Árvore Sintética de /proc e cgroupfs ===\n");
+    monitor_set_verbose(0);
+
+    char root[] = "/tmp/test_fixture_XXXXXX";
+    if (!mkdtemp(root)) {
+        printf("❌ diretório temporário\n");
+        return 1;
+    }
+    procfixture_config_t cfg = { NPROCS, 3, 4, 0, 0 };
+    if (procfixture_write(root, &cfg) != 0) {
+        printf("❌ procfixture_write\n");
+        procfixture_remove(root);
+        return 1;
+    }
+    char proc[64], cg[64];
+    snprintf(proc, sizeof(proc), "%s/proc", root);
+    snprintf(cg, sizeof(cg), "%s/cgroup", root);
+    monitor_set_proc_root(proc);
+    cgroup_set_root(cg);
+
+    failures += test_proc_collectors(&cfg);
+    failures += test_evolving(root, &cfg);
+    failures += test_cgroups(&cfg);
+    failures += test_top_scan(proc);
+
+    monitor_set_proc_root(NULL);
+    cgroup_set_root(NULL);
+    if (strcmp(monitor_proc_root(), "/proc") != 0) {
+        printf("❌ raiz padrão não restaurada\n");
+        failures++;
+    }
+    if (procfixture_remove(root) != 0 || access(root, F_OK) == 0) {
+        printf("❌ árvore não removida\n");
+        failures++;
+    }
+
+    if (failures == 0)
+        printf("✅ Teste de árvore sintética concluído.\n");
+    else
+        printf("❌ Teste de árvore sintética falhou (%d).\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "../include/monitor.h"
+#include "../include/procfixture.h"
+
+#define NPROCS 40
+#define NGROUPS 4
+
+/* net/dev sem lo e net/snmp exatamente como gerados */
+static int test_counters(const procfixture_config_t *cfg) {
+    procfixture_proc_t v;
+    procfixture_proc_values(cfg, 7, &v);
+    net_counters_t c;
+    if (monitor_net_usage(v.pid, &c) != 0) {
+        printf("❌ monitor_net_usage no PID %d\n", v.pid);
+        return 1;
+    }
+    if (c.ifaces != 1 || c.rx_bytes != v.net_rx_bytes || c.tx_bytes != v.net_tx_bytes ||
+        c.rx_packets != v.net_rx_packets || c.rx_drops != v.net_drops || c.tcp_retrans != v.tcp_retrans ||
+        c.tcp_out_segs != v.net_tx_packets || c.udp_out != v.net_tx_packets / 8) {
+        printf("❌ contadores: %d interfaces, rx=%llu tx=%llu retrans=%llu (esperado rx=%llu tx=%llu retrans=%llu)\n",
+               c.ifaces, c.rx_bytes, c.tx_bytes, c.tcp_retrans, v.net_rx_bytes, v.net_tx_bytes, v.tcp_retrans);
+        return 1;
+    }
+    if (monitor_netns(v.pid) != v.netns) {
+        printf("❌ netns do PID %d: %lu (esperado %lu)\n", v.pid, monitor_netns(v.pid), v.netns);
+        return 1;
+    }
+    return 0;
+}
+
+/* um tick lê cada netns uma vez; o seguinte tem taxas pelos deltas */
+static int test_cache(const char *root, procfixture_config_t *cfg) {
+    netns_cache_t nc = {0};
+    int fail = 0;
+    netns_cache_begin(&nc);
+    for (size_t i = 0; i < NPROCS; i++) {
+        pid_t pid = procfixture_pid(cfg, i);
+        if (netns_cache_read(&nc, pid, monitor_netns(pid), NULL, NULL) != 0) fail = 1;
+    }
+    if (fail || nc.reads != NGROUPS || nc.hits != NPROCS - NGROUPS) {
+        printf("❌ primeiro tick: %zu leituras, %zu reaproveitadas\n", nc.reads, nc.hits);
+        netns_cache_free(&nc);
+        return 1;
+    }
+
+    procfixture_proc_t a, b;
+    procfixture_proc_values(cfg, 4, &a);
+    cfg->tick += 3;
+    if (procfixture_write(root, cfg) != 0) return 1;
+    procfixture_proc_values(cfg, 4, &b);
+
+    /* só o netns do processo 4 neste tick: os outros saem do cache no próximo */
+    netns_cache_begin(&nc);
+    net_counters_t c;
+    net_rates_t r;
+    if (netns_cache_read(&nc, b.pid, monitor_netns(b.pid), &c, &r) != 0 ||
+        c.rx_bytes - a.net_rx_bytes != b.net_rx_bytes - a.net_rx_bytes || r.rx_bytes_per_s <= 0.0 ||
+        r.tx_bytes_per_s <= 0.0 || r.tcp_retrans_per_s <= 0.0) {
+        printf("❌ segundo tick: rx=%llu, %.1f B/s\n", c.rx_bytes, r.rx_bytes_per_s);
+        fail = 1;
+    }
+    netns_cache_begin(&nc);
+    if (nc.n != 1) {
+        printf("❌ namespaces sem leitura não foram descartados (%zu)\n", nc.n);
+        fail = 1;
+    }
+    netns_cache_free(&nc);
+    return fail;
+}
+
+/* o próprio processo: inode igual ao do kernel e segmentos TCP por loopback em net/snmp */
+static int test_live(void) {
+    struct stat st;
+    if (stat("/proc/self/ns/net", &st) != 0 || monitor_netns(getpid()) != (unsigned long)st.st_ino) {
+        printf("❌ inode do netns do próprio processo\n");
+        return 1;
+    }
+    net_counters_t before, after;
+    if (monitor_net_usage(getpid(), &before) != 0) {
+        printf("❌ net/dev do próprio processo\n");
+        return 1;
+    }
+
+    int srv = socket(AF_INET, SOCK_STREAM, 0), cli = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    socklen_t alen = sizeof(addr);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int ok = srv >= 0 && cli >= 0 && bind(srv, (struct sockaddr *)&addr, sizeof(addr)) == 0 &&
+             listen(srv, 1) == 0 && getsockname(srv, (struct sockaddr *)&addr, &alen) == 0 &&
+             connect(cli, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+    int acc = ok ? accept(srv, NULL, NULL) : -1;
+    ok = ok && acc >= 0 && write(cli, "ping", 4) == 4;
+    if (acc >= 0) close(acc);
+    if (cli >= 0) close(cli);
+    if (srv >= 0) close(srv);
+    if (!ok) {
+        printf("⚠️  sem TCP por loopback: só a leitura foi conferida\n");
+        return 0;
+    }
+
+    monitor_net_usage(getpid(), &after);
+    if (after.tcp_out_segs < before.tcp_out_segs + 3) {
+        printf("❌ OutSegs não andou: %llu -> %llu\n", before.tcp_out_segs, after.tcp_out_segs);
+        return 1;
+    }
+    return 0;
+}
+
+int main() {
+    int failures = 0;
+    printf("=== Teste: Rede por Namespace ===\n");
+
+    char root[] = "/tmp/test_net_XXXXXX";
+    if (!mkdtemp(root)) {
+        printf("❌ diretório temporário\n");
+        return 1;
+    }
+    procfixture_config_t cfg = { NPROCS, 1, NGROUPS, 0, 1 };
+    if (procfixture_write(root, &cfg) != 0) {
+        printf("❌ procfixture_write\n");
+        procfixture_remove(root);
+        return 1;
+    }
+    char proc[64];
+    snprintf(proc, sizeof(proc), "%s/proc", root);
+    monitor_set_proc_root(proc);
+    failures += test_counters(&cfg);
+    failures += test_cache(root, &cfg);
+    monitor_set_proc_root(NULL);
+    procfixture_remove(root);
+
+    failures += test_live();
+
+    if (failures == 0)
+        printf("✅ Teste de rede por namespace concluído.\n");
+    else
+        printf("❌ Teste de rede por namespace falhou (%d).\n", failures);
+    return failures ? 1 : 0;
+}
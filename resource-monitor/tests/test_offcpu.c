@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include "../include/offcpu.h"
+
+#define HZ 200.0
+#define DURATION_S 0.5
+
+static volatile int g_stop = 0;
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_cond = PTHREAD_COND_INITIALIZER;
+static int g_pipe[2];
+
+static void *futex_thread(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_lock);
+    while (!g_stop) pthread_cond_wait(&g_cond, &g_lock);
+    pthread_mutex_unlock(&g_lock);
+    return NULL;
+}
+
+static void *poll_thread(void *arg) {
+    (void)arg;
+    struct pollfd p = { g_pipe[0], POLLIN, 0 };
+    while (!g_stop) poll(&p, 1, -1);
+    return NULL;
+}
+
+static void *sleep_thread(void *arg) {
+    (void)arg;
+    while (!g_stop) usleep(100000);
+    return NULL;
+}
+
+static void *spin_thread(void *arg) {
+    (void)arg;
+    volatile double x = 1.0;
+    while (!g_stop) x *= 1.0000001;
+    return NULL;
+}
+
+static int test_classify(void) {
+    struct { char state; long sysno; const char *wchan; offcpu_cat_t want; } cases[] = {
+        { 'R', -2, "", OFFCPU_RUNNING },
+        { 'S', SYS_futex, "futex_wait_queue", OFFCPU_FUTEX },
+        { 'S', SYS_epoll_pwait, "", OFFCPU_POLL },
+        { 'S', SYS_clock_nanosleep, "", OFFCPU_SLEEP },
+        { 'S', SYS_read, "pipe_read", OFFCPU_READ_WRITE },
+        { 'D', SYS_read, "folio_wait_bit_common", OFFCPU_IO_WAIT },
+        { 'D', SYS_fsync, "", OFFCPU_IO_WAIT },
+        { 'D', -1, "folio_wait_bit_common", OFFCPU_PAGE_FAULT },
+        { 'S', -2, "ep_poll", OFFCPU_POLL },           // sem syscall: pelo wchan
+        { 'S', -2, "futex_wait_queue", OFFCPU_FUTEX },
+        { 'D', -2, "0", OFFCPU_IO_WAIT },
+        { 'T', SYS_read, "do_signal_stop", OFFCPU_OTHER },
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        offcpu_cat_t got = offcpu_classify(cases[i].state, cases[i].sysno, cases[i].wchan);
+        if (got != cases[i].want) {
+            printf("❌ classificação %zu (%c, %ld, %s): %s, esperado %s\n", i, cases[i].state,
+                   cases[i].sysno, cases[i].wchan, offcpu_cat_name(got), offcpu_cat_name(cases[i].want));
+            return 1;
+        }
+    }
+    if (!offcpu_syscall_name(SYS_futex) || strcmp(offcpu_syscall_name(SYS_futex), "futex") != 0) {
+        printf("❌ nome da syscall futex\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* o próprio processo: uma thread por categoria, amostrada por meio segundo */
+static int test_profile(void) {
+    static offcpu_t o;
+    if (pipe(g_pipe) != 0) return 1;
+    pthread_t th[4];
+    void *(*fn[4])(void *) = { futex_thread, poll_thread, sleep_thread, spin_thread };
+    for (int i = 0; i < 4; i++) pthread_create(&th[i], NULL, fn[i], NULL);
+    usleep(50000);
+
+    int fail = 0;
+    if (offcpu_init(&o, getpid(), HZ, BATCHREAD_AUTO) != 0 || offcpu_run(&o, DURATION_S, NULL) != 0) {
+        printf("❌ amostragem falhou\n");
+        fail = 1;
+    } else {
+        offcpu_print(&o, stdout, 8);
+        /* cada thread bloqueada deve aparecer em quase todos os ticks */
+        uint64_t min = o.ticks * 8 / 10;
+        offcpu_cat_t want[] = { OFFCPU_FUTEX, OFFCPU_POLL, OFFCPU_SLEEP, OFFCPU_RUNNING };
+        for (int i = 0; i < 4; i++) {
+            if (o.cat_samples[want[i]] < min) {
+                printf("❌ %s: %llu amostras em %llu ticks\n", offcpu_cat_name(want[i]),
+                       (unsigned long long)o.cat_samples[want[i]], (unsigned long long)o.ticks);
+                fail = 1;
+            }
+        }
+        if (o.ticks < (uint64_t)(HZ * DURATION_S / 2) || o.nthreads != 5) {
+            printf("❌ %llu ticks, %zu threads\n", (unsigned long long)o.ticks, o.nthreads);
+            fail = 1;
+        }
+        const char *csv = "/tmp/test_offcpu.csv";
+        if (offcpu_write_csv(&o, csv) != 0) {
+            printf("❌ CSV\n");
+            fail = 1;
+        }
+        remove(csv);
+    }
+    offcpu_free(&o);
+
+    g_stop = 1;
+    pthread_mutex_lock(&g_lock);
+    pthread_cond_broadcast(&g_cond);
+    pthread_mutex_unlock(&g_lock);
+    if (write(g_pipe[1], "x", 1) != 1) fail = 1;
+    for (int i = 0; i < 4; i++) pthread_join(th[i], NULL);
+    close(g_pipe[0]);
+    close(g_pipe[1]);
+    return fail;
+}
+
+int main() {
+    int failures = 0;
+    printf("=== Teste: Perfil Off-CPU ===\n");
+    failures += test_classify();
+    failures += test_profile();
+
+    if (failures == 0)
+        printf("✅ Teste de perfil off-CPU concluído.\n");
+    else
+        printf("❌ Teste de perfil off-CPU falhou (%d).\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "../include/perfcount.h"
+
+#define TOUCH_PAGES 2048
+
+/* uma falta por página: sem huge pages transparentes, que fariam uma falta a cada 2 MB */
+static void touch_pages(size_t n) {
+    char *mem = mmap(NULL, n * 4096, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) return;
+    madvise(mem, n * 4096, MADV_NOHUGEPAGE);
+    for (size_t i = 0; i < n; i++) ((volatile char *)mem)[i * 4096] = 1;
+    munmap(mem, n * 4096);
+}
+
+static double mono_s(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec / 1e9;
+}
+
+static void *late_thread(void *arg) {
+    (void)arg;
+    touch_pages(TOUCH_PAGES);
+    return NULL;
+}
+
+int main() {
+    printf("=== Teste: Contadores perf_event_open ===\n");
+    perfcount_t pc;
+    if (perfcount_open(&pc, getpid(), 1) != 0) {
+        printf("✅ Teste de contadores perf concluído (perf_event_open indisponível, ignorado).\n");
+        return 0;
+    }
+    printf(" - %d grupo(s), %d eventos por grupo, hardware %s%s\n", pc.ngroups, pc.nmembers,
+           pc.has_hw ? "sim" : "não", pc.user_only ? ", só usuário" : "");
+
+    proc_metrics_t m;
+    memset(&m, 0, sizeof(m));
+    int fail = 0;
+    /* t_outer cobre as duas leituras, t_inner fica entre elas: o dt medido está no meio */
+    double t_outer = mono_s();
+    if (perfcount_read(&pc, &m) != 0 || m.task_clock_ms_per_s != 0.0 || m.page_faults_per_s != 0.0) {
+        printf("❌ primeira leitura deveria só preparar os deltas\n");
+        fail = 1;
+    }
+
+    /* faltas de página na thread principal e numa thread criada depois da abertura (inherit) */
+    double t_inner = mono_s();
+    touch_pages(TOUCH_PAGES);
+    pthread_t th;
+    pthread_create(&th, NULL, late_thread, NULL);
+    pthread_join(th, NULL);
+    for (int i = 0; i < 5; i++) usleep(2000);
+    volatile double x = 0.0;
+    for (int i = 0; i < 2000000; i++) x += i * 0.5;
+
+    t_inner = mono_s() - t_inner;
+    int rc = perfcount_read(&pc, &m);
+    t_outer = mono_s() - t_outer;
+    if (rc != 0) {
+        printf("❌ leitura dos grupos falhou\n");
+        fail = 1;
+    } else {
+        printf(" - em %.1f ms: task-clock %.1f ms/s, ctxsw %.1f/s, migrações %.1f/s, faults %.0f/s, IPC %.2f\n",
+               t_outer * 1e3, m.task_clock_ms_per_s, m.ctx_switches_per_s, m.cpu_migrations_per_s,
+               m.page_faults_per_s, m.ipc);
+        /* uma thread rodando por vez: no máximo ~1000 ms de CPU por segundo */
+        if (m.task_clock_ms_per_s <= 0.0 || m.task_clock_ms_per_s > 1100.0) {
+            printf("❌ task-clock deveria ser uma taxa em (0, 1000] ms/s: %.1f\n", m.task_clock_ms_per_s);
+            fail = 1;
+        }
+        /* taxa x intervalo: acima do total com o intervalo externo, abaixo com o interno */
+        double faults = 2.0 * TOUCH_PAGES;
+        if (m.page_faults_per_s * t_outer < faults * 0.9 || m.page_faults_per_s * t_inner > faults * 2.0) {
+            printf("❌ faltas de página por segundo: %.0f/s em %.1f..%.1f ms (esperado ~%.0f faltas)\n",
+                   m.page_faults_per_s, t_inner * 1e3, t_outer * 1e3, faults);
+            fail = 1;
+        }
+        if (m.ctx_switches_per_s * t_outer < 5.0) {
+            printf("❌ usleep deveria trocar de contexto: %.1f/s\n", m.ctx_switches_per_s);
+            fail = 1;
+        }
+        if (pc.has_hw && (m.cycles_per_s <= 0.0 || m.ipc <= 0.0)) {
+            printf("❌ PMU aberto sem cycles/IPC\n");
+            fail = 1;
+        }
+    }
+    perfcount_close(&pc);
+
+    if (!fail)
+        printf("✅ Teste de contadores perf concluído.\n");
+    else
+        printf("❌ Teste de contadores perf falhou.\n");
+    return fail;
+}
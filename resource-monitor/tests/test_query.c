@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include "../include/query.h"
+#include "../include/export.h"
+#include "../include/blockindex.h"
+
+#define N 20000
+
+/* .rmb de uma versão sem os contadores perf: registros menores que proc_metrics_t */
+static int write_old_rmb(const char *path, const proc_metrics_t *data, size_t count) {
+    size_t old_size = offsetof(proc_metrics_t, task_clock_ms_per_s);
+    FILE *f = fopen(path, "wb");
+    if (!f) return -1;
+    rmb_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, RMB_MAGIC, 4);
+    h.version = RMB_VERSION;
+    h.header_size = sizeof(h);
+    h.record_size = (uint32_t)old_size;
+    h.count = count;
+    fwrite(&h, sizeof(h), 1, f);
+    for (size_t i = 0; i < count; i++) fwrite(&data[i], old_size, 1, f);
+    return fclose(f);
+}
+
+/* conta as linhas de dados (sem cabeçalho) de um arquivo */
+static long data_lines(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    char line[1024];
+    long n = -1;
+    while (fgets(line, sizeof(line), f))
+        if (line[0] != '#') n++;
+    fclose(f);
+    return n;
+}
+
+static int check(const char *data, const char *label, size_t expect_matched, int expect_skip) {
+    const char *out = "/tmp/test_query_out.csv";
+    query_t q;
+    query_init(&q);
+    q.from = 5000;
+    q.to = 5999;
+    q.has_pid = 1;
+    q.pid = 11;
+    if (query_add_where(&q, "cpu_percent>=50,rss_kb<100000") != 0) return 1;
+
+    FILE *f = fopen(out, "w");
+    query_stats_t st;
+    int rc = query_run(data, &q, f, &st);
+    fclose(f);
+    if (rc != 0 || st.rows_matched != expect_matched || data_lines(out) != (long)expect_matched) {
+        printf("❌ %s: rc=%d, %zu linhas (esperado %zu)\n", label, rc, st.rows_matched, expect_matched);
+        return 1;
+    }
+    if (expect_skip && (!st.indexed || st.blocks_read >= st.blocks_total)) {
+        printf("❌ %s: índice não pulou blocos (%zu/%zu)\n", label, st.blocks_read, st.blocks_total);
+        return 1;
+    }
+    remove(out);
+    return 0;
+}
+
+int main() {
+    static proc_metrics_t data[N];
+    int failures = 0;
+    printf("=== Teste: Consulta ===\n");
+
+    memset(data, 0, sizeof(data));
+    for (int i = 0; i < N; i++) {
+        data[i].timestamp = i / 2;          // dois PIDs por segundo
+        data[i].pid = 10 + (i % 2);
+        data[i].cpu_percent = (i / 2) % 100;
+        data[i].rss_kb = 50000;
+    }
+    // PID 11 entre t=5000..5999 com cpu >= 50: 500 linhas
+    const size_t expect = 500;
+
+    const char *csv = "/tmp/test_query.csv";
+    const char *rmb = "/tmp/test_query.rmb";
+    char idx[512];
+    if (export_metrics_csv(csv, data, N) != 0 || export_metrics_rmb(rmb, data, N) != 0) {
+        printf("❌ gravação\n");
+        return 1;
+    }
+
+    // 1) com índice: só os blocos da janela de tempo são lidos
+    failures += check(csv, "CSV indexado", expect, 1);
+    failures += check(rmb, "RMB indexado", expect, 1);
+
+    // 2) sem índice: mesmo resultado, e o índice é recriado
+    block_index_path(csv, idx, sizeof(idx));
+    remove(idx);
+    failures += check(csv, "CSV sem índice", expect, 0);
+    failures += check(csv, "CSV reindexado", expect, 1);
+
+    // 2b) .rmb antigo sem índice: o índice recriado usa o record_size do cabeçalho
+    const char *old_rmb = "/tmp/test_query_old.rmb";
+    char old_idx[512];
+    block_index_path(old_rmb, old_idx, sizeof(old_idx));
+    remove(old_idx);
+    if (write_old_rmb(old_rmb, data, N) != 0) {
+        printf("❌ gravação .rmb antigo\n");
+        failures++;
+    } else {
+        failures += check(old_rmb, "RMB antigo sem índice", expect, 0);
+        failures += check(old_rmb, "RMB antigo reindexado", expect, 1);
+    }
+    remove(old_rmb);
+    remove(old_idx);
+
+    // 3) campo desconhecido
+    query_t q;
+    query_init(&q);
+    if (query_add_where(&q, "nada>1") == 0) {
+        printf("❌ campo inválido aceito\n");
+        failures++;
+    }
+
+    remove(csv);
+    remove(rmb);
+    remove(idx);
+    block_index_path(rmb, idx, sizeof(idx));
+    remove(idx);
+
+    if (failures == 0)
+        printf("✅ Teste de consulta concluído.\n");
+    else
+        printf("❌ Teste de consulta falhou (%d).\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "../include/replay.h"
+#include "../include/export.h"
+
+#define NPIDS 3
+#define NPER 200
+
+static void make_samples(proc_metrics_t *data) {
+    memset(data, 0, sizeof(proc_metrics_t) * NPIDS * NPER);
+    // amostras intercaladas entre os PIDs, como num arquivo multi-alvo
+    for (int i = 0; i < NPER; i++)
+        for (int p = 0; p < NPIDS; p++) {
+            proc_metrics_t *m = &data[i * NPIDS + p];
+            m->timestamp = 1000 + i;
+            m->pid = 100 + p;
+            m->cpu_percent = (i / 50) * 10.0;       // patamares: muitas repetições
+            m->rss_kb = 4096;
+            m->minflt = (unsigned long)i * 10;
+        }
+}
+
+/* lê a contagem de cpu_percent do PID no resumo CSV */
+static long summary_count(const char *path, int pid) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    char line[256];
+    long count = -1;
+    while (fgets(line, sizeof(line), f)) {
+        int p;
+        char metric[64];
+        long c;
+        if (sscanf(line, "%d,%63[^,],%ld", &p, metric, &c) == 3 &&
+            p == pid && strcmp(metric, "cpu_percent") == 0)
+            count = c;
+    }
+    fclose(f);
+    return count;
+}
+
+int main() {
+    static proc_metrics_t data[NPIDS * NPER];
+    int failures = 0;
+    printf("=== Teste: Replay ===\n");
+    make_samples(data);
+
+    // 1) .rmb: leitura mapeada devolve as mesmas amostras
+    const char *rmb = "/tmp/test_replay.rmb";
+    if (export_metrics_rmb(rmb, data, NPIDS * NPER) != 0) { printf("❌ gravação .rmb\n"); return 1; }
+    replay_data_t d;
+    if (replay_load(rmb, &d) != 0 || d.count != NPIDS * NPER || !d.map ||
+        memcmp(d.samples, data, sizeof(data)) != 0) {
+        printf("❌ leitura .rmb\n");
+        failures++;
+    }
+    replay_free(&d);
+
+    // 1b) .rmb de uma versão sem os contadores perf: campos novos ficam em zero
+    const char *old_rmb = "/tmp/test_replay_old.rmb";
+    size_t old_size = offsetof(proc_metrics_t, task_clock_ms_per_s);
+    FILE *f = fopen(old_rmb, "wb");
+    if (!f) { printf("❌ gravação .rmb antigo\n"); return 1; }
+    rmb_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, RMB_MAGIC, 4);
+    h.version = RMB_VERSION;
+    h.header_size = sizeof(h);
+    h.record_size = (uint32_t)old_size;
+    h.count = NPIDS;
+    fwrite(&h, sizeof(h), 1, f);
+    for (int i = 0; i < NPIDS; i++) fwrite(&data[i], old_size, 1, f);
+    fclose(f);
+    if (replay_load(old_rmb, &d) != 0 || d.count != NPIDS || d.samples[2].pid != data[2].pid ||
+        d.samples[2].minflt != data[2].minflt || d.samples[2].page_faults_per_s != 0.0) {
+        printf("❌ leitura .rmb com layout antigo\n");
+        failures++;
+    }
+    replay_free(&d);
+    remove(old_rmb);
+
+    // 2) replay paralelo com resumo e anomalias
+    replay_options_t opt;
+    memset(&opt, 0, sizeof(opt));
+    opt.anomaly = 1;
+    anomaly_config_default(&opt.anomaly_cfg);
+    opt.summary = 1;
+    opt.threads = 4;
+    if (replay_run(rmb, &opt) != 0) { printf("❌ replay .rmb\n"); failures++; }
+    if (summary_count("/tmp/test_replay.rmb.replay.summary.csv", 101) != NPER) {
+        printf("❌ resumo do replay .rmb\n");
+        failures++;
+    }
+
+    // 3) CSV com supressão é reexpandido
+    const char *csv = "/tmp/test_replay.csv";
+    export_suppression_t sup = { 1, 0.0, 0.0, 1.0 };
+    export_set_suppression(&sup);
+    export_set_fields("cpu_percent,rss_kb");
+    if (export_metrics_csv(csv, data, NPIDS * NPER) != 0) { printf("❌ gravação CSV\n"); return 1; }
+    if (replay_load(csv, &d) != 0 || d.count >= NPIDS * NPER || d.interval_s != 1.0) {
+        printf("❌ leitura CSV suprimido (%zu linhas)\n", d.count);
+        failures++;
+    }
+    replay_free(&d);
+    opt.anomaly = 0;
+    if (replay_run(csv, &opt) != 0 ||
+        summary_count("/tmp/test_replay.csv.replay.summary.csv", 102) != NPER) {
+        printf("❌ reexpansão no replay CSV\n");
+        failures++;
+    }
+
+    remove(rmb);
+    remove(csv);
+    remove("/tmp/test_replay.rmb.replay.summary.csv");
+    remove("/tmp/test_replay.rmb.replay.anomalies.jsonl");
+    remove("/tmp/test_replay.csv.replay.summary.csv");
+
+    if (failures == 0)
+        printf("✅ Teste de replay concluído.\n");
+    else
+        printf("❌ Teste de replay falhou (%d).\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <string.h>
+#include "../include/monitor.h"
+#include "../include/rollup.h"
+
+int main() {
+    rollup_store_t st;
+    int failures = 0;
+
+    printf("=== Teste: Rollup ===\n");
+
+    // 5 amostras brutas, 4 janelas de 10 s, 2 de 1 min
+    if (rollup_store_init(&st, 42, 5, 4, 2) != 0) {
+        printf("❌ Falha ao alocar store.\n");
+        return 1;
+    }
+    size_t bytes = rollup_store_bytes(&st);
+
+    // 100 amostras (1/s): cpu_percent = i, rss_kb = 1000 + i, rchar acima de 2^24
+    const unsigned long long rchar0 = 1ULL << 40;
+    for (int i = 0; i < 100; i++) {
+        proc_metrics_t m;
+        memset(&m, 0, sizeof(m));
+        m.timestamp = 1000.0 + i;
+        m.pid = 42;
+        m.cpu_percent = i;
+        m.rss_kb = 1000 + (unsigned long)i;
+        m.rchar = rchar0 + (unsigned long long)i;
+        rollup_store_add(&st, &m);
+    }
+
+    // 1) memória não cresce
+    if (rollup_store_bytes(&st) != bytes) {
+        printf("❌ Store cresceu.\n");
+        failures++;
+    }
+
+    // 2) buffer bruto guarda só as 5 últimas, em ordem
+    proc_metrics_t raw[8];
+    size_t n = rollup_store_raw_copy(&st, raw, 8);
+    if (n != 5 || raw[0].cpu_percent != 95.0 || raw[4].cpu_percent != 99.0) {
+        printf("❌ Buffer bruto incorreto (n=%zu).\n", n);
+        failures++;
+    }
+
+    // 3) tier de 10 s: janela fechada [1080,1090) tem min 80, max 89, média 84.5
+    const rollup_tier_t *t = &st.tiers[ROLLUP_TIER_10S];
+    size_t slot = (t->head + t->cap - 1) % t->cap;
+    double mn[METRIC_FIELD_MAX], mx[METRIC_FIELD_MAX], av[METRIC_FIELD_MAX], ls[METRIC_FIELD_MAX];
+    rollup_tier_window(&st, t, slot, mn, mx, av, ls);
+    // cpu_percent é a primeira métrica
+    if (t->count != 4 || t->start_ts[slot] != 1080.0 || t->samples[slot] != 10 ||
+        mn[0] != 80.0 || mx[0] != 89.0 || av[0] != 84.5 || ls[0] != 89.0) {
+        printf("❌ Janela de 10 s incorreta.\n");
+        failures++;
+    }
+    // contador de 64 bits sem perda de unidades: em float, 2^40 + 89 viraria 2^40
+    int k_rchar = -1;
+    for (int k = 0; k < st.nmetrics; k++)
+        if (st.metric_idx[k] == metric_field_find("rchar")) k_rchar = k;
+    if (k_rchar < 0 || mn[k_rchar] != (double)(rchar0 + 80) || ls[k_rchar] != (double)(rchar0 + 89) ||
+        av[k_rchar] != (double)rchar0 + 84.5) {
+        printf("❌ Contador rchar perdeu precisão no agregado.\n");
+        failures++;
+    }
+    // janela aberta [1090,1100) ainda com 10 amostras acumuladas
+    if (t->acc_n != 10 || t->acc_start != 1090.0) {
+        printf("❌ Janela aberta incorreta.\n");
+        failures++;
+    }
+
+    rollup_store_free(&st);
+
+    // 4) tiers padrão de --long-run (1 amostra/s, 7 dias de janelas de 1 min)
+    //    com os campos padrão dentro de poucos MB
+    if (ROLLUP_DEFAULT_1M_DAYS < 7.0) {
+        printf("❌ Tier de 1 min padrão cobre menos de 7 dias.\n");
+        failures++;
+    }
+    if (rollup_store_init(&st, 42, (size_t)(ROLLUP_DEFAULT_RAW_MINUTES * 60.0),
+                          (size_t)(ROLLUP_DEFAULT_10S_HOURS * 360.0),
+                          (size_t)(ROLLUP_DEFAULT_1M_DAYS * 1440.0)) != 0) {
+        printf("❌ Falha ao alocar store padrão.\n");
+        return 1;
+    }
+    bytes = rollup_store_bytes(&st);
+    printf("Store padrão: %.1f MB (%d métricas)\n", bytes / (1024.0 * 1024.0), st.nmetrics);
+    if (st.nmetrics != export_get_fields()->count - 2) {
+        printf("❌ Store agrega %d métricas, seleção tem %d.\n", st.nmetrics, export_get_fields()->count - 2);
+        failures++;
+    }
+    if (bytes > 6u * 1024 * 1024) {
+        printf("❌ Store padrão ocupa %.1f MB (orçamento 6 MB).\n", bytes / (1024.0 * 1024.0));
+        failures++;
+    }
+    rollup_store_free(&st);
+
+    // 5) só as métricas de --fields entram nos agregados
+    export_set_fields("cpu_percent,rss_kb");
+    if (rollup_store_init(&st, 42, 5, 4, 2) != 0) {
+        printf("❌ Falha ao alocar store com --fields.\n");
+        return 1;
+    }
+    if (st.nmetrics != 2 || st.metric_idx[0] != metric_field_find("cpu_percent") ||
+        st.metric_idx[1] != metric_field_find("rss_kb") || st.nwide != 0) {
+        printf("❌ Store com --fields agrega %d métricas.\n", st.nmetrics);
+        failures++;
+    }
+    rollup_store_free(&st);
+    export_set_fields(NULL);
+    if (failures) return 1;
+    printf("✅ Teste de rollup concluído.\n");
+    return 0;
+}
@@ -0,0 +1,268 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "../include/sampler.h"
+#include "../include/selfstats.h"
+
+#define RING_ITEMS 200000
+
+static void *ring_producer(void *arg) {
+    spsc_ring_t *r = arg;
+    for (size_t i = 0; i < RING_ITEMS; i++) {
+        sample_item_t *it;
+        while (!(it = spsc_ring_reserve(r))) sched_yield();
+        it->m.timestamp = (double)i;
+        spsc_ring_commit(r);
+    }
+    return NULL;
+}
+
+/* anel pequeno com produtor e consumidor concorrentes: nada perdido, ordem mantida */
+static int test_ring(void) {
+    spsc_ring_t r;
+    if (spsc_ring_init(&r, 64) != 0) return 1;
+    if (spsc_ring_init(&(spsc_ring_t){0}, 48) == 0) {
+        printf("❌ capacidade não potência de 2 aceita\n");
+        return 1;
+    }
+    pthread_t th;
+    pthread_create(&th, NULL, ring_producer, &r);
+    int fail = 0;
+    for (size_t i = 0; i < RING_ITEMS && !fail; i++) {
+        const sample_item_t *it;
+        while (!(it = spsc_ring_peek(&r))) sched_yield();
+        if (it->m.timestamp != (double)i) {
+            printf("❌ anel fora de ordem: %zu -> %.0f\n", i, it->m.timestamp);
+            fail = 1;
+        }
+        spsc_ring_release(&r);
+    }
+    pthread_join(th, NULL);
+    spsc_ring_free(&r);
+    return fail;
+}
+
+/* consumidor parado: a coleta continua no ritmo e as amostras ficam na fila */
+static int test_stalled_consumer(void) {
+    sampler_config_t cfg = { .pid = getpid(), .interval_ms = 20, .max_samples = 10, .pin_cpu = -1 };
+    sampler_t s;
+    if (sampler_start(&s, &cfg) != 0) return 1;
+
+    usleep(300000);
+    size_t ahead = atomic_load(&s.produced);
+
+    sample_item_t it;
+    size_t got = 0;
+    int rc;
+    while ((rc = sampler_next(&s, &it, 1000)) >= 0) {
+        if (rc == 1) {
+            if (it.m.pid != cfg.pid) break;
+            got++;
+        }
+    }
+    sampler_finish(&s);
+
+    if (ahead < 5 || got != 10 || atomic_load(&s.dropped) != 0) {
+        printf("❌ consumidor parado: %zu prontas durante a pausa, %zu recebidas\n", ahead, got);
+        return 1;
+    }
+    return 0;
+}
+
+/* anel cheio: a coleta descarta e conta, sem bloquear */
+static int test_overflow(void) {
+    sampler_config_t cfg = { .pid = getpid(), .interval_ms = 10, .max_samples = 12,
+                             .pin_cpu = -1, .ring_capacity = 2 };
+    sampler_t s;
+    if (sampler_start(&s, &cfg) != 0) return 1;
+    usleep(400000);
+
+    sample_item_t it;
+    size_t got = 0;
+    while (sampler_next(&s, &it, 1000) >= 0) got++;
+    sampler_finish(&s);
+
+    size_t dropped = atomic_load(&s.dropped);
+    if (dropped == 0 || got + dropped < 12) {
+        printf("❌ anel cheio: %zu recebidas, %zu descartadas\n", got, dropped);
+        return 1;
+    }
+    return 0;
+}
+
+/* orçamento: acima corta cgroup/PSI e depois alarga; com folga volta; sinal escolhe o alvo */
+static int test_budget(void) {
+    sampler_budget_t b;
+    sampler_budget_init(&b, 0.5, 1000, 0, 0, SAMPLER_SHED_BIT(SAMPLER_SHED_CGROUP));
+    if (b.min_ms != 250 || b.max_ms != 8000 || b.interval_ms != 1000) {
+        printf("❌ limites padrão do intervalo: %ld..%ld\n", b.min_ms, b.max_ms);
+        return 1;
+    }
+
+    long iv = sampler_budget_update(&b, 2.0, 0, 0);
+    if (!b.shed || iv != 1000) {
+        printf("❌ primeiro excesso deveria cortar os opcionais (shed=%#x, %ld ms)\n", b.shed, iv);
+        return 1;
+    }
+    for (int i = 0; i < 20; i++) iv = sampler_budget_update(&b, 2.0, 0, 0);
+    if (iv != 8000 || b.widened == 0) {
+        printf("❌ excesso contínuo deveria chegar ao máximo: %ld ms\n", iv);
+        return 1;
+    }
+    /* urgência não passa por cima do orçamento */
+    if (sampler_budget_update(&b, 0.6, 1, 0) != 8000) {
+        printf("❌ urgência ignorou o piso do orçamento\n");
+        return 1;
+    }
+
+    for (int i = 0; i < 200; i++) iv = sampler_budget_update(&b, 0.05, 0, 0);
+    if (iv != 1000 || b.shed || b.floor_ms != b.min_ms || b.tightened == 0) {
+        printf("❌ folga deveria restaurar (%ld ms, shed=%#x, piso %ld)\n", iv, b.shed, b.floor_ms);
+        return 1;
+    }
+    if (sampler_budget_update(&b, 0.05, 1, 0) != 250) {
+        printf("❌ urgência com folga deveria usar o mínimo\n");
+        return 1;
+    }
+    for (int i = 0; i < SAMPLER_IDLE_TICKS; i++) iv = sampler_budget_update(&b, 0.05, 0, 1);
+    if (iv != 4000 || sampler_budget_update(&b, 0.05, 0, 0) != 1000) {
+        printf("❌ alvo ocioso: %ld ms\n", iv);
+        return 1;
+    }
+
+    /* sem opcionais para cortar, alarga já no primeiro excesso */
+    sampler_budget_init(&b, 1.0, 2000, 500, 4000, 0);
+    if (sampler_budget_update(&b, 5.0, 0, 0) != 3000 || b.shed) {
+        printf("❌ alargamento sem coletores opcionais\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* um coletor cortado por tick acima do orçamento, na ordem; religados na ordem inversa */
+static int test_shed_order(void) {
+    unsigned all = SAMPLER_SHED_BIT(SAMPLER_SHED_COUNT) - 1;
+    unsigned optional = all & ~SAMPLER_SHED_BIT(SAMPLER_SHED_NET);    // rede desligada: pulada
+    sampler_budget_t b;
+    sampler_budget_init(&b, 0.5, 1000, 0, 0, optional);
+
+    unsigned want = 0;
+    for (int c = 0; c < SAMPLER_SHED_COUNT; c++) {
+        if (!(optional & SAMPLER_SHED_BIT(c))) continue;
+        want |= SAMPLER_SHED_BIT(c);
+        sampler_budget_update(&b, 2.0, 0, 0);
+        if (b.shed != want || b.widened != 0) {
+            printf("❌ corte de %s: shed=%#x, esperado %#x\n", sampler_shed_name(c), b.shed, want);
+            return 1;
+        }
+    }
+    sampler_budget_update(&b, 2.0, 0, 0);
+    if (b.shed != optional || b.widened != 1) {
+        printf("❌ sem opcionais restantes deveria alargar (%zu)\n", b.widened);
+        return 1;
+    }
+
+    /* com folga: primeiro o piso volta ao mínimo, depois smaps, cgroup, perf, ... */
+    while (b.floor_ms > b.min_ms) sampler_budget_update(&b, 0.0, 0, 0);
+    for (int c = SAMPLER_SHED_COUNT - 1; c >= 0; c--) {
+        if (!(optional & SAMPLER_SHED_BIT(c))) continue;
+        want &= ~SAMPLER_SHED_BIT(c);
+        for (int i = 0; i < SAMPLER_CALM_TICKS && b.shed != want; i++) sampler_budget_update(&b, 0.0, 0, 0);
+        if (b.shed != want) {
+            printf("❌ religar %s: shed=%#x, esperado %#x\n", sampler_shed_name(c), b.shed, want);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* coleta real com todos os opcionais: cada um deixa de ser lido nas amostras em que está cortado */
+static int test_shed_collectors(void) {
+    selfstats_enable(1);
+    sampler_config_t cfg = { .pid = getpid(), .interval_ms = 20, .max_samples = 12, .pin_cpu = -1,
+                             .max_overhead_pct = 1e-6, .min_interval_ms = 20, .max_interval_ms = 40,
+                             .collect_cgroup = 1, .smaps_interval_ms = 20, .perf = 1, .schedstat = 1,
+                             .net = 1, .fds = 1 };
+    sampler_t s;
+    if (sampler_start(&s, &cfg) != 0) return 1;
+    static const self_collector_t probe[SAMPLER_SHED_COUNT] = {
+        SELF_SCHED, SELF_FD, SELF_NET, SELF_PERF, SELF_CGROUP, SELF_SMAPS,
+    };
+    unsigned long long ran[SAMPLER_SHED_COUNT] = {0};
+    unsigned seen = 0;
+    sample_item_t it;
+    int rc;
+    while ((rc = sampler_next(&s, &it, 1000)) >= 0) {
+        if (rc != 1) continue;
+        seen |= it.shed;
+        for (int c = 0; c < SAMPLER_SHED_COUNT; c++)
+            if (!(it.shed & SAMPLER_SHED_BIT(c))) ran[c]++;
+        if ((it.shed & SAMPLER_SHED_BIT(SAMPLER_SHED_CGROUP)) ? it.cg_valid : !it.cg_valid) {
+            printf("❌ cg_valid=%d com shed=%#x\n", it.cg_valid, it.shed);
+            sampler_finish(&s);
+            return 1;
+        }
+    }
+    sampler_finish(&s);
+    selfstats_enable(0);
+
+    int fail = 0;
+    for (int c = 0; c < SAMPLER_SHED_COUNT; c++) {
+        if (c == SAMPLER_SHED_PERF && !s.perf_ok) continue;   // sem perf_event_open no ambiente
+        if (!(seen & SAMPLER_SHED_BIT(c))) {
+            printf("❌ %s nunca foi cortado\n", sampler_shed_name(c));
+            fail = 1;
+        }
+        if (c == SAMPLER_SHED_SMAPS) continue;              // thread própria: conferida abaixo
+        unsigned long long n = selfstats_collector(probe[c])->time_ns.n;
+        if (n != ran[c]) {
+            printf("❌ %s lido %llu vezes, esperado %llu\n", sampler_shed_name(c), n, ran[c]);
+            fail = 1;
+        }
+    }
+    if (s.smaps.skipped == 0) {
+        printf("❌ smaps_rollup não pulou passadas com o orçamento estourado\n");
+        fail = 1;
+    }
+    return fail;
+}
+
+/* coleta adaptativa real: itens trazem o intervalo vigente e o orçamento é aplicado */
+static int test_adaptive_sampler(void) {
+    sampler_config_t cfg = { .pid = getpid(), .interval_ms = 40, .max_samples = 8, .pin_cpu = -1,
+                             .max_overhead_pct = 1e-6, .min_interval_ms = 20, .max_interval_ms = 80 };
+    sampler_t s;
+    if (sampler_start(&s, &cfg) != 0) return 1;
+    sample_item_t it;
+    long last = 0;
+    int rc;
+    while ((rc = sampler_next(&s, &it, 1000)) >= 0)
+        if (rc == 1) last = it.interval_ms;
+    sampler_finish(&s);
+    if (last != 80 || s.budget.widened == 0) {
+        printf("❌ orçamento mínimo deveria levar ao intervalo máximo: %ld ms\n", last);
+        return 1;
+    }
+    return 0;
+}
+
+int main() {
+    int failures = 0;
+    printf("=== Teste: Coleta em Thread (anel SPSC) ===\n");
+    monitor_set_verbose(0);
+    failures += test_ring();
+    failures += test_stalled_consumer();
+    failures += test_overflow();
+    failures += test_budget();
+    failures += test_shed_order();
+    failures += test_shed_collectors();
+    failures += test_adaptive_sampler();
+
+    if (failures == 0)
+        printf("✅ Teste de coleta em thread concluído.\n");
+    else
+        printf("❌ Teste de coleta em thread falhou (%d).\n", failures);
+    return failures ? 1 : 0;
+}
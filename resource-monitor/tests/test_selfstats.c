@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "../include/selfstats.h"
+#include "../include/sampler.h"
+
+/* quantis dentro do erro do bucket; valores pequenos exatos */
+static int test_histogram(void) {
+    self_hist_t h;
+    memset(&h, 0, sizeof(h));
+    for (uint64_t v = 1; v <= 100000; v++) self_hist_record(&h, v);
+    double p50 = (double)self_hist_quantile(&h, 0.5), p99 = (double)self_hist_quantile(&h, 0.99);
+    if (p50 < 50000 || p50 > 50000 * 1.125 || p99 < 99000 || p99 > 100000 || h.max != 100000) {
+        printf("❌ quantis do histograma: p50=%.0f p99=%.0f\n", p50, p99);
+        return 1;
+    }
+    memset(&h, 0, sizeof(h));
+    for (int i = 0; i < 10; i++) self_hist_record(&h, 3);
+    self_hist_record(&h, 7);
+    self_hist_record(&h, UINT64_MAX);
+    if (self_hist_quantile(&h, 0.5) != 3 || self_hist_quantile(&h, 0.95) != 7 ||
+        self_hist_quantile(&h, 1.0) != UINT64_MAX) {
+        printf("❌ buckets exatos/extremos incorretos\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* sonda: conta as leituras e os bytes do trecho, sem a própria leitura */
+static int test_probe(void) {
+    char buf[100];
+    int fd = open("/proc/self/stat", O_RDONLY);
+    self_probe_t p;
+
+    selfstats_enable(0);
+    selfstats_begin(&p);
+    selfstats_end(&p, SELF_IO);
+    if (selfstats_collector(SELF_IO)->time_ns.n != 0) {
+        printf("❌ registro com self-stats desligado\n");
+        close(fd);
+        return 1;
+    }
+
+    selfstats_enable(1);
+    ssize_t total = 0;
+    selfstats_begin(&p);
+    for (int i = 0; i < 5; i++) total += pread(fd, buf, sizeof(buf), 0);
+    selfstats_end(&p, SELF_IO);
+    close(fd);
+
+    const self_collector_stats_t *s = selfstats_collector(SELF_IO);
+    if (s->time_ns.n != 1 || s->syscalls.max != 5 || s->bytes.max != (uint64_t)total) {
+        printf("❌ sonda: %llu chamadas, %llu syscalls, %llu bytes (esperado 5, %zd)\n",
+               (unsigned long long)s->time_ns.n, (unsigned long long)s->syscalls.max,
+               (unsigned long long)s->bytes.max, total);
+        return 1;
+    }
+    return 0;
+}
+
+/* coleta real na thread de amostragem: cada coletor e o próprio monitor registrados */
+static int test_sampler_integration(void) {
+    selfstats_enable(1);
+    sampler_config_t cfg = { .pid = getpid(), .interval_ms = 20, .max_samples = 4, .pin_cpu = -1 };
+    sampler_t s;
+    if (sampler_start(&s, &cfg) != 0) return 1;
+    sample_item_t it;
+    while (sampler_next(&s, &it, 1000) >= 0) {}
+    sampler_finish(&s);
+
+    const self_collector_stats_t *cpu = selfstats_collector(SELF_CPU);
+    const self_collector_stats_t *tick = selfstats_collector(SELF_TICK);
+    if (cpu->time_ns.n != 4 || tick->time_ns.n != 4 || cpu->syscalls.max == 0 ||
+        tick->time_ns.max < cpu->time_ns.max) {
+        printf("❌ integração com a coleta: cpu=%llu tick=%llu syscalls=%llu\n",
+               (unsigned long long)cpu->time_ns.n, (unsigned long long)tick->time_ns.n,
+               (unsigned long long)cpu->syscalls.max);
+        return 1;
+    }
+
+    char base[] = "/tmp/test_selfstats_XXXXXX";
+    int fd = mkstemp(base);
+    if (fd >= 0) close(fd);
+    char path[64];
+    snprintf(path, sizeof(path), "%s.selfstats.csv", base);
+    int fail = selfstats_write(base) != 0;
+    FILE *f = fopen(path, "r");
+    char line[256];
+    int rows = 0, has_rss = 0;
+    while (f && fgets(line, sizeof(line), f)) {
+        rows++;
+        if (strncmp(line, "monitor,rss_kb,4,", 17) == 0) has_rss = 1;
+    }
+    if (f) fclose(f);
+    if (fail || rows < 10 || !has_rss) {
+        printf("❌ %s: %d linhas, rss do monitor %s\n", path, rows, has_rss ? "ok" : "ausente");
+        fail = 1;
+    }
+    unlink(path);
+    unlink(base);
+    return fail;
+}
+
+int main() {
+    int failures = 0;
+    printf("=== Teste: Custo do Monitor (self-stats) ===\n");
+    monitor_set_verbose(0);
+    failures += test_histogram();
+    failures += test_probe();
+    failures += test_sampler_integration();
+    selfstats_thread_done();
+
+    if (failures == 0)
+        printf("✅ Teste de self-stats concluído.\n");
+    else
+        printf("❌ Teste de self-stats falhou (%d).\n", failures);
+    return failures ? 1 : 0;
+}
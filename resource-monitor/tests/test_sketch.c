@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../include/sketch.h"
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* quantil exato usando o mesmo rank de ddsketch_quantile */
+static double exact_quantile(const double *sorted, size_t n, double q) {
+    return sorted[(size_t)floor(q * (double)(n - 1))];
+}
+
+int main() {
+    enum { N = 20000 };
+    static double vals[N];
+    ddsketch_t a, b, all;
+    int failures = 0;
+
+    printf("=== Teste: DDSketch ===\n");
+
+    ddsketch_init(&a, 0.01);
+    ddsketch_init(&b, 0.01);
+    ddsketch_init(&all, 0.01);
+
+    // distribuição de cauda longa (log-normal) + alguns zeros
+    srand(12345);
+    for (int i = 0; i < N; i++) {
+        double u1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+        double u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+        double z = sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+        double v = (i % 50 == 0) ? 0.0 : exp(8.0 + 2.0 * z);
+        vals[i] = v;
+        ddsketch_add(&all, v);
+        ddsketch_add((i % 2) ? &a : &b, v);
+    }
+    qsort(vals, N, sizeof(double), cmp_double);
+
+    // 1) erro relativo dentro de alpha (com folga para o rank discreto)
+    const double qs[] = { 0.5, 0.9, 0.99 };
+    for (size_t i = 0; i < 3; i++) {
+        double got = ddsketch_quantile(&all, qs[i]);
+        double want = exact_quantile(vals, N, qs[i]);
+        if (fabs(got - want) > 0.011 * want) {
+            printf("❌ q%.2f: got %.2f want %.2f\n", qs[i], got, want);
+            failures++;
+        }
+    }
+    if (ddsketch_quantile(&all, 1.0) != vals[N - 1]) {
+        printf("❌ max incorreto\n");
+        failures++;
+    }
+
+    // 2) merge de dois sketches == sketch único
+    if (ddsketch_merge(&a, &b) != 0 || a.count != all.count) {
+        printf("❌ merge falhou\n");
+        failures++;
+    }
+    for (size_t i = 0; i < 3; i++) {
+        if (ddsketch_quantile(&a, qs[i]) != ddsketch_quantile(&all, qs[i])) {
+            printf("❌ merge q%.2f difere\n", qs[i]);
+            failures++;
+        }
+    }
+
+    if (failures) return 1;
+    printf("✅ Teste de sketch concluído.\n");
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "../include/sampler.h"
+
+#define SHARED_MB 32
+#define NCHILDREN 3
+
+/* pai toca SHARED_MB e faz fork: as páginas ficam compartilhadas (COW) com os filhos */
+static int test_pss_split(pid_t *kids) {
+    size_t len = (size_t)SHARED_MB << 20;
+    char *mem = malloc(len);
+    if (!mem) return 1;
+    memset(mem, 0x5a, len);
+
+    for (int i = 0; i < NCHILDREN; i++) {
+        kids[i] = fork();
+        if (kids[i] == 0) {
+            volatile char sink = mem[len - 1];  // mantém o mapeamento vivo
+            (void)sink;
+            pause();
+            _exit(0);
+        }
+        if (kids[i] < 0) return 1;
+    }
+    usleep(100000);
+
+    smaps_rollup_t r[1 + NCHILDREN];
+    pid_t pids[1 + NCHILDREN] = { getpid(), kids[0], kids[1], kids[2] };
+    unsigned long pss_sum = 0, rss_sum = 0;
+    for (int i = 0; i <= NCHILDREN; i++) {
+        if (monitor_smaps_rollup(pids[i], &r[i]) != 0) {
+            printf("❌ smaps_rollup de %d não lido\n", pids[i]);
+            return 1;
+        }
+        pss_sum += r[i].pss_kb;
+        rss_sum += r[i].rss_kb;
+    }
+    unsigned long shared_kb = (unsigned long)SHARED_MB * 1024;
+    printf(" - RSS somado: %lu KB, PSS somado: %lu KB, USS do filho: %lu KB\n", rss_sum, pss_sum,
+           r[1].private_clean_kb + r[1].private_dirty_kb);
+
+    /* RSS conta a região em cada processo; a soma do PSS a conta uma vez */
+    if (rss_sum < shared_kb * (1 + NCHILDREN)) {
+        printf("❌ RSS somado deveria incluir %d cópias da região\n", 1 + NCHILDREN);
+        return 1;
+    }
+    if (pss_sum < shared_kb || pss_sum > shared_kb * 2) {
+        printf("❌ PSS somado deveria ficar perto de %lu KB: %lu KB\n", shared_kb, pss_sum);
+        return 1;
+    }
+    if (r[1].private_clean_kb + r[1].private_dirty_kb > shared_kb / 2) {
+        printf("❌ USS do filho deveria excluir a região compartilhada\n");
+        return 1;
+    }
+
+    pid_t kids_read[8];
+    int n = monitor_children(getpid(), kids_read, 8);
+    if (n != NCHILDREN) {
+        printf("❌ filhos diretos: %d (esperado %d)\n", n, NCHILDREN);
+        return 1;
+    }
+    if (monitor_smaps_rollup(999999999, &r[0]) == 0) {
+        printf("❌ PID inexistente deveria falhar\n");
+        return 1;
+    }
+    free(mem);
+    return 0;
+}
+
+/* custo medido alarga o intervalo além do configurado, nunca o encurta */
+static int test_cadence(void) {
+    if (sampler_smaps_interval(5000, 2.0, 1.0) != 5000 ||
+        sampler_smaps_interval(5000, 80.0, 1.0) != 8000 ||
+        sampler_smaps_interval(5000, 80.0, 0.0) != 5000) {
+        printf("❌ intervalo de smaps pelo custo incorreto\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* coleta com a thread lenta: totais chegam às amostras e ao CSV por processo */
+static int test_sampler_lane(void) {
+    char csv[] = "/tmp/test_smaps_XXXXXX";
+    int fd = mkstemp(csv);
+    if (fd < 0) return 1;
+    close(fd);
+
+    sampler_t s;
+    sampler_config_t cfg = {
+        .pid = getpid(),
+        .interval_ms = 100,
+        .max_samples = 8,
+        .pin_cpu = -1,
+        .smaps_interval_ms = 100,
+        .smaps_children = 1,
+        .smaps_csv = csv,
+    };
+    if (sampler_start(&s, &cfg) != 0) return 1;
+    sample_item_t it;
+    int rc, procs = 0;
+    unsigned long pss = 0;
+    while ((rc = sampler_next(&s, &it, 1000)) >= 0)
+        if (rc == 1 && it.smaps_procs > 0) {
+            procs = it.smaps_procs;
+            pss = it.smaps.pss_kb;
+        }
+    sampler_finish(&s);
+
+    FILE *fp = fopen(csv, "r");
+    int lines = 0;
+    char line[512];
+    while (fp && fgets(line, sizeof(line), fp)) lines++;
+    if (fp) fclose(fp);
+    unlink(csv);
+
+    if (procs != 1 + NCHILDREN || pss < (unsigned long)SHARED_MB * 1024 / 2 || s.smaps.passes == 0) {
+        printf("❌ amostras sem totais de smaps: %d processos, PSS %lu KB, %zu passadas\n",
+               procs, pss, s.smaps.passes);
+        return 1;
+    }
+    if (lines < 1 + (1 + NCHILDREN)) {
+        printf("❌ CSV de smaps com %d linhas\n", lines);
+        return 1;
+    }
+    return 0;
+}
+
+int main() {
+    int failures = 0;
+    pid_t kids[NCHILDREN] = {0};
+    printf("=== Teste: smaps_rollup (PSS/USS) ===\n");
+    monitor_set_verbose(0);
+
+    if (access("/proc/self/smaps_rollup", R_OK) != 0) {
+        printf("✅ Teste de smaps_rollup concluído (kernel sem smaps_rollup, ignorado).\n");
+        return 0;
+    }
+    failures += test_cadence();
+    failures += test_pss_split(kids);
+    if (failures == 0) failures += test_sampler_lane();
+
+    for (int i = 0; i < NCHILDREN; i++) {
+        if (kids[i] > 0) {
+            kill(kids[i], SIGTERM);
+            waitpid(kids[i], NULL, 0);
+        }
+    }
+
+    if (failures == 0)
+        printf("✅ Teste de smaps_rollup concluído.\n");
+    else
+        printf("❌ Teste de smaps_rollup falhou (%d).\n", failures);
+    return failures ? 1 : 0;
+}
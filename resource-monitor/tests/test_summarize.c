@@ -0,0 +1,154 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "../include/summarize.h"
+
+static void write_file(const char *dir, const char *name, const char *content) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *f = fopen(path, "w");
+    if (!f) return;
+    fputs(content, f);
+    fclose(f);
+}
+
+/* valor da coluna col na linha de dados cuja primeira coluna é key */
+static double read_cell(const char *path, const char *key, int col) {
+    FILE *f = fopen(path, "r");
+    if (!f) return NAN;
+    char line[1024];
+    double v = NAN;
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\n")] = '\0';
+        char *rest = line;
+        char *tok = strsep(&rest, ",");    // mantém campos vazios
+        if (strcmp(tok, key) != 0) continue;
+        for (int c = 1; c <= col && tok; c++) tok = strsep(&rest, ",");
+        if (tok && *tok) v = atof(tok);
+        break;
+    }
+    fclose(f);
+    return v;
+}
+
+static int near(double a, double b, double tol) { return fabs(a - b) <= tol; }
+
+int main() {
+    int failures = 0;
+    printf("=== Teste: Resumo de Experimentos ===\n");
+
+    char exp1[] = "/tmp/test_summarize_XXXXXX";
+    char exp3[] = "/tmp/test_summarize_XXXXXX";
+    if (!mkdtemp(exp1) || !mkdtemp(exp3)) {
+        printf("❌ mkdtemp\n");
+        return 1;
+    }
+
+    // Experimento 1: overhead de 10% em tempo, 20% em CPU e 5% de vazão no intervalo 1
+    write_file(exp1, "overhead_summary.csv",
+               "mode,interval,run,elapsed_sec,percent_cpu,throughput\n"
+               "baseline,1,1,10.0,50,1000\n"
+               "monitored,1,1,11.0,60,960\n"
+               "baseline,1,2,10.0,50,1000\n"
+               "monitored,1,2,11.0,60,940\n"
+               "baseline,0.5,1,10.0,50,\n"
+               "monitored,0.5,1,,,\n");
+    char rows[4096] = "Timestamp,PID,CPU%\n";
+    for (int i = 0; i < 20; i++) {
+        char line[64];
+        snprintf(line, sizeof(line), "%d,42,%d.00\n", 1000 + i, i < 10 ? 10 : 90);
+        strcat(rows, line);
+    }
+    write_file(exp1, "metrics_1_1.csv", rows);
+
+    char out[512];
+    if (summarize_experiment(exp1, NULL) != 0) {
+        printf("❌ summarize exp1 falhou\n");
+        failures++;
+    }
+    snprintf(out, sizeof(out), "%s/plots/aggregated_summary.csv", exp1);
+    if (!near(read_cell(out, "1", 3), 10.0, 1e-6) || !near(read_cell(out, "1", 6), 20.0, 1e-6)) {
+        printf("❌ overhead: tempo %.2f%% cpu %.2f%% (esperado 10%% e 20%%)\n",
+               read_cell(out, "1", 3), read_cell(out, "1", 6));
+        failures++;
+    }
+    if (!near(read_cell(out, "1", 13), 90.0, 1.0) || !near(read_cell(out, "1", 14), 1.0, 1e-6)) {
+        printf("❌ percentis de CPU/latência incorretos\n");
+        failures++;
+    }
+    if (!near(read_cell(out, "1", 18), 5.0, 1e-6) || !isnan(read_cell(out, "0.5", 18))) {
+        printf("❌ perda de vazão: %.2f%% (esperado 5%%)\n", read_cell(out, "1", 18));
+        failures++;
+    }
+    if (!isnan(read_cell(out, "0.5", 2))) {
+        printf("❌ intervalo sem monitorado válido deveria ficar vazio\n");
+        failures++;
+    }
+    snprintf(out, sizeof(out), "%s/plots/latency_per_run.csv", exp1);
+    if (!near(read_cell(out, "metrics_1_1.csv", 1), 20, 0) ||
+        !near(read_cell(out, "metrics_1_1.csv", 2), 1.0, 1e-9)) {
+        printf("❌ latency_per_run.csv incorreto\n");
+        failures++;
+    }
+
+    // Experimento 3: cota de 0.5 núcleo, medido 40% e 60% -> 100% de uso da cota
+    write_file(exp3, "exp3_results.csv",
+               "limit,trial,limit_cores,applied,max_cpu_pct,measured_cpu_pct,throughput_iters\n"
+               "0.5,1,0.5,yes,50000,40.0,100\n"
+               "0.5,2,0.5,no,50000,60.0,300\n");
+    snprintf(out, sizeof(out), "%s/agg", exp3);
+    if (summarize_experiment(exp3, out) != 0) {
+        printf("❌ summarize exp3 falhou\n");
+        failures++;
+    }
+    snprintf(out, sizeof(out), "%s/agg/exp3_agg.csv", exp3);
+    if (!near(read_cell(out, "0.5", 1), 2, 0) || !near(read_cell(out, "0.5", 2), 50.0, 1e-9) ||
+        !near(read_cell(out, "0.5", 3), sqrt(200.0), 1e-6) || !near(read_cell(out, "0.5", 5), 1, 0) ||
+        !near(read_cell(out, "0.5", 7), 100.0, 1e-9)) {
+        printf("❌ exp3_agg.csv incorreto\n");
+        failures++;
+    }
+
+    // Resultados largos: colunas usadas depois da 40ª (o cabeçalho não tem limite fixo)
+    char wide[] = "/tmp/test_summarize_XXXXXX";
+    if (!mkdtemp(wide)) {
+        printf("❌ mkdtemp\n");
+        return 1;
+    }
+    char content[2048] = "", pad[256] = "";
+    for (int i = 0; i < 40; i++) {
+        char col[16];
+        snprintf(col, sizeof(col), "pad%d,", i);
+        strcat(content, col);
+        strcat(pad, "0,");
+    }
+    strcat(content, "limit,trial,limit_cores,applied,max_cpu_pct,measured_cpu_pct,throughput_iters\n");
+    strcat(content, pad);
+    strcat(content, "0.5,1,0.5,yes,50000,40.0,100\n");
+    strcat(content, pad);
+    strcat(content, "0.5,2,0.5,no,50000,60.0,300\n");
+    write_file(wide, "exp3_results.csv", content);
+    if (summarize_experiment(wide, NULL) != 0) {
+        printf("❌ summarize com 47 colunas falhou\n");
+        failures++;
+    }
+    snprintf(out, sizeof(out), "%s/plots/exp3_agg.csv", wide);
+    if (!near(read_cell(out, "0.5", 1), 2, 0) || !near(read_cell(out, "0.5", 2), 50.0, 1e-9) ||
+        !near(read_cell(out, "0.5", 7), 100.0, 1e-9)) {
+        printf("❌ exp3_agg.csv com 47 colunas incorreto\n");
+        failures++;
+    }
+
+    char cmd[1200];
+    snprintf(cmd, sizeof(cmd), "rm -rf %s %s %s", exp1, exp3, wide);
+    if (system(cmd) != 0) printf("Aviso: não foi possível remover os diretórios temporários\n");
+
+    if (failures == 0)
+        printf("✅ Teste de resumo concluído.\n");
+    else
+        printf("❌ Teste de resumo falhou (%d).\n", failures);
+    return failures ? 1 : 0;
+}
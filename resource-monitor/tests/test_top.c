@@ -0,0 +1,280 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "../include/top.h"
+
+static top_row_t mk_row(pid_t pid, const char *comm, double cpu, unsigned long rss_kb,
+                        int threads, const char *cg, unsigned long pidns) {
+    top_row_t r;
+    memset(&r, 0, sizeof(r));
+    r.pid = pid;
+    snprintf(r.comm, sizeof(r.comm), "%s", comm);
+    r.state = 'S';
+    r.cpu_percent = cpu;
+    r.rss_kb = rss_kb;
+    r.threads = threads;
+    snprintf(r.cgroup, sizeof(r.cgroup), "%s", cg);
+    r.pidns = pidns;
+    r.netns = pidns;
+    r.net_rx_per_s = pidns == 1 ? 2048.0 : 0.0;    // tráfego do namespace, repetido em cada linha
+    r.spark[TOP_SPARK_LEN - 1] = (float)cpu;
+    return r;
+}
+
+static top_frame_t synthetic_frame(void) {
+    static top_row_t rows[5];
+    rows[0] = mk_row(10, "nginx", 5.0, 20000, 4, "/web", 1);
+    rows[1] = mk_row(11, "nginx", 15.0, 22000, 4, "/web", 1);
+    rows[2] = mk_row(20, "postgres", 40.0, 500000, 8, "/db", 2);
+    rows[3] = mk_row(30, "bash", 0.0, 4000, 1, "/", 1);
+    rows[4] = mk_row(31, "cron", 0.0, 3000, 1, "/", 1);
+    top_frame_t f = { .rows = rows, .count = 5, .cap = 5, .generation = 1, .cpu_total = 60.0 };
+    return f;
+}
+
+/* ordenação, inversão, filtro e ociosos sobre um quadro sintético */
+static int test_view(void) {
+    top_frame_t f = synthetic_frame();
+    top_view_t v;
+    top_line_t out[16];
+    top_view_default(&v);
+
+    size_t n = top_view_build(&v, &f, out, 16);
+    if (n != 5 || out[0].row->pid != 20 || out[1].row->pid != 11 || out[4].row->pid != 31) {
+        printf("❌ ordem por CPU incorreta\n");
+        return 1;
+    }
+    v.sort = TOP_SORT_MEM;
+    v.reverse = 1;
+    n = top_view_build(&v, &f, out, 16);
+    if (n != 5 || out[0].row->pid != 31 || out[4].row->pid != 20) {
+        printf("❌ ordem invertida por memória incorreta\n");
+        return 1;
+    }
+    top_view_default(&v);
+    snprintf(v.filter, sizeof(v.filter), "NGINX");
+    n = top_view_build(&v, &f, out, 16);
+    if (n != 2) {
+        printf("❌ filtro sem distinção de caixa: %zu linhas\n", n);
+        return 1;
+    }
+    snprintf(v.filter, sizeof(v.filter), "/db");
+    n = top_view_build(&v, &f, out, 16);
+    if (n != 1 || out[0].row->pid != 20) {
+        printf("❌ filtro por cgroup incorreto\n");
+        return 1;
+    }
+    top_view_default(&v);
+    v.hide_idle = 1;
+    n = top_view_build(&v, &f, out, 2);
+    if (n != 2) {
+        printf("❌ limite de linhas não respeitado\n");
+        return 1;
+    }
+    n = top_view_build(&v, &f, out, 16);
+    if (n != 3) {
+        printf("❌ ociosos não foram ocultados: %zu linhas\n", n);
+        return 1;
+    }
+    return 0;
+}
+
+/* grupos: cabeçalho com totais, ordenados pelo total da coluna */
+static int test_groups(void) {
+    top_frame_t f = synthetic_frame();
+    top_view_t v;
+    top_line_t out[16];
+    top_view_default(&v);
+    v.group = TOP_GROUP_CGROUP;
+
+    size_t n = top_view_build(&v, &f, out, 16);
+    if (n != 8 || !out[0].is_group || strcmp(out[0].key, "/db") != 0 ||
+        !out[2].is_group || strcmp(out[2].key, "/web") != 0 || out[2].nprocs != 2 ||
+        out[2].cpu_percent != 20.0 || out[3].row->pid != 11 || !out[5].is_group) {
+        printf("❌ agrupamento por cgroup incorreto (%zu linhas)\n", n);
+        return 1;
+    }
+    v.group = TOP_GROUP_PIDNS;
+    v.sort = TOP_SORT_MEM;
+    n = top_view_build(&v, &f, out, 16);
+    if (n != 7 || strcmp(out[0].key, "pidns:2") != 0 || out[2].rss_kb != 49000 || out[2].nprocs != 4) {
+        printf("❌ agrupamento por namespace incorreto (%zu linhas)\n", n);
+        return 1;
+    }
+    v.group = TOP_GROUP_NETNS;
+    n = top_view_build(&v, &f, out, 16);
+    char buf[256];
+    top_format_line(&out[2], buf, sizeof(buf), 120);
+    if (n != 7 || strcmp(out[2].key, "netns:1") != 0 || !out[2].has_net || out[2].net_rx_per_s != 2048.0 ||
+        !strstr(buf, "rx 2.0 KB/s")) {
+        printf("❌ agrupamento por netns incorreto: \"%s\"\n", buf);
+        return 1;
+    }
+    return 0;
+}
+
+/* largura: nenhuma linha passa da tela; histórico some em telas estreitas */
+static int test_format(void) {
+    top_frame_t f = synthetic_frame();
+    top_line_t l = { .row = &f.rows[2], .cpu_percent = 40.0, .rss_kb = 500000, .nprocs = 1 };
+    char buf[512];
+
+    top_format_line(&l, buf, sizeof(buf), 30);
+    if (strlen(buf) != 30) {
+        printf("❌ linha não truncada em 30 colunas: \"%s\"\n", buf);
+        return 1;
+    }
+    top_format_line(&l, buf, sizeof(buf), 120);
+    if (!strstr(buf, "postgres") || !strstr(buf, "▄") || !strstr(buf, "40.0")) {
+        printf("❌ linha sem comando, histórico ou CPU: \"%s\"\n", buf);
+        return 1;
+    }
+    top_format_line(&l, buf, sizeof(buf), 50);
+    if (strstr(buf, "▄")) {
+        printf("❌ histórico em tela estreita\n");
+        return 1;
+    }
+    top_format_header(buf, sizeof(buf), 120);
+    if (!strstr(buf, "PID") || !strstr(buf, "COMANDO")) {
+        printf("❌ cabeçalho incompleto\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* varredura real: o próprio processo aparece e o CPU% sai da segunda leitura */
+static int test_scan(void) {
+    top_collector_t c;
+    top_frame_t snap = {0};
+    top_collector_init(&c, 50);
+    if (top_collector_scan(&c) != 0 || top_snapshot(&c, &snap) != 1) {
+        printf("❌ primeira varredura falhou\n");
+        top_collector_free(&c);
+        return 1;
+    }
+    if (top_snapshot(&c, &snap) != 0) {
+        printf("❌ quadro repetido reportado como novo\n");
+        top_collector_free(&c);
+        return 1;
+    }
+
+    volatile double x = 0;
+    for (long i = 0; i < 30000000; i++) x += i * 0.5;
+    top_collector_scan(&c);
+    top_snapshot(&c, &snap);
+
+    int fail = 1;
+    for (size_t i = 0; i < snap.count; i++) {
+        const top_row_t *r = &snap.rows[i];
+        if (r->pid != getpid()) continue;
+        if (r->rss_kb > 0 && r->threads >= 1 && r->cpu_percent > 0.0 && r->cgroup[0] == '/')
+            fail = 0;
+        else
+            printf("❌ linha do próprio processo: rss=%lu thr=%d cpu=%.1f cg=%s\n",
+                   r->rss_kb, r->threads, r->cpu_percent, r->cgroup);
+        break;
+    }
+    if (fail && snap.count) printf("❌ próprio PID ausente em %zu processos\n", snap.count);
+    for (size_t i = 1; i < snap.count; i++) {
+        if (snap.rows[i - 1].pid >= snap.rows[i].pid) {
+            printf("❌ quadro fora de ordem de PID\n");
+            fail = 1;
+            break;
+        }
+    }
+
+    /* thread coletora publica sozinha e para sob demanda */
+    unsigned long gen = snap.generation;
+    top_collector_start(&c);
+    usleep(200000);
+    top_snapshot(&c, &snap);
+    if (snap.generation <= gen) {
+        printf("❌ thread coletora não publicou quadros\n");
+        fail = 1;
+    }
+    top_collector_free(&c);
+    top_frame_free(&snap);
+    return fail;
+}
+
+/* varredura no pool: mesmo resultado da serial, com as threads pedidas */
+static int test_parallel_scan(void) {
+    top_collector_t c;
+    top_frame_t snap = {0};
+    top_collector_init(&c, 50);
+    c.workers = 3;
+    top_collector_scan(&c);
+    top_collector_scan(&c);
+    top_snapshot(&c, &snap);
+
+    int fail = snap.workers != 3;
+    int found = 0;
+    for (size_t i = 0; i < snap.count; i++) {
+        if (snap.rows[i].pid == getpid() && snap.rows[i].rss_kb > 0) found = 1;
+        if (i > 0 && snap.rows[i - 1].pid >= snap.rows[i].pid) fail = 1;
+    }
+    if (fail || !found)
+        printf("❌ varredura paralela: %d threads, próprio PID %s\n",
+               snap.workers, found ? "presente" : "ausente");
+    top_collector_free(&c);
+    top_frame_free(&snap);
+    return fail || !found;
+}
+
+/* backends de leitura: mesmos processos com pread e io_uring; PID que sai é descartado */
+static int test_io_backends(void) {
+    int fail = 0;
+    for (int be = BATCHREAD_URING; be <= BATCHREAD_PREAD; be++) {
+        top_collector_t c;
+        top_frame_t snap = {0};
+        top_collector_init(&c, 50);
+        c.io_backend = be;
+        c.workers = 1;
+
+        pid_t child = fork();
+        if (child == 0) {
+            pause();
+            _exit(0);
+        }
+        top_collector_scan(&c);
+        kill(child, SIGKILL);
+        waitpid(child, NULL, 0);
+        top_collector_scan(&c);
+        top_snapshot(&c, &snap);
+
+        int self = 0, gone = 1;
+        for (size_t i = 0; i < snap.count; i++) {
+            if (snap.rows[i].pid == getpid() && snap.rows[i].threads >= 1) self = 1;
+            if (snap.rows[i].pid == child) gone = 0;
+        }
+        if (!self || !gone) {
+            printf("❌ backend %s: próprio PID %s, filho encerrado %s\n", snap.io_backend,
+                   self ? "presente" : "ausente", gone ? "removido" : "ainda listado");
+            fail = 1;
+        }
+        if (be == BATCHREAD_PREAD && snap.io_syscalls != snap.count) fail = 1;
+        top_collector_free(&c);
+        top_frame_free(&snap);
+    }
+    return fail;
+}
+
+int main() {
+    int failures = 0;
+    printf("=== Teste: Painel Top ===\n");
+    failures += test_view();
+    failures += test_groups();
+    failures += test_format();
+    failures += test_scan();
+    failures += test_parallel_scan();
+    failures += test_io_backends();
+
+    if (failures == 0)
+        printf("✅ Teste de painel top concluído.\n");
+    else
+        printf("❌ Teste de painel top falhou (%d).\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,58 @@
+#include <stdio.h>
+#include <math.h>
+#include "../include/trend.h"
+
+int main() {
+    int failures = 0;
+    trend_t tr;
+    trend_estimate_t est;
+    printf("=== Teste: Tendência ===\n");
+
+    // 1) vazamento de 1 MB/s com ruído e picos isolados (ex: GC)
+    const double mb = 1024.0 * 1024.0;
+    trend_init(&tr, 60.0);
+    for (int t = 0; t < 300; t++) {
+        double y = 100.0 * mb + t * mb + ((t * 7919) % 13 - 6) * 0.05 * mb;
+        if (t % 37 == 0) y += 80.0 * mb;
+        trend_add(&tr, 1000.0 + t, y);
+    }
+    if (trend_estimate(&tr, &est) != 0 || isnan(est.slope_robust)) {
+        printf("❌ estimativa indisponível\n");
+        failures++;
+    } else {
+        if (fabs(est.slope - mb) > 0.05 * mb) {
+            printf("❌ inclinação %.0f, esperado %.0f\n", est.slope, mb);
+            failures++;
+        }
+        double eta = trend_time_to(&est, 500.0 * mb);
+        // nível em t=299 ~ 399 MB -> ~101 s até 500 MB
+        if (fabs(eta - 101.0) > 10.0) {
+            printf("❌ tempo até o limite %.1f s, esperado ~101 s\n", eta);
+            failures++;
+        }
+    }
+
+    // 2) série estável não prevê OOM
+    trend_init(&tr, 60.0);
+    for (int t = 0; t < 200; t++) trend_add(&tr, t, 50.0 * mb + (t % 3) * 1024.0);
+    if (trend_estimate(&tr, &est) == 0 && !isinf(trend_time_to(&est, 100.0 * mb)) &&
+        trend_time_to(&est, 100.0 * mb) < 86400.0) {
+        printf("❌ série estável previu OOM\n");
+        failures++;
+    }
+
+    // 3) poucos pontos: sem estimativa
+    trend_init(&tr, 60.0);
+    trend_add(&tr, 0, 1.0);
+    trend_add(&tr, 1, 2.0);
+    if (trend_estimate(&tr, &est) == 0) {
+        printf("❌ estimativa com 2 pontos\n");
+        failures++;
+    }
+
+    if (failures == 0)
+        printf("✅ Teste de tendência concluído.\n");
+    else
+        printf("❌ Teste de tendência falhou (%d).\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "../include/workpool.h"
+
+#define NTASKS 10000
+
+typedef struct {
+    atomic_int *hits;
+    size_t slow_below;      // tarefas < slow_below dormem slow_us
+    long slow_us;
+} job_t;
+
+static void task(void *ctx, size_t i) {
+    job_t *j = ctx;
+    if (i < j->slow_below) usleep((useconds_t)j->slow_us);
+    atomic_fetch_add(&j->hits[i], 1);
+}
+
+static double now_ms(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec * 1e3 + (double)t.tv_nsec / 1e6;
+}
+
+/* cada tarefa roda exatamente uma vez por tick, em vários ticks seguidos */
+static int test_exactly_once(workpool_t *p) {
+    atomic_int *hits = calloc(NTASKS, sizeof(*hits));
+    job_t j = { hits, 0, 0 };
+    for (int tick = 1; tick <= 5; tick++) {
+        workpool_run(p, NTASKS, task, &j);
+        for (size_t i = 0; i < NTASKS; i++) {
+            if (atomic_load(&hits[i]) != tick) {
+                printf("❌ tarefa %zu executada %d vezes no tick %d\n", i, atomic_load(&hits[i]), tick);
+                free(hits);
+                return 1;
+            }
+        }
+    }
+    workpool_run(p, 0, task, &j);   // tick vazio não trava
+    free(hits);
+    return 0;
+}
+
+/* alvos lentos concentrados na faixa do primeiro worker: os outros roubam */
+static int test_slow_targets(workpool_t *p) {
+    const size_t n = 64;
+    const long slow_us = 20000;
+    atomic_int hits[64] = {0};
+    job_t j = { hits, 16, slow_us };
+
+    double t0 = now_ms();
+    workpool_run(p, n, task, &j);
+    double elapsed = now_ms() - t0;
+
+    /* sem roubo, o primeiro worker leria as 16 lentas em série (320 ms) */
+    double serial_shard = 16 * slow_us / 1000.0;
+    size_t steals = atomic_load(&p->steals);
+    if (steals == 0 || elapsed > serial_shard * 0.6) {
+        printf("❌ alvos lentos: %.1f ms com %zu roubos (faixa serial %.0f ms)\n",
+               elapsed, steals, serial_shard);
+        return 1;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (atomic_load(&hits[i]) != 1) {
+            printf("❌ tarefa %zu perdida após roubo\n", i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main() {
+    int failures = 0;
+    printf("=== Teste: Pool de Coleta (roubo de trabalho) ===\n");
+    workpool_t p;
+    if (workpool_init(&p, 4) != 0) {
+        printf("❌ workpool_init falhou\n");
+        return 1;
+    }
+    failures += test_exactly_once(&p);
+    failures += test_slow_targets(&p);
+    workpool_free(&p);
+
+    if (failures == 0)
+        printf("✅ Teste de pool de coleta concluído.\n");
+    else
+        printf("❌ Teste de pool de coleta falhou (%d).\n", failures);
+    return failures ? 1 : 0;
+}
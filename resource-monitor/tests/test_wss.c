@@ -0,0 +1,88 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include "../include/wss.h"
+#include "../include/monitor.h"
+
+#define TOTAL_MB 64
+#define HOT_MB 8
+
+/* trechos do bitmap: lacunas curtas juntam, longas separam, tamanho máximo corta */
+static int test_plan_runs(void) {
+    uint64_t pfns[] = { 0, 1, 63, 64, 200, 64 * 1000, 64 * 1000 + 5 };
+    wss_run_t runs[8];
+    size_t nr = wss_plan_runs(pfns, 7, 1024, 4, runs, 8);
+    if (nr != 2 || runs[0].word != 0 || runs[0].nwords != 4 || runs[1].word != 1000 || runs[1].nwords != 1) {
+        printf("❌ trechos com lacuna: %zu\n", nr);
+        return 1;
+    }
+    nr = wss_plan_runs(pfns, 5, 2, 4, runs, 8);     // palavras 0,1,3 com no máximo 2 por trecho
+    if (nr != 2 || runs[0].nwords != 2 || runs[1].word != 3) {
+        printf("❌ trechos limitados por tamanho: %zu\n", nr);
+        return 1;
+    }
+    if (wss_plan_runs(pfns, 7, 1024, 4, runs, 1) != 1 || wss_plan_runs(pfns, 0, 1024, 4, runs, 8) != 0) {
+        printf("❌ limite de trechos ignorado\n");
+        return 1;
+    }
+    if (wss_method_parse("refs") != WSS_REFS || wss_method_parse("x") != -1) {
+        printf("❌ nomes de método\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* filho residente em TOTAL_MB, tocando sem parar só os primeiros HOT_MB */
+static int test_measure(void) {
+    pid_t child = fork();
+    if (child == 0) {
+        size_t len = (size_t)TOTAL_MB << 20, hot = (size_t)HOT_MB << 20;
+        volatile char *mem = malloc(len);
+        if (!mem) _exit(1);
+        for (size_t i = 0; i < len; i += 4096) mem[i] = 1;
+        for (;;) {
+            for (size_t i = 0; i < hot; i += 4096) mem[i]++;
+            usleep(5000);
+        }
+    }
+    if (child < 0) return 1;
+    usleep(300000);
+
+    wss_result_t r;
+    int fail = 0;
+    if (wss_measure(child, 0.5, WSS_AUTO, &r) != 0) {
+        printf("❌ medição falhou\n");
+        fail = 1;
+    } else {
+        printf(" - método %s: WSS %lu KB de %lu KB residentes em %.2f s\n",
+               wss_method_name(r.method), r.wss_kb, r.rss_kb, r.window_s);
+        unsigned long hot_kb = HOT_MB * 1024, total_kb = TOTAL_MB * 1024;
+        if (r.rss_kb < total_kb || r.wss_kb < hot_kb || r.wss_kb > total_kb / 2) {
+            printf("❌ WSS deveria ficar perto de %lu KB, bem abaixo do RSS\n", hot_kb);
+            fail = 1;
+        }
+    }
+    kill(child, SIGKILL);
+    waitpid(child, NULL, 0);
+    return fail;
+}
+
+int main() {
+    int failures = 0;
+    printf("=== Teste: Working Set (WSS) ===\n");
+    failures += test_plan_runs();
+
+    if (access("/proc/self/clear_refs", W_OK) == 0 || access("/sys/kernel/mm/page_idle/bitmap", R_OK) == 0)
+        failures += test_measure();
+    else
+        printf(" - sem clear_refs nem page_idle: medição ignorada\n");
+
+    if (failures == 0)
+        printf("✅ Teste de working set concluído.\n");
+    else
+        printf("❌ Teste de working set falhou (%d).\n", failures);
+    return failures ? 1 : 0;
+}